@@ -45,6 +45,12 @@ class Recognizer(avg.Publisher):
         self.__node.subscribe(avg.Node.KILLED, self.__onNodeGone)
         self.__isContinuous = isContinuous
         self.__maxContacts = maxContacts
+        # Contact motion events and frames are only dispatched to recognizers that
+        # handle them.
+        self.__needsMotionEvents = (self.__isOverridden("_handleMove") or
+                self.__isOverridden("_handleChange"))
+        self.__needsFrames = (self.__isOverridden("_onFrame") or
+                self.__isOverridden("_handleChange"))
 
         self.__downHandlerID = None
         self.__moveHandlerID = {}
@@ -132,12 +138,13 @@ class Recognizer(avg.Publisher):
         if event.contact and not(nodeGone):
             if (self.__maxContacts is None or len(self._contacts) <
                     self.__maxContacts):
-                self.__moveHandlerID[event.contact] = event.contact.subscribe(
-                        avg.Contact.CURSOR_MOTION, self.__onMotion)
+                if self.__needsMotionEvents:
+                    self.__moveHandlerID[event.contact] = event.contact.subscribe(
+                            avg.Contact.CURSOR_MOTION, self.__onMotion)
                 self.__upHandlerID[event.contact] = event.contact.subscribe(
                         avg.Contact.CURSOR_UP, self.__onUp)
                 self._contacts.add(event.contact)
-                if len(self._contacts) == 1:
+                if len(self._contacts) == 1 and self.__needsFrames:
                     self.__frameHandlerID = player.subscribe(player.ON_FRAME, 
                             self._onFrame)
                 self.__dirty = True
@@ -153,10 +160,10 @@ class Recognizer(avg.Publisher):
         nodeGone = self._handleNodeGone()
         if event.contact and not(nodeGone):
             self.__dirty = True
-            del self.__moveHandlerID[event.contact]
+            self.__moveHandlerID.pop(event.contact, None)
             del self.__upHandlerID[event.contact]
             self._contacts.remove(event.contact)
-            if len(self._contacts) == 0:
+            if len(self._contacts) == 0 and self.__frameHandlerID:
                 player.unsubscribe(player.ON_FRAME, self.__frameHandlerID)
                 self.__frameHandlerID = None
             self._handleUp(event)
@@ -172,7 +179,9 @@ class Recognizer(avg.Publisher):
 
     def _disconnectContacts(self):
         for contact in self._contacts:
-            contact.unsubscribe(avg.Contact.CURSOR_MOTION, self.__moveHandlerID[contact])
+            if contact in self.__moveHandlerID:
+                contact.unsubscribe(avg.Contact.CURSOR_MOTION,
+                        self.__moveHandlerID[contact])
             contact.unsubscribe(avg.Contact.CURSOR_UP, self.__upHandlerID[contact])
         self.__moveHandlerID = {}
         self.__upHandlerID = {}
@@ -224,6 +233,10 @@ class Recognizer(avg.Publisher):
             self.__downHandlerID = self.__node.subscribe(
                     avg.Node.CURSOR_DOWN, self.__onDown)
 
+    def __isOverridden(self, methodName):
+        return (getattr(type(self), methodName).__func__ is not 
+                getattr(Recognizer, methodName).__func__)
+
 
 class TapRecognizer(Recognizer):
 
@@ -235,33 +248,33 @@ class TapRecognizer(Recognizer):
         if maxDist is None:
             maxDist = TapRecognizer.MAX_TAP_DIST
         self.__maxDist = maxDist
+        # Distance and time checks are done natively once per frame.
+        if maxTime:
+            self.__tracker = avg.TapTracker(maxDist, maxTime)
+        else:
+            self.__tracker = avg.TapTracker(maxDist)
+        self.__tracker.subscribe(avg.TapTracker.OUT_OF_RANGE, self.__onTrackerFail)
+        self.__tracker.subscribe(avg.TapTracker.TIMEOUT, self.__onTrackerFail)
         super(TapRecognizer, self).__init__(node, False, 1, initialEvent,
                 possibleHandler, failHandler, detectedHandler)
 
     def _handleDown(self, event):
         self._setPossible(event)
-        self.__startTime = player.getFrameTime()
-
-    def _handleMove(self, event):
-        if self.getState() != "IDLE": 
-            if (event.contact.distancefromstart > 
-                    self.__maxDist*player.getPixelsPerMM()):
-                self._setFail(event)
+        self.__tracker.start(event.contact)
 
     def _handleUp(self, event):
+        self.__tracker.update()
         if self.getState() == "POSSIBLE":
-            if (event.contact.distancefromstart > 
-                    self.__maxDist*player.getPixelsPerMM()):
-                self._setFail(event)
-            else:
-                self._setDetected(event)
+            self.__tracker.stop()
+            self._setDetected(event)
 
-    def _onFrame(self):
-        downTime = player.getFrameTime() - self.__startTime
-        if self.getState() == "POSSIBLE":
-            if self.__maxTime and downTime > self.__maxTime:
-                self._setFail(None)
-        super(TapRecognizer, self)._onFrame()
+    def _disconnectContacts(self):
+        self.__tracker.stop()
+        super(TapRecognizer, self)._disconnectContacts()
+
+    def __onTrackerFail(self):
+        if not(self._handleNodeGone()) and self.getState() == "POSSIBLE":
+            self._setFail(None)
 
 
 class DoubletapRecognizer(Recognizer):
@@ -283,7 +296,10 @@ class DoubletapRecognizer(Recognizer):
         self.__stateMachine.addState("UP1", ("DOWN2", "IDLE"))
         self.__stateMachine.addState("DOWN2", ("IDLE",))
         #self.__stateMachine.traceChanges(True)
-        self.__frameHandlerID = None
+        # Distance and time checks are done natively once per frame.
+        self.__tracker = avg.TapTracker(maxDist, maxTime)
+        self.__tracker.subscribe(avg.TapTracker.OUT_OF_RANGE, self.__onTrackerFail)
+        self.__tracker.subscribe(avg.TapTracker.TIMEOUT, self.__onTrackerFail)
         super(DoubletapRecognizer, self).__init__(node, False, 1, 
                 initialEvent, possibleHandler, failHandler, detectedHandler)
 
@@ -298,53 +314,40 @@ class DoubletapRecognizer(Recognizer):
         super(DoubletapRecognizer, self).enable(isEnabled)
 
     def _handleDown(self, event):
-        self.__startTime = player.getFrameTime()
         if self.__stateMachine.state == "IDLE":
-            self.__frameHandlerID = player.subscribe(player.ON_FRAME, self.__onFrame)
             self.__stateMachine.changeState("DOWN1")
-            self.__startPos = event.pos
+            self.__tracker.start(event.contact)
             self._setPossible(event)
         elif self.__stateMachine.state == "UP1":
-            if ((event.pos - self.__startPos).getNorm() > 
-                    self.__maxDist*player.getPixelsPerMM()):
-                self.__stateMachine.changeState("IDLE")
-                self._setFail(event)
-            else:
+            self.__tracker.restartTimer()
+            self.__tracker.setContact(event.contact)
+            self.__tracker.update()
+            if self.__stateMachine.state == "UP1":
                 self.__stateMachine.changeState("DOWN2")
         else:
             assert(False), self.__stateMachine.state
 
-    def _handleMove(self, event):
-        if self.__stateMachine.state != "IDLE": 
-            if ((event.pos - self.__startPos).getNorm() > 
-                    self.__maxDist*player.getPixelsPerMM()):
-                self.__stateMachine.changeState("IDLE")
-                self._setFail(event)
-
     def _handleUp(self, event):
+        self.__tracker.update()
         if self.__stateMachine.state == "DOWN1":
-            self.__startTime = player.getFrameTime()
+            self.__tracker.restartTimer()
+            self.__tracker.setContact(None)
             self.__stateMachine.changeState("UP1")
         elif self.__stateMachine.state == "DOWN2":
-            if ((event.pos - self.__startPos).getNorm() >
-                    self.__maxDist*player.getPixelsPerMM()):
-                self._setFail(event)
-            else:
-                self._setDetected(event)
+            self._setDetected(event)
             self.__stateMachine.changeState("IDLE")
         elif self.__stateMachine.state == "IDLE":
             pass
         else:
             assert(False), self.__stateMachine.state
 
-    def __onFrame(self):
-        downTime = player.getFrameTime() - self.__startTime
-        if downTime > self.__maxTime:
-            self._setFail(None)
+    def __onTrackerFail(self):
+        if not(self._handleNodeGone()) and self.__stateMachine.state != "IDLE":
             self.__stateMachine.changeState("IDLE")
+            self._setFail(None)
 
     def __enterIdle(self):
-        player.unsubscribe(player.ON_FRAME, self.__frameHandlerID)
+        self.__tracker.stop()
 
 
 class SwipeRecognizer(Recognizer):
@@ -382,9 +385,6 @@ class SwipeRecognizer(Recognizer):
         if len(self._contacts) == self.__numContacts:
             self._setPossible(event)
 
-    def _handleMove(self, event):
-        pass
-
     def _handleUp(self, event):
         if self.getState() == "POSSIBLE":
             if (event.contact.distancefromstart < self.__minDist or
@@ -430,8 +430,11 @@ class HoldRecognizer(Recognizer):
         if maxDist is None:
             maxDist = TapRecognizer.MAX_TAP_DIST
         self.__maxDist = maxDist
+        # Distance and delay checks are done natively once per frame.
+        self.__tracker = avg.TapTracker(maxDist, delay)
+        self.__tracker.subscribe(avg.TapTracker.OUT_OF_RANGE, self.__onOutOfRange)
+        self.__tracker.subscribe(avg.TapTracker.TIMEOUT, self.__onTimeout)
 
-        self.__lastEvent = None
         if stopHandler is not None:
             endHandler = stopHandler
             warnings.warn(
@@ -440,30 +443,28 @@ class HoldRecognizer(Recognizer):
                 possibleHandler, failHandler, detectedHandler, endHandler)
 
     def _handleDown(self, event):
-        self.__lastEvent = event
         self._setPossible(event)
-        self.__startTime = player.getFrameTime()
-
-    def _handleMove(self, event):
-        self.__lastEvent = event
-        if self.getState() == "POSSIBLE": 
-            if (event.contact.distancefromstart > 
-                    self.__maxDist*player.getPixelsPerMM()):
-                self._setFail(event)
+        self.__tracker.start(event.contact)
 
     def _handleUp(self, event):
-        self.__lastEvent = event
+        self.__tracker.update()
+        self.__tracker.stop()
         if self.getState() == "POSSIBLE":
             self._setFail(event)
         elif self.getState() == "RUNNING":
             self._setEnd(event)
 
-    def _onFrame(self):
-        downTime = player.getFrameTime() - self.__startTime
-        if self.getState() == "POSSIBLE":
-            if downTime > self.__delay:
-                self._setDetected(self.__lastEvent)
-        super(HoldRecognizer, self)._onFrame()
+    def _disconnectContacts(self):
+        self.__tracker.stop()
+        super(HoldRecognizer, self)._disconnectContacts()
+
+    def __onOutOfRange(self):
+        if not(self._handleNodeGone()) and self.getState() == "POSSIBLE":
+            self._setFail(None)
+
+    def __onTimeout(self):
+        if not(self._handleNodeGone()) and self.getState() == "POSSIBLE":
+            self._setDetected(None)
 
 
 class DragRecognizer(Recognizer):
@@ -507,6 +508,13 @@ class DragRecognizer(Recognizer):
         self.__isSliding = False
         self.__inertiaHandler = None
 
+        # Drag detection and motion are handled natively once per frame.
+        self.__tracker = avg.DragTracker(self.__direction, self.__directionTolerance,
+                self.__minDragDist)
+        self.__tracker.subscribe(avg.DragTracker.DETECTED, self.__onTrackerDetected)
+        self.__tracker.subscribe(avg.DragTracker.FAILED, self.__onTrackerFailed)
+        self.__tracker.subscribe(avg.DragTracker.MOTION, self.__onTrackerMotion)
+
         super(DragRecognizer, self).__init__(eventNode, True, 1, 
                 initialEvent, possibleHandler=possibleHandler, failHandler=failHandler, 
                 detectedHandler=detectedHandler, endHandler=endHandler)
@@ -514,6 +522,7 @@ class DragRecognizer(Recognizer):
         self.subscribe(Recognizer.UP, upHandler)
 
     def abort(self):
+        self.__tracker.stop()
         if self.__inertiaHandler:
             self.__inertiaHandler.abort()
         self.__inertiaHandler = None
@@ -531,44 +540,32 @@ class DragRecognizer(Recognizer):
                 self._setDetected(event)
             else:
                 self._setPossible(event)
-            pos = self._relEventPos(self.__coordSysNode(), event)
-            self.__dragStartPos = pos
-            self.__lastPos = pos
-
-    def _handleMove(self, event):
-        if not self._handleCoordSysNodeUnlinked():
-            if self.getState() != "IDLE":
-                pos = self._relEventPos(self.__coordSysNode(), event)
-                offset = pos - self.__dragStartPos
-                if self.getState() == "RUNNING":
-                    self.notifySubscribers(Recognizer.MOTION, [offset])
-                else:
-                    if offset.getNorm() > self.__minDragDist*player.getPixelsPerMM():
-                        if self.__angleFits(offset):
-                            self._setDetected(event)
-                            self.notifySubscribers(Recognizer.MOTION, [offset])
-                        else:
-                            self.__fail(event)
-                if self.__inertiaHandler:
-                    self.__inertiaHandler.onDrag(Transform(pos - self.__lastPos))
-                self.__lastPos = pos
+            self.__tracker.start(event.contact, self.__coordSysNode())
+            self.__lastOffset = avg.Point2D(0, 0)
 
     def _handleUp(self, event):
         if not self._handleCoordSysNodeUnlinked():
+            self.__tracker.update()
+            self.__tracker.stop()
             if self.getState() != "IDLE":
                 pos = self._relEventPos(self.__coordSysNode(), event)
                 if self.getState() == "RUNNING":
-                    self.__offset = pos - self.__dragStartPos
+                    self.__offset = pos - self.__tracker.startpos
                     self.notifySubscribers(Recognizer.UP, [self.__offset])
                     if self.__friction != -1:
                         self.__isSliding = True
-                        self.__inertiaHandler.onDrag(Transform(pos - self.__lastPos))
+                        self.__inertiaHandler.onDrag(
+                                Transform(self.__offset - self.__lastOffset))
                         self.__inertiaHandler.onUp()
                     else:
                         self._setEnd(event)
                 else:
                     self.__fail(event)
 
+    def _disconnectContacts(self):
+        self.__tracker.stop()
+        super(DragRecognizer, self)._disconnectContacts()
+
     def _handleCoordSysNodeUnlinked(self):
         if self.__coordSysNode().getParent() or isinstance(
                 self.__coordSysNode(), avg.CanvasNode):
@@ -577,6 +574,21 @@ class DragRecognizer(Recognizer):
             self.abort()
             return True
 
+    def __onTrackerDetected(self):
+        if not self._handleCoordSysNodeUnlinked():
+            self._setDetected(None)
+
+    def __onTrackerFailed(self):
+        if not self._handleCoordSysNodeUnlinked():
+            self.__fail(None)
+
+    def __onTrackerMotion(self, offset):
+        if not self._handleCoordSysNodeUnlinked():
+            self.notifySubscribers(Recognizer.MOTION, [offset])
+            if self.__inertiaHandler:
+                self.__inertiaHandler.onDrag(Transform(offset - self.__lastOffset))
+            self.__lastOffset = offset
+
     def __fail(self, event):
         self._setFail(event)
         if self.__inertiaHandler:
@@ -595,19 +607,6 @@ class DragRecognizer(Recognizer):
         else:
             self._setEnd(None)
 
-    def __angleFits(self, offset):
-        angle = offset.getAngle()
-        if angle < 0:
-            angle = -angle
-        if self.__direction == DragRecognizer.VERTICAL:
-            return (math.pi/2-self.__directionTolerance < angle
-                    < math.pi/2+self.__directionTolerance)
-        elif self.__direction == DragRecognizer.HORIZONTAL:
-            return (angle < self.__directionTolerance 
-                    or angle > math.pi-self.__directionTolerance)
-        else:
-            return True
-
 
 class Mat3x3(object):
     # Internal class. Will be removed again.
@@ -747,20 +746,13 @@ class Transform(object):
         self.scale = scale
         self.pivot = avg.Point2D(pivot)
 
+    @classmethod
+    def fromGestureTransform(cls, transform):
+        return Transform(transform.trans, transform.rot, transform.scale, 
+                transform.pivot)
+
     def moveNode(self, node):
-        transMat = Mat3x3.translate(self.trans)
-        rotMat = Mat3x3.rotate(self.rot)
-        scaleMat = Mat3x3.scale((self.scale, self.scale))
-        pivotMat = Mat3x3.translate(self.pivot)
-        invPivotMat = pivotMat.inverse()
-        startTransform = Mat3x3.fromNode(node)
-        newTransform = pivotMat.applyMat(
-                rotMat.applyMat(
-                scaleMat.applyMat(
-                invPivotMat.applyMat(
-                transMat.applyMat(
-                startTransform)))))
-        newTransform.setNodeTransform(node)
+        avg.GestureTransform(self.trans, self.rot, self.scale, self.pivot).moveNode(node)
 
     def __repr__(self):
         return "Transform" + str((self.trans, self.rot, self.scale, self.pivot))
@@ -784,11 +776,9 @@ class TransformRecognizer(Recognizer):
         else:
             self.__friction = friction
 
-        self.__baseTransform = Mat3x3()
-        self.__lastPosns = []
-        self.__posns = []
+        # Contact positions and the transform math are handled natively.
+        self.__tracker = self.__createTracker()
         self.__inertiaHandler = None
-        self.__filters = {}
         self.__frameHandlerID = None
 
         super(TransformRecognizer, self).__init__(eventNode, True, None, 
@@ -807,13 +797,9 @@ class TransformRecognizer(Recognizer):
 
     def _handleDown(self, event):
         numContacts = len(self._contacts)
-        self.__newPhase()
-        if self.__isFiltered():
-            self.__filters[event.contact] = [
-                    filter.OneEuroFilter(mincutoff=TransformRecognizer.FILTER_MIN_CUTOFF, 
-                            beta=TransformRecognizer.FILTER_BETA),
-                    filter.OneEuroFilter(mincutoff=TransformRecognizer.FILTER_MIN_CUTOFF,
-                            beta=TransformRecognizer.FILTER_BETA)]
+        if numContacts == 1:
+            self.__tracker = self.__createTracker()
+        self.__tracker.addContact(event.contact, self.__coordSysNode())
         if numContacts == 1:
             if self.__inertiaHandler:
                 self.__inertiaHandler.abort()
@@ -826,10 +812,10 @@ class TransformRecognizer(Recognizer):
 
     def _handleUp(self, event):
         numContacts = len(self._contacts)
+        transform = self.__tracker.removeContact(event.contact, self.__coordSysNode(),
+                player.getFrameTime())
         if numContacts == 0:
-            contact = event.contact
-            transform = Transform(self.__filteredRelContactPos(contact)
-                    - self.__lastPosns[0])
+            transform = Transform.fromGestureTransform(transform)
             player.unsubscribe(player.ON_FRAME, self.__frameHandlerID)
             self.__frameHandlerID = None
             if self.__friction != -1:
@@ -838,12 +824,6 @@ class TransformRecognizer(Recognizer):
             else:
                 self._setEnd(event)
             self.notifySubscribers(Recognizer.UP, [transform])
-        elif numContacts == 1:
-            self.__newPhase()
-        else:
-            self.__newPhase()
-        if self.__isFiltered():
-            del self.__filters[event.contact]
 
     def _handleNodeGone(self):
         if ((self.__coordSysNode and not(self.__coordSysNode())) or
@@ -860,57 +840,11 @@ class TransformRecognizer(Recognizer):
             self.__move()
 
     def __move(self):
-        numContacts = len(self._contacts)
-        contactPosns = [self.__filteredRelContactPos(contact)
-                for contact in self._contacts]
-        if numContacts == 1:
-            transform = Transform(contactPosns[0] - self.__lastPosns[0])
-            if self.__friction != -1:
-                self.__inertiaHandler.onDrag(transform)
-            self.notifySubscribers(Recognizer.MOTION, [transform])
-            self.__lastPosns = contactPosns
-        else:
-            if numContacts == 2:
-                self.__posns = contactPosns
-            else:
-                self.__posns = [getCentroid(self.__clusters[i], contactPosns) for
-                        i in range(2)]
-
-            startDelta = self.__lastPosns[1]-self.__lastPosns[0]
-            curDelta = self.__posns[1]-self.__posns[0]
-
-            pivot = (self.__posns[0]+self.__posns[1])/2
-
-            rot = avg.Point2D.angle(curDelta, startDelta)
-
-            if self.__lastPosns[0] == self.__lastPosns[1]:
-                scale = 1
-            else:
-                scale = ((self.__posns[0]-self.__posns[1]).getNorm() / 
-                        (self.__lastPosns[0]-self.__lastPosns[1]).getNorm())
-
-            trans = ((self.__posns[0]+self.__posns[1])/2 - 
-                    (self.__lastPosns[0]+self.__lastPosns[1])/2)
-            transform = Transform(trans, rot, scale, pivot)
-            if self.__friction != -1:
-                self.__inertiaHandler.onDrag(transform)
-            self.notifySubscribers(Recognizer.MOTION, [transform])
-            self.__lastPosns = self.__posns
-
-    def __newPhase(self):
-        self.__lastPosns = []
-        numContacts = len(self._contacts)
-        contactPosns = [self.__relContactPos(contact) 
-                for contact in self._contacts]
-        if numContacts == 1:
-            self.__lastPosns.append(contactPosns[0])
-        else:
-            if numContacts == 2:
-                self.__lastPosns = contactPosns
-            else:
-                self.__clusters = calcKMeans(contactPosns)
-                self.__lastPosns = [getCentroid(self.__clusters[i], contactPosns) for
-                        i in range(2)]
+        transform = Transform.fromGestureTransform(
+                self.__tracker.update(self.__coordSysNode(), player.getFrameTime()))
+        if self.__friction != -1:
+            self.__inertiaHandler.onDrag(transform)
+        self.notifySubscribers(Recognizer.MOTION, [transform])
 
     def __onInertiaMove(self, transform):
         self.notifySubscribers(Recognizer.MOTION, [transform])
@@ -919,22 +853,15 @@ class TransformRecognizer(Recognizer):
         self.__inertiaHandler = None
         self._setEnd(None)
 
-    def __filteredRelContactPos(self, contact):
-        rawPos = self.__relContactPos(contact)
-        if self.__isFiltered():
-            f = self.__filters[contact]
-            return avg.Point2D(f[0].apply(rawPos.x, player.getFrameTime()),
-                    f[1].apply(rawPos.y, player.getFrameTime()))
+    def __createTracker(self):
+        if TransformRecognizer.FILTER_MIN_CUTOFF is not None:
+            return avg.TransformTracker(TransformRecognizer.FILTER_MIN_CUTOFF,
+                    TransformRecognizer.FILTER_BETA)
         else:
-            return rawPos
-
-    def __relContactPos(self, contact):
-        return self._relEventPos(self.__coordSysNode(), contact.events[-1])
-
-    def __isFiltered(self):
-        return TransformRecognizer.FILTER_MIN_CUTOFF is not None
+            return avg.TransformTracker()
 
     def __abort(self):
+        self.__tracker.clear()
         if self.__frameHandlerID:
             player.unsubscribe(player.ON_FRAME, self.__frameHandlerID)
             self.__frameHandlerID = None
@@ -46,8 +46,6 @@ class AVG_API AudioBuffer
         int getRate();
         void clear();
 
-        void volumize(float lastVol, float curVol);
-
     private:
         int m_NumFrames;
         short* m_pData;
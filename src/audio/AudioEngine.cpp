@@ -23,11 +23,10 @@
 
 #include "AudioEngine.h"
 
-#include "Dynamics.h"
-
 #include "../base/Exception.h"
 #include "../base/Logger.h"
 #include "../base/TimeSource.h"
+#include "../base/ScopeTimer.h"
 
 #include <iostream>
 
@@ -38,16 +37,15 @@ namespace avg {
 
 AudioEngine* AudioEngine::s_pInstance = 0;
 
+static ProfilingZoneID MixProfilingZone("Audio mix");
+
 AudioEngine* AudioEngine::get()
 {
     return s_pInstance;
 }
 
 AudioEngine::AudioEngine()
-    : m_pTempBuffer(),
-      m_pMixBuffer(0),
-      m_pLimiter(0),
-      m_pGobblerThread(0),
+    : m_pGobblerThread(0),
       m_bEnabled(true),
       m_Volume(1),
       m_bInitialized(false)
@@ -62,15 +60,9 @@ AudioEngine::AudioEngine()
 
 AudioEngine::~AudioEngine()
 {
-    if (m_pMixBuffer) {
-        delete[] m_pMixBuffer;
-    }
-    if (m_pLimiter) {
-        delete m_pLimiter;
-        m_pLimiter = 0;
-    }
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
     m_AudioSources.clear();
+    m_pMixer = AudioMixerPtr();
 }
 
 int AudioEngine::getChannels()
@@ -98,14 +90,13 @@ void AudioEngine::init(const AudioParams& ap, float volume)
     if (!m_bInitialized) {
         m_bInitialized = true;
         m_AP = ap;
-        Dynamics<float, 2>* pLimiter = new Dynamics<float, 2>(float(m_AP.m_SampleRate));
-        pLimiter->setThreshold(0.f); // in dB
-        pLimiter->setAttackTime(0.f); // in seconds
-        pLimiter->setReleaseTime(0.05f); // in seconds
-        pLimiter->setRmsTime(0.f); // in seconds
-        pLimiter->setRatio(std::numeric_limits<float>::infinity());
-        pLimiter->setMakeupGain(0.f); // in dB
-        m_pLimiter = pLimiter;
+        m_pMixer = AudioMixerPtr(new AudioMixer(m_AP));
+        m_pMixer->setVolume(m_Volume);
+        // The audio callback runs in a realtime thread, so everything the profiler
+        // would allocate on its first call is set up here.
+        m_pProfiler = ThreadProfilerPtr(new ThreadProfiler());
+        m_pProfiler->setName("Audio");
+        m_pProfiler->preallocate(MixProfilingZone);
 
         SDL_AudioSpec desired;
         desired.freq = m_AP.m_SampleRate;
@@ -128,6 +119,7 @@ void AudioEngine::init(const AudioParams& ap, float volume)
         }
 
     } else {
+        m_pMixer->setVolume(m_Volume);
         if (m_bFakeAudio) {
             m_bStopGobbler = false;
             m_pGobblerThread = new boost::thread(&AudioEngine::consumeBuffers, this);
@@ -155,7 +147,9 @@ void AudioEngine::teardown()
 #endif
     }
 
+    lock_guard lock(m_Mutex);
     m_AudioSources.clear();
+    updateMixerSources();
 }
 
 void AudioEngine::setAudioEnabled(bool bEnabled)
@@ -184,67 +178,49 @@ void AudioEngine::pause()
 
 int AudioEngine::addSource(AudioMsgQueue& dataQ, AudioMsgQueue& statusQ)
 {
-    SDL_LockAudio();
     lock_guard lock(m_Mutex);
     static int nextID = -1;
     nextID++;
     AudioSourcePtr pSrc(new AudioSource(dataQ, statusQ, m_AP.m_SampleRate));
     m_AudioSources[nextID] = pSrc;
-    SDL_UnlockAudio();
+    updateMixerSources();
     return nextID;
 }
 
 void AudioEngine::removeSource(int id)
 {
-    SDL_LockAudio();
     lock_guard lock(m_Mutex);
     int numErased = m_AudioSources.erase(id);
     AVG_ASSERT(numErased == 1);
-    SDL_UnlockAudio();
+    updateMixerSources();
 }
 
 void AudioEngine::pauseSource(int id)
 {
-    lock_guard lock(m_Mutex);
-    AudioSourceMap::iterator itSource = m_AudioSources.find(id);
-    AVG_ASSERT(itSource != m_AudioSources.end());
-    AudioSourcePtr pSource = itSource->second;
-    pSource->pause();
+    getSource(id)->pause();
 }
 
 void AudioEngine::playSource(int id)
 {
-    lock_guard lock(m_Mutex);
-    AudioSourceMap::iterator itSource = m_AudioSources.find(id);
-    AVG_ASSERT(itSource != m_AudioSources.end());
-    AudioSourcePtr pSource = itSource->second;
-    pSource->play();
+    getSource(id)->play();
 }
 
 void AudioEngine::notifySeek(int id)
 {
-    lock_guard lock(m_Mutex);
-    AudioSourceMap::iterator itSource = m_AudioSources.find(id);
-    AVG_ASSERT(itSource != m_AudioSources.end());
-    AudioSourcePtr pSource = itSource->second;
-    pSource->notifySeek();
+    getSource(id)->notifySeek();
 }
 
 void AudioEngine::setSourceVolume(int id, float volume)
 {
-    lock_guard lock(m_Mutex);
-    AudioSourceMap::iterator itSource = m_AudioSources.find(id);
-    AVG_ASSERT(itSource != m_AudioSources.end());
-    AudioSourcePtr pSource = itSource->second;
-    pSource->setVolume(volume);
+    getSource(id)->setVolume(volume);
 }
 
 void AudioEngine::setVolume(float volume)
 {
-    SDL_LockAudio();
-    lock_guard lock(m_Mutex);
     m_Volume = volume;
-    SDL_UnlockAudio();
+    if (m_pMixer) {
+        m_pMixer->setVolume(volume);
+    }
 }
 
 float AudioEngine::getVolume() const
@@ -259,35 +235,9 @@ bool AudioEngine::isEnabled() const
         
 void AudioEngine::mixAudio(Uint8 *pDestBuffer, int destBufferLen)
 {
+    ScopeTimer timer(MixProfilingZone, m_pProfiler.get());
     int numFrames = destBufferLen/(2*getChannels()); // 16 bit samples.
-
-    if (!m_pTempBuffer || m_pTempBuffer->getNumFrames() < numFrames) {
-        if (m_pTempBuffer) {
-            delete[] m_pMixBuffer;
-        }
-        m_pTempBuffer = AudioBufferPtr(new AudioBuffer(numFrames, m_AP));
-        m_pMixBuffer = new float[getChannels()*numFrames];
-    }
-
-    for (int i = 0; i < getChannels()*numFrames; ++i) {
-        m_pMixBuffer[i]=0;
-    }
-    {
-        lock_guard lock(m_Mutex);
-        AudioSourceMap::iterator it;
-        for (it = m_AudioSources.begin(); it != m_AudioSources.end(); it++) {
-            m_pTempBuffer->clear();
-            it->second->fillAudioBuffer(m_pTempBuffer);
-            addBuffers(m_pMixBuffer, m_pTempBuffer);
-        }
-    }
-    calcVolume(m_pMixBuffer, numFrames*getChannels(), getVolume());
-    for (int i = 0; i < numFrames; ++i) {
-        m_pLimiter->process(m_pMixBuffer+i*getChannels());
-        for (int j = 0; j < getChannels(); ++j) {
-            ((short*)pDestBuffer)[i*2+j]=short(m_pMixBuffer[i*2+j]*32768);
-        }
-    }
+    m_pMixer->mix((short*)pDestBuffer, numFrames);
 }
 
 void AudioEngine::consumeBuffers()
@@ -309,21 +259,24 @@ void AudioEngine::audioCallback(void *userData, Uint8 *audioBuffer, int audioBuf
     pThis->mixAudio(audioBuffer, audioBufferLen);
 }
 
-void AudioEngine::addBuffers(float *pDest, AudioBufferPtr pSrc)
+void AudioEngine::updateMixerSources()
 {
-    int numFrames = pSrc->getNumFrames();
-    short * pData = pSrc->getData();
-    for(int i = 0; i < numFrames*getChannels(); ++i) {
-        pDest[i] += pData[i]/32768.0f;
+    if (m_pMixer) {
+        AudioMixer::AudioSourceList pSources;
+        AudioSourceMap::iterator it;
+        for (it = m_AudioSources.begin(); it != m_AudioSources.end(); it++) {
+            pSources.push_back(it->second);
+        }
+        m_pMixer->setSources(pSources);
     }
 }
 
-void AudioEngine::calcVolume(float *pBuffer, int numSamples, float volume)
+AudioSourcePtr AudioEngine::getSource(int id)
 {
-    // TODO: We need a VolumeFader class that keeps state.
-    for(int i = 0; i < numSamples; ++i) {
-        pBuffer[i] *= volume;
-    }
+    lock_guard lock(m_Mutex);
+    AudioSourceMap::iterator itSource = m_AudioSources.find(id);
+    AVG_ASSERT(itSource != m_AudioSources.end());
+    return itSource->second;
 }
 
 }
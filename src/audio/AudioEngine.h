@@ -27,8 +27,9 @@
 #include "../api.h"
 #include "AudioSource.h"
 #include "AudioParams.h"
-#include "AudioBuffer.h"
-#include "IProcessor.h"
+#include "AudioMixer.h"
+
+#include "../base/ThreadProfiler.h"
 
 #include <SDL2/SDL.h>
 
@@ -75,13 +76,14 @@ class AVG_API AudioEngine
         void mixAudio(Uint8 *pDestBuffer, int destBufferLen);
         void consumeBuffers();
         static void audioCallback(void *userData, Uint8 *audioBuffer, int audioBufferLen);
-        void addBuffers(float *pDest, AudioBufferPtr pSrc);
-        void calcVolume(float *pBuffer, int numSamples, float volume);
+        void updateMixerSources();
+        AudioSourcePtr getSource(int id);
         
         AudioParams m_AP;
-        AudioBufferPtr m_pTempBuffer;
-        float * m_pMixBuffer;
-        IProcessor<float>* m_pLimiter;
+        AudioMixerPtr m_pMixer;
+        // Used by the audio callback instead of the thread's own profiler.
+        ThreadProfilerPtr m_pProfiler;
+        // Protects m_AudioSources. The audio callback doesn't use it.
         boost::mutex m_Mutex;
 
         // Reads all audio packets when we can't initialize audio so the
@@ -0,0 +1,149 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "AudioMixer.h"
+#include "Dynamics.h"
+#include "MixKernels.h"
+
+#include "../base/Exception.h"
+#include "../base/StringHelper.h"
+#include "../base/TimeSource.h"
+
+#include <cstring>
+
+using namespace std;
+
+namespace avg {
+
+template<int CHANNELS>
+IProcessor<float>* createLimiter(float sampleRate)
+{
+    Dynamics<float, CHANNELS>* pLimiter = new Dynamics<float, CHANNELS>(sampleRate);
+    pLimiter->setThreshold(0.f); // in dB
+    pLimiter->setAttackTime(0.f); // in seconds
+    pLimiter->setReleaseTime(0.05f); // in seconds
+    pLimiter->setRmsTime(0.f); // in seconds
+    pLimiter->setRatio(std::numeric_limits<float>::infinity());
+    pLimiter->setMakeupGain(0.f); // in dB
+    return pLimiter;
+}
+
+AudioMixer::AudioMixer(const AudioParams& ap)
+    : m_AP(ap),
+      m_pLimiter(0),
+      m_pMixBuffer(0),
+      m_NumBufferFrames(0),
+      m_Volume(1),
+      m_pSources(new AudioSourceList()),
+      m_MixCount(0)
+{
+    float sampleRate = float(m_AP.m_SampleRate);
+    switch (m_AP.m_Channels) {
+        case 1:
+            m_pLimiter = createLimiter<1>(sampleRate);
+            break;
+        case 2:
+            m_pLimiter = createLimiter<2>(sampleRate);
+            break;
+        case 4:
+            m_pLimiter = createLimiter<4>(sampleRate);
+            break;
+        case 6:
+            m_pLimiter = createLimiter<6>(sampleRate);
+            break;
+        case 8:
+            m_pLimiter = createLimiter<8>(sampleRate);
+            break;
+        default:
+            delete m_pSources.load();
+            throw Exception(AVG_ERR_UNSUPPORTED, "Unsupported number of audio channels: "
+                    + toString(m_AP.m_Channels) + ".");
+    }
+    allocBuffers(m_AP.m_OutputBufferSamples);
+}
+
+AudioMixer::~AudioMixer()
+{
+    delete m_pLimiter;
+    delete[] m_pMixBuffer;
+    delete m_pSources.load();
+}
+
+void AudioMixer::setSources(const AudioSourceList& pSources)
+{
+    AudioSourceList* pOldSources = m_pSources.exchange(new AudioSourceList(pSources));
+    // Sources that were removed are destroyed here in the calling thread, but only
+    // after the audio thread has stopped using the old list.
+    waitForMixPass();
+    delete pOldSources;
+}
+
+void AudioMixer::setVolume(float volume)
+{
+    m_Volume = volume;
+}
+
+float AudioMixer::getVolume() const
+{
+    return m_Volume;
+}
+
+void AudioMixer::mix(short* pDest, int numFrames)
+{
+    int numSamples = numFrames*m_AP.m_Channels;
+    if (numFrames != m_NumBufferFrames) {
+        allocBuffers(numFrames);
+    }
+    memset(m_pMixBuffer, 0, numSamples*sizeof(float));
+
+    m_MixCount++;
+    AudioSourceList& sources = *m_pSources.load();
+    for (unsigned i = 0; i < sources.size(); ++i) {
+        sources[i]->mixInto(m_pMixBuffer, m_pTempBuffer);
+    }
+    m_MixCount++;
+
+    applyGain(m_pMixBuffer, numSamples, m_Volume);
+    m_pLimiter->processBlock(m_pMixBuffer, numFrames);
+    floatToS16(pDest, m_pMixBuffer, numSamples);
+}
+
+void AudioMixer::allocBuffers(int numFrames)
+{
+    delete[] m_pMixBuffer;
+    m_pMixBuffer = new float[numFrames*m_AP.m_Channels];
+    m_pTempBuffer = AudioBufferPtr(new AudioBuffer(numFrames, m_AP));
+    m_NumBufferFrames = numFrames;
+}
+
+void AudioMixer::waitForMixPass()
+{
+    unsigned mixCount = m_MixCount;
+    if (mixCount & 1) {
+        // A mix pass is running and might be using an outdated source list. 
+        while (m_MixCount == mixCount) {
+            msleep(1);
+        }
+    }
+}
+
+}
@@ -0,0 +1,79 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _AudioMixer_H_
+#define _AudioMixer_H_
+
+#include "../api.h"
+#include "AudioSource.h"
+#include "AudioParams.h"
+#include "AudioBuffer.h"
+#include "IProcessor.h"
+
+#include <atomic>
+#include <vector>
+
+namespace avg {
+
+// Mixes all audio sources into one output buffer: Every source is converted to float
+// and added to the mix bus with its own volume ramp, then the master volume and the
+// limiter are applied to the whole block. Independent of SDL, so it can also run
+// offline.
+//
+// mix() is called from the real-time audio thread and never blocks or allocates
+// (except when the block size changes). The source list is replaced by the main thread
+// with setSources(); the mixer always works on a consistent snapshot.
+class AVG_API AudioMixer
+{
+public:
+    typedef std::vector<AudioSourcePtr> AudioSourceList;
+
+    AudioMixer(const AudioParams& ap);
+    virtual ~AudioMixer();
+
+    void setSources(const AudioSourceList& pSources);
+    void setVolume(float volume);
+    float getVolume() const;
+
+    void mix(short* pDest, int numFrames);
+
+private:
+    void allocBuffers(int numFrames);
+    void waitForMixPass();
+
+    AudioParams m_AP;
+    IProcessor<float>* m_pLimiter;
+    AudioBufferPtr m_pTempBuffer;
+    float* m_pMixBuffer;
+    int m_NumBufferFrames;
+
+    std::atomic<float> m_Volume;
+    std::atomic<AudioSourceList*> m_pSources;
+    // Odd while mix() is running.
+    std::atomic<unsigned> m_MixCount;
+};
+
+typedef boost::shared_ptr<AudioMixer> AudioMixerPtr;
+
+}
+
+#endif
@@ -20,9 +20,10 @@
 //
 
 #include "AudioSource.h"
-#include "AudioEngine.h"
+#include "MixKernels.h"
 
 #include <string>
+#include <cstring>
 #include <algorithm>
 
 using namespace std;
@@ -34,7 +35,8 @@ AudioSource::AudioSource(AudioMsgQueue& msgQ, AudioMsgQueue& statusQ, int sample
       m_StatusQ(statusQ),
       m_SampleRate(sampleRate),
       m_bPaused(false),
-      m_bSeeking(false),
+      m_NumSeeksRequested(0),
+      m_NumSeeksDone(0),
       m_Volume(1.0),
       m_LastVolume(1.0)
 {
@@ -56,10 +58,9 @@ void AudioSource::play()
 
 void AudioSource::notifySeek()
 {
-    while (m_bSeeking) {
-        processNextMsg(true);
-    }
-    m_bSeeking = true;
+    // The audio thread discards data until the matching SEEK_DONE arrives. Seek sequence
+    // numbers start at 1 for every decoder, so they correspond to this count.
+    m_NumSeeksRequested++;
 }
     
 void AudioSource::setVolume(float volume)
@@ -67,10 +68,24 @@ void AudioSource::setVolume(float volume)
     m_Volume = volume;
 }
 
+void AudioSource::mixInto(float* pMixBuffer, AudioBufferPtr pTempBuffer)
+{
+    pTempBuffer->clear();
+    fillAudioBuffer(pTempBuffer);
+    float volume = m_Volume;
+    if (!m_bPaused) {
+        mixS16ToFloat(pMixBuffer, pTempBuffer->getData(), 
+                pTempBuffer->getNumFrames()*pTempBuffer->getNumChannels(), 
+                m_LastVolume, volume);
+        m_LastVolume = volume;
+    }
+}
+
 void AudioSource::fillAudioBuffer(AudioBufferPtr pBuffer)
 {
+    flushStatusMsgs();
     bool bContinue = true;
-    while (bContinue && m_bSeeking) {
+    while (bContinue && isSeeking()) {
         bContinue = processNextMsg(false);
     }
     if (!m_bPaused) {
@@ -105,12 +120,15 @@ void AudioSource::fillAudioBuffer(AudioBufferPtr pBuffer)
                 }
             }
         }
-        pBuffer->volumize(m_LastVolume, m_Volume);
-        m_LastVolume = m_Volume;
 
-        AudioMsgPtr pStatusMsg(new AudioMsg);
-        pStatusMsg->setAudioTime(m_LastTime);
-        m_StatusQ.push(pStatusMsg);
+        // Never block the audio callback. If the application doesn't read status
+        // messages, dropping a time update is harmless: the next one supersedes it.
+        // It must not overtake a pending EOF or SEEK_DONE, though.
+        if (flushStatusMsgs()) {
+            AudioMsgPtr pStatusMsg(new AudioMsg);
+            pStatusMsg->setAudioTime(m_LastTime);
+            m_StatusQ.tryPush(pStatusMsg);
+        }
     }
 }
 
@@ -120,6 +138,11 @@ void AudioSource::clearQueue()
     }
 }
 
+bool AudioSource::isSeeking() const
+{
+    return m_NumSeeksDone < m_NumSeeksRequested;
+}
+
 bool AudioSource::processNextMsg(bool bWait)
 {
     AudioMsgPtr pMsg = m_MsgQ.pop(bWait);
@@ -133,20 +156,20 @@ bool AudioSource::processNextMsg(bool bWait)
                 return true;
             case AudioMsg::END_OF_FILE: {
 //                cerr << "        AudioSource: EOF" << endl;
-                m_bSeeking = false;
+                m_NumSeeksDone = m_NumSeeksRequested;
                 AudioMsgPtr pStatusMsg(new AudioMsg);
                 pStatusMsg->setEOF();
-                m_StatusQ.push(pStatusMsg);
+                pushStatusMsg(pStatusMsg);
                 return false;
             }
             case AudioMsg::SEEK_DONE: {
 //                cerr << "        AudioSource: SEEK_DONE" << endl;
-                m_bSeeking = false;
+                m_NumSeeksDone = max(m_NumSeeksDone, pMsg->getSeekSeqNum());
                 m_pInputAudioBuffer = AudioBufferPtr();
                 m_LastTime = pMsg->getSeekTime();
                 AudioMsgPtr pStatusMsg(new AudioMsg);
                 pStatusMsg->setSeekDone(pMsg->getSeekSeqNum(), m_LastTime);
-                m_StatusQ.push(pStatusMsg);
+                pushStatusMsg(pStatusMsg);
                 return true;
             }
             default:
@@ -159,4 +182,33 @@ bool AudioSource::processNextMsg(bool bWait)
     }
 }
 
+void AudioSource::pushStatusMsg(AudioMsgPtr pMsg)
+{
+    if (pMsg->getType() == AudioMsg::SEEK_DONE) {
+        // The application only needs the latest seek, and a seek resets EOF.
+        m_pPendingSeekDoneMsg = pMsg;
+        m_pPendingEOFMsg = AudioMsgPtr();
+    } else {
+        m_pPendingEOFMsg = pMsg;
+    }
+    flushStatusMsgs();
+}
+
+bool AudioSource::flushStatusMsgs()
+{
+    if (m_pPendingSeekDoneMsg) {
+        if (!m_StatusQ.tryPush(m_pPendingSeekDoneMsg)) {
+            return false;
+        }
+        m_pPendingSeekDoneMsg = AudioMsgPtr();
+    }
+    if (m_pPendingEOFMsg) {
+        if (!m_StatusQ.tryPush(m_pPendingEOFMsg)) {
+            return false;
+        }
+        m_pPendingEOFMsg = AudioMsgPtr();
+    }
+    return true;
+}
+
 }
@@ -28,6 +28,8 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <atomic>
+
 namespace avg
 {
 
@@ -42,11 +44,16 @@ public:
     void notifySeek();
     void setVolume(float volume);
 
+    // Called from the audio thread.
+    void mixInto(float* pMixBuffer, AudioBufferPtr pTempBuffer);
     void fillAudioBuffer(AudioBufferPtr pBuffer);
     void clearQueue();
 
 private:
     bool processNextMsg(bool bWait);
+    bool isSeeking() const;
+    void pushStatusMsg(AudioMsgPtr pMsg);
+    bool flushStatusMsgs();
 
     AudioMsgQueue& m_MsgQ;    
     AudioMsgQueue& m_StatusQ;
@@ -54,10 +61,16 @@ private:
     AudioBufferPtr m_pInputAudioBuffer;
     float m_LastTime;
     int m_CurInputAudioPos;
-    bool m_bPaused;
-    bool m_bSeeking;
-    float m_Volume;
+    std::atomic<bool> m_bPaused;
+    // Seeks are counted so notifySeek() doesn't need to wait for the audio thread.
+    std::atomic<int> m_NumSeeksRequested;
+    int m_NumSeeksDone;
+    std::atomic<float> m_Volume;
     float m_LastVolume;
+    // EOF and SEEK_DONE messages that didn't fit into the status queue. They are
+    // retried in order on the next callback.
+    AudioMsgPtr m_pPendingSeekDoneMsg;
+    AudioMsgPtr m_pPendingEOFMsg;
 };
 
 typedef boost::shared_ptr<AudioSource> AudioSourcePtr;
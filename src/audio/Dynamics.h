@@ -47,6 +47,7 @@ class AVG_API Dynamics: public IProcessor<T>
         Dynamics(T fs);
         virtual ~Dynamics();
         virtual void process(T* pSamples);
+        virtual void processBlock(T* pSamples, int numFrames);
 
         void setThreshold(T threshold);
         T getThreshold() const;
@@ -181,74 +182,98 @@ void Dynamics<T, CHANNELS>::maxFilter(T& rms)
 template<typename T, int CHANNELS>
 void Dynamics<T, CHANNELS>::process(T* pSamples)
 {
+    processBlock(pSamples, 1);
+}
+
+template<typename T, int CHANNELS>
+void Dynamics<T, CHANNELS>::processBlock(T* pSamples, int numFrames)
+{
+    for (int frame = 0; frame < numFrames; frame++) {
+        T* pFrame = pSamples + frame*CHANNELS;
+
+        //---------------- Preprocessing
+        T x = 0.f;
+        for (int i = 0; i < CHANNELS; i++) {
+            // Apply pregain
+            const T tmp = pFrame[i] * preGain_;
+
+            T abs = std::fabs(tmp);
+            if (abs > x) {
+                x = abs;
+            }
+        }
 
-    //---------------- Preprocessing
-    T x = 0.f;
-    for (int i = 0; i < CHANNELS; i++) {
-        // Apply pregain
-        const T tmp = pSamples[i] * preGain_;
+        //---------------- RMS
+        T rms = (1.f - rmsCoef_) * x * x + rmsCoef_ * rms1_;
+        rms1_ = rms;
+        rms   = sqrt(rms);
 
-        T abs = std::fabs(tmp);
-        if (abs > x) {
-            x = abs;
+        //---------------- Max filter
+        if (rms > 1.) {
+            maxFilter(rms);
         }
-    }
 
-    //---------------- RMS
-    T rms = (1.f - rmsCoef_) * x * x + rmsCoef_ * rms1_;
-    rms1_ = rms;
-    rms   = sqrt(rms);
+        //---------------- Ratio
+        // Below the threshold, the lookahead buffer contains 1 and the gain is exactly
+        // 1 as well. This is the common case, so we skip log10() and pow() there.
+        T c = 1.;
+        const T peak = lookaheadBuf_[lookaheadBufIdx_];
+        if (peak != 1.) {
+            T dbMax  = std::log10(peak);
+            T dbComp = dbMax * inverseRatio_;
+            T comp   = std::pow(static_cast<T>(10.), dbComp);
+            c        = comp / peak;
+        }
 
-    //---------------- Max filter
-    if (rms > 1.) {
-        maxFilter(rms);
-    }
+        lookaheadBuf_[lookaheadBufIdx_] = 1.;
+        lookaheadBufIdx_ = (lookaheadBufIdx_+1)&(LOOKAHEAD-1);
 
-    //---------------- Ratio
-    T dbMax  = std::log10(lookaheadBuf_[lookaheadBufIdx_]);
-    T dbComp = dbMax * inverseRatio_;
-    T comp   = std::pow(static_cast<T>(10.), dbComp);
-    T c      = comp / lookaheadBuf_[lookaheadBufIdx_];
+        //---------------- Attack/release envelope
+        if (env1_ <= c) {
+            c = c + (env1_ - c) * relCoef_;
+        } else {
+            c = c + (env1_ - c) * attCoef_;
+        }
+        env1_ = c;
+
+        //---------------- Smoothing
+        const T tmp1           = avg1Old_ + c - avg1Buf_[avg1BufRIdx_];
+        avg1Old_               = tmp1;
+        avg1Buf_[avg1BufWIdx_] = c;
+        c = tmp1;
+        if (++avg1BufRIdx_ == AVG1) {
+            avg1BufRIdx_ = 0;
+        }
+        if (++avg1BufWIdx_ == AVG1) {
+            avg1BufWIdx_ = 0;
+        }
 
-    lookaheadBuf_[lookaheadBufIdx_] = 1.;
-    lookaheadBufIdx_ = (lookaheadBufIdx_+1)%LOOKAHEAD;
+        const T tmp2           = avg2Old_ + c - avg2Buf_[avg2BufRIdx_];
+        avg2Old_               = tmp2;
+        avg2Buf_[avg2BufWIdx_] = c;
+        c = tmp2;
+        if (++avg2BufRIdx_ == AVG2) {
+            avg2BufRIdx_ = 0;
+        }
+        if (++avg2BufWIdx_ == AVG2) {
+            avg2BufWIdx_ = 0;
+        }
 
-    //---------------- Attack/release envelope
-    if (env1_ <= c) {
-        c = c + (env1_ - c) * relCoef_;
-    } else {
-        c = c + (env1_ - c) * attCoef_;
-    }
-    env1_ = c;
-
-    //---------------- Smoothing
-    const T tmp1           = avg1Old_ + c - avg1Buf_[avg1BufRIdx_];
-    avg1Old_               = tmp1;
-    avg1Buf_[avg1BufWIdx_] = c;
-    c = tmp1;
-    avg1BufRIdx_ = (avg1BufRIdx_+1)%AVG1;
-    avg1BufWIdx_ = (avg1BufWIdx_+1)%AVG1;
-
-    const T tmp2           = avg2Old_ + c - avg2Buf_[avg2BufRIdx_];
-    avg2Old_               = tmp2;
-    avg2Buf_[avg2BufWIdx_] = c;
-    c = tmp2;
-    avg2BufRIdx_ = (avg2BufRIdx_+1)%AVG2;
-    avg2BufWIdx_ = (avg2BufWIdx_+1)%AVG2;
-
-    c = c / (static_cast<T>(AVG1) * static_cast<T>(AVG2));
-
-    //---------------- Postprocessing
-    for (int i = 0; i < CHANNELS; i++) {
-        // Delay input samples
-        const T in                 = delayBuf_[delayBufIdx_*CHANNELS+i];
-        delayBuf_[delayBufIdx_*CHANNELS+i] = pSamples[i];
-
-        // Apply control signal
-        pSamples[i] = in * c * postGain_;
-    }
+        c = c / (static_cast<T>(AVG1) * static_cast<T>(AVG2));
 
-    delayBufIdx_ = (delayBufIdx_+1)&(LOOKAHEAD-1);
+        //---------------- Postprocessing
+        T* pDelay = delayBuf_ + delayBufIdx_*CHANNELS;
+        for (int i = 0; i < CHANNELS; i++) {
+            // Delay input samples
+            const T in = pDelay[i];
+            pDelay[i] = pFrame[i];
+
+            // Apply control signal
+            pFrame[i] = in * c * postGain_;
+        }
+
+        delayBufIdx_ = (delayBufIdx_+1)&(LOOKAHEAD-1);
+    }
 }
 
 template<typename T, int CHANNELS>
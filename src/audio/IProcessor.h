@@ -29,7 +29,10 @@ class AVG_API IProcessor
 {
 public:
     virtual ~IProcessor() {};
+    // Processes one frame (one sample per channel).
     virtual void process(T* pSamples) = 0;
+    // Processes numFrames interleaved frames in place.
+    virtual void processBlock(T* pSamples, int numFrames) = 0;
 
 };
 
@@ -0,0 +1,144 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "MixKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define AVG_MIX_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #define AVG_MIX_NEON
+    #include <arm_neon.h>
+#endif
+
+#define VOLUME_FADE_SAMPLES 100
+
+namespace avg {
+
+static const float S16_TO_FLOAT = 1.f/32768;
+
+static void mixS16ToFloatConstGain(float* pDest, const short* pSrc, int numSamples, 
+        float gain)
+{
+    float scale = gain*S16_TO_FLOAT;
+    int i = 0;
+#if defined(AVG_MIX_SSE2)
+    __m128 scale4 = _mm_set1_ps(scale);
+    for (; i+8 <= numSamples; i += 8) {
+        __m128i src = _mm_loadu_si128((const __m128i*)(pSrc+i));
+        // Sign-extend to 32 bit by unpacking into the upper halves and shifting down.
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(src, src), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(src, src), 16);
+        __m128 dest0 = _mm_loadu_ps(pDest+i);
+        __m128 dest1 = _mm_loadu_ps(pDest+i+4);
+        dest0 = _mm_add_ps(dest0, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale4));
+        dest1 = _mm_add_ps(dest1, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale4));
+        _mm_storeu_ps(pDest+i, dest0);
+        _mm_storeu_ps(pDest+i+4, dest1);
+    }
+#elif defined(AVG_MIX_NEON)
+    for (; i+8 <= numSamples; i += 8) {
+        int16x8_t src = vld1q_s16(pSrc+i);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(src)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(src)));
+        vst1q_f32(pDest+i, vmlaq_n_f32(vld1q_f32(pDest+i), lo, scale));
+        vst1q_f32(pDest+i+4, vmlaq_n_f32(vld1q_f32(pDest+i+4), hi, scale));
+    }
+#endif
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc[i]*scale;
+    }
+}
+
+void mixS16ToFloat(float* pDest, const short* pSrc, int numSamples, float lastGain, 
+        float gain)
+{
+    int numFadeSamples = 0;
+    if (lastGain != gain) {
+        numFadeSamples = VOLUME_FADE_SAMPLES;
+        if (numFadeSamples > numSamples) {
+            numFadeSamples = numSamples;
+        }
+        float gainDiff = lastGain - gain;
+        for (int i = 0; i < numFadeSamples; ++i) {
+            float fadeGain = gain + gainDiff*(VOLUME_FADE_SAMPLES-i)/VOLUME_FADE_SAMPLES;
+            pDest[i] += pSrc[i]*fadeGain*S16_TO_FLOAT;
+        }
+    }
+    if (gain != 0) {
+        mixS16ToFloatConstGain(pDest+numFadeSamples, pSrc+numFadeSamples, 
+                numSamples-numFadeSamples, gain);
+    }
+}
+
+void applyGain(float* pBuffer, int numSamples, float gain)
+{
+    if (gain == 1) {
+        return;
+    }
+    int i = 0;
+#if defined(AVG_MIX_SSE2)
+    __m128 gain4 = _mm_set1_ps(gain);
+    for (; i+4 <= numSamples; i += 4) {
+        _mm_storeu_ps(pBuffer+i, _mm_mul_ps(_mm_loadu_ps(pBuffer+i), gain4));
+    }
+#elif defined(AVG_MIX_NEON)
+    for (; i+4 <= numSamples; i += 4) {
+        vst1q_f32(pBuffer+i, vmulq_n_f32(vld1q_f32(pBuffer+i), gain));
+    }
+#endif
+    for (; i < numSamples; ++i) {
+        pBuffer[i] *= gain;
+    }
+}
+
+void floatToS16(short* pDest, const float* pSrc, int numSamples)
+{
+    int i = 0;
+#if defined(AVG_MIX_SSE2)
+    __m128 scale4 = _mm_set1_ps(32768.f);
+    for (; i+8 <= numSamples; i += 8) {
+        // cvtt truncates like the scalar cast, packs saturates.
+        __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(pSrc+i), scale4));
+        __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(pSrc+i+4), scale4));
+        _mm_storeu_si128((__m128i*)(pDest+i), _mm_packs_epi32(lo, hi));
+    }
+#elif defined(AVG_MIX_NEON)
+    for (; i+8 <= numSamples; i += 8) {
+        int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(pSrc+i), 32768.f));
+        int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(pSrc+i+4), 32768.f));
+        vst1q_s16(pDest+i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#endif
+    for (; i < numSamples; ++i) {
+        float sample = pSrc[i]*32768.f;
+        if (sample >= 32767.f) {
+            pDest[i] = 32767;
+        } else if (sample <= -32768.f) {
+            pDest[i] = -32768;
+        } else {
+            pDest[i] = short(sample);
+        }
+    }
+}
+
+}
@@ -0,0 +1,45 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _MixKernels_H_
+#define _MixKernels_H_
+
+#include "../api.h"
+
+namespace avg {
+
+// Building blocks of the float mix bus. All functions work on interleaved samples, so
+// they don't depend on the number of channels. Uses SSE2 or NEON if available.
+
+// pDest += pSrc*gain, with 16 bit input scaled to [-1, 1). The gain ramps linearly 
+// from lastGain to gain over the first samples to avoid clicks on volume changes.
+AVG_API void mixS16ToFloat(float* pDest, const short* pSrc, int numSamples, 
+        float lastGain, float gain);
+
+AVG_API void applyGain(float* pBuffer, int numSamples, float gain);
+
+// Converts [-1, 1] to 16 bit, saturating values outside that range.
+AVG_API void floatToS16(short* pDest, const float* pSrc, int numSamples);
+
+}
+
+#endif
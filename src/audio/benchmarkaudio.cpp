@@ -0,0 +1,183 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "AudioMixer.h"
+#include "AudioSource.h"
+#include "Dynamics.h"
+
+#include "../base/TimeSource.h"
+#include "../base/StringHelper.h"
+
+#include <iostream>
+#include <math.h>
+
+using namespace avg;
+using namespace std;
+
+// Offline mixer benchmarks. Doesn't need SDL or an audio device.
+
+static const int SAMPLE_RATE = 44100;
+static const int NUM_CHANNELS = 2;
+static const int BUFFER_FRAMES = 1024;
+
+template<class TEST>
+void runPerformanceTest(int numRuns=500)
+{
+    TEST PerfTest;
+    long long StartTime = TimeSource::get()->getCurrentMicrosecs();
+    for (int i = 0; i < numRuns; ++i) {
+        PerfTest.run();
+    }
+    float ActiveTime = (TimeSource::get()->getCurrentMicrosecs()-StartTime)/1000.; 
+    cerr << PerfTest.getName() << ": " << ActiveTime/numRuns << " ms" << endl;
+}
+
+class PerfTestBase {
+public:
+    PerfTestBase(string sName) 
+        : m_sName(sName)
+    {
+    }
+
+    std::string getName()
+    {
+        return m_sName;
+    }
+
+private:
+    std::string m_sName;
+};
+
+static AudioBufferPtr createSineBuffer(const AudioParams& ap, float freq)
+{
+    AudioBufferPtr pBuffer(new AudioBuffer(ap.m_OutputBufferSamples, ap));
+    short* pData = pBuffer->getData();
+    for (int i = 0; i < ap.m_OutputBufferSamples; ++i) {
+        short sample = short(16000*sin(i*freq*2*float(M_PI)/ap.m_SampleRate));
+        for (int j = 0; j < ap.m_Channels; ++j) {
+            pData[i*ap.m_Channels+j] = sample;
+        }
+    }
+    return pBuffer;
+}
+
+// One mixer callback for NUM_SOURCES sources, including feeding the source queues.
+template<int NUM_SOURCES>
+class MixPerfTest: public PerfTestBase {
+public:
+    MixPerfTest()
+        : PerfTestBase("MixPerfTest ("+toString(NUM_SOURCES)+" sources)"),
+          m_AP(SAMPLE_RATE, NUM_CHANNELS, BUFFER_FRAMES),
+          m_Mixer(m_AP)
+    {
+        AudioMixer::AudioSourceList pSources;
+        for (int i = 0; i < NUM_SOURCES; ++i) {
+            AudioMsgQueuePtr pMsgQ(new AudioMsgQueue(8));
+            AudioMsgQueuePtr pStatusQ(new AudioMsgQueue(8));
+            AudioSourcePtr pSource(new AudioSource(*pMsgQ, *pStatusQ, SAMPLE_RATE));
+            pSource->setVolume(1.f/NUM_SOURCES);
+            AudioMsgPtr pMsg(new AudioMsg);
+            pMsg->setAudio(createSineBuffer(m_AP, 220.f*(i+1)), 0);
+            m_pMsgQs.push_back(pMsgQ);
+            m_pStatusQs.push_back(pStatusQ);
+            m_pMsgs.push_back(pMsg);
+            pSources.push_back(pSource);
+        }
+        m_Mixer.setSources(pSources);
+        m_pDest = new short[BUFFER_FRAMES*NUM_CHANNELS];
+    }
+
+    ~MixPerfTest()
+    {
+        m_Mixer.setSources(AudioMixer::AudioSourceList());
+        delete[] m_pDest;
+    }
+
+    void run()
+    {
+        for (int i = 0; i < NUM_SOURCES; ++i) {
+            m_pMsgQs[i]->push(m_pMsgs[i]);
+        }
+        m_Mixer.mix(m_pDest, BUFFER_FRAMES);
+        for (int i = 0; i < NUM_SOURCES; ++i) {
+            m_pStatusQs[i]->clear();
+        }
+    }
+
+private:
+    AudioParams m_AP;
+    AudioMixer m_Mixer;
+    vector<AudioMsgQueuePtr> m_pMsgQs;
+    vector<AudioMsgQueuePtr> m_pStatusQs;
+    vector<AudioMsgPtr> m_pMsgs;
+    short* m_pDest;
+};
+
+template<bool BLOCK>
+class LimiterPerfTest: public PerfTestBase {
+public:
+    LimiterPerfTest()
+        : PerfTestBase(BLOCK ? "LimiterPerfTest (block)" : "LimiterPerfTest (frame)"),
+          m_Limiter(float(SAMPLE_RATE))
+    {
+        m_pSamples = new float[BUFFER_FRAMES*NUM_CHANNELS];
+        for (int i = 0; i < BUFFER_FRAMES*NUM_CHANNELS; ++i) {
+            m_pSamples[i] = 0.5f*sin(i*0.01f);
+        }
+    }
+
+    ~LimiterPerfTest()
+    {
+        delete[] m_pSamples;
+    }
+
+    void run()
+    {
+        if (BLOCK) {
+            m_Limiter.processBlock(m_pSamples, BUFFER_FRAMES);
+        } else {
+            for (int i = 0; i < BUFFER_FRAMES; ++i) {
+                m_Limiter.process(m_pSamples+i*NUM_CHANNELS);
+            }
+        }
+    }
+
+private:
+    Dynamics<float, NUM_CHANNELS> m_Limiter;
+    float* m_pSamples;
+};
+
+void runPerformanceTests()
+{
+    runPerformanceTest<LimiterPerfTest<false> >();
+    runPerformanceTest<LimiterPerfTest<true> >();
+    runPerformanceTest<MixPerfTest<1> >();
+    runPerformanceTest<MixPerfTest<4> >();
+    runPerformanceTest<MixPerfTest<16> >();
+    runPerformanceTest<MixPerfTest<64> >(100);
+}
+
+int main(int nargs, char** args)
+{
+    runPerformanceTests();
+}
+
@@ -20,6 +20,7 @@
 //
 
 #include "Dynamics.h"
+#include "MixKernels.h"
 
 #include "../base/TestSuite.h"
 #include "../base/MathHelper.h"
@@ -95,6 +96,112 @@ public:
         // Free memory
         delete d;
         delete[] pSamples;
+
+        testBlockProcessing<2>(fs);
+        testBlockProcessing<6>(fs);
+    }
+
+private:
+    template<int CHANNELS>
+    void testBlockProcessing(float fs)
+    {
+        // processBlock() must give exactly the same results as process() per frame.
+        int numFrames = 1000;
+        float* pFrameSamples = new float[CHANNELS*numFrames];
+        float* pBlockSamples = new float[CHANNELS*numFrames];
+        for (int j = 0; j < numFrames; j++) {
+            for (int i = 0; i < CHANNELS; i++) {
+                pFrameSamples[j*CHANNELS+i] = (i+1)*sin(j*(440.f/44100)*float(M_PI));
+                pBlockSamples[j*CHANNELS+i] = pFrameSamples[j*CHANNELS+i];
+            }
+        }
+        Dynamics<float, CHANNELS> frameLimiter(fs);
+        Dynamics<float, CHANNELS> blockLimiter(fs);
+        for (int j = 0; j < numFrames; j++) {
+            frameLimiter.process(pFrameSamples+j*CHANNELS);
+        }
+        // Odd block sizes to make sure state is carried over correctly.
+        int frame = 0;
+        int blockSize = 1;
+        while (frame < numFrames) {
+            int curFrames = min(blockSize, numFrames-frame);
+            blockLimiter.processBlock(pBlockSamples+frame*CHANNELS, curFrames);
+            frame += curFrames;
+            blockSize = blockSize*3+1;
+        }
+        bool bEqual = true;
+        for (int i = 0; i < CHANNELS*numFrames; i++) {
+            if (pFrameSamples[i] != pBlockSamples[i]) {
+                bEqual = false;
+            }
+        }
+        TEST(bEqual);
+        delete[] pFrameSamples;
+        delete[] pBlockSamples;
+    }
+};
+
+class MixKernelsTest: public Test {
+public:
+    MixKernelsTest()
+        : Test("MixKernelsTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        // Odd length so the scalar tail is tested as well.
+        const int numSamples = 203;
+        short src[numSamples];
+        float mix[numSamples];
+        for (int i = 0; i < numSamples; i++) {
+            src[i] = short((i*331)%65536 - 32768);
+            mix[i] = 0.25f;
+        }
+        mixS16ToFloat(mix, src, numSamples, 0.5f, 0.5f);
+        bool bOk = true;
+        for (int i = 0; i < numSamples; i++) {
+            if (mix[i] != 0.25f + src[i]*0.5f/32768) {
+                bOk = false;
+            }
+        }
+        TEST(bOk);
+
+        // Volume ramp: starts at the old gain and reaches the new gain.
+        for (int i = 0; i < numSamples; i++) {
+            src[i] = 32767;
+            mix[i] = 0;
+        }
+        mixS16ToFloat(mix, src, numSamples, 0.f, 1.f);
+        TEST(mix[0] < 0.01f);
+        TEST(mix[50] > 0.4f && mix[50] < 0.6f);
+        TEST(almostEqual(mix[numSamples-1], 1.f, 0.001f));
+
+        applyGain(mix, numSamples, 0.5f);
+        TEST(almostEqual(mix[numSamples-1], 0.5f, 0.001f));
+
+        float floatSrc[numSamples];
+        short dest[numSamples];
+        for (int i = 0; i < numSamples; i++) {
+            floatSrc[i] = (i-100)/50.f;
+        }
+        floatToS16(dest, floatSrc, numSamples);
+        bOk = true;
+        for (int i = 0; i < numSamples; i++) {
+            float sample = floatSrc[i]*32768;
+            short expected;
+            if (sample >= 32767) {
+                expected = 32767;
+            } else if (sample <= -32768) {
+                expected = -32768;
+            } else {
+                expected = short(sample);
+            }
+            if (dest[i] != expected) {
+                bOk = false;
+            }
+        }
+        TEST(bOk);
     }
 };
 
@@ -102,7 +209,9 @@ int main(int nargs, char** args)
 {
     LimiterTest test;
     test.runTests();
-    bool bOK = test.isOk();
+    MixKernelsTest mixTest;
+    mixTest.runTests();
+    bool bOK = test.isOk() && mixTest.isOk();
 
     if (bOK) {
         return 0;
@@ -24,5 +24,9 @@
 /* Enable ffmpeg swscale support. */
 #define AVG_ENABLE_SWSCALE
 
+/* Decode jpeg and png files without gdk-pixbuf. */
+#undef AVG_ENABLE_JPEG_DECODER
+#undef AVG_ENABLE_PNG_DECODER
+
 /* Name of package */
 #undef PACKAGE
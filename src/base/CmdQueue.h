@@ -35,7 +35,7 @@ class AVG_TEMPLATE_API CmdQueue: public Queue<Command<RECEIVER> >
 public:
     CmdQueue(int maxSize=-1);
     typedef typename Queue<Command<RECEIVER> >::QElementPtr CmdPtr;
-    void pushCmd(typename Command<RECEIVER>::CmdFunc func);
+    void pushCmd(typename Command<RECEIVER>::CmdFunc func, bool bBlock=true);
     
 };
 
@@ -46,9 +46,10 @@ CmdQueue<RECEIVER>::CmdQueue(int maxSize)
 }
 
 template<class RECEIVER>
-void CmdQueue<RECEIVER>::pushCmd(typename Command<RECEIVER>::CmdFunc func)
+void CmdQueue<RECEIVER>::pushCmd(typename Command<RECEIVER>::CmdFunc func, 
+        bool bBlock)
 {
-    this->push(CmdPtr(new Command<RECEIVER>(func)));
+    this->push(CmdPtr(new Command<RECEIVER>(func)), bBlock);
 }
 
 }
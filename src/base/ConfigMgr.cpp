@@ -76,11 +76,21 @@ ConfigMgr::ConfigMgr()
     addOption("scr", "usepow2textures", "false");
     addOption("scr", "usepixelbuffers", "true");
     addOption("scr", "multisamplesamples", "8");
+    addOption("scr", "prerenderthreads", "0");
+    addOption("scr", "renderbatching", "true");
+    addOption("scr", "textureatlas", "true");
+    addOption("scr", "texuploadbudget", "0");
     addOption("scr", "shaderusage", "auto");
     addOption("scr", "gamma", "-1,-1,-1");
     addOption("scr", "vsyncmode", "auto");
     addOption("scr", "videoaccel", "true");
+    addOption("scr", "videodecoderthreads", "1");
+    addOption("scr", "videodecoderthreadtype", "auto");
+    addOption("scr", "videozerocopy", "true");
     addOption("scr", "imgcachesize", "-1,-1");
+    addOption("scr", "imgdiskcache", "");
+    addOption("scr", "imgdiskcachesize", "1024");
+    addOption("scr", "tracefile", "");
     
     addSubsys("aud");
     addOption("aud", "channels", "2");
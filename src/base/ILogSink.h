@@ -43,7 +43,9 @@ class AVG_API ILogSink
 public:
     virtual void logMessage(const tm* pTime, unsigned millis, const category_t& category,
             severity_t severity, const UTF8String& sMsg) = 0;
-    
+
+    // Called after a batch of messages has been passed to logMessage().
+    virtual void flush() {}
 };
 
 typedef boost::shared_ptr<ILogSink> LogSinkPtr;
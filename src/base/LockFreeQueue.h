@@ -0,0 +1,316 @@
+//
+//  libavg - Media Playback Engine.
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _LockFreeQueue_H_
+#define _LockFreeQueue_H_
+
+#include "../api.h"
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <atomic>
+#include <assert.h>
+#include <stddef.h>
+
+namespace avg {
+
+// Bounded ring buffer queue with the same interface as Queue. Passing elements from
+// one producer thread to one consumer thread doesn't take any locks. Blocking calls
+// yield a few times and then sleep on a condition; the condition mutex is only touched
+// if a thread is actually asleep.
+//
+// Every cell carries a sequence number (as in D. Vyukov's bounded MPMC queue), so
+// pop() and clear() may also be called by a second thread - e.g. by the producer to
+// throw away stale elements after a seek. push() must always be called from the same
+// thread, and peek() must not be called while another thread pops.
+template<class QElement>
+class AVG_TEMPLATE_API LockFreeQueue
+{
+public:
+    typedef boost::shared_ptr<QElement> QElementPtr;
+
+    LockFreeQueue(int maxSize);
+    virtual ~LockFreeQueue();
+
+    bool empty() const;
+    QElementPtr pop(bool bBlock = true);
+    void clear();
+    void push(const QElementPtr& pElem);
+    bool tryPush(const QElementPtr& pElem);
+    QElementPtr peek(bool bBlock = true) const;
+    int size() const;
+    int getMaxSize() const;
+
+private:
+    typedef boost::unique_lock<boost::mutex> unique_lock;
+
+    LockFreeQueue(const LockFreeQueue&);
+    LockFreeQueue& operator=(const LockFreeQueue&);
+
+    struct Cell {
+        std::atomic<size_t> m_Seq;
+        QElementPtr m_pElem;
+    };
+
+    bool doPush(const QElementPtr& pElem);
+    QElementPtr doPop();
+    QElementPtr doPeek() const;
+    void beginWait() const;
+    void endWait() const;
+    void wakeWaiters() const;
+
+    Cell* m_pCells;
+    size_t m_Mask;
+    int m_MaxSize;
+
+    // Producer and consumer positions live in different cache lines.
+    char m_Pad0[64];
+    std::atomic<size_t> m_PushPos;
+    char m_Pad1[64];
+    std::atomic<size_t> m_PopPos;
+    char m_Pad2[64];
+
+    mutable std::atomic<int> m_NumWaiters;
+    mutable boost::mutex m_WaitMutex;
+    mutable boost::condition m_WaitCond;
+};
+
+template<class QElement>
+LockFreeQueue<QElement>::LockFreeQueue(int maxSize)
+    : m_MaxSize(maxSize),
+      m_PushPos(0),
+      m_PopPos(0),
+      m_NumWaiters(0)
+{
+    assert(maxSize > 0);
+    size_t numCells = 1;
+    while (numCells < size_t(maxSize)) {
+        numCells *= 2;
+    }
+    m_pCells = new Cell[numCells];
+    m_Mask = numCells-1;
+    for (size_t i = 0; i < numCells; ++i) {
+        m_pCells[i].m_Seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<class QElement>
+LockFreeQueue<QElement>::~LockFreeQueue()
+{
+    delete[] m_pCells;
+}
+
+template<class QElement>
+bool LockFreeQueue<QElement>::empty() const
+{
+    return size() == 0;
+}
+
+template<class QElement>
+typename LockFreeQueue<QElement>::QElementPtr LockFreeQueue<QElement>::pop(bool bBlock)
+{
+    QElementPtr pElem = doPop();
+    if (!pElem && bBlock) {
+        for (int i = 0; i < 16 && !pElem; ++i) {
+            boost::this_thread::yield();
+            pElem = doPop();
+        }
+        if (!pElem) {
+            unique_lock lock(m_WaitMutex);
+            beginWait();
+            pElem = doPop();
+            while (!pElem) {
+                m_WaitCond.wait(lock);
+                pElem = doPop();
+            }
+            endWait();
+        }
+    }
+    if (pElem) {
+        // A slot is free now, so a blocked producer can continue.
+        wakeWaiters();
+    }
+    return pElem;
+}
+
+template<class QElement>
+void LockFreeQueue<QElement>::clear()
+{
+    QElementPtr pElem;
+    do {
+        pElem = pop(false);
+    } while (pElem);
+}
+
+template<class QElement>
+typename LockFreeQueue<QElement>::QElementPtr LockFreeQueue<QElement>::peek(bool bBlock)
+        const
+{
+    QElementPtr pElem = doPeek();
+    if (!pElem && bBlock) {
+        unique_lock lock(m_WaitMutex);
+        beginWait();
+        pElem = doPeek();
+        while (!pElem) {
+            m_WaitCond.wait(lock);
+            pElem = doPeek();
+        }
+        endWait();
+    }
+    return pElem;
+}
+
+template<class QElement>
+void LockFreeQueue<QElement>::push(const QElementPtr& pElem)
+{
+    assert(pElem);
+    bool bPushed = doPush(pElem);
+    for (int i = 0; i < 16 && !bPushed; ++i) {
+        boost::this_thread::yield();
+        bPushed = doPush(pElem);
+    }
+    if (!bPushed) {
+        unique_lock lock(m_WaitMutex);
+        beginWait();
+        while (!doPush(pElem)) {
+            m_WaitCond.wait(lock);
+        }
+        endWait();
+    }
+    wakeWaiters();
+}
+
+template<class QElement>
+bool LockFreeQueue<QElement>::tryPush(const QElementPtr& pElem)
+{
+    assert(pElem);
+    if (doPush(pElem)) {
+        wakeWaiters();
+        return true;
+    } else {
+        return false;
+    }
+}
+
+template<class QElement>
+int LockFreeQueue<QElement>::size() const
+{
+    // Read the consumer position first so the difference can't become negative.
+    size_t popPos = m_PopPos.load(std::memory_order_acquire);
+    size_t pushPos = m_PushPos.load(std::memory_order_acquire);
+    int numElems = int(pushPos - popPos);
+    if (numElems > m_MaxSize) {
+        numElems = m_MaxSize;
+    }
+    return numElems;
+}
+
+template<class QElement>
+int LockFreeQueue<QElement>::getMaxSize() const
+{
+    return m_MaxSize;
+}
+
+template<class QElement>
+bool LockFreeQueue<QElement>::doPush(const QElementPtr& pElem)
+{
+    size_t pos = m_PushPos.load(std::memory_order_relaxed);
+    if (pos - m_PopPos.load(std::memory_order_acquire) >= size_t(m_MaxSize)) {
+        return false;
+    }
+    Cell& cell = m_pCells[pos & m_Mask];
+    if (cell.m_Seq.load(std::memory_order_acquire) != pos) {
+        // A consumer has claimed the cell but is still moving the element out.
+        return false;
+    }
+    cell.m_pElem = pElem;
+    cell.m_Seq.store(pos+1, std::memory_order_release);
+    m_PushPos.store(pos+1, std::memory_order_release);
+    return true;
+}
+
+template<class QElement>
+typename LockFreeQueue<QElement>::QElementPtr LockFreeQueue<QElement>::doPop()
+{
+    size_t pos = m_PopPos.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = m_pCells[pos & m_Mask];
+        size_t seq = cell.m_Seq.load(std::memory_order_acquire);
+        ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos+1);
+        if (diff == 0) {
+            if (m_PopPos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) {
+                QElementPtr pElem;
+                pElem.swap(cell.m_pElem);
+                cell.m_Seq.store(pos+m_Mask+1, std::memory_order_release);
+                return pElem;
+            }
+        } else if (diff < 0) {
+            return QElementPtr();
+        } else {
+            // Another thread popped this element in the meantime.
+            pos = m_PopPos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<class QElement>
+typename LockFreeQueue<QElement>::QElementPtr LockFreeQueue<QElement>::doPeek() const
+{
+    size_t pos = m_PopPos.load(std::memory_order_relaxed);
+    const Cell& cell = m_pCells[pos & m_Mask];
+    if (cell.m_Seq.load(std::memory_order_acquire) == pos+1) {
+        return cell.m_pElem;
+    } else {
+        return QElementPtr();
+    }
+}
+
+template<class QElement>
+void LockFreeQueue<QElement>::beginWait() const
+{
+    // Must be called with m_WaitMutex held. The fence pairs with the one in
+    // wakeWaiters(): Either the waker sees the waiter or the waiter sees the new state.
+    m_NumWaiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+template<class QElement>
+void LockFreeQueue<QElement>::endWait() const
+{
+    m_NumWaiters.fetch_sub(1);
+}
+
+template<class QElement>
+void LockFreeQueue<QElement>::wakeWaiters() const
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_NumWaiters.load(std::memory_order_relaxed) > 0) {
+        unique_lock lock(m_WaitMutex);
+        m_WaitCond.notify_all();
+    }
+}
+
+}
+#endif
+
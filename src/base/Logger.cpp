@@ -23,13 +23,13 @@
 #include "Exception.h"
 #include "StandardLogSink.h"
 #include "OSHelper.h"
+#include "LockFreeQueue.h"
 
 #include <boost/algorithm/string.hpp>
 
 #ifdef _WIN32
 #include <Winsock2.h>
 #include <time.h>
-#include <Mmsystem.h>
 #undef ERROR
 #else
 #include <sys/time.h>
@@ -37,6 +37,8 @@
 #endif
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <stdlib.h>
 
 using namespace std;
 namespace ba = boost::algorithm;
@@ -62,28 +64,141 @@ namespace avg {
     const category_t Logger::category::DEPRECATION = UTF8String("DEPREC");
     const category_t Logger::category::VIDEO = UTF8String("VIDEO");
 
+struct LogMsg
+{
+    LogMsg(long long time, const category_t& category, severity_t severity,
+            const UTF8String& sMsg)
+        : m_Time(time),
+          m_Category(category),
+          m_Severity(severity),
+          m_sMsg(sMsg)
+    {
+    }
+
+    long long m_Time;
+    category_t m_Category;
+    severity_t m_Severity;
+    UTF8String m_sMsg;
+};
+
+typedef boost::shared_ptr<LogMsg> LogMsgPtr;
+
+class LogRing: public LockFreeQueue<LogMsg>
+{
+public:
+    LogRing()
+        : LockFreeQueue<LogMsg>(1024),
+          m_bThreadDone(false),
+          m_bDelivering(false)
+    {
+    }
+
+    std::atomic<bool> m_bThreadDone;
+    // True while the owning thread is in deliverQueuedMsgs(). Only accessed by the 
+    // owning thread.
+    bool m_bDelivering;
+};
+
 namespace {
-    Logger* s_pLogger = 0;
+    std::atomic<Logger*> s_pLogger(0);
     boost::mutex s_logMutex;
-    boost::mutex s_traceMutex;
-    boost::mutex s_sinkMutex;
     boost::mutex s_removeStdSinkMutex;
+
+    // Max. number of messages taken from one ring before the sinks are flushed.
+    const int MAX_BATCH_SIZE = 256;
+
+    // Wall clock time in microseconds since the epoch.
+    long long getLogTime()
+    {
+#ifdef _WIN32
+        FILETIME fileTime;
+        GetSystemTimeAsFileTime(&fileTime);
+        long long time = ((long long)(fileTime.dwHighDateTime) << 32) | 
+                fileTime.dwLowDateTime;
+        return time/10 - 11644473600000000LL;
+#else
+        struct timeval time;
+        gettimeofday(&time, NULL);
+        return (long long)(time.tv_sec)*1000000 + time.tv_usec;
+#endif
+    }
+
+    void getLocalTime(long long logTime, tm* pTime)
+    {
+        time_t secs = time_t(logTime/1000000);
+#ifdef _WIN32
+        localtime_s(pTime, &secs);
+#else
+        localtime_r(&secs, pTime);
+#endif
+    }
+
+    bool isEarlier(const LogMsgPtr& pMsg1, const LogMsgPtr& pMsg2)
+    {
+        return pMsg1->m_Time < pMsg2->m_Time;
+    }
+
+    void releaseThreadRing(LogRingPtr* ppRing)
+    {
+        (*ppRing)->m_bThreadDone = true;
+        delete ppRing;
+    }
+
+    typedef boost::lock_guard<boost::recursive_mutex> recursive_lock_guard;
+
+    // Marks the thread's ring while the thread delivers messages. Restores the old
+    // value because deliverQueuedMsgs() can be called recursively.
+    class DeliveringScope
+    {
+    public:
+        DeliveringScope(LogRing& ring)
+            : m_Ring(ring),
+              m_bWasDelivering(ring.m_bDelivering)
+        {
+            m_Ring.m_bDelivering = true;
+        }
+
+        ~DeliveringScope()
+        {
+            m_Ring.m_bDelivering = m_bWasDelivering;
+        }
+
+    private:
+        LogRing& m_Ring;
+        bool m_bWasDelivering;
+    };
 }
 
 boost::mutex Logger::m_CategoryMutex;
 
 Logger * Logger::get()
 {
-    lock_guard lock(s_logMutex);
-    if (!s_pLogger) {
-        s_pLogger = new Logger;
+    Logger* pLogger = s_pLogger.load(std::memory_order_acquire);
+    if (!pLogger) {
+        lock_guard lock(s_logMutex);
+        pLogger = s_pLogger.load(std::memory_order_relaxed);
+        if (!pLogger) {
+            pLogger = new Logger;
+            s_pLogger.store(pLogger, std::memory_order_release);
+        }
     }
-    return s_pLogger;
+    return pLogger;
 }
 
 Logger::Logger()
+    : m_NumSinks(0),
+      m_NumSyncSinks(0),
+      m_NumCategoryReaders(0),
+      m_pSinkThread(0),
+      m_bSinkThreadStarted(false),
+      m_bSinkThreadStopped(false)
 {
     m_Severity = severity::WARNING;
+    boost::shared_ptr<CatToSeverityMap> pEmptyMap(new CatToSeverityMap);
+    m_pCategoryMaps.push_back(pEmptyMap);
+    m_pCategorySeverities.store(pEmptyMap.get());
+    m_MinSeverity.store(m_Severity);
+
     string sEnvSeverity;
     bool bEnvSeveritySet = getEnv("AVG_LOG_SEVERITY", sEnvSeverity);
     if(bEnvSeveritySet) {
@@ -126,19 +241,33 @@ Logger::~Logger()
 {
 }
 
-void Logger::addLogSink(const LogSinkPtr& logSink)
+void Logger::addLogSink(const LogSinkPtr& logSink, bool bSynchronous)
 {
-    lock_guard lock(s_sinkMutex);
-    m_pSinks.push_back(logSink);
+    lock_guard lock(m_SinkMutex);
+    if (bSynchronous) {
+        m_pSyncSinks.push_back(logSink);
+        m_NumSyncSinks = int(m_pSyncSinks.size());
+    } else {
+        m_pSinks.push_back(logSink);
+        m_NumSinks = int(m_pSinks.size());
+    }
 }
 
 void Logger::removeLogSink(const LogSinkPtr& logSink)
 {
-    lock_guard lock(s_sinkMutex);
+    // Messages logged before the sink is removed still reach it.
+    flush();
+    lock_guard lock(m_SinkMutex);
     std::vector<LogSinkPtr>::iterator it;
     it = find(m_pSinks.begin(), m_pSinks.end(), logSink);
     if ( it != m_pSinks.end() ) {
         m_pSinks.erase(it);
+        m_NumSinks = int(m_pSinks.size());
+    }
+    it = find(m_pSyncSinks.begin(), m_pSyncSinks.end(), logSink);
+    if ( it != m_pSyncSinks.end() ) {
+        m_pSyncSinks.erase(it);
+        m_NumSyncSinks = int(m_pSyncSinks.size());
     }
 }
 
@@ -151,47 +280,92 @@ void Logger::removeStdLogSink()
     }
 }
 
+void Logger::flush()
+{
+    while (deliverQueuedMsgs() > 0) {}
+}
+
 category_t Logger::configureCategory(category_t category, severity_t severity)
 {
     lock_guard lock(m_CategoryMutex);
     severity = (severity == Logger::severity::NONE) ? m_Severity : severity;
     UTF8String sCategory = boost::to_upper_copy(string(category));
+    boost::shared_ptr<CatToSeverityMap> pSeverities(
+            new CatToSeverityMap(*m_pCategorySeverities.load()));
+    pSeverities->erase(sCategory);
+    pair<const category_t, const severity_t> element(sCategory, severity);
+    pSeverities->insert(element);
+
+    severity_t minSeverity = severity;
     CatToSeverityMap::iterator it;
-    it = m_CategorySeverities.find(sCategory);
-    if ( it != m_CategorySeverities.end()) {
-        m_CategorySeverities.erase(sCategory);
+    for (it = pSeverities->begin(); it != pSeverities->end(); ++it) {
+        minSeverity = min(minSeverity, it->second);
+    }
+    m_pCategoryMaps.push_back(pSeverities);
+    m_pCategorySeverities.store(pSeverities.get());
+    m_MinSeverity.store(minSeverity);
+    if (m_NumCategoryReaders.load() == 0) {
+        // Readers that start after this point see the new map, so the old ones can
+        // be freed. Otherwise, they're freed by a later call.
+        m_pCategoryMaps.erase(m_pCategoryMaps.begin(), m_pCategoryMaps.end()-1);
     }
-    pair<const category_t, const severity_t> element(sCategory, severity);
-    m_CategorySeverities.insert(element);
     return sCategory;
 }
 
 CatToSeverityMap Logger::getCategories()
 {
-    return m_CategorySeverities;
+    lock_guard lock(m_CategoryMutex);
+    return *m_pCategorySeverities.load();
 }
 
 void Logger::trace(const UTF8String& sMsg, const category_t& category,
         severity_t severity) const
 {
-    lock_guard lock(s_traceMutex);
-    struct tm* pTime;
-    #ifdef _WIN32
-    __int64 now;
-    _time64(&now);
-    pTime = _localtime64(&now);
-    DWORD tms = timeGetTime();
-    unsigned millis = unsigned(tms % 1000);
-    #else
-    struct timeval time;
-    gettimeofday(&time, NULL);
-    pTime = localtime(&time.tv_sec);
-    unsigned millis = time.tv_usec/1000;
-    #endif
-    lock_guard lockHandler(s_sinkMutex);
-    std::vector<LogSinkPtr>::const_iterator it;
-    for(it=m_pSinks.begin(); it!=m_pSinks.end(); ++it){
-        (*it)->logMessage(pTime, millis, category, severity, sMsg);
+    long long time = getLogTime();
+    if (m_NumSyncSinks > 0) {
+        vector<LogSinkPtr> pSyncSinks;
+        {
+            lock_guard lock(m_SinkMutex);
+            pSyncSinks = m_pSyncSinks;
+        }
+        struct tm localTime;
+        getLocalTime(time, &localTime);
+        unsigned millis = unsigned((time/1000) % 1000);
+        std::vector<LogSinkPtr>::const_iterator it;
+        for (it = pSyncSinks.begin(); it != pSyncSinks.end(); ++it) {
+            (*it)->logMessage(&localTime, millis, category, severity, sMsg);
+            (*it)->flush();
+        }
+    }
+    if (m_NumSinks > 0) {
+        bool bThreadRunning = startSinkThread();
+        Logger* pThis = const_cast<Logger*>(this);
+        LogMsgPtr pMsg(new LogMsg(time, category, severity, sMsg));
+        LogRing& ring = getThreadRing();
+        if (ring.tryPush(pMsg)) {
+            if (ring.size() == ring.getMaxSize()/2) {
+                // Burst of messages: Don't wait for the sink thread to poll.
+                wakeSinkThread();
+            }
+        } else {
+            if (ring.m_bDelivering) {
+                // A sink logged while this thread is delivering messages, so this 
+                // thread holds m_DeliverMutex. Waiting for the sink thread would 
+                // deadlock and flushing would call the sinks recursively.
+                return;
+            }
+            if (bThreadRunning && !isSinkThread()) {
+                wakeSinkThread();
+                ring.push(pMsg);
+            } else {
+                pThis->flush();
+                ring.push(pMsg);
+            }
+        }
+        if (severity >= Logger::severity::ERROR || !bThreadRunning) {
+            // Make sure the message gets out even if the process dies right after.
+            pThis->flush();
+        }
     }
 }
 
@@ -228,6 +402,146 @@ void Logger::log(const UTF8String& msg, const category_t& category,
     }
 }
 
+LogRing& Logger::getThreadRing() const
+{
+    static boost::thread_specific_ptr<LogRingPtr> s_pThreadRing(releaseThreadRing);
+    if (!s_pThreadRing.get()) {
+        LogRingPtr pRing(new LogRing);
+        {
+            lock_guard lock(m_RingMutex);
+            m_pRings.push_back(pRing);
+        }
+        s_pThreadRing.reset(new LogRingPtr(pRing));
+    }
+    return **s_pThreadRing;
+}
+
+bool Logger::startSinkThread() const
+{
+    if (!m_bSinkThreadStarted.load(std::memory_order_acquire)) {
+        lock_guard lock(m_SinkThreadMutex);
+        if (!m_bSinkThreadStarted.load(std::memory_order_relaxed)) {
+            Logger* pThis = const_cast<Logger*>(this);
+            m_pSinkThread = new boost::thread(&Logger::runSinkThread, pThis);
+            atexit(&Logger::onExit);
+            m_bSinkThreadStarted.store(true, std::memory_order_release);
+        }
+    }
+    // Once the thread has been stopped at exit, messages are delivered directly.
+    return !m_bSinkThreadStopped.load(std::memory_order_acquire);
+}
+
+void Logger::stopSinkThread()
+{
+    {
+        lock_guard lock(m_SinkThreadMutex);
+        if (!m_pSinkThread) {
+            return;
+        }
+        m_bSinkThreadStopped = true;
+        m_SinkThreadCond.notify_one();
+    }
+    m_pSinkThread->join();
+    delete m_pSinkThread;
+    m_pSinkThread = 0;
+    flush();
+}
+
+void Logger::wakeSinkThread() const
+{
+    lock_guard lock(m_SinkThreadMutex);
+    m_SinkThreadCond.notify_one();
+}
+
+bool Logger::isSinkThread() const
+{
+    return m_pSinkThread && boost::this_thread::get_id() == m_pSinkThread->get_id();
+}
+
+void Logger::runSinkThread()
+{
+    while (true) {
+        int numMsgs = deliverQueuedMsgs();
+        boost::unique_lock<boost::mutex> lock(m_SinkThreadMutex);
+        if (m_bSinkThreadStopped) {
+            break;
+        }
+        if (numMsgs == 0) {
+            // Producers don't signal new messages, so poll the rings.
+            m_SinkThreadCond.timed_wait(lock, boost::posix_time::milliseconds(10));
+        }
+    }
+}
+
+int Logger::deliverQueuedMsgs()
+{
+    recursive_lock_guard deliverLock(m_DeliverMutex);
+    DeliveringScope deliveringScope(getThreadRing());
+    vector<LogRingPtr> pRings;
+    {
+        lock_guard lock(m_RingMutex);
+        // The rings of threads that have ended are dropped once they're empty.
+        vector<LogRingPtr>::iterator it = m_pRings.begin();
+        while (it != m_pRings.end()) {
+            if ((*it)->m_bThreadDone && (*it)->empty()) {
+                it = m_pRings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        pRings = m_pRings;
+    }
+
+    vector<LogMsgPtr> pMsgs;
+    for (unsigned i = 0; i < pRings.size(); ++i) {
+        LogMsgPtr pMsg = pRings[i]->pop(false);
+        while (pMsg) {
+            pMsgs.push_back(pMsg);
+            if (pMsgs.size() % MAX_BATCH_SIZE == 0) {
+                break;
+            }
+            pMsg = pRings[i]->pop(false);
+        }
+    }
+    if (pMsgs.empty()) {
+        return 0;
+    }
+    stable_sort(pMsgs.begin(), pMsgs.end(), isEarlier);
+
+    vector<LogSinkPtr> pSinks;
+    {
+        lock_guard lock(m_SinkMutex);
+        pSinks = m_pSinks;
+    }
+    // localtime is only called once per second of log messages.
+    long long curSecond = -1;
+    struct tm localTime;
+    for (unsigned i = 0; i < pMsgs.size(); ++i) {
+        LogMsg& msg = *pMsgs[i];
+        if (msg.m_Time/1000000 != curSecond) {
+            curSecond = msg.m_Time/1000000;
+            getLocalTime(msg.m_Time, &localTime);
+        }
+        unsigned millis = unsigned((msg.m_Time/1000) % 1000);
+        for (unsigned j = 0; j < pSinks.size(); ++j) {
+            pSinks[j]->logMessage(&localTime, millis, msg.m_Category, msg.m_Severity,
+                    msg.m_sMsg);
+        }
+    }
+    for (unsigned j = 0; j < pSinks.size(); ++j) {
+        pSinks[j]->flush();
+    }
+    return int(pMsgs.size());
+}
+
+void Logger::onExit()
+{
+    Logger* pLogger = s_pLogger.load();
+    if (pLogger) {
+        pLogger->stopSinkThread();
+    }
+}
+
 void Logger::setupCategory()
 {
     configureCategory(category::NONE);
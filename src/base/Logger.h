@@ -35,6 +35,7 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <atomic>
 
 #ifdef ERROR
 #undef ERROR
@@ -44,6 +45,9 @@ namespace avg {
 
 typedef boost::unordered_map< const category_t, const severity_t > CatToSeverityMap;
 
+class LogRing;
+typedef boost::shared_ptr<LogRing> LogRingPtr;
+
 #ifdef _WIN32
 // non dll-interface class used as base for dll-interface class
 #pragma warning(disable:4275) 
@@ -82,10 +86,17 @@ public:
     static severity_t stringToSeverity(const string& sSeverity);
     static const char * severityToString(const severity_t severity);
 
-    void addLogSink(const LogSinkPtr& logSink);
+    // Messages are normally handed to the sinks by a background thread. Synchronous
+    // sinks are called in the thread that logs the message instead. This is needed for
+    // sinks that take a lock the logging thread might hold (e.g. the Python GIL).
+    void addLogSink(const LogSinkPtr& logSink, bool bSynchronous=false);
     void removeLogSink(const LogSinkPtr& logSink);
     void removeStdLogSink();
 
+    // Passes all queued messages to the sinks before returning. Messages with
+    // severity ERROR or above are flushed immediately.
+    void flush();
+
     category_t configureCategory(category_t category,
             severity_t severity=severity::NONE);
     CatToSeverityMap getCategories();
@@ -105,26 +116,65 @@ public:
     void log(const UTF8String& msg, const category_t& category=category::APP,
             severity_t severity=severity::INFO) const;
 
+    // Doesn't take any locks. Messages below the lowest configured severity are
+    // rejected without looking at the category.
     inline bool shouldLog(const category_t& category, severity_t severity) const {
-        lock_guard lock(m_CategoryMutex);
-        try {
-            severity_t targetSeverity = m_CategorySeverities.at(category);
-            return (targetSeverity <= severity);
-        } catch (out_of_range e){
+        if (severity < m_MinSeverity.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        // configureCategory() only frees superseded category maps while no reader 
+        // is registered here.
+        m_NumCategoryReaders.fetch_add(1);
+        const CatToSeverityMap* pSeverities = m_pCategorySeverities.load();
+        CatToSeverityMap::const_iterator it = pSeverities->find(category);
+        bool bKnown = (it != pSeverities->end());
+        bool bLog = bKnown && it->second <= severity;
+        m_NumCategoryReaders.fetch_sub(1);
+        if (!bKnown) {
             string msg("Unknown category: " + category);
             throw Exception(AVG_ERR_INVALID_ARGS, msg);
         }
+        return bLog;
     }
 
 private:
     Logger();
     void setupCategory();
 
+    LogRing& getThreadRing() const;
+    bool startSinkThread() const;
+    void stopSinkThread();
+    void wakeSinkThread() const;
+    bool isSinkThread() const;
+    void runSinkThread();
+    int deliverQueuedMsgs();
+    static void onExit();
+
     std::vector<LogSinkPtr> m_pSinks;
+    std::vector<LogSinkPtr> m_pSyncSinks;
+    std::atomic<int> m_NumSinks;
+    std::atomic<int> m_NumSyncSinks;
+    mutable boost::mutex m_SinkMutex;
     LogSinkPtr m_pStdSink;
-    CatToSeverityMap m_CategorySeverities;
+
+    // Category table readers see an immutable snapshot. configureCategory() publishes
+    // a new one and frees the old snapshots once no reader is active.
+    std::atomic<const CatToSeverityMap*> m_pCategorySeverities;
+    mutable std::atomic<int> m_NumCategoryReaders;
+    std::vector<boost::shared_ptr<CatToSeverityMap> > m_pCategoryMaps;
+    std::atomic<severity_t> m_MinSeverity;
     severity_t m_Severity;
     static boost::mutex m_CategoryMutex;
+
+    // One single-producer ring per logging thread, drained by the sink thread.
+    mutable std::vector<LogRingPtr> m_pRings;
+    mutable boost::mutex m_RingMutex;
+    mutable boost::recursive_mutex m_DeliverMutex;
+    mutable boost::thread* m_pSinkThread;
+    mutable std::atomic<bool> m_bSinkThreadStarted;
+    std::atomic<bool> m_bSinkThreadStopped;
+    mutable boost::mutex m_SinkThreadMutex;
+    mutable boost::condition_variable m_SinkThreadCond;
 };
 
 #define AVG_TRACE(category, severity, sMsg) { \
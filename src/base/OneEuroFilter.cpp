@@ -0,0 +1,107 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "OneEuroFilter.h"
+
+#include "Exception.h"
+#include "MathHelper.h"
+#include "StringHelper.h"
+
+namespace avg {
+
+OneEuroFilter::OneEuroFilter(float minCutoff, float beta, float dCutoff)
+    : m_Freq(60),     // Initial frequency, updated as soon as we have > 1 sample.
+      m_MinCutoff(minCutoff),
+      m_Beta(beta),
+      m_DCutoff(dCutoff),
+      m_LastTime(-1)
+{
+    if (minCutoff <= 0) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE, "OneEuroFilter: minCutoff should be >0.");
+    }
+    if (dCutoff <= 0) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE, "OneEuroFilter: dCutoff should be >0.");
+    }
+}
+
+float OneEuroFilter::apply(float x, long long time)
+{
+    double t = time/1000.;
+    if (m_LastTime == t) {
+        return x;
+    }
+    // Update the sampling frequency based on timestamps.
+    if (m_LastTime > 0 && t > 0) {
+        m_Freq = 1/(t-m_LastTime);
+    }
+    m_LastTime = t;
+    // Estimate the current variation per second.
+    double dx = 0;
+    if (m_XFilter.hasValue()) {
+        dx = (x-m_XFilter.getLastValue())*m_Freq;
+    }
+    double edx = m_DXFilter.apply(dx, getAlpha(m_DCutoff));
+    // Use it to update the cutoff frequency.
+    double cutoff = m_MinCutoff + m_Beta*fabs(edx);
+    return float(m_XFilter.apply(x, getAlpha(cutoff)));
+}
+
+double OneEuroFilter::getAlpha(double cutoff) const
+{
+    double te = 1/m_Freq;
+    double tau = 1/(2*M_PI*cutoff);
+    return 1/(1+tau/te);
+}
+
+OneEuroFilter::LowPassFilter::LowPassFilter()
+    : m_bHasValue(false),
+      m_Y(0),
+      m_S(0)
+{
+}
+
+double OneEuroFilter::LowPassFilter::apply(double value, double alpha)
+{
+    if (alpha <= 0 || alpha > 1) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE, "LowPassFilter alpha (" + 
+                toString(alpha) + ") should be in (0.0, 1.0].");
+    }
+    if (m_bHasValue) {
+        m_S = alpha*value + (1-alpha)*m_S;
+    } else {
+        m_S = value;
+        m_bHasValue = true;
+    }
+    m_Y = value;
+    return m_S;
+}
+
+bool OneEuroFilter::LowPassFilter::hasValue() const
+{
+    return m_bHasValue;
+}
+
+double OneEuroFilter::LowPassFilter::getLastValue() const
+{
+    return m_Y;
+}
+
+}
@@ -29,6 +29,9 @@ namespace avg {
 ProfilingZone::ProfilingZone(const ProfilingZoneID& zoneID)
     : m_TimeSum(0),
       m_AvgTime(0),
+      m_CounterSum(0),
+      m_AvgCounter(0),
+      m_bHasCounter(false),
       m_NumFrames(0),
       m_Indent(0),
       m_ZoneID(zoneID)
@@ -46,6 +49,8 @@ void ProfilingZone::restart()
     m_NumFrames = 0;
     m_AvgTime = 0;
     m_TimeSum = 0;
+    m_AvgCounter = 0;
+    m_CounterSum = 0;
 }
 
 void ProfilingZone::reset()
@@ -53,16 +58,28 @@ void ProfilingZone::reset()
     m_NumFrames++;
     m_AvgTime = (m_AvgTime*(m_NumFrames-1)+m_TimeSum)/m_NumFrames;
     m_TimeSum = 0;
+    m_AvgCounter = (m_AvgCounter*(m_NumFrames-1)+m_CounterSum)/m_NumFrames;
+    m_CounterSum = 0;
 }
 
 long long ProfilingZone::getUSecs() const
 {
-    return m_TimeSum;
+    return m_TimeSum/1000;
 }
 
 long long ProfilingZone::getAvgUSecs() const
 {
-    return m_AvgTime;
+    return m_AvgTime/1000;
+}
+
+bool ProfilingZone::hasCounter() const
+{
+    return m_bHasCounter;
+}
+
+long long ProfilingZone::getAvgCounter() const
+{
+    return m_AvgCounter;
 }
 
 void ProfilingZone::setIndentLevel(int indent)
@@ -84,5 +101,10 @@ const string& ProfilingZone::getName() const
 {
     return m_ZoneID.getName();
 }
+
+const ProfilingZoneID& ProfilingZone::getZoneID() const
+{
+    return m_ZoneID;
+}
     
 }
@@ -24,7 +24,8 @@
 
 #include "../api.h"
 #include "ProfilingZoneID.h"
-#include "TimeSource.h"
+
+#include <string>
 
 namespace avg {
 
@@ -35,26 +36,38 @@ public:
     virtual ~ProfilingZone();
     void restart();
     
-    void start() 
+    // Times are in nanoseconds.
+    void start(long long time) 
+    {
+        m_StartTime = time;
+    };
+    void stop(long long time)
     {
-        m_StartTime = TimeSource::get()->getCurrentMicrosecs();
+        m_TimeSum += time-m_StartTime;
     };
-    void stop()
+    void addToCounter(long long value)
     {
-        m_TimeSum += TimeSource::get()->getCurrentMicrosecs()-m_StartTime;
+        m_CounterSum += value;
+        m_bHasCounter = true;
     };
     void reset();
     long long getUSecs() const;
     long long getAvgUSecs() const;
+    bool hasCounter() const;
+    long long getAvgCounter() const;
     void setIndentLevel(int indent);
     int getIndentLevel() const;
     std::string getIndentString() const;
     const std::string& getName() const;
+    const ProfilingZoneID& getZoneID() const;
 
 private:
     long long m_TimeSum;
     long long m_AvgTime;
     long long m_StartTime;
+    long long m_CounterSum;
+    long long m_AvgCounter;
+    bool m_bHasCounter;
     int m_NumFrames;
     int m_Indent;
     const ProfilingZoneID& m_ZoneID;
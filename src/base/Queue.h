@@ -46,7 +46,9 @@ public:
     bool empty() const;
     QElementPtr pop(bool bBlock = true);
     void clear();
-    void push(const QElementPtr& pElem);
+    // Blocks while the queue is full. If bBlock is false, the element is added even
+    // if this exceeds the maximum size.
+    void push(const QElementPtr& pElem, bool bBlock = true);
     QElementPtr peek(bool bBlock = true) const;
     int size() const;
     int getMaxSize() const;
@@ -111,12 +113,12 @@ typename Queue<QElement>::QElementPtr Queue<QElement>::peek(bool bBlock) const
 }
 
 template<class QElement>
-void Queue<QElement>::push(const QElementPtr& pElem)
+void Queue<QElement>::push(const QElementPtr& pElem, bool bBlock)
 {
     assert(pElem);
     unique_lock lock(m_Mutex);
-    if (m_pElements.size() == (unsigned)m_MaxSize) {
-        while (m_pElements.size() == (unsigned)m_MaxSize) {
+    if (bBlock && m_MaxSize >= 0) {
+        while (m_pElements.size() >= (unsigned)m_MaxSize) {
             m_Cond.wait(lock);
         }
     }
@@ -34,7 +34,20 @@ public:
     {
         if (s_bTimersEnabled) {
             m_pZoneID = &zoneID;
-            m_pZoneID->getProfiler()->startZone(zoneID);
+            m_pProfiler = zoneID.getProfiler();
+            m_pProfiler->startZone(zoneID);
+        } else {
+            m_pZoneID = 0;
+        }
+    };
+
+    // Uses the given profiler instead of the one of the current thread.
+    ScopeTimer(ProfilingZoneID& zoneID, ThreadProfiler* pProfiler)
+    {
+        if (s_bTimersEnabled) {
+            m_pZoneID = &zoneID;
+            m_pProfiler = pProfiler;
+            m_pProfiler->startZone(zoneID);
         } else {
             m_pZoneID = 0;
         }
@@ -43,7 +56,14 @@ public:
     ~ScopeTimer()
     {
         if (m_pZoneID) {
-            m_pZoneID->getProfiler()->stopZone(*m_pZoneID);
+            m_pProfiler->stopZone(*m_pZoneID);
+        }
+    };
+
+    void addToCounter(long long value)
+    {
+        if (m_pZoneID) {
+            m_pProfiler->addToZoneCounter(*m_pZoneID, value);
         }
     };
 
@@ -51,6 +71,7 @@ public:
 
 private:
     ProfilingZoneID* m_pZoneID;
+    ThreadProfiler* m_pProfiler;
 
     static bool s_bTimersEnabled;
 };
@@ -0,0 +1,189 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "SpatialGrid.h"
+
+#include "Exception.h"
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+namespace avg {
+
+// The grid has about as many cells as entries, but never more than this per axis.
+static const int MAX_CELLS_PER_AXIS = 64;
+
+static bool isEmpty(const FRect& rect)
+{
+    return rect.tl.x > rect.br.x || rect.tl.y > rect.br.y;
+}
+
+static bool containsClosed(const FRect& rect, const glm::vec2& pt)
+{
+    return pt.x >= rect.tl.x && pt.x <= rect.br.x && pt.y >= rect.tl.y && 
+            pt.y <= rect.br.y;
+}
+
+SpatialGrid::SpatialGrid()
+    : m_NumCells(0,0)
+{
+}
+
+void SpatialGrid::build(const vector<FRect>& bounds)
+{
+    clear();
+    if (bounds.empty()) {
+        return;
+    }
+    m_Bounds = bounds;
+    bool bExtentValid = false;
+    for (unsigned i = 0; i < bounds.size(); ++i) {
+        if (!isEmpty(bounds[i])) {
+            if (bExtentValid) {
+                m_Extent.expand(bounds[i]);
+            } else {
+                m_Extent = bounds[i];
+                bExtentValid = true;
+            }
+        }
+    }
+    if (!bExtentValid) {
+        m_Extent = FRect(0, 0, 1, 1);
+    }
+    float width = max(m_Extent.width(), 1.f);
+    float height = max(m_Extent.height(), 1.f);
+    float numEntries = float(bounds.size());
+    m_NumCells.x = int(ceil(sqrt(numEntries*width/height)));
+    m_NumCells.y = int(ceil(sqrt(numEntries*height/width)));
+    m_NumCells.x = max(1, min(m_NumCells.x, MAX_CELLS_PER_AXIS));
+    m_NumCells.y = max(1, min(m_NumCells.y, MAX_CELLS_PER_AXIS));
+    m_CellSize = glm::vec2(width/m_NumCells.x, height/m_NumCells.y);
+    m_Cells.resize(m_NumCells.x*m_NumCells.y);
+
+    m_CellRanges.resize(bounds.size());
+    for (unsigned i = 0; i < bounds.size(); ++i) {
+        insert(i);
+    }
+}
+
+void SpatialGrid::update(int id, const FRect& bounds)
+{
+    AVG_ASSERT(id >= 0 && id < getNumEntries());
+    remove(id);
+    m_Bounds[id] = bounds;
+    insert(id);
+}
+
+void SpatialGrid::clear()
+{
+    m_Bounds.clear();
+    m_CellRanges.clear();
+    m_Cells.clear();
+    m_NumCells = IntPoint(0,0);
+}
+
+void SpatialGrid::getCandidates(const glm::vec2& pt, vector<int>& ids) const
+{
+    ids.clear();
+    if (m_Cells.empty()) {
+        return;
+    }
+    IntPoint cell = getCell(pt);
+    const vector<int>& cellIDs = m_Cells[cell.y*m_NumCells.x+cell.x];
+    for (unsigned i = 0; i < cellIDs.size(); ++i) {
+        int id = cellIDs[i];
+        if (containsClosed(m_Bounds[id], pt)) {
+            ids.push_back(id);
+        }
+    }
+}
+
+int SpatialGrid::getNumEntries() const
+{
+    return int(m_Bounds.size());
+}
+
+int SpatialGrid::getNumCells() const
+{
+    return int(m_Cells.size());
+}
+
+const FRect& SpatialGrid::getBounds(int id) const
+{
+    return m_Bounds[id];
+}
+
+IntRect SpatialGrid::getCellRange(const FRect& bounds) const
+{
+    // Rectangles that reach outside of the grid extent are clamped to the border cells.
+    // getCell() does the same for points, so lookups stay consistent.
+    IntPoint tl = getCell(bounds.tl);
+    IntPoint br = getCell(bounds.br);
+    return IntRect(tl, br);
+}
+
+IntPoint SpatialGrid::getCell(const glm::vec2& pt) const
+{
+    float x = (pt.x-m_Extent.tl.x)/m_CellSize.x;
+    float y = (pt.y-m_Extent.tl.y)/m_CellSize.y;
+    x = max(0.f, min(x, float(m_NumCells.x-1)));
+    y = max(0.f, min(y, float(m_NumCells.y-1)));
+    return IntPoint(int(x), int(y));
+}
+
+void SpatialGrid::insert(int id)
+{
+    if (isEmpty(m_Bounds[id])) {
+        m_CellRanges[id] = IntRect(0, 0, -1, -1);
+        return;
+    }
+    IntRect range = getCellRange(m_Bounds[id]);
+    m_CellRanges[id] = range;
+    for (int y = range.tl.y; y <= range.br.y; ++y) {
+        for (int x = range.tl.x; x <= range.br.x; ++x) {
+            vector<int>& cellIDs = m_Cells[y*m_NumCells.x+x];
+            // Keep cells sorted so candidates are returned in ascending order.
+            if (cellIDs.empty() || cellIDs.back() < id) {
+                cellIDs.push_back(id);
+            } else {
+                cellIDs.insert(lower_bound(cellIDs.begin(), cellIDs.end(), id), id);
+            }
+        }
+    }
+}
+
+void SpatialGrid::remove(int id)
+{
+    const IntRect& range = m_CellRanges[id];
+    for (int y = range.tl.y; y <= range.br.y; ++y) {
+        for (int x = range.tl.x; x <= range.br.x; ++x) {
+            vector<int>& cellIDs = m_Cells[y*m_NumCells.x+x];
+            vector<int>::iterator it = lower_bound(cellIDs.begin(), cellIDs.end(), id);
+            AVG_ASSERT(it != cellIDs.end() && *it == id);
+            cellIDs.erase(it);
+        }
+    }
+}
+
+}
@@ -0,0 +1,75 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _SpatialGrid_H_
+#define _SpatialGrid_H_
+
+#include "../api.h"
+
+#include "GLMHelper.h"
+#include "Rect.h"
+
+#include "../glm/glm.hpp"
+
+#include <vector>
+
+namespace avg {
+
+// Uniform grid over a set of axis-aligned rectangles. Answers the question which
+// rectangles contain a point without testing all of them. Entries are identified by
+// their index in the vector passed to build(). Rectangles are treated as closed, so
+// points on the border are considered inside. Empty rectangles (tl > br) are stored but
+// never returned as candidates.
+class AVG_API SpatialGrid
+{
+public:
+    SpatialGrid();
+
+    void build(const std::vector<FRect>& bounds);
+    void update(int id, const FRect& bounds);
+    void clear();
+
+    // Returns the ids of all rectangles that contain pt, in ascending order.
+    void getCandidates(const glm::vec2& pt, std::vector<int>& ids) const;
+
+    int getNumEntries() const;
+    int getNumCells() const;
+    const FRect& getBounds(int id) const;
+
+private:
+    IntRect getCellRange(const FRect& bounds) const;
+    IntPoint getCell(const glm::vec2& pt) const;
+    void insert(int id);
+    void remove(int id);
+
+    FRect m_Extent;
+    glm::vec2 m_CellSize;
+    IntPoint m_NumCells;
+
+    std::vector<FRect> m_Bounds;
+    std::vector<IntRect> m_CellRanges;
+    std::vector<std::vector<int> > m_Cells;
+};
+
+}
+
+#endif
@@ -22,7 +22,6 @@
 #include "Logger.h"
 
 #include <iostream>
-#include <iomanip>
 
 using namespace std;
 
@@ -38,16 +37,40 @@ StandardLogSink::~StandardLogSink()
 
 }
 
+static void appendPadded(string& s, const string& sField, unsigned width)
+{
+    if (sField.size() < width) {
+        s.append(width-sField.size(), '.');
+    }
+    s += sField;
+}
+
 void StandardLogSink::logMessage(const tm* pTime, unsigned millis,
         const category_t& category, severity_t severity, const UTF8String& sMsg)
 {
     char timeString[256];
     strftime(timeString, sizeof(timeString), "%y-%m-%d %H:%M:%S", pTime);
-    cerr << "[" << timeString << "." << 
-        setw(3) << setfill('0') << millis << setw(0) << "][";
-    cerr << setw(4) << setfill('.') << Logger::severityToString(severity) << "][";
-    cerr << setw(9) << setfill('.') << category << "] : " << sMsg << endl;
-    cerr.flush();
+    char millisString[5] = {'.', char('0'+millis/100), char('0'+millis/10%10),
+            char('0'+millis%10), 0};
+    m_sBuffer += "[";
+    m_sBuffer += timeString;
+    m_sBuffer += millisString;
+    m_sBuffer += "][";
+    appendPadded(m_sBuffer, Logger::severityToString(severity), 4);
+    m_sBuffer += "][";
+    appendPadded(m_sBuffer, category, 9);
+    m_sBuffer += "] : ";
+    m_sBuffer += sMsg;
+    m_sBuffer += "\n";
+}
+
+void StandardLogSink::flush()
+{
+    if (!m_sBuffer.empty()) {
+        cerr.write(m_sBuffer.c_str(), m_sBuffer.size());
+        cerr.flush();
+        m_sBuffer.clear();
+    }
 }
 
 }
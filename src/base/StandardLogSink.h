@@ -23,6 +23,8 @@
 
 #include "ILogSink.h"
 
+#include <string>
+
 namespace avg {
 
 class StandardLogSink: public ILogSink
@@ -33,6 +35,11 @@ public:
 
     virtual void logMessage(const tm* pTime, unsigned millis, const category_t& category,
             severity_t severity, const UTF8String& sMsg);
+    virtual void flush();
+
+private:
+    // Formatted messages are collected here and written to cerr in flush().
+    std::string m_sBuffer;
 };
 
 }
@@ -25,6 +25,7 @@
 #include "Exception.h"
 #include "ProfilingZone.h"
 #include "ScopeTimer.h"
+#include "TimeSource.h"
 
 #include <sstream>
 #include <iomanip>
@@ -58,7 +59,7 @@ ThreadProfiler::ThreadProfiler()
 {
     m_bRunning = false;
     ScopeTimer::enableTimers(Logger::get()->shouldLog(m_LogCategory,
-            Logger::severity::INFO));
+            Logger::severity::INFO) || TraceRecorder::isRecording());
 }
 
 ThreadProfiler::~ThreadProfiler() 
@@ -86,25 +87,37 @@ void ThreadProfiler::restart()
 void ThreadProfiler::startZone(const ProfilingZoneID& zoneID)
 {
     auto it = m_ZoneMap.find(&zoneID);
-    // Duplicated code to avoid instantiating a new smart pointer when it's not
-    // necessary.
+    ProfilingZone* pZone;
     if (it == m_ZoneMap.end()) {
-        ProfilingZonePtr pZone = addZone(zoneID);
-        pZone->start();
-        m_ActiveZones.push_back(pZone);
+        pZone = addZone(zoneID);
     } else {
-        ProfilingZonePtr& pZone = it->second;
-        pZone->start();
-        m_ActiveZones.push_back(pZone);
+        pZone = it->second.get();
+    }
+    long long now = TimeSource::get()->getCurrentNanosecs();
+    pZone->start(now);
+    m_ActiveZones.push_back(pZone);
+    if (TraceRecorder::isRecording()) {
+        addTraceEvent(now, TraceEvent::BEGIN, zoneID);
     }
 }
 
 void ThreadProfiler::stopZone(const ProfilingZoneID& zoneID)
 {
-    auto it = m_ZoneMap.find(&zoneID);
-    ProfilingZonePtr& pZone = it->second;
-    pZone->stop();
+    // ScopeTimers are strictly nested, so the zone to stop is the innermost one.
+    long long now = TimeSource::get()->getCurrentNanosecs();
+    ProfilingZone* pZone = m_ActiveZones.back();
+    pZone->stop(now);
     m_ActiveZones.pop_back();
+    if (TraceRecorder::isRecording()) {
+        addTraceEvent(now, TraceEvent::END, zoneID);
+    }
+}
+
+void ThreadProfiler::addToZoneCounter(const ProfilingZoneID& zoneID, long long value)
+{
+    auto it = m_ZoneMap.find(&zoneID);
+    AVG_ASSERT(it != m_ZoneMap.end());
+    it->second->addToCounter(value);
 }
 
 void ThreadProfiler::dumpStatistics()
@@ -112,15 +125,23 @@ void ThreadProfiler::dumpStatistics()
     if (!m_Zones.empty()) {
         AVG_TRACE(m_LogCategory, Logger::severity::INFO, "Thread " << m_sName);
         AVG_TRACE(m_LogCategory, Logger::severity::INFO,
-                "Zone name                          Avg. time");
+                "Zone name                          Avg. time   Avg. count");
         AVG_TRACE(m_LogCategory, Logger::severity::INFO,
-                "---------                          ---------");
+                "---------                          ---------   ----------");
 
         for (auto it = m_Zones.begin(); it != m_Zones.end(); ++it) {
-            AVG_TRACE(m_LogCategory, Logger::severity::INFO,
-                    std::setw(35) << std::left 
-                    << ((*it)->getIndentString()+(*it)->getName())
-                    << std::setw(9) << std::right << (*it)->getAvgUSecs());
+            if ((*it)->hasCounter()) {
+                AVG_TRACE(m_LogCategory, Logger::severity::INFO,
+                        std::setw(35) << std::left 
+                        << ((*it)->getIndentString()+(*it)->getName())
+                        << std::setw(9) << std::right << (*it)->getAvgUSecs()
+                        << std::setw(13) << std::right << (*it)->getAvgCounter());
+            } else {
+                AVG_TRACE(m_LogCategory, Logger::severity::INFO,
+                        std::setw(35) << std::left 
+                        << ((*it)->getIndentString()+(*it)->getName())
+                        << std::setw(9) << std::right << (*it)->getAvgUSecs());
+            }
         }
         AVG_TRACE(m_LogCategory, Logger::severity::INFO, "");
     }
@@ -146,10 +167,32 @@ const std::string& ThreadProfiler::getName() const
 void ThreadProfiler::setName(const std::string& sName)
 {
     m_sName = sName;
+    if (m_pTraceBuffer) {
+        m_pTraceBuffer->setThreadName(sName);
+    }
 }
 
+void ThreadProfiler::preallocate(const ProfilingZoneID& zoneID)
+{
+    if (m_ZoneMap.find(&zoneID) == m_ZoneMap.end()) {
+        addZone(zoneID);
+    }
+    m_ActiveZones.reserve(m_Zones.size());
+    if (!m_pTraceBuffer) {
+        m_pTraceBuffer = TraceRecorder::get()->createBuffer(m_sName);
+    }
+}
+
+void ThreadProfiler::addTraceEvent(long long time, TraceEvent::Type type,
+        const ProfilingZoneID& zoneID)
+{
+    if (!m_pTraceBuffer) {
+        m_pTraceBuffer = TraceRecorder::get()->createBuffer(m_sName);
+    }
+    m_pTraceBuffer->addEvent(time, type, &zoneID);
+}
 
-ProfilingZonePtr ThreadProfiler::addZone(const ProfilingZoneID& zoneID)
+ProfilingZone* ThreadProfiler::addZone(const ProfilingZoneID& zoneID)
 {
     ProfilingZonePtr pZone(new ProfilingZone(zoneID));
     m_ZoneMap[&zoneID] = pZone;
@@ -158,11 +201,11 @@ ProfilingZonePtr ThreadProfiler::addZone(const ProfilingZoneID& zoneID)
     if (m_ActiveZones.empty()) {
         it = m_Zones.end();
     } else {
-        ProfilingZonePtr pActiveZone = m_ActiveZones.back();
+        ProfilingZone* pActiveZone = m_ActiveZones.back();
         bool bParentFound = false;
         for (it = m_Zones.begin(); it != m_Zones.end(); ++it) 
         {
-            if (pActiveZone == *it) {
+            if (pActiveZone == it->get()) {
                 bParentFound = true;
                 break;
             }
@@ -174,7 +217,7 @@ ProfilingZonePtr ThreadProfiler::addZone(const ProfilingZoneID& zoneID)
     }
     m_Zones.insert(it, pZone);
     pZone->setIndentLevel(parentIndent+2);
-    return pZone;
+    return pZone.get();
 }
 
 }
@@ -24,6 +24,7 @@
 
 #include "../api.h"
 #include "ILogSink.h"
+#include "TraceRecorder.h"
 
 #include <boost/thread.hpp>
 #include <boost/shared_ptr.hpp>
@@ -57,6 +58,7 @@ public:
     void restart();
     void startZone(const ProfilingZoneID& zoneID);
     void stopZone(const ProfilingZoneID& zoneID);
+    void addToZoneCounter(const ProfilingZoneID& zoneID, long long value);
     void dumpStatistics();
     void reset();
     int getNumZones();
@@ -64,8 +66,14 @@ public:
     const std::string& getName() const;
     void setName(const std::string& sName);
 
+    // Creates the zone and the trace buffer in advance, so profiling the zone doesn't
+    // allocate memory or take locks later. For threads that mustn't block.
+    void preallocate(const ProfilingZoneID& zoneID);
+
 private:
-    ProfilingZonePtr addZone(const ProfilingZoneID& zoneID);
+    ProfilingZone* addZone(const ProfilingZoneID& zoneID);
+    void addTraceEvent(long long time, TraceEvent::Type type, 
+            const ProfilingZoneID& zoneID);
     std::string m_sName;
 
 #if defined(_WIN32) || defined(_LIBCPP_VERSION)
@@ -75,8 +83,9 @@ private:
 #endif
     typedef std::vector<ProfilingZonePtr> ZoneVector;
     ZoneMap m_ZoneMap;
-    ZoneVector m_ActiveZones;
+    std::vector<ProfilingZone*> m_ActiveZones;
     ZoneVector m_Zones;
+    TraceBufferPtr m_pTraceBuffer;
     bool m_bRunning;
     category_t m_LogCategory;
 
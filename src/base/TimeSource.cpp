@@ -68,6 +68,11 @@ TimeSource::TimeSource()
 #ifdef __APPLE__
     mach_timebase_info(&m_TimebaseInfo);
 #endif
+#ifdef _WIN32
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    m_PerfCounterFreq = freq.QuadPart;
+#endif
 }
 
 TimeSource::~TimeSource()
@@ -96,6 +101,27 @@ long long TimeSource::getCurrentMicrosecs()
 #endif
 }
 
+long long TimeSource::getCurrentNanosecs()
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    long long secs = counter.QuadPart/m_PerfCounterFreq;
+    long long rest = counter.QuadPart%m_PerfCounterFreq;
+    return secs*1000000000+rest*1000000000/m_PerfCounterFreq;
+#else
+#ifdef __APPLE__
+    long long systemTime = mach_absolute_time();
+    return systemTime * m_TimebaseInfo.numer/m_TimebaseInfo.denom;
+#else
+    struct timespec now;
+    int rc = clock_gettime(CLOCK_MONOTONIC, &now);
+    assert(rc == 0);
+    return ((long long)now.tv_sec)*1000000000+now.tv_nsec;
+#endif
+#endif
+}
+
 void TimeSource::sleepUntil(long long targetTime)
 {
     long long now = getCurrentMillisecs();
@@ -41,6 +41,8 @@ public:
    
     long long getCurrentMillisecs();
     long long getCurrentMicrosecs();
+    // Monotonic clock with the best resolution available. Used for profiling.
+    long long getCurrentNanosecs();
     
     void sleepUntil(long long targetTime);
 
@@ -49,6 +51,9 @@ private:
 #ifdef __APPLE__
     mach_timebase_info_data_t m_TimebaseInfo;
 #endif
+#ifdef _WIN32
+    long long m_PerfCounterFreq;
+#endif
     
     static TimeSource* m_pTimeSource;
 };
@@ -0,0 +1,257 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "TraceRecorder.h"
+
+#include "Exception.h"
+#include "Logger.h"
+#include "ProfilingZoneID.h"
+#include "ScopeTimer.h"
+#include "StringHelper.h"
+#include "ThreadHelper.h"
+#include "TimeSource.h"
+
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+namespace avg {
+
+// 24 bytes per event, so this is < 1 MB per thread.
+static const int EVENTS_PER_THREAD = 32768;
+
+TraceBuffer::TraceBuffer(int threadIndex, int capacity)
+    : m_ThreadIndex(threadIndex),
+      m_WritePos(0)
+{
+    size_t size = 1;
+    while (size < size_t(capacity)) {
+        size *= 2;
+    }
+    m_Events.resize(size);
+    m_Mask = size-1;
+}
+
+TraceBuffer::~TraceBuffer()
+{
+}
+
+void TraceBuffer::getEvents(long long startTime, long long endTime,
+        vector<TraceEvent>& events) const
+{
+    size_t endPos = m_WritePos.load(std::memory_order_acquire);
+    size_t startPos = 0;
+    if (endPos > m_Events.size()) {
+        startPos = endPos-m_Events.size();
+    }
+    vector<TraceEvent> tempEvents;
+    tempEvents.reserve(endPos-startPos);
+    for (size_t pos = startPos; pos < endPos; ++pos) {
+        tempEvents.push_back(m_Events[pos & m_Mask]);
+    }
+    // The owning thread may have overwritten old events while we were copying.
+    size_t newEndPos = m_WritePos.load(std::memory_order_acquire);
+    size_t numOverwritten = 0;
+    if (newEndPos-startPos > m_Events.size()) {
+        numOverwritten = min(newEndPos-startPos-m_Events.size(), tempEvents.size());
+    }
+    for (size_t i = numOverwritten; i < tempEvents.size(); ++i) {
+        const TraceEvent& event = tempEvents[i];
+        if (event.m_Time >= startTime && event.m_Time < endTime) {
+            events.push_back(event);
+        }
+    }
+}
+
+int TraceBuffer::getThreadIndex() const
+{
+    return m_ThreadIndex;
+}
+
+string TraceBuffer::getThreadName() const
+{
+    lock_guard lock(m_NameMutex);
+    return m_sThreadName;
+}
+
+void TraceBuffer::setThreadName(const string& sName)
+{
+    lock_guard lock(m_NameMutex);
+    m_sThreadName = sName;
+}
+
+
+std::atomic<bool> TraceRecorder::s_bRecording(false);
+
+TraceRecorder* TraceRecorder::get()
+{
+    static boost::mutex s_Mutex;
+    static TraceRecorder* s_pTraceRecorder = 0;
+    lock_guard lock(s_Mutex);
+    if (!s_pTraceRecorder) {
+        s_pTraceRecorder = new TraceRecorder;
+    }
+    return s_pTraceRecorder;
+}
+
+TraceRecorder::TraceRecorder()
+    : m_NumThreads(0),
+      m_StartTime(0),
+      m_StopTime(0)
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+}
+
+void TraceRecorder::start()
+{
+    lock_guard lock(m_Mutex);
+    // Forget threads that have ended since the last recording.
+    vector<TraceBufferPtr>::iterator it = m_pBuffers.begin();
+    while (it != m_pBuffers.end()) {
+        if (it->use_count() == 1) {
+            it = m_pBuffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_StartTime = TimeSource::get()->getCurrentNanosecs();
+    m_StopTime = 0;
+    s_bRecording = true;
+    ScopeTimer::enableTimers(true);
+}
+
+void TraceRecorder::stop()
+{
+    lock_guard lock(m_Mutex);
+    if (s_bRecording) {
+        s_bRecording = false;
+        m_StopTime = TimeSource::get()->getCurrentNanosecs();
+        ScopeTimer::enableTimers(Logger::get()->shouldLog(Logger::category::PROFILE,
+                Logger::severity::INFO));
+    }
+}
+
+TraceBufferPtr TraceRecorder::createBuffer(const string& sThreadName)
+{
+    lock_guard lock(m_Mutex);
+    TraceBufferPtr pBuffer(new TraceBuffer(m_NumThreads, EVENTS_PER_THREAD));
+    m_NumThreads++;
+    pBuffer->setThreadName(sThreadName);
+    m_pBuffers.push_back(pBuffer);
+    return pBuffer;
+}
+
+static void writeJSONString(ostream& os, const string& s)
+{
+    os << '"';
+    for (unsigned i = 0; i < s.size(); ++i) {
+        unsigned char c = s[i];
+        if (c == '"' || c == '\\') {
+            os << '\\' << c;
+        } else if (c < 0x20) {
+            os << "\\u" << hex << setw(4) << setfill('0') << int(c) << dec;
+        } else {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+void TraceRecorder::save(const string& sFilename) const
+{
+    lock_guard lock(m_Mutex);
+    if (m_StartTime == 0) {
+        throw Exception(AVG_ERR_UNSUPPORTED, 
+                "Can't save trace: Tracing has never been started.");
+    }
+    ofstream os(sFilename.c_str(), ios::out | ios::trunc);
+    if (!os) {
+        throw Exception(AVG_ERR_FILEIO, "Can't write trace file '"+sFilename+"'.");
+    }
+    long long endTime = m_StopTime;
+    if (s_bRecording) {
+        endTime = TimeSource::get()->getCurrentNanosecs();
+    }
+    // Chrome trace event format. Timestamps are microseconds since start().
+    os << fixed << setprecision(3);
+    os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool bFirstEvent = true;
+    for (unsigned i = 0; i < m_pBuffers.size(); ++i) {
+        writeThreadEvents(os, *m_pBuffers[i], endTime, bFirstEvent);
+    }
+    os << "\n]}\n";
+    if (!os) {
+        throw Exception(AVG_ERR_FILEIO, "Can't write trace file '"+sFilename+"'.");
+    }
+}
+
+void TraceRecorder::writeThreadEvents(ostream& os, const TraceBuffer& buffer, 
+        long long endTime, bool& bFirstEvent) const
+{
+    vector<TraceEvent> events;
+    buffer.getEvents(m_StartTime, endTime, events);
+    int tid = buffer.getThreadIndex();
+    string sName = buffer.getThreadName();
+    if (sName.empty()) {
+        sName = "thread "+toString(tid);
+    }
+    os << (bFirstEvent ? "\n" : ",\n");
+    bFirstEvent = false;
+    os << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << tid
+            << ", \"args\": {\"name\": ";
+    writeJSONString(os, sName);
+    os << "}}";
+
+    // Matched begin and end events become complete ("X") events. Ends without a
+    // begin started before the recorded range and are dropped; zones still open at 
+    // the end are written as begin events.
+    vector<const TraceEvent*> pOpenEvents;
+    for (unsigned i = 0; i < events.size(); ++i) {
+        const TraceEvent& event = events[i];
+        if (event.m_Type == TraceEvent::BEGIN) {
+            pOpenEvents.push_back(&event);
+        } else if (!pOpenEvents.empty() && 
+                pOpenEvents.back()->m_pZoneID == event.m_pZoneID)
+        {
+            const TraceEvent& beginEvent = *pOpenEvents.back();
+            pOpenEvents.pop_back();
+            os << ",\n{\"name\": ";
+            writeJSONString(os, beginEvent.m_pZoneID->getName());
+            os << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << tid 
+                    << ", \"ts\": " << (beginEvent.m_Time-m_StartTime)/1000. 
+                    << ", \"dur\": " << (event.m_Time-beginEvent.m_Time)/1000. << "}";
+        }
+    }
+    for (unsigned i = 0; i < pOpenEvents.size(); ++i) {
+        const TraceEvent& event = *pOpenEvents[i];
+        os << ",\n{\"name\": ";
+        writeJSONString(os, event.m_pZoneID->getName());
+        os << ", \"ph\": \"B\", \"pid\": 1, \"tid\": " << tid 
+                << ", \"ts\": " << (event.m_Time-m_StartTime)/1000. << "}";
+    }
+}
+
+}
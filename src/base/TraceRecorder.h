@@ -0,0 +1,121 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _TraceRecorder_H_ 
+#define _TraceRecorder_H_
+
+#include "../api.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace avg {
+
+class ProfilingZoneID;
+
+struct TraceEvent
+{
+    enum Type {BEGIN, END};
+
+    long long m_Time;
+    const ProfilingZoneID* m_pZoneID;
+    Type m_Type;
+};
+
+// Ring buffer of profiling zone events for one thread. Only the owning thread writes;
+// once the ring is full, the oldest events are overwritten.
+class AVG_API TraceBuffer
+{
+public:
+    TraceBuffer(int threadIndex, int capacity);
+    virtual ~TraceBuffer();
+
+    void addEvent(long long time, TraceEvent::Type type, const ProfilingZoneID* pZoneID)
+    {
+        size_t pos = m_WritePos.load(std::memory_order_relaxed);
+        TraceEvent& event = m_Events[pos & m_Mask];
+        event.m_Time = time;
+        event.m_pZoneID = pZoneID;
+        event.m_Type = type;
+        m_WritePos.store(pos+1, std::memory_order_release);
+    };
+
+    // Copies the events recorded in [startTime, endTime) in chronological order.
+    // Can be called from any thread.
+    void getEvents(long long startTime, long long endTime, 
+            std::vector<TraceEvent>& events) const;
+
+    int getThreadIndex() const;
+    std::string getThreadName() const;
+    void setThreadName(const std::string& sName);
+
+private:
+    int m_ThreadIndex;
+    std::vector<TraceEvent> m_Events;
+    size_t m_Mask;
+    std::atomic<size_t> m_WritePos;
+
+    mutable boost::mutex m_NameMutex;
+    std::string m_sThreadName;
+};
+
+typedef boost::shared_ptr<TraceBuffer> TraceBufferPtr;
+
+// Collects timestamped zone begin and end events from all threads that use
+// ScopeTimers and writes them as a trace file for chrome://tracing or Perfetto.
+class AVG_API TraceRecorder
+{
+public:
+    static TraceRecorder* get();
+    virtual ~TraceRecorder();
+
+    void start();
+    void stop();
+    static bool isRecording()
+    {
+        return s_bRecording.load(std::memory_order_relaxed);
+    };
+    void save(const std::string& sFilename) const;
+
+    TraceBufferPtr createBuffer(const std::string& sThreadName);
+
+private:
+    TraceRecorder();
+    void writeThreadEvents(std::ostream& os, const TraceBuffer& buffer, 
+            long long endTime, bool& bFirstEvent) const;
+
+    std::vector<TraceBufferPtr> m_pBuffers;
+    int m_NumThreads;
+    long long m_StartTime;
+    long long m_StopTime;
+    mutable boost::mutex m_Mutex;
+
+    static std::atomic<bool> s_bRecording;
+};
+
+}
+
+#endif
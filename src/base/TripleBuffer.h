@@ -0,0 +1,110 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _TripleBuffer_H_
+#define _TripleBuffer_H_
+
+#include "../api.h"
+
+#include <atomic>
+
+namespace avg {
+
+// Mailbox that passes the latest of a stream of values from one writer thread to one
+// reader thread without locks. Writer and reader each own one slot; the third slot
+// holds the value that was written last and is exchanged atomically. Values that are
+// overwritten before the reader gets to them are dropped.
+//
+// Slots are reset to T() as soon as their value has been passed on or dropped, so the
+// buffer never keeps stale values (e.g. bitmaps) alive.
+template<class T>
+class AVG_TEMPLATE_API TripleBuffer
+{
+public:
+    TripleBuffer();
+
+    // Returns false if the previous value was dropped without being read.
+    bool write(const T& value);
+    bool read(T& value);
+    bool hasNewValue() const;
+    void clear();
+
+private:
+    TripleBuffer(const TripleBuffer&);
+    TripleBuffer& operator=(const TripleBuffer&);
+
+    static const int SLOT_MASK = 3;
+    static const int NEW_VALUE = 4;
+
+    T m_Slots[3];
+    int m_WriteSlot;
+    std::atomic<int> m_State;
+    int m_ReadSlot;
+};
+
+template<class T>
+TripleBuffer<T>::TripleBuffer()
+    : m_WriteSlot(0),
+      m_State(1),
+      m_ReadSlot(2)
+{
+}
+
+template<class T>
+bool TripleBuffer<T>::write(const T& value)
+{
+    m_Slots[m_WriteSlot] = value;
+    int oldState = m_State.exchange(m_WriteSlot | NEW_VALUE, std::memory_order_acq_rel);
+    m_WriteSlot = oldState & SLOT_MASK;
+    m_Slots[m_WriteSlot] = T();
+    return (oldState & NEW_VALUE) == 0;
+}
+
+template<class T>
+bool TripleBuffer<T>::read(T& value)
+{
+    if (!hasNewValue()) {
+        return false;
+    }
+    int oldState = m_State.exchange(m_ReadSlot, std::memory_order_acq_rel);
+    m_ReadSlot = oldState & SLOT_MASK;
+    value = m_Slots[m_ReadSlot];
+    m_Slots[m_ReadSlot] = T();
+    return true;
+}
+
+template<class T>
+bool TripleBuffer<T>::hasNewValue() const
+{
+    return (m_State.load(std::memory_order_acquire) & NEW_VALUE) != 0;
+}
+
+template<class T>
+void TripleBuffer<T>::clear()
+{
+    // Must be called by the reader while the writer is inactive.
+    T value;
+    read(value);
+}
+
+}
+#endif
+
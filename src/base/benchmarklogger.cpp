@@ -0,0 +1,145 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "Logger.h"
+#include "TimeSource.h"
+#include "StringHelper.h"
+
+#include <boost/thread/thread.hpp>
+
+#include <iostream>
+
+using namespace avg;
+using namespace std;
+
+// Cost of AVG_TRACE calls as seen by the logging thread.
+
+static const category_t BENCH_CAT("BENCHMARK");
+
+class NullLogSink: public ILogSink
+{
+public:
+    virtual void logMessage(const tm* pTime, unsigned millis, const category_t& category,
+            severity_t severity, const UTF8String& sMsg)
+    {
+    }
+};
+
+template<class TEST>
+void runPerformanceTest(int numRuns=1000000)
+{
+    TEST PerfTest;
+    long long StartTime = TimeSource::get()->getCurrentMicrosecs();
+    for (int i = 0; i < numRuns; ++i) {
+        PerfTest.run(i);
+    }
+    float ActiveTime = float(TimeSource::get()->getCurrentMicrosecs()-StartTime); 
+    Logger::get()->flush();
+    cerr << PerfTest.getName() << ": " << ActiveTime*1000/numRuns << " ns" << endl;
+}
+
+class PerfTestBase {
+public:
+    PerfTestBase(string sName) 
+        : m_sName(sName)
+    {
+    }
+
+    std::string getName()
+    {
+        return m_sName;
+    }
+
+private:
+    std::string m_sName;
+};
+
+class DisabledTracePerfTest: public PerfTestBase {
+public:
+    DisabledTracePerfTest()
+        : PerfTestBase("DisabledTracePerfTest")
+    {
+    }
+
+    void run(int i)
+    {
+        AVG_TRACE(BENCH_CAT, Logger::severity::DEBUG, "Message " << i);
+    }
+};
+
+class EnabledTracePerfTest: public PerfTestBase {
+public:
+    EnabledTracePerfTest()
+        : PerfTestBase("EnabledTracePerfTest")
+    {
+    }
+
+    void run(int i)
+    {
+        AVG_TRACE(BENCH_CAT, Logger::severity::WARNING, "Message " << i);
+    }
+};
+
+// NUM_THREADS threads log concurrently; the time is per message and thread.
+template<int NUM_THREADS>
+class ThreadedTracePerfTest: public PerfTestBase {
+public:
+    ThreadedTracePerfTest()
+        : PerfTestBase("ThreadedTracePerfTest ("+toString(NUM_THREADS)+" threads)")
+    {
+    }
+
+    void run(int i)
+    {
+        if (i == 0) {
+            boost::thread_group threads;
+            for (int j = 0; j < NUM_THREADS; ++j) {
+                threads.create_thread(&ThreadedTracePerfTest::logMessages);
+            }
+            threads.join_all();
+        }
+    }
+
+private:
+    static void logMessages()
+    {
+        for (int i = 0; i < 100000; ++i) {
+            AVG_TRACE(BENCH_CAT, Logger::severity::WARNING, "Message " << i);
+        }
+    }
+};
+
+void runPerformanceTests()
+{
+    runPerformanceTest<DisabledTracePerfTest>(10000000);
+    runPerformanceTest<EnabledTracePerfTest>();
+    runPerformanceTest<ThreadedTracePerfTest<4> >(100000);
+}
+
+int main(int nargs, char** args)
+{
+    Logger* pLogger = Logger::get();
+    pLogger->configureCategory(BENCH_CAT, Logger::severity::WARNING);
+    pLogger->removeStdLogSink();
+    pLogger->addLogSink(LogSinkPtr(new NullLogSink));
+    runPerformanceTests();
+}
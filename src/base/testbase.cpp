@@ -21,6 +21,8 @@
 
 #include "DAG.h"
 #include "Queue.h"
+#include "LockFreeQueue.h"
+#include "TripleBuffer.h"
 #include "Command.h"
 #include "WorkerThread.h"
 #include "ObjectCounter.h"
@@ -32,16 +34,20 @@
 #include "StringHelper.h"
 #include "MathHelper.h"
 #include "CubicSpline.h"
+#include "OneEuroFilter.h"
 #include "BezierCurve.h"
 #include "Signal.h"
 #include "Backtrace.h"
 #include "WideLine.h"
 #include "Rect.h"
 #include "Triangle.h"
+#include "SpatialGrid.h"
 #include "TestSuite.h"
 #include "TimeSource.h"
 #include "XMLHelper.h"
 #include "Logger.h"
+#include "ScopeTimer.h"
+#include "TraceRecorder.h"
 
 #include <boost/thread/thread.hpp>
 
@@ -189,6 +195,18 @@ private:
         TEST(q.empty());
         ElemPtr pElem = q.pop(false);
         TEST(!pElem);
+
+        // Non-blocking pushes can exceed the maximum size of a bounded queue.
+        Queue<string> boundedQ(2);
+        boundedQ.push(ElemPtr(new string("1")));
+        boundedQ.push(ElemPtr(new string("2")));
+        boundedQ.push(ElemPtr(new string("3")), false);
+        TEST(boundedQ.size() == 3);
+        TEST(*boundedQ.pop() == "1");
+        TEST(*boundedQ.pop() == "2");
+        boundedQ.push(ElemPtr(new string("4")));
+        TEST(*boundedQ.pop() == "3");
+        TEST(*boundedQ.pop() == "4");
     }
 
     void runMultiThreadTests()
@@ -260,6 +278,253 @@ private:
     }
 };
 
+class LockFreeQueueTest: public Test
+{
+public:
+    LockFreeQueueTest()
+        : Test("LockFreeQueueTest", 2)
+    {
+    }
+
+    void runTests() 
+    {
+        runSingleThreadTests();
+        runMultiThreadTests();
+        runPerfTest();
+    }
+
+private:
+    typedef LockFreeQueue<int>::QElementPtr ElemPtr;
+    
+    void runSingleThreadTests()
+    {
+        LockFreeQueue<string> q(3);
+        typedef LockFreeQueue<string>::QElementPtr ElemPtr;
+        TEST(q.empty());
+        TEST(q.getMaxSize() == 3);
+        q.push(ElemPtr(new string("1")));
+        TEST(q.size() == 1);
+        TEST(!q.empty());
+        q.push(ElemPtr(new string("2")));
+        q.push(ElemPtr(new string("3")));
+        TEST(q.size() == 3);
+        TEST(!q.tryPush(ElemPtr(new string("x"))));
+        TEST(*q.pop() == "1");
+        TEST(*q.pop() == "2");
+        q.push(ElemPtr(new string("4")));
+        TEST(*q.pop() == "3");
+        TEST(*q.peek() == "4");
+        TEST(*q.pop() == "4");
+        TEST(q.empty());
+        ElemPtr pElem = q.pop(false);
+        TEST(!pElem);
+        pElem = q.peek(false);
+        TEST(!pElem);
+        for (int i=0; i<10; ++i) {
+            TEST(q.tryPush(ElemPtr(new string("5"))));
+            TEST(*q.pop() == "5");
+        }
+    }
+
+    void runMultiThreadTests()
+    {
+        {
+            LockFreeQueue<int> q(10);
+            bool bOk;
+            thread pusher(boost::bind(&pushThread, &q, 1000));
+            thread popper(boost::bind(&popThread, &q, 1000, &bOk));
+            pusher.join();
+            popper.join();
+            TEST(bOk);
+            TEST(q.empty());
+        }
+        {
+            // Producer clears the queue from time to time, like the demuxer on seek.
+            LockFreeQueue<int> q(10);
+            bool bOk;
+            thread pusher(boost::bind(&pushClearThread, &q, 1000));
+            thread popper(boost::bind(&popClearThread, &q, &bOk));
+            pusher.join();
+            popper.join();
+            TEST(bOk);
+            TEST(q.empty());
+        }
+    }
+
+    void runPerfTest()
+    {
+        const int numElems = 100000;
+        long long startTime = TimeSource::get()->getCurrentMicrosecs();
+        {
+            Queue<int> q(50);
+            thread pusher(boost::bind(&pushPerfThread<Queue<int> >, &q, numElems));
+            thread popper(boost::bind(&popPerfThread<Queue<int> >, &q, numElems));
+            pusher.join();
+            popper.join();
+        }
+        long long lockedTime = TimeSource::get()->getCurrentMicrosecs()-startTime;
+        startTime = TimeSource::get()->getCurrentMicrosecs();
+        {
+            LockFreeQueue<int> q(50);
+            thread pusher(boost::bind(&pushPerfThread<LockFreeQueue<int> >, &q, 
+                    numElems));
+            thread popper(boost::bind(&popPerfThread<LockFreeQueue<int> >, &q, 
+                    numElems));
+            pusher.join();
+            popper.join();
+        }
+        long long lockFreeTime = TimeSource::get()->getCurrentMicrosecs()-startTime;
+        cerr << "    " << numElems << " elements: Queue: " << lockedTime/1000 
+                << " ms, LockFreeQueue: " << lockFreeTime/1000 << " ms" << endl;
+    }
+
+    static void pushThread(LockFreeQueue<int>* pq, int numPushes)
+    {
+        for (int i=0; i<numPushes; ++i) {
+            pq->push(ElemPtr(new int(i)));
+            if (i%100 == 0) {
+                msleep(1);
+            }
+        }
+    }
+
+    static void popThread(LockFreeQueue<int>* pq, int numPops, bool* pbOk)
+    {
+        *pbOk = true;
+        for (int i=0; i<numPops; ++i) {
+            pq->peek();
+            ElemPtr pElem = pq->pop();
+            if (*pElem != i) {
+                *pbOk = false;
+            }
+            if (i%70 == 0) {
+                msleep(3);
+            }
+        }
+    }
+
+    static void pushClearThread(LockFreeQueue<int>* pq, int numPushes)
+    {
+        for (int i=0; i<numPushes; ++i) {
+            pq->push(ElemPtr(new int(i)));
+            if (i%7 == 0) {
+                pq->clear();
+            }
+        }
+        pq->push(ElemPtr(new int(-1)));
+    }
+
+    static void popClearThread(LockFreeQueue<int>* pq, bool* pbOk)
+    {
+        *pbOk = true;
+        ElemPtr pElem;
+        int lastElem = -1;
+        do {
+            pElem = pq->pop();
+            if (*pElem != -1) {
+                // Elements can get lost in clear(), but never reordered.
+                if (*pElem <= lastElem) {
+                    *pbOk = false;
+                }
+                lastElem = *pElem;
+            }
+        } while (*pElem != -1);
+    }
+
+    template<class QUEUE>
+    static void pushPerfThread(QUEUE* pq, int numPushes)
+    {
+        typename QUEUE::QElementPtr pElem(new int(0));
+        for (int i=0; i<numPushes; ++i) {
+            pq->push(pElem);
+        }
+    }
+
+    template<class QUEUE>
+    static void popPerfThread(QUEUE* pq, int numPops)
+    {
+        for (int i=0; i<numPops; ++i) {
+            pq->pop();
+        }
+    }
+};
+
+class TripleBufferTest: public Test
+{
+public:
+    TripleBufferTest()
+        : Test("TripleBufferTest", 2)
+    {
+    }
+
+    void runTests() 
+    {
+        {
+            TripleBuffer<int> buffer;
+            int value = -1;
+            TEST(!buffer.hasNewValue());
+            TEST(!buffer.read(value));
+            TEST(buffer.write(1));
+            TEST(buffer.hasNewValue());
+            TEST(buffer.read(value) && value == 1);
+            TEST(!buffer.read(value));
+            TEST(buffer.write(2));
+            TEST(!buffer.write(3));
+            TEST(buffer.read(value) && value == 3);
+            TEST(buffer.write(4));
+            buffer.clear();
+            TEST(!buffer.hasNewValue());
+        }
+        {
+            // Stale values aren't kept alive.
+            typedef boost::shared_ptr<int> IntPtr;
+            TripleBuffer<IntPtr> buffer;
+            IntPtr pInt(new int(1));
+            buffer.write(pInt);
+            buffer.write(IntPtr(new int(2)));
+            TEST(pInt.unique());
+            IntPtr pValue;
+            buffer.read(pValue);
+            TEST(*pValue == 2 && pValue.unique());
+        }
+        {
+            TripleBuffer<int> buffer;
+            bool bOk;
+            thread writer(boost::bind(&writeThread, &buffer, 10000));
+            thread reader(boost::bind(&readThread, &buffer, 10000, &bOk));
+            writer.join();
+            reader.join();
+            TEST(bOk);
+        }
+    }
+
+private:
+    static void writeThread(TripleBuffer<int>* pBuffer, int numValues)
+    {
+        for (int i=1; i<=numValues; ++i) {
+            pBuffer->write(i);
+        }
+    }
+
+    static void readThread(TripleBuffer<int>* pBuffer, int lastValue, bool* pbOk)
+    {
+        // Values can be dropped, but they never arrive out of order.
+        *pbOk = true;
+        int value = 0;
+        int prevValue = 0;
+        while (value != lastValue) {
+            if (pBuffer->read(value)) {
+                if (value <= prevValue) {
+                    *pbOk = false;
+                }
+                prevValue = value;
+            } else {
+                boost::this_thread::yield();
+            }
+        }
+    }
+};
+
 class TestWorkerThread: public WorkerThread<TestWorkerThread>
 {
 public:
@@ -518,6 +783,69 @@ public:
 };
 
 
+class SpatialGridTest: public Test
+{
+public:
+    SpatialGridTest()
+        : Test("SpatialGridTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        SpatialGrid grid;
+        vector<int> ids;
+        grid.getCandidates(glm::vec2(0,0), ids);
+        TEST(ids.empty());
+
+        // 10x10 non-overlapping squares plus one large rectangle on top.
+        vector<FRect> bounds;
+        for (int y = 0; y < 10; ++y) {
+            for (int x = 0; x < 10; ++x) {
+                bounds.push_back(FRect(x*10.f, y*10.f, x*10.f+8, y*10.f+8));
+            }
+        }
+        bounds.push_back(FRect(0, 0, 25, 25));
+        grid.build(bounds);
+        TEST(grid.getNumEntries() == 101);
+        TEST(grid.getNumCells() > 1);
+
+        grid.getCandidates(glm::vec2(15, 15), ids);
+        TEST(ids.size() == 2 && ids[0] == 11 && ids[1] == 100);
+        grid.getCandidates(glm::vec2(95, 95), ids);
+        TEST(ids.size() == 1 && ids[0] == 99);
+        grid.getCandidates(glm::vec2(59, 59), ids);
+        TEST(ids.empty());
+        // Borders are inside.
+        grid.getCandidates(glm::vec2(98, 98), ids);
+        TEST(ids.size() == 1 && ids[0] == 99);
+        grid.getCandidates(glm::vec2(200, 200), ids);
+        TEST(ids.empty());
+
+        // Move an entry, including outside of the original grid extent.
+        grid.update(99, FRect(150, 150, 160, 160));
+        grid.getCandidates(glm::vec2(95, 95), ids);
+        TEST(ids.empty());
+        grid.getCandidates(glm::vec2(155, 155), ids);
+        TEST(ids.size() == 1 && ids[0] == 99);
+        grid.update(0, FRect(-20, -20, 50, 50));
+        grid.getCandidates(glm::vec2(45, 45), ids);
+        TEST(ids.size() == 2 && ids[0] == 0 && ids[1] == 44);
+        grid.getCandidates(glm::vec2(-10, -10), ids);
+        TEST(ids.size() == 1 && ids[0] == 0);
+        // Empty rectangles are never returned.
+        grid.update(0, FRect(0, 0, -1, -1));
+        grid.getCandidates(glm::vec2(-10, -10), ids);
+        TEST(ids.empty());
+
+        grid.clear();
+        TEST(grid.getNumEntries() == 0);
+        grid.getCandidates(glm::vec2(45, 45), ids);
+        TEST(ids.empty());
+    }
+};
+
+
 class FileTest: public Test
 {
 public:
@@ -653,6 +981,38 @@ public:
 };
 
 
+class OneEuroFilterTest: public Test
+{
+public:
+    OneEuroFilterTest()
+        : Test("OneEuroFilterTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        // Reference values are from libavg.filter.OneEuroFilter.
+        OneEuroFilter filter(1, 0.1f);
+        float xd[] = {10, 10, 12, 9, 30, 31, 30};
+        float expected[] = {10, 10, 10.3543f, 10.1591f, 21.1589f, 26.5208f, 28.2941f};
+        for (int i = 0; i < 7; ++i) {
+            float y = filter.apply(xd[i], 1000+i*16);
+            QUIET_TEST(almostEqual(y, expected[i], 0.001f));
+        }
+        // Repeated timestamps aren't filtered.
+        TEST(filter.apply(5, 1000+6*16) == 5);
+
+        bool bExceptionThrown = false;
+        try {
+            OneEuroFilter badFilter(0);
+        } catch (const Exception&) {
+            bExceptionThrown = true;
+        }
+        TEST(bExceptionThrown);
+    }
+};
+
+
 class BezierCurveTest: public Test
 {
 public:
@@ -918,6 +1278,101 @@ public:
 };
 
 
+static ProfilingZoneID OuterTestProfilingZone("Outer \"zone\"", true);
+static ProfilingZoneID InnerTestProfilingZone("Inner zone", true);
+
+class TraceRecorderTest: public Test
+{
+public:
+    TraceRecorderTest()
+        : Test("TraceRecorderTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        // Only the newest events survive when the ring buffer overflows.
+        TraceBuffer buffer(0, 4);
+        for (int i = 0; i < 10; ++i) {
+            buffer.addEvent(i, TraceEvent::BEGIN, &InnerTestProfilingZone);
+        }
+        vector<TraceEvent> events;
+        buffer.getEvents(0, 100, events);
+        TEST(events.size() == 4);
+        TEST(events[0].m_Time == 6 && events[3].m_Time == 9);
+        events.clear();
+        buffer.getEvents(7, 9, events);
+        TEST(events.size() == 2);
+
+        // A profiler set up in advance, as the audio callback uses it.
+        ThreadProfiler profiler;
+        profiler.setName("PreallocatedThread");
+        profiler.preallocate(InnerTestProfilingZone);
+        TEST(profiler.getNumZones() == 1);
+
+        TraceRecorder* pRecorder = TraceRecorder::get();
+        pRecorder->start();
+        TEST(TraceRecorder::isRecording());
+        boost::thread thread(&TraceRecorderTest::runThread);
+        thread.join();
+        boost::thread preallocatedThread(&TraceRecorderTest::runPreallocatedThread, 
+                &profiler);
+        preallocatedThread.join();
+        TEST(profiler.getNumZones() == 1);
+        {
+            ScopeTimer timer(OuterTestProfilingZone);
+            recordZones();
+        }
+        pRecorder->stop();
+        TEST(!TraceRecorder::isRecording());
+        {
+            // Not recorded.
+            ScopeTimer timer(InnerTestProfilingZone);
+        }
+
+        string sFilename = "testtrace.json";
+        pRecorder->save(sFilename);
+        string sTrace;
+        readWholeFile(sFilename, sTrace);
+        unlink(sFilename.c_str());
+        TEST(sTrace.find("\"traceEvents\"") != string::npos);
+        TEST(sTrace.find("\"name\": \"TraceThread\"") != string::npos);
+        TEST(sTrace.find("\"name\": \"PreallocatedThread\"") != string::npos);
+        TEST(sTrace.find("Outer \\\"zone\\\"") != string::npos);
+        TEST(countOccurrences(sTrace, "\"ph\": \"X\"") == 4);
+        TEST(countOccurrences(sTrace, "\"Inner zone\"") == 3);
+    }
+
+private:
+    static void runThread()
+    {
+        ThreadProfiler::get()->setName("TraceThread");
+        recordZones();
+    }
+
+    static void recordZones()
+    {
+        ScopeTimer timer(InnerTestProfilingZone);
+    }
+
+    static void runPreallocatedThread(ThreadProfiler* pProfiler)
+    {
+        ScopeTimer timer(InnerTestProfilingZone, pProfiler);
+    }
+
+    int countOccurrences(const string& s, const string& sPattern)
+    {
+        int count = 0;
+        string::size_type pos = s.find(sPattern);
+        while (pos != string::npos) {
+            count++;
+            pos = s.find(sPattern, pos+1);
+        }
+        return count;
+    }
+};
+
+
 class StandardLoggerTest: public Test
 {
 public:
@@ -935,12 +1390,14 @@ public:
             std::cerr.rdbuf(buffer.rdbuf());
                 string msg("Test log message");
                 AVG_TRACE(Logger::category::NONE, Logger::severity::WARNING, msg);
+                logger->flush();
             std::cerr.rdbuf(sbuf);
                 TEST(buffer.str().find(msg) != string::npos);
             buffer.str(string());
 
             std::cerr.rdbuf(buffer.rdbuf());
                 AVG_TRACE(Logger::category::NONE, Logger::severity::DEBUG, msg);
+                logger->flush();
             std::cerr.rdbuf(sbuf);
             std::cout << buffer.str();
                 TEST(buffer.str().find(msg) == string::npos);
@@ -951,6 +1408,7 @@ public:
                 category_t CUSTOM_CAT = logger->configureCategory("CUSTOM_CAT 1");
                 string msg("CUSTOM_CAT LOG");
                 AVG_TRACE(CUSTOM_CAT, Logger::severity::WARNING, msg);
+                logger->flush();
             std::cerr.rdbuf(sbuf);
                 TEST(buffer.str().find(msg) != string::npos);
             buffer.str(string());
@@ -961,6 +1419,7 @@ public:
                         Logger::severity::CRITICAL);
                 string msg_info("CUSTOM_CAT LOG INFO");
                 AVG_TRACE(CUSTOM_CAT, Logger::severity::WARNING, msg_info);
+                logger->flush();
             std::cerr.rdbuf(sbuf);
                 TEST(buffer.str().find(msg_info) == string::npos);
             buffer.str(string());
@@ -968,11 +1427,82 @@ public:
             std::cerr.rdbuf(buffer.rdbuf());
                 string msg_critical("CUSTOM_CAT LOG CRITICAL");
                 AVG_TRACE(CUSTOM_CAT, Logger::severity::CRITICAL, msg_critical);
+                logger->flush();
             std::cerr.rdbuf(sbuf);
                 TEST(buffer.str().find(msg_critical) != string::npos);
             buffer.str(string());
         }
+        {
+            // Messages from other threads end up in the same sinks.
+            std::cerr.rdbuf(buffer.rdbuf());
+                string msg("Thread log message");
+                boost::thread thread(boost::bind(&StandardLoggerTest::logFromThread,
+                        msg));
+                thread.join();
+                logger->flush();
+            std::cerr.rdbuf(sbuf);
+                TEST(buffer.str().find(msg) != string::npos);
+            buffer.str(string());
+        }
+        {
+            // A sink that logs more messages than fit into the ring while it's being
+            // called mustn't block the logger.
+            LogSinkPtr pSink(new BurstLogSink);
+            logger->addLogSink(pSink);
+            std::cerr.rdbuf(buffer.rdbuf());
+                AVG_TRACE(Logger::category::NONE, Logger::severity::WARNING, 
+                        "Start burst");
+                logger->flush();
+                logger->removeLogSink(pSink);
+                string msg("Log message after burst");
+                AVG_TRACE(Logger::category::NONE, Logger::severity::WARNING, msg);
+                logger->flush();
+            std::cerr.rdbuf(sbuf);
+                TEST(buffer.str().find(msg) != string::npos);
+            buffer.str(string());
+        }
+        {
+            // Superseded category maps are freed, so this doesn't accumulate memory.
+            category_t CUSTOM_CAT;
+            for (int i=0; i<1000; ++i) {
+                CUSTOM_CAT = logger->configureCategory("CUSTOM_CAT 2", 
+                        (i%2) ? Logger::severity::INFO : Logger::severity::ERROR);
+            }
+            TEST(logger->shouldLog(CUSTOM_CAT, Logger::severity::WARNING));
+            TEST(!logger->shouldLog(CUSTOM_CAT, Logger::severity::DEBUG));
+            TEST(logger->getCategories()[CUSTOM_CAT] == Logger::severity::INFO);
+        }
     }
+
+private:
+    static void logFromThread(const string& sMsg)
+    {
+        AVG_TRACE(Logger::category::NONE, Logger::severity::WARNING, sMsg);
+    }
+
+    class BurstLogSink: public ILogSink
+    {
+    public:
+        BurstLogSink()
+            : m_bBurstDone(false)
+        {
+        }
+
+        virtual void logMessage(const tm* pTime, unsigned millis, 
+                const category_t& category, severity_t severity, const UTF8String& sMsg)
+        {
+            if (!m_bBurstDone) {
+                m_bBurstDone = true;
+                for (int i=0; i<3000; ++i) {
+                    AVG_TRACE(Logger::category::NONE, Logger::severity::WARNING, 
+                            "Burst message " << i);
+                }
+            }
+        }
+
+    private:
+        bool m_bBurstDone;
+    };
 };
 
 class BaseTestSuite: public TestSuite
@@ -983,19 +1513,24 @@ public:
     {
         addTest(TestPtr(new DAGTest));
         addTest(TestPtr(new QueueTest));
+        addTest(TestPtr(new LockFreeQueueTest));
+        addTest(TestPtr(new TripleBufferTest));
         addTest(TestPtr(new WorkerThreadTest));
         addTest(TestPtr(new ObjectCounterTest));
         addTest(TestPtr(new GeomTest));
         addTest(TestPtr(new TriangleTest));
+        addTest(TestPtr(new SpatialGridTest));
         addTest(TestPtr(new FileTest));
         addTest(TestPtr(new OSTest));
         addTest(TestPtr(new StringTest));
         addTest(TestPtr(new SplineTest));
+        addTest(TestPtr(new OneEuroFilterTest));
         addTest(TestPtr(new BezierCurveTest));
         addTest(TestPtr(new SignalTest));
         addTest(TestPtr(new BacktraceTest));
         addTest(TestPtr(new XmlParserTest));
         addTest(TestPtr(new StandardLoggerTest));
+        addTest(TestPtr(new TraceRecorderTest));
     }
 };
 
@@ -24,6 +24,7 @@
 #include "Pixel16.h"
 #include "Pixel8.h"
 #include "Filter3x3.h"
+#include "YUVConversion.h"
 
 #include "../base/Exception.h"
 #include "../base/Logger.h"
@@ -120,8 +121,16 @@ Bitmap::Bitmap(Bitmap& origBmp, const IntRect& rect)
     } else {
         m_sName = "";
     }
-    unsigned char * pRegionStart = origBmp.getPixels()
-            + size_t(rect.tl.y)*origBmp.getStride() + rect.tl.x*getBytesPerPixel();
+    unsigned char * pRegionStart;
+    if (pixelFormatIsCompressed(m_PF)) {
+        // Block-compressed bitmaps can only be split at block boundaries.
+        AVG_ASSERT(rect.tl.x%4 == 0 && rect.tl.y%4 == 0);
+        pRegionStart = origBmp.getPixels() + size_t(rect.tl.y/4)*origBmp.getStride()
+                + (rect.tl.x/4)*getBytesPerBlock(m_PF);
+    } else {
+        pRegionStart = origBmp.getPixels() + size_t(rect.tl.y)*origBmp.getStride()
+                + rect.tl.x*getBytesPerPixel();
+    }
     initWithData(pRegionStart, origBmp.getStride(), false);
 }
 
@@ -161,7 +170,7 @@ void Bitmap::copyPixels(const Bitmap& origBmp)
     if (origBmp.getPixelFormat() == m_PF) {
         const unsigned char * pSrc = origBmp.getPixels();
         unsigned char * pDest = m_pBits;
-        int height = min(origBmp.getSize().y, m_Size.y);
+        int height = min(origBmp.getNumLines(), getNumLines());
         int lineLen = min(origBmp.getLineLen(), getLineLen());
         int srcStride = origBmp.getStride();
         for (int y = 0; y < height; ++y) {
@@ -169,6 +178,13 @@ void Bitmap::copyPixels(const Bitmap& origBmp)
             pDest += m_Stride;
             pSrc += srcStride;
         }
+    } else if (pixelFormatIsCompressed(origBmp.getPixelFormat()) || 
+            pixelFormatIsCompressed(m_PF))
+    {
+        throw Exception(AVG_ERR_UNSUPPORTED, "Can't convert " +
+                getPixelFormatString(origBmp.getPixelFormat()) + " to " +
+                getPixelFormatString(m_PF) + 
+                ": Block-compressed bitmaps can only be copied as-is.");
     } else {
         switch (origBmp.getPixelFormat()) {
             case YCbCr422:
@@ -302,214 +318,10 @@ void Bitmap::copyPixels(const Bitmap& origBmp)
     }
 }
 
-#if defined(__SSE__) || defined(_WIN32)
-ostream& operator<<(ostream& os, const __m64 &val)
-{
-    unsigned char * pVal = (unsigned char *)(&val);
-    for (int i = 0; i < 8; ++i) {
-        os << hex << setw(2) << setfill('0') << int(pVal[i]);
-        if (i%2 == 1) {
-            os << " ";
-        }
-        if (i%4 == 3) {
-            os << " ";
-        }
-    }
-    return os;
-}
-#endif
-
-#define YUV_TO_RGB_UNPACK    \
-    /* Input: r, g, b contain 4 words each of the u and v inputs for the color */    \
-    /* channels. ylo and yhi contain 4 words each of the y input. */    \
-\
-    /* duplicate u and v channels and add y    \
-     * each of r,g, b in the form [s1(16), s2(16), s3(16), s4(16)]    \
-     * first interleave, so tmp is [s1(16), s1(16), s2(16), s2(16)]    \
-     * then add y, then interleave again    \
-     * then pack with saturation, to get the desired output of    \
-     *   [s1(8), s1(8), s2(8), s2(8), s3(8), s3(8), s4(8), s4(8)]    \
-     */    \
-    tmp = _m_punpckhwd(r, r);    \
-    tmp = _m_paddsw(tmp, yhi);    \
-    tmp2 = _m_punpcklwd(r, r);    \
-    tmp2 = _m_paddsw(tmp2, ylo);    \
-    r = _m_packuswb(tmp2, tmp);    \
-    \
-    tmp = _m_punpckhwd(g, g);    \
-    tmp2 = _m_punpcklwd(g, g);    \
-    tmp = _m_paddsw(tmp, yhi);    \
-    tmp2 = _m_paddsw(tmp2, ylo);    \
-    g = _m_packuswb(tmp2, tmp);    \
-    \
-    tmp = _m_punpckhwd(b, b);    \
-    tmp2 = _m_punpcklwd(b, b);    \
-    tmp = _m_paddsw(tmp, yhi);    \
-    tmp2 = _m_paddsw(tmp2, ylo);    \
-    b = _m_packuswb(tmp2, tmp);    \
-    \
-    /* now we have 8 8-bit r, g and b samples.  we want these to be packed    \
-     * into 32-bit values.    \
-     */    \
-    imm = _mm_set1_pi32(0xFFFFFFFF);    \
-    tmp = _m_punpcklbw(b, r);    \
-    tmp2 = _m_punpcklbw(g, imm);    \
-    *o++ = _m_punpcklbw(tmp, tmp2);    \
-    *o++ = _m_punpckhbw(tmp, tmp2);    \
-    tmp = _m_punpckhbw(b, r);    \
-    tmp2 = _m_punpckhbw(g, imm);    \
-    *o++ = _m_punpcklbw(tmp, tmp2);    \
-    *o++ = _m_punpckhbw(tmp, tmp2);
-
-
 void Bitmap::copyYUVPixels(const Bitmap& yBmp, const Bitmap& uBmp, const Bitmap& vBmp,
         bool bJPEG)
 {
-    int height = min(yBmp.getSize().y, m_Size.y);
-    int width = min(yBmp.getSize().x, m_Size.x);
-
-    int yStride = yBmp.getStride();
-    int uStride = uBmp.getStride();
-    int vStride = vBmp.getStride();
-    int destStride = m_Stride/getBytesPerPixel();
-    Pixel32 * pDestLine = (Pixel32*)m_pBits;
-
-#if defined(__SSE__) || defined(_WIN32)
-#pragma pack(16)
-    // Original SSE conversion code taken from liboggplay: oggplay_sse_x86.c
-    int               i;     
-    const unsigned char   * ptry;
-    const unsigned char   * ptru;
-    const unsigned char   * ptrv;
-
-    __m64    *o;
-    __m64    y, ylo, yhi;
-    __m64    zero, ut, vt, imm;
-    __m64    r, g, b;
-    __m64    tmp, tmp2;
-
-    zero = _mm_setzero_si64(); 
-
-    ptry = yBmp.getPixels();
-    ptru = uBmp.getPixels();
-    ptrv = vBmp.getPixels();
-
-    for (i = 0; i < height; i++) {
-        int j;
-        o = (__m64*)pDestLine;
-        pDestLine += destStride;
-        if (bJPEG) {
-            for (j = 0; j < width; j += 8) {
-                // ylo and yhi contain 4 pixels each
-                y = *(__m64*)(&(ptry[j]));
-                ylo = _m_punpcklbw(y, zero);
-               
-                yhi = _m_punpckhbw(y, zero);
-
-                ut = _m_from_int(*(int *)(ptru + j/2));
-                vt = _m_from_int(*(int *)(ptrv + j/2));
-
-                ut = _m_punpcklbw(ut, zero);
-                vt = _m_punpcklbw(vt, zero);
-
-                /* subtract 128 from u and v */ 
-                imm = _mm_set1_pi16(128);
-                ut = _m_psubw(ut, imm);
-                vt = _m_psubw(vt, imm);
-
-                /* transfer and multiply into r, g, b registers */
-                imm = _mm_set1_pi16(-44);
-                g = _m_pmullw(ut, imm);
-                imm = _mm_set1_pi16(113);
-                b = _m_pmullw(ut, imm);
-                imm = _mm_set1_pi16(179);
-                r = _m_pmullw(vt, imm);
-                imm = _mm_set1_pi16(-91);
-                imm = _m_pmullw(vt, imm);
-                g = _m_paddsw(g, imm);
-
-                /* shift r, g and b registers to the right */
-                r = _m_psrawi(r, 7);
-                g = _m_psrawi(g, 7);
-                b = _m_psrawi(b, 6);
-                YUV_TO_RGB_UNPACK
-
-            }
-        } else {
-            for (j = 0; j < width; j += 8) {
-
-                // y' = (298*(y-16))
-                // ylo and yhi contain 4 pixels each
-                y = *(__m64*)(&(ptry[j]));
-                ylo = _m_punpcklbw(y, zero);
-                imm = _mm_set1_pi16(16);
-                ylo = _m_psubusw(ylo, imm);
-                imm = _mm_set1_pi16(149);
-                ylo = _m_pmullw(ylo, imm);
-                ylo = _mm_srli_pi16(ylo, 7);
-               
-                yhi = _m_punpckhbw(y, zero);
-                imm = _mm_set1_pi16(16);
-                yhi = _m_psubusw(yhi, imm);
-                imm = _mm_set1_pi16(149);
-                yhi = _m_pmullw(yhi, imm);
-                yhi = _mm_srli_pi16(yhi, 7);
-
-                ut = _m_from_int(*(int *)(ptru + j/2));
-                vt = _m_from_int(*(int *)(ptrv + j/2));
-
-                ut = _m_punpcklbw(ut, zero);
-                vt = _m_punpcklbw(vt, zero);
-
-                /* subtract 128 from u and v */ 
-                imm = _mm_set1_pi16(128);
-                ut = _m_psubw(ut, imm);
-                vt = _m_psubw(vt, imm);
-
-                /* transfer and multiply into r, g, b registers */
-                imm = _mm_set1_pi16(-50);
-                g = _m_pmullw(ut, imm);
-                imm = _mm_set1_pi16(129);
-                b = _m_pmullw(ut, imm);
-                imm = _mm_set1_pi16(204);
-                r = _m_pmullw(vt, imm);
-                imm = _mm_set1_pi16(-104);
-                imm = _m_pmullw(vt, imm);
-                g = _m_paddsw(g, imm);
-
-                /* shift r, g and b registers to the right */
-                r = _m_psrawi(r, 7);
-                g = _m_psrawi(g, 7);
-                b = _m_psrawi(b, 6);
-                YUV_TO_RGB_UNPACK
-            }
-        }
-        if (i & 0x1) {
-            ptru += uStride;
-            ptrv += vStride;
-        }
-        ptry += yStride;
-    }
-    _m_empty();
-#pragma pack()
-#else
-    AVG_ASSERT(m_PF==B8G8R8X8);
-    const unsigned char * pYSrc = yBmp.getPixels();
-    const unsigned char * pUSrc = uBmp.getPixels();
-    const unsigned char * pVSrc = vBmp.getPixels();
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            YUVtoBGR32Pixel(pDestLine + x, pYSrc[x], pUSrc[x/2], pVSrc[x/2]);
-        }
-        pDestLine += destStride;
-        pYSrc += yStride;
-        if (y % 2 == 1) {
-            pUSrc += uStride;
-            pVSrc += vStride;
-        }
-    }
-#endif
+    YUVtoRGB32(yBmp, uBmp, vBmp, bJPEG, *this);
 }
 
 void Bitmap::save(const UTF8String& sFilename)
@@ -623,8 +435,8 @@ void Bitmap::setPixels(const unsigned char* pPixels, int stride)
     }
     unsigned char* pDestLine = m_pBits;
     const unsigned char* pSrcLine = pPixels;
-    for (int y=0; y<m_Size.y; y++) {
-        memcpy(pDestLine, pSrcLine, getBytesPerPixel()*m_Size.x);
+    for (int y=0; y<getNumLines(); y++) {
+        memcpy(pDestLine, pSrcLine, getLineLen());
         pDestLine += m_Stride;
         pSrcLine += stride;
     }
@@ -649,15 +461,27 @@ int Bitmap::getLineLen() const
 {
     if (m_PF == YCbCr411) {
         return int(m_Size.x*1.5);
+    } else if (pixelFormatIsCompressed(m_PF)) {
+        return getNumBlocks(m_Size, m_PF).x*getBytesPerBlock(m_PF);
     } else {
         return m_Size.x*getBytesPerPixel();
     }
 }
 
+int Bitmap::getNumLines() const
+{
+    // A line of a block-compressed bitmap is a row of blocks.
+    if (pixelFormatIsCompressed(m_PF)) {
+        return getNumBlocks(m_Size, m_PF).y;
+    } else {
+        return m_Size.y;
+    }
+}
+
 int Bitmap::getMemNeeded() const
 {
     // This assumes a positive value for stride.
-    return m_Stride*m_Size.y;
+    return m_Stride*getNumLines();
 }
 
 bool Bitmap::hasAlpha() const
@@ -1103,7 +927,11 @@ void Bitmap::dump(bool bDumpPixels) const
 
 int Bitmap::getPreferredStride(int width, PixelFormat pf)
 {
-    return (((width*avg::getBytesPerPixel(pf))-1)/4+1)*4;
+    if (pixelFormatIsCompressed(pf)) {
+        return getNumBlocks(IntPoint(width, 1), pf).x*getBytesPerBlock(pf);
+    } else {
+        return (((width*avg::getBytesPerPixel(pf))-1)/4+1)*4;
+    }
 }
 
 void Bitmap::initWithData(unsigned char * pBits, int stride, bool bCopyBits)
@@ -1124,10 +952,10 @@ void Bitmap::initWithData(unsigned char * pBits, int stride, bool bCopyBits)
     }
     if (bCopyBits) {
         allocBits();
-        if (m_Stride == stride && stride == (m_Size.x*getBytesPerPixel())) {
-            memcpy(m_pBits, pBits, stride*m_Size.y);
+        if (m_Stride == stride && stride == getLineLen()) {
+            memcpy(m_pBits, pBits, size_t(stride)*getNumLines());
         } else {
-            for (int y = 0; y < m_Size.y; ++y) {
+            for (int y = 0; y < getNumLines(); ++y) {
                 memcpy(m_pBits+m_Stride*y, pBits+stride*y, m_Stride);
             }
         }
@@ -1164,7 +992,7 @@ void Bitmap::allocBits(int stride)
         // Yuck.
         m_pBits = new unsigned char[size_t(m_Stride+1)*(m_Size.y+1)];
     } else {
-        m_pBits = new unsigned char[size_t(m_Stride)*m_Size.y];
+        m_pBits = new unsigned char[size_t(m_Stride)*getNumLines()];
     }
 }
 
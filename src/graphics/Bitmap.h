@@ -32,9 +32,6 @@
 
 #include <boost/shared_ptr.hpp>
 
-#if defined(__SSE__) || defined(_WIN32)
-#include <xmmintrin.h>
-#endif
 
 #include <string>
 #include <vector>
@@ -79,6 +76,7 @@ public:
     const std::string& getName() const;
     int getBytesPerPixel() const;
     int getLineLen() const;
+    int getNumLines() const;
     int getMemNeeded() const;
     bool hasAlpha() const;
     HistogramPtr getHistogram(int stride = 1) const;
@@ -133,9 +131,6 @@ void Bitmap::setPixel(const IntPoint& p, PIXEL color)
     *(PIXEL*)(&(m_pBits[p.y*m_Stride+p.x*getBytesPerPixel()])) = color;
 }
 
-#if defined(__SSE__) || defined(_WIN32)
-std::ostream& operator<<(std::ostream& os, const __m64 &val);
-#endif
 
 }
 #endif
@@ -22,12 +22,21 @@
 #include "BitmapLoader.h"
 
 #include "PixelFormat.h"
-#include "Filterfliprgb.h"
+#include "GdkPixbufDecoder.h"
+#include "KTXDecoder.h"
+#include "DDSDecoder.h"
+#ifdef AVG_ENABLE_PNG_DECODER
+#include "PNGDecoder.h"
+#endif
+#ifdef AVG_ENABLE_JPEG_DECODER
+#include "JPEGDecoder.h"
+#endif
 
 #include "../base/Exception.h"
 #include "../base/ScopeTimer.h"
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <stdio.h>
 #include <iostream>
 
 using namespace std;
@@ -58,6 +67,15 @@ BitmapLoader* BitmapLoader::get()
 BitmapLoader::BitmapLoader(bool bBlueFirst)
     : m_bBlueFirst(bBlueFirst)
 {
+    m_pFallbackDecoder = ImageDecoderPtr(new GdkPixbufDecoder());
+    registerDecoder(ImageDecoderPtr(new KTXDecoder()));
+    registerDecoder(ImageDecoderPtr(new DDSDecoder()));
+#ifdef AVG_ENABLE_PNG_DECODER
+    registerDecoder(ImageDecoderPtr(new PNGDecoder()));
+#endif
+#ifdef AVG_ENABLE_JPEG_DECODER
+    registerDecoder(ImageDecoderPtr(new JPEGDecoder()));
+#endif
 }
 
 BitmapLoader::~BitmapLoader() 
@@ -86,70 +104,56 @@ PixelFormat BitmapLoader::getDefaultPixelFormat(bool bAlpha)
     } 
 }
 
-static ProfilingZoneID GDKPixbufProfilingZone("gdk_pixbuf load", true);
-static ProfilingZoneID ConvertProfilingZone("Format conversion", true);
-static ProfilingZoneID RGBFlipProfilingZone("RGB<->BGR flip", true);
+void BitmapLoader::registerDecoder(ImageDecoderPtr pDecoder)
+{
+    m_pDecoders.insert(m_pDecoders.begin(), pDecoder);
+}
+
+static ProfilingZoneID ConvertProfilingZone("BitmapLoader: format conversion", true);
 
-BitmapPtr BitmapLoader::load(const UTF8String& sFName, PixelFormat pf) const
+BitmapPtr BitmapLoader::load(const UTF8String& sFName, PixelFormat pf,
+        const IntPoint& targetSize) const
 {
     AVG_ASSERT(s_pBitmapLoader != 0);
-    GError* pError = 0;
-    GdkPixbuf* pPixBuf;
-    {
-        ScopeTimer timer(GDKPixbufProfilingZone);
-        pPixBuf = gdk_pixbuf_new_from_file(sFName.c_str(), &pError);
-    }
-    if (!pPixBuf) {
-        string sErr = pError->message;
-        g_error_free(pError);
-        throw Exception(AVG_ERR_FILEIO, sErr);
-    }
-    IntPoint size = IntPoint(gdk_pixbuf_get_width(pPixBuf), 
-            gdk_pixbuf_get_height(pPixBuf));
-    
-    PixelFormat srcPF;
-    if (gdk_pixbuf_get_has_alpha(pPixBuf)) {
-        srcPF = R8G8B8A8;
-    } else {
-        srcPF = R8G8B8;
+    BitmapPtr pBmp;
+    const ImageDecoder* pDecoder = findDecoder(sFName);
+    if (pDecoder) {
+        pBmp = pDecoder->decode(sFName, pf, targetSize);
     }
-    if (pf == NO_PIXELFORMAT) {
-        if (m_bBlueFirst) {
-            if (srcPF == R8G8B8A8) {
-                pf = B8G8R8A8;
-            } else if (srcPF == R8G8B8) {
-                pf = B8G8R8X8;
-            }
-        } else {
-            if (srcPF == R8G8B8A8) {
-                pf = R8G8B8A8;
-            } else if (srcPF == R8G8B8) {
-                pf = R8G8B8X8;
-            }
-        }
+    if (!pBmp) {
+        pBmp = m_pFallbackDecoder->decode(sFName, pf, targetSize);
     }
-    BitmapPtr pBmp(new Bitmap(size, pf, sFName));
-    {
+    if (pf != NO_PIXELFORMAT && pBmp->getPixelFormat() != pf) {
         ScopeTimer timer(ConvertProfilingZone);
+        BitmapPtr pDestBmp(new Bitmap(pBmp->getSize(), pf, sFName));
+        pDestBmp->copyPixels(*pBmp);
+        pBmp = pDestBmp;
+    }
+    return pBmp;
+}
 
-        int stride = gdk_pixbuf_get_rowstride(pPixBuf);
-        guchar* pSrc = gdk_pixbuf_get_pixels(pPixBuf);
-        BitmapPtr pSrcBmp(new Bitmap(size, srcPF, pSrc, stride, false));
-        {
-            ScopeTimer timer(RGBFlipProfilingZone);
-            if (pixelFormatIsBlueFirst(pf) != pixelFormatIsBlueFirst(srcPF)) {
-                FilterFlipRGB().applyInPlace(pSrcBmp);
-            }
+const ImageDecoder* BitmapLoader::findDecoder(const UTF8String& sFName) const
+{
+    FILE* pFile = fopen(sFName.c_str(), "rb");
+    if (!pFile) {
+        // Let the fallback decoder generate the error message.
+        return 0;
+    }
+    unsigned char header[16];
+    int headerSize = int(fread(header, 1, sizeof(header), pFile));
+    fclose(pFile);
+    for (unsigned i = 0; i < m_pDecoders.size(); ++i) {
+        if (m_pDecoders[i]->canDecode(header, headerSize)) {
+            return m_pDecoders[i].get();
         }
-        pBmp->copyPixels(*pSrcBmp);
     }
-    g_object_unref(pPixBuf);
-    return pBmp;
+    return 0;
 }
 
-BitmapPtr loadBitmap(const UTF8String& sFName, PixelFormat pf)
+BitmapPtr loadBitmap(const UTF8String& sFName, PixelFormat pf,
+        const IntPoint& targetSize)
 {
-    return BitmapLoader::get()->load(sFName, pf);
+    return BitmapLoader::get()->load(sFName, pf, targetSize);
 }
 
 }
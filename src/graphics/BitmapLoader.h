@@ -27,8 +27,10 @@
 
 #include "Bitmap.h"
 #include "PixelFormat.h"
+#include "ImageDecoder.h"
 
 #include <string>
+#include <vector>
 
 namespace avg {
 
@@ -38,17 +40,27 @@ public:
     static BitmapLoader* get();
     bool isBlueFirst() const;
     PixelFormat getDefaultPixelFormat(bool bAlpha);
-    BitmapPtr load(const UTF8String& sFName, PixelFormat pf=NO_PIXELFORMAT) const;
+    BitmapPtr load(const UTF8String& sFName, PixelFormat pf=NO_PIXELFORMAT,
+            const IntPoint& targetSize=IntPoint(0,0)) const;
+
+    // Decoders registered later are tried first. Files no registered decoder accepts
+    // are loaded using gdk-pixbuf. Not thread-safe: Register decoders before loading.
+    void registerDecoder(ImageDecoderPtr pDecoder);
 
 private:
     BitmapLoader(bool bBlueFirst);
     virtual ~BitmapLoader();
 
+    const ImageDecoder* findDecoder(const UTF8String& sFName) const;
+
     bool m_bBlueFirst;
+    std::vector<ImageDecoderPtr> m_pDecoders;
+    ImageDecoderPtr m_pFallbackDecoder;
     static BitmapLoader * s_pBitmapLoader;
 };
 
-BitmapPtr AVG_API loadBitmap(const UTF8String& sFName, PixelFormat pf=NO_PIXELFORMAT);
+BitmapPtr AVG_API loadBitmap(const UTF8String& sFName, PixelFormat pf=NO_PIXELFORMAT,
+        const IntPoint& targetSize=IntPoint(0,0));
 
 }
 
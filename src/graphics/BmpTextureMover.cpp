@@ -57,9 +57,31 @@ void BmpTextureMover::moveBmpToTexture(BitmapPtr pBmp, GLTexture& tex)
     tex.activate(WrapMode());
     unsigned char * pStartPos = pBmp->getPixels();
     IntPoint size = tex.getSize();
+    int stride = pBmp->getStride();
+    bool bRowLength = false;
+    if (stride != Bitmap::getPreferredStride(size.x, getPF())) {
+        // Bitmaps that point into other buffers (e.g. decoded video frames) can have
+        // any stride.
+#ifdef GL_UNPACK_ROW_LENGTH
+        bRowLength = !GLContext::getCurrent()->isGLES() && 
+                stride % pBmp->getBytesPerPixel() == 0;
+        if (bRowLength) {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, stride/pBmp->getBytesPerPixel());
+        }
+#endif
+        if (!bRowLength) {
+            m_pBmp->copyPixels(*pBmp);
+            pStartPos = m_pBmp->getPixels();
+        }
+    }
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.x, size.y,
             tex.getGLFormat(getPF()), tex.getGLType(getPF()), 
             pStartPos);
+#ifdef GL_UNPACK_ROW_LENGTH
+    if (bRowLength) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+#endif
     tex.generateMipmaps();
     GLContext::checkError("BmpTextureMover::moveBmpToTexture: glTexSubImage2D()");
 }
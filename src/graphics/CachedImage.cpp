@@ -30,6 +30,7 @@
 #include "Bitmap.h"
 #include "GLContextManager.h"
 #include "MCTexture.h"
+#include "TextureAtlas.h"
 #include "ImageCache.h"
 #include "Filterfliprgb.h"
 
@@ -39,6 +40,7 @@ namespace avg {
 
 CachedImage::CachedImage(const std::string& sFilename, TexCompression compression)
     : m_bUseMipmaps(false),
+      m_bAllowAtlas(false),
       m_Compression(compression),
       m_BmpRefCount(0),
       m_TexRefCount(0)
@@ -46,8 +48,7 @@ CachedImage::CachedImage(const std::string& sFilename, TexCompression compressio
     ObjectCounter::get()->incRef(&typeid(*this));
     m_sFilename = sFilename;
     AVG_TRACE(Logger::category::MEMORY, Logger::severity::INFO, "Loading " << sFilename);
-    BitmapPtr pBmp = loadBitmap(m_sFilename);
-    m_pBmp = applyCompression(pBmp);
+    m_pBmp = loadBmp();
     incBmpRef(m_Compression);
 }
 
@@ -71,9 +72,8 @@ void CachedImage::incBmpRef(TexCompression compression)
         // Reload from disk, making sure the cache knows about the size change
         int oldSize = m_pBmp->getMemNeeded();
         m_Compression = compression;
-        BitmapPtr pBmp = loadBitmap(m_sFilename);
-        m_pBmp = applyCompression(pBmp);
-        ImageCache::get()->onSizeChange(pBmp->getMemNeeded()-oldSize, STORAGE_CPU);
+        m_pBmp = loadBmp();
+        ImageCache::get()->onSizeChange(m_pBmp->getMemNeeded()-oldSize, STORAGE_CPU);
     }
 }
 
@@ -87,21 +87,28 @@ void CachedImage::decBmpRef()
     }
 }
 
-void CachedImage::incTexRef(bool bUseMipmaps)
+void CachedImage::incTexRef(bool bUseMipmaps, bool bAllowAtlas)
 {
     m_TexRefCount++;
     AVG_ASSERT(m_TexRefCount <= m_BmpRefCount);
     if (m_TexRefCount == 1) {
         m_bUseMipmaps = bUseMipmaps;
-        if (!m_pTex) {
+        m_bAllowAtlas = bAllowAtlas;
+        if (!hasTex()) {
             createTexture();
             ImageCache::get()->onTexLoad(m_sFilename);
+        } else if (m_pAtlasEntry && (bUseMipmaps || !bAllowAtlas)) {
+            recreateTexture();
+        }
+    } else {
+        // The image can only stay in the atlas if all users are ok with that.
+        bool bRecreate = (bUseMipmaps && !m_bUseMipmaps) || 
+                (!bAllowAtlas && m_pAtlasEntry);
+        m_bUseMipmaps = m_bUseMipmaps || bUseMipmaps;
+        m_bAllowAtlas = m_bAllowAtlas && bAllowAtlas;
+        if (bRecreate) {
+            recreateTexture();
         }
-    } else if (bUseMipmaps && !m_bUseMipmaps) {
-        m_bUseMipmaps = true;
-        int oldSize = m_pTex->getMemNeeded();
-        createTexture();
-        ImageCache::get()->onSizeChange(m_pTex->getMemNeeded()-oldSize, STORAGE_GPU);
     }
 }
 
@@ -117,8 +124,9 @@ void CachedImage::decTexRef()
 void CachedImage::unloadTex()
 {
     AVG_ASSERT(m_TexRefCount == 0);
-    AVG_ASSERT(m_pTex);
+    AVG_ASSERT(hasTex());
     m_pTex = MCTexturePtr();
+    m_pAtlasEntry = TextureAtlasEntryPtr();
 }
 
 BitmapPtr CachedImage::getBmp()
@@ -133,9 +141,15 @@ MCTexturePtr CachedImage::getTex()
     return m_pTex;
 }
 
+TextureAtlasEntryPtr CachedImage::getAtlasEntry()
+{
+    AVG_ASSERT(m_TexRefCount >= 1);
+    return m_pAtlasEntry;
+}
+
 bool CachedImage::hasTex() const
 {
-    return m_pTex != MCTexturePtr();
+    return m_pTex || m_pAtlasEntry;
 }
 
 int CachedImage::getMemUsed(StorageType st) const
@@ -144,11 +158,7 @@ int CachedImage::getMemUsed(StorageType st) const
         case CachedImage::STORAGE_CPU:
             return m_pBmp->getMemNeeded();
         case CachedImage::STORAGE_GPU:
-            if (m_pTex) {
-                return m_pTex->getMemNeeded();
-            } else {
-                return 0;
-            }
+            return getTexMemUsed();
         default:
             AVG_ASSERT(false);
             return 0;
@@ -175,11 +185,32 @@ void CachedImage::dump() const
             << ", " << hasTex() << endl;
 }
 
-BitmapPtr CachedImage::applyCompression(BitmapPtr pBmp)
+BitmapPtr CachedImage::loadBmp()
+{
+    DiskImageCache* pDiskCache = ImageCache::get()->getDiskCache();
+    BitmapPtr pBmp;
+    if (pDiskCache) {
+        pBmp = pDiskCache->load(m_sFilename, m_Compression);
+        if (pBmp) {
+            return pBmp;
+        }
+    }
+    pBmp = applyCompression(loadBitmap(m_sFilename), m_Compression);
+    // Block-compressed files are loaded without decoding, so caching them doesn't
+    // gain anything.
+    if (pDiskCache && !pixelFormatIsCompressed(pBmp->getPixelFormat())) {
+        pDiskCache->store(m_sFilename, m_Compression, pBmp);
+    }
+    return pBmp;
+}
+
+BitmapPtr CachedImage::applyCompression(BitmapPtr pBmp, TexCompression compression)
 {
-    // Duplicated code with GPUImage::setBitmap()
-    if (m_Compression == TEXCOMPRESSION_B5G6R5) {
-        BitmapPtr pDestBmp = BitmapPtr(new Bitmap(pBmp->getSize(), B5G6R5, m_sFilename));
+    if (compression == TEXCOMPRESSION_B5G6R5 && 
+            !pixelFormatIsCompressed(pBmp->getPixelFormat()))
+    {
+        BitmapPtr pDestBmp = BitmapPtr(new Bitmap(pBmp->getSize(), B5G6R5, 
+                pBmp->getName()));
         if (!BitmapLoader::get()->isBlueFirst()) {
             FilterFlipRGB().applyInPlace(pBmp);
         }
@@ -192,7 +223,35 @@ BitmapPtr CachedImage::applyCompression(BitmapPtr pBmp)
 
 void CachedImage::createTexture()
 {
-    m_pTex = GLContextManager::get()->createTextureFromBmp(m_pBmp, m_bUseMipmaps);
+    GLContextManager* pCM = GLContextManager::get();
+    m_pTex = MCTexturePtr();
+    m_pAtlasEntry = TextureAtlasEntryPtr();
+    // Images are uploaded within the per-frame texture upload budget.
+    if (m_bAllowAtlas && !m_bUseMipmaps) {
+        m_pAtlasEntry = pCM->createAtlasEntryFromBmp(m_pBmp, true);
+    }
+    if (!m_pAtlasEntry) {
+        m_pTex = pCM->createTextureFromBmp(m_pBmp, m_bUseMipmaps, false, 0, true);
+    }
+}
+
+void CachedImage::recreateTexture()
+{
+    // Make sure the cache knows about the size change
+    int oldSize = getTexMemUsed();
+    createTexture();
+    ImageCache::get()->onSizeChange(getTexMemUsed()-oldSize, STORAGE_GPU);
+}
+
+int CachedImage::getTexMemUsed() const
+{
+    if (m_pTex) {
+        return m_pTex->getMemNeeded();
+    } else if (m_pAtlasEntry) {
+        return m_pAtlasEntry->getMemNeeded();
+    } else {
+        return 0;
+    }
 }
 
 }
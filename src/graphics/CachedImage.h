@@ -35,6 +35,8 @@ class Bitmap;
 typedef boost::shared_ptr<Bitmap> BitmapPtr;
 class MCTexture;
 typedef boost::shared_ptr<MCTexture> MCTexturePtr;
+class TextureAtlasEntry;
+typedef boost::shared_ptr<TextureAtlasEntry> TextureAtlasEntryPtr;
 
 class AVG_API CachedImage
 {
@@ -51,28 +53,37 @@ class AVG_API CachedImage
 
         void incBmpRef(TexCompression compression);
         void decBmpRef();
-        void incTexRef(bool bUseMipmaps);
+        void incTexRef(bool bUseMipmaps, bool bAllowAtlas=false);
         void decTexRef();
         void unloadTex();
 
         BitmapPtr getBmp();
         MCTexturePtr getTex();
+        TextureAtlasEntryPtr getAtlasEntry();
         bool hasTex() const;
         int getMemUsed(StorageType st) const;
         int getRefCount(StorageType st) const;
 
         void dump() const;
 
+        // Converts pBmp to the pixel format used for the compression mode. Can change 
+        // pBmp. Bitmaps that are already block-compressed are returned unchanged.
+        static BitmapPtr applyCompression(BitmapPtr pBmp, TexCompression compression);
+
     private:
-        BitmapPtr applyCompression(BitmapPtr pBmp);
+        BitmapPtr loadBmp();
         void createTexture();
+        void recreateTexture();
+        int getTexMemUsed() const;
         void testDelete();
 
         std::string m_sFilename;
         BitmapPtr m_pBmp;
         MCTexturePtr m_pTex;
+        TextureAtlasEntryPtr m_pAtlasEntry;
 
         bool m_bUseMipmaps;
+        bool m_bAllowAtlas;
         TexCompression m_Compression;
         
         int m_BmpRefCount;
@@ -0,0 +1,154 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "DDSDecoder.h"
+
+#include "Bitmap.h"
+
+#include "../base/Exception.h"
+#include "../base/ScopeTimer.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+using namespace std;
+
+namespace avg {
+
+// File layout as documented by Microsoft. All fields are little-endian.
+struct DDSPixelFormat {
+    uint32_t m_Size;
+    uint32_t m_Flags;
+    uint32_t m_FourCC;
+    uint32_t m_RGBBitCount;
+    uint32_t m_BitMasks[4];
+};
+
+struct DDSHeader {
+    char m_Magic[4];
+    uint32_t m_Size;
+    uint32_t m_Flags;
+    uint32_t m_Height;
+    uint32_t m_Width;
+    uint32_t m_PitchOrLinearSize;
+    uint32_t m_Depth;
+    uint32_t m_NumMipmapLevels;
+    uint32_t m_Reserved1[11];
+    DDSPixelFormat m_PF;
+    uint32_t m_Caps[4];
+    uint32_t m_Reserved2;
+};
+
+struct DDSHeaderDX10 {
+    uint32_t m_DXGIFormat;
+    uint32_t m_ResourceDimension;
+    uint32_t m_MiscFlag;
+    uint32_t m_ArraySize;
+    uint32_t m_MiscFlags2;
+};
+
+static const uint32_t DDPF_FOURCC = 0x4;
+static const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+static const uint32_t DDSCAPS2_VOLUME = 0x200000;
+static const uint32_t DXGI_FORMAT_BC1_UNORM = 71;
+static const uint32_t DXGI_FORMAT_BC3_UNORM = 77;
+
+static uint32_t makeFourCC(const char* psz)
+{
+    return uint32_t(psz[0]) | (uint32_t(psz[1]) << 8) | (uint32_t(psz[2]) << 16) | 
+            (uint32_t(psz[3]) << 24);
+}
+
+DDSDecoder::DDSDecoder()
+{
+}
+
+DDSDecoder::~DDSDecoder()
+{
+}
+
+bool DDSDecoder::canDecode(const unsigned char* pHeader, int headerSize) const
+{
+    return headerSize >= 4 && memcmp(pHeader, "DDS ", 4) == 0;
+}
+
+static ProfilingZoneID DDSLoadProfilingZone("DDS load", true);
+
+BitmapPtr DDSDecoder::decode(const UTF8String& sFName, PixelFormat pf,
+        const IntPoint& targetSize) const
+{
+    ScopeTimer timer(DDSLoadProfilingZone);
+    FILE* pFile = fopen(sFName.c_str(), "rb");
+    if (!pFile) {
+        return BitmapPtr();
+    }
+    string sError;
+    BitmapPtr pBmp;
+    DDSHeader header;
+    PixelFormat filePF = NO_PIXELFORMAT;
+    if (fread(&header, sizeof(header), 1, pFile) != 1) {
+        sError = "File truncated.";
+    } else if (header.m_Size != sizeof(header)-sizeof(header.m_Magic)) {
+        sError = "Invalid header.";
+    } else if (header.m_PF.m_Flags & DDPF_FOURCC) {
+        uint32_t fourCC = header.m_PF.m_FourCC;
+        if (fourCC == makeFourCC("DXT1")) {
+            filePF = BC1;
+        } else if (fourCC == makeFourCC("DXT5")) {
+            filePF = BC3;
+        } else if (fourCC == makeFourCC("DX10")) {
+            DDSHeaderDX10 dx10Header;
+            if (fread(&dx10Header, sizeof(dx10Header), 1, pFile) != 1) {
+                sError = "File truncated.";
+            } else if (dx10Header.m_ArraySize > 1) {
+                sError = "Texture arrays are not supported.";
+            } else if (dx10Header.m_DXGIFormat == DXGI_FORMAT_BC1_UNORM) {
+                filePF = BC1;
+            } else if (dx10Header.m_DXGIFormat == DXGI_FORMAT_BC3_UNORM) {
+                filePF = BC3;
+            }
+        }
+    }
+    if (sError.empty()) {
+        if (filePF == NO_PIXELFORMAT) {
+            sError = "Only DXT1 and DXT5 compressed textures are supported.";
+        } else if (header.m_Height == 0 || header.m_Width == 0 ||
+                (header.m_Caps[1] & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)))
+        {
+            sError = "Only 2D textures are supported.";
+        } else {
+            IntPoint size(header.m_Width, header.m_Height);
+            pBmp = BitmapPtr(new Bitmap(size, filePF, sFName));
+            if (fread(pBmp->getPixels(), pBmp->getMemNeeded(), 1, pFile) != 1) {
+                sError = "File truncated.";
+            }
+        }
+    }
+    fclose(pFile);
+    if (!sError.empty()) {
+        throw Exception(AVG_ERR_FILEIO, string("Error loading '") + sFName + "': " +
+                sError);
+    }
+    return pBmp;
+}
+
+}
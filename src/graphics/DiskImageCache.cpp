@@ -0,0 +1,328 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "DiskImageCache.h"
+
+#include "Bitmap.h"
+#include "BitmapLoader.h"
+
+#include "../base/Exception.h"
+#include "../base/Logger.h"
+#include "../base/Directory.h"
+#include "../base/FileHelper.h"
+#include "../base/StringHelper.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+using namespace std;
+namespace bip = boost::interprocess;
+
+namespace avg {
+
+// Increment this whenever the entry file layout changes. Entries with a different
+// version are deleted on access.
+static const int32_t DISK_CACHE_VERSION = 1;
+static const char DISK_CACHE_MAGIC[4] = {'A', 'V', 'G', 'I'};
+static const string DISK_CACHE_SUFFIX = ".avgimg";
+
+struct DiskImageHeader {
+    char m_Magic[4];
+    int32_t m_Version;
+    int32_t m_PF;
+    int32_t m_Width;
+    int32_t m_Height;
+    int32_t m_Stride;
+    int64_t m_SrcMTime;
+    int64_t m_SrcSize;
+    int32_t m_PathLen;
+    int32_t m_DataOffset;
+};
+
+typedef boost::shared_ptr<bip::mapped_region> MappedRegionPtr;
+
+// Bitmap that points into a mapped cache entry. The mapping is copy-on-write, so the
+// pixels can be changed without touching the file.
+class MappedBitmap: public Bitmap
+{
+public:
+    MappedBitmap(MappedRegionPtr pRegion, const DiskImageHeader& header,
+            const UTF8String& sName)
+        : Bitmap(IntPoint(header.m_Width, header.m_Height), PixelFormat(header.m_PF),
+                (unsigned char*)(pRegion->get_address())+header.m_DataOffset,
+                header.m_Stride, false, sName),
+          m_pRegion(pRegion)
+    {
+    }
+
+    virtual ~MappedBitmap()
+    {
+    }
+
+private:
+    MappedRegionPtr m_pRegion;
+};
+
+DiskImageCache::DiskImageCache(const string& sDir, long long capacity)
+    : m_sDir(sDir),
+      m_Capacity(capacity),
+      m_MemUsed(0),
+      m_NumHits(0)
+{
+    readDir();
+    AVG_TRACE(Logger::category::CONFIG, Logger::severity::INFO,
+            "Image disk cache: " << m_sDir << ", " << m_Entries.size() << " entries, " <<
+            m_MemUsed/(1024*1024) << " of " << m_Capacity/(1024*1024) << " MB used.");
+    checkCapacity("");
+}
+
+DiskImageCache::~DiskImageCache()
+{
+}
+
+BitmapPtr DiskImageCache::load(const string& sFilename, TexCompression compression)
+{
+    string sEntryName = getEntryName(sFilename, compression);
+    EntryMap::iterator it = m_Entries.find(sEntryName);
+    if (it == m_Entries.end()) {
+        return BitmapPtr();
+    }
+    struct stat srcStat;
+    if (stat(sFilename.c_str(), &srcStat) != 0) {
+        return BitmapPtr();
+    }
+    string sPath = getEntryPath(sEntryName);
+    MappedRegionPtr pRegion;
+    try {
+        bip::file_mapping mapping(sPath.c_str(), bip::read_only);
+        pRegion = MappedRegionPtr(new bip::mapped_region(mapping, bip::copy_on_write));
+    } catch (bip::interprocess_exception& e) {
+        AVG_LOG_WARNING("Image disk cache: Can't map " << sPath << ": " << e.what());
+        removeEntry(sEntryName);
+        return BitmapPtr();
+    }
+
+    const char* pData = (const char*)(pRegion->get_address());
+    long long regionSize = pRegion->get_size();
+    DiskImageHeader header;
+    bool bValid = regionSize >= (long long)sizeof(header);
+    if (bValid) {
+        memcpy(&header, pData, sizeof(header));
+        bValid = memcmp(header.m_Magic, DISK_CACHE_MAGIC, 4) == 0 &&
+                header.m_Version == DISK_CACHE_VERSION &&
+                header.m_SrcMTime == (int64_t)srcStat.st_mtime &&
+                header.m_SrcSize == (int64_t)srcStat.st_size &&
+                header.m_PathLen == (int32_t)sFilename.size() &&
+                header.m_DataOffset >= (int32_t)sizeof(header)+header.m_PathLen &&
+                header.m_DataOffset+(long long)header.m_Stride*header.m_Height
+                        <= regionSize &&
+                sFilename.compare(0, string::npos, pData+sizeof(header),
+                        header.m_PathLen) == 0;
+    }
+    if (!bValid) {
+        // Stale entry or one written by a different libavg version.
+        pRegion = MappedRegionPtr();
+        removeEntry(sEntryName);
+        return BitmapPtr();
+    }
+    it->second.m_LastUse = time(0);
+    utime(sPath.c_str(), 0);
+    m_NumHits++;
+    return BitmapPtr(new MappedBitmap(pRegion, header, sFilename));
+}
+
+void DiskImageCache::store(const string& sFilename, TexCompression compression,
+        BitmapPtr pBmp)
+{
+    struct stat srcStat;
+    if (stat(sFilename.c_str(), &srcStat) != 0) {
+        return;
+    }
+    DiskImageHeader header;
+    memcpy(header.m_Magic, DISK_CACHE_MAGIC, 4);
+    header.m_Version = DISK_CACHE_VERSION;
+    header.m_PF = pBmp->getPixelFormat();
+    header.m_Width = pBmp->getSize().x;
+    header.m_Height = pBmp->getSize().y;
+    header.m_Stride = pBmp->getStride();
+    header.m_SrcMTime = srcStat.st_mtime;
+    header.m_SrcSize = srcStat.st_size;
+    header.m_PathLen = int32_t(sFilename.size());
+    // Keep the pixels 64-byte aligned.
+    header.m_DataOffset = ((sizeof(header)+header.m_PathLen+63)/64)*64;
+    long long entrySize = header.m_DataOffset+(long long)header.m_Stride*header.m_Height;
+    if (entrySize > m_Capacity) {
+        return;
+    }
+
+    string sEntryName = getEntryName(sFilename, compression);
+    string sPath = getEntryPath(sEntryName);
+    string sTempPath = sPath+".tmp";
+    FILE* pFile = fopen(sTempPath.c_str(), "wb");
+    if (!pFile) {
+        AVG_LOG_WARNING("Image disk cache: Can't write " << sTempPath << ".");
+        return;
+    }
+    vector<char> padding(header.m_DataOffset-sizeof(header)-header.m_PathLen, 0);
+    bool bOK = fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+            fwrite(sFilename.c_str(), header.m_PathLen, 1, pFile) == 1;
+    if (bOK && !padding.empty()) {
+        bOK = fwrite(&padding[0], padding.size(), 1, pFile) == 1;
+    }
+    if (bOK) {
+        bOK = fwrite(pBmp->getPixels(), header.m_Stride, header.m_Height, pFile) ==
+                size_t(header.m_Height);
+    }
+    bOK = (fclose(pFile) == 0) && bOK;
+    if (!bOK) {
+        AVG_LOG_WARNING("Image disk cache: Error writing " << sTempPath << ".");
+        unlink(sTempPath.c_str());
+        return;
+    }
+    removeEntry(sEntryName);
+    if (rename(sTempPath.c_str(), sPath.c_str()) != 0) {
+        unlink(sTempPath.c_str());
+        return;
+    }
+    addEntry(sEntryName, entrySize, time(0));
+    checkCapacity(sEntryName);
+}
+
+const string& DiskImageCache::getDir() const
+{
+    return m_sDir;
+}
+
+long long DiskImageCache::getCapacity() const
+{
+    return m_Capacity;
+}
+
+long long DiskImageCache::getMemUsed() const
+{
+    return m_MemUsed;
+}
+
+int DiskImageCache::getNumHits() const
+{
+    return m_NumHits;
+}
+
+string DiskImageCache::getEntryName(const string& sFilename, TexCompression compression)
+        const
+{
+    string sKey = sFilename + "|" + toString(int(compression)) + "|" +
+            toString(BitmapLoader::get()->isBlueFirst());
+    // 64-bit FNV-1a. std::hash isn't guaranteed to be stable across runs.
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned i = 0; i < sKey.size(); ++i) {
+        hash ^= (unsigned char)(sKey[i]);
+        hash *= 1099511628211ULL;
+    }
+    char szName[32];
+    sprintf(szName, "%08x%08x", unsigned(hash >> 32), unsigned(hash & 0xFFFFFFFF));
+    return string(szName) + DISK_CACHE_SUFFIX;
+}
+
+string DiskImageCache::getEntryPath(const string& sEntryName) const
+{
+    return m_sDir + "/" + sEntryName;
+}
+
+void DiskImageCache::readDir()
+{
+    Directory dir(m_sDir);
+    if (dir.open(true) != 0) {
+        AVG_LOG_WARNING("Image disk cache: Can't open or create directory " << m_sDir
+                << ".");
+        return;
+    }
+    DirEntryPtr pDirEntry = dir.getNextEntry();
+    while (pDirEntry) {
+        string sName = pDirEntry->getName();
+        if (getExtension(sName) == "tmp") {
+            // Left over from an interrupted write.
+            pDirEntry->remove();
+        } else if (sName.size() > DISK_CACHE_SUFFIX.size() &&
+                sName.compare(sName.size()-DISK_CACHE_SUFFIX.size(), string::npos,
+                        DISK_CACHE_SUFFIX) == 0)
+        {
+            struct stat entryStat;
+            if (stat(getEntryPath(sName).c_str(), &entryStat) == 0) {
+                addEntry(sName, entryStat.st_size, entryStat.st_mtime);
+            }
+        }
+        pDirEntry = dir.getNextEntry();
+    }
+}
+
+void DiskImageCache::addEntry(const string& sEntryName, long long size,
+        long long lastUse)
+{
+    Entry entry;
+    entry.m_Size = size;
+    entry.m_LastUse = lastUse;
+    m_Entries[sEntryName] = entry;
+    m_MemUsed += size;
+}
+
+void DiskImageCache::removeEntry(const string& sEntryName)
+{
+    EntryMap::iterator it = m_Entries.find(sEntryName);
+    if (it != m_Entries.end()) {
+        m_MemUsed -= it->second.m_Size;
+        m_Entries.erase(it);
+        unlink(getEntryPath(sEntryName).c_str());
+    }
+}
+
+void DiskImageCache::checkCapacity(const string& sKeepEntryName)
+{
+    while (m_MemUsed > m_Capacity) {
+        EntryMap::iterator itOldest = m_Entries.end();
+        for (EntryMap::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it) {
+            if (it->first != sKeepEntryName && (itOldest == m_Entries.end() ||
+                    it->second.m_LastUse < itOldest->second.m_LastUse))
+            {
+                itOldest = it;
+            }
+        }
+        if (itOldest == m_Entries.end()) {
+            break;
+        }
+        removeEntry(itOldest->first);
+    }
+}
+
+}
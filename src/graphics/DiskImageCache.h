@@ -0,0 +1,87 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _DiskImageCache_H_
+#define _DiskImageCache_H_
+
+#include "../api.h"
+
+#include "TexInfo.h"
+
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <map>
+
+namespace avg {
+
+class Bitmap;
+typedef boost::shared_ptr<Bitmap> BitmapPtr;
+
+// Persistent cache of decoded images. Each entry is a file that contains a header and
+// the raw pixels, so cached images can be memory-mapped instead of decoded. Entries are
+// keyed by source path, compression and channel order and are invalidated when the
+// modification time or size of the source file changes. If the cache grows larger
+// than its capacity, the least recently used entries are deleted.
+class AVG_API DiskImageCache
+{
+    public:
+        DiskImageCache(const std::string& sDir, long long capacity);
+        virtual ~DiskImageCache();
+
+        // Returns an empty pointer if there is no valid entry for the file.
+        BitmapPtr load(const std::string& sFilename, TexCompression compression);
+        void store(const std::string& sFilename, TexCompression compression,
+                BitmapPtr pBmp);
+
+        const std::string& getDir() const;
+        long long getCapacity() const;
+        long long getMemUsed() const;
+        int getNumHits() const;
+
+    private:
+        struct Entry {
+            long long m_Size;
+            long long m_LastUse;
+        };
+
+        std::string getEntryName(const std::string& sFilename,
+                TexCompression compression) const;
+        std::string getEntryPath(const std::string& sEntryName) const;
+        void readDir();
+        void addEntry(const std::string& sEntryName, long long size, long long lastUse);
+        void removeEntry(const std::string& sEntryName);
+        void checkCapacity(const std::string& sKeepEntryName);
+
+        std::string m_sDir;
+        long long m_Capacity;
+        long long m_MemUsed;
+        int m_NumHits;
+
+        typedef std::map<std::string, Entry> EntryMap;
+        EntryMap m_Entries;
+};
+
+typedef boost::shared_ptr<DiskImageCache> DiskImageCachePtr;
+
+}
+
+#endif
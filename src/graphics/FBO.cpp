@@ -139,12 +139,20 @@ void FBO::moveToPBO(int i) const
 {
     AVG_ASSERT(GLContext::getCurrent()->getMemoryMode() == MM_PBO);
 #ifndef AVG_ENABLE_EGL
+    moveToPBO(*m_pOutputPBO, i);
+#endif
+}
+
+#ifndef AVG_ENABLE_EGL
+void FBO::moveToPBO(PBO& pbo, int i) const
+{
     // Get data directly from the FBO using glReadBuffer. At least on NVidia/Linux, this 
     // is faster than reading stuff from the texture.
+    AVG_ASSERT(pbo.isReadPBO() && pbo.getSize() == getSize() && pbo.getPF() == getPF());
     copyToDestTexture();
     glproc::BindFramebuffer(GL_FRAMEBUFFER, m_OutputFBO); 
  
-    m_pOutputPBO->activate(); 
+    pbo.activate(); 
     GLContext::checkError("FBO::moveToPBO BindBuffer()"); 
     glReadBuffer(GL_COLOR_ATTACHMENT0+i); 
     GLContext::checkError("FBO::moveToPBO ReadBuffer()"); 
@@ -154,8 +162,8 @@ void FBO::moveToPBO(int i) const
     glReadPixels(0, 0, size.x, size.y, GLTexture::getGLFormat(pf),  
             GLTexture::getGLType(pf), 0); 
     GLContext::checkError("FBO::moveToPBO ReadPixels()");     
-#endif
 }
+#endif
  
 BitmapPtr FBO::getImageFromPBO() const
 {
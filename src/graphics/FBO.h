@@ -57,6 +57,9 @@ public:
     BitmapPtr getImage(int i=0) const;
     void moveToPBO(int i=0) const;
     BitmapPtr getImageFromPBO() const;
+#ifndef AVG_ENABLE_EGL
+    void moveToPBO(PBO& pbo, int i=0) const;
+#endif
     GLTexturePtr getTex(int i=0) const;
 
     static void checkError(const std::string& sContext);
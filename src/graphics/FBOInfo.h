@@ -41,13 +41,13 @@ public:
     virtual ~FBOInfo();
 
     const IntPoint& getSize() const;
+    PixelFormat getPF() const;
 
     static bool isFBOSupported();
     static bool isMultisampleFBOSupported();
     static bool isPackedDepthStencilSupported();
 
 protected:
-    PixelFormat getPF() const;
     unsigned getMultisampleSamples() const;
     bool getUsePackedDepthStencil() const;
     bool getUseStencil() const;
@@ -26,10 +26,118 @@
 
 #include <iostream>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define AVG_FLIP_SSE2
+    #include <emmintrin.h>
+#endif
+
+// SSSE3 isn't part of the x86 baseline, so it's compiled for its own target and 
+// selected at runtime.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define AVG_FLIP_SSSE3
+    #include <tmmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define AVG_TARGET_SSSE3
+    #else
+        #define AVG_TARGET_SSSE3 __attribute__((target("ssse3")))
+    #endif
+#endif
+
 using namespace std;
 
 namespace avg {
-    
+
+// Swaps bytes 0 and 2 of every 32 bit pixel. pSrc and pDest may be identical.
+static void flipLine32(const unsigned char* pSrc, unsigned char* pDest, int width)
+{
+    int x = 0;
+#ifdef AVG_FLIP_SSE2
+    __m128i keepMask = _mm_set1_epi32(int(0xFF00FF00));
+    __m128i lowMask = _mm_set1_epi32(0x000000FF);
+    for (; x+4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(pSrc+x*4));
+        __m128i flipped = _mm_or_si128(_mm_and_si128(pixels, keepMask),
+                _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pixels, lowMask), 16),
+                _mm_and_si128(_mm_srli_epi32(pixels, 16), lowMask)));
+        _mm_storeu_si128((__m128i*)(pDest+x*4), flipped);
+    }
+#endif
+    for (; x < width; ++x) {
+        unsigned char tmp = pSrc[x*4+REDPOS];
+        pDest[x*4+REDPOS] = pSrc[x*4+BLUEPOS];
+        pDest[x*4+GREENPOS] = pSrc[x*4+GREENPOS];
+        pDest[x*4+BLUEPOS] = tmp;
+        pDest[x*4+ALPHAPOS] = pSrc[x*4+ALPHAPOS];
+    }
+}
+
+#ifdef AVG_FLIP_SSSE3
+static bool cpuHasSSSE3()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+static bool hasSSSE3()
+{
+    static bool bHasSSSE3 = cpuHasSSSE3();
+    return bHasSSSE3;
+}
+
+// Converts 16 pixels per iteration and returns the number of pixels converted. The
+// three loads cover exactly 16 24 bit pixels, so nothing is read past the line.
+AVG_TARGET_SSSE3
+static int flipLine24To32SSSE3(const unsigned char* pSrc, unsigned char* pDest, 
+        int width)
+{
+    const __m128i shuffleMask = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 
+            8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i alpha = _mm_set1_epi32(int(0xFF000000));
+    int x = 0;
+    for (; x+16 <= width; x += 16) {
+        __m128i src0 = _mm_loadu_si128((const __m128i*)(pSrc+x*3));
+        __m128i src1 = _mm_loadu_si128((const __m128i*)(pSrc+x*3+16));
+        __m128i src2 = _mm_loadu_si128((const __m128i*)(pSrc+x*3+32));
+        // Move each group of 4 pixels to the start of a register.
+        __m128i pixels[4];
+        pixels[0] = src0;
+        pixels[1] = _mm_alignr_epi8(src1, src0, 12);
+        pixels[2] = _mm_alignr_epi8(src2, src1, 8);
+        pixels[3] = _mm_srli_si128(src2, 4);
+        for (int i = 0; i < 4; ++i) {
+            __m128i flipped = _mm_or_si128(_mm_shuffle_epi8(pixels[i], shuffleMask),
+                    alpha);
+            _mm_storeu_si128((__m128i*)(pDest+x*4+i*16), flipped);
+        }
+    }
+    return x;
+}
+#endif
+
+// Expands 24 bit pixels to 32 bit, swaps bytes 0 and 2 and sets alpha to 255.
+static void flipLine24To32(const unsigned char* pSrc, unsigned char* pDest, int width)
+{
+    int x = 0;
+#ifdef AVG_FLIP_SSSE3
+    if (hasSSSE3()) {
+        x = flipLine24To32SSSE3(pSrc, pDest, width);
+    }
+#endif
+    for (; x < width; ++x) {
+        pDest[x*4+REDPOS] = pSrc[x*3+BLUEPOS];
+        pDest[x*4+GREENPOS] = pSrc[x*3+GREENPOS];
+        pDest[x*4+BLUEPOS] = pSrc[x*3+REDPOS];
+        pDest[x*4+ALPHAPOS] = 255;
+    }
+}
+
 FilterFlipRGB::FilterFlipRGB(bool bChangePF)
     : Filter(),
       m_bChangePF(bChangePF)
@@ -74,11 +182,7 @@ void FilterFlipRGB::applyInPlace(BitmapPtr pBmp)
     for (int y = 0; y < size.y; y++) {
         unsigned char * pLine = pBmp->getPixels()+y*pBmp->getStride();
         if (pBmp->getBytesPerPixel() == 4) {
-            for (int x = 0; x < size.x; x++) { 
-                unsigned char tmp = pLine[x*4+REDPOS];
-                pLine[x*4+REDPOS] = pLine[x*4+BLUEPOS];
-                pLine[x*4+BLUEPOS] = tmp;
-            }
+            flipLine32(pLine, pLine, size.x);
         } else {
             for (int x = 0; x < size.x; x++) { 
                 unsigned char tmp = pLine[x*3+REDPOS];
@@ -89,4 +193,30 @@ void FilterFlipRGB::applyInPlace(BitmapPtr pBmp)
     }
 }
 
+void FilterFlipRGB::copyFlipped(const Bitmap& srcBmp, Bitmap& destBmp)
+{
+    int srcBPP = srcBmp.getBytesPerPixel();
+    int destBPP = destBmp.getBytesPerPixel();
+    AVG_ASSERT(srcBPP >= 3 && srcBPP <= 4 && destBPP >= 3 && destBPP <= 4);
+    int width = min(srcBmp.getSize().x, destBmp.getSize().x);
+    int height = min(srcBmp.getSize().y, destBmp.getSize().y);
+    for (int y = 0; y < height; y++) {
+        const unsigned char * pSrc = srcBmp.getPixels()+y*srcBmp.getStride();
+        unsigned char * pDest = destBmp.getPixels()+y*destBmp.getStride();
+        if (srcBPP == 4 && destBPP == 4) {
+            flipLine32(pSrc, pDest, width);
+        } else if (destBPP == 4) {
+            flipLine24To32(pSrc, pDest, width);
+        } else {
+            for (int x = 0; x < width; x++) { 
+                pDest[REDPOS] = pSrc[BLUEPOS];
+                pDest[GREENPOS] = pSrc[GREENPOS];
+                pDest[BLUEPOS] = pSrc[REDPOS];
+                pSrc += srcBPP;
+                pDest += 3;
+            }
+        }
+    }
+}
+
 } // namespace
@@ -35,6 +35,10 @@ public:
     virtual ~FilterFlipRGB();
     virtual void applyInPlace(BitmapPtr pBmp) ;
 
+    // Copies srcBmp to destBmp and flips R and B in the same pass, converting between
+    // 24 and 32 bpp if necessary. destBmp keeps its pixel format.
+    static void copyFlipped(const Bitmap& srcBmp, Bitmap& destBmp);
+
 private:
     bool m_bChangePF;
 };
@@ -30,6 +30,8 @@ namespace avg {
 using namespace std;
 
 GLConfig::GLConfig()
+    : m_bUseRenderBatching(true),
+      m_bUseTextureAtlas(true)
 {
 }
 
@@ -40,7 +42,9 @@ GLConfig::GLConfig(bool bGLES, bool bUsePOTTextures, bool bUsePixelBuffers,
       m_bUsePixelBuffers(bUsePixelBuffers),
       m_MultiSampleSamples(multiSampleSamples),
       m_ShaderUsage(shaderUsage),
-      m_bUseDebugContext(bUseDebugContext)
+      m_bUseDebugContext(bUseDebugContext),
+      m_bUseRenderBatching(true),
+      m_bUseTextureAtlas(true)
 {
 }
 
@@ -63,6 +67,10 @@ void GLConfig::log()
             "  Shader usage: " << sShader);
     AVG_TRACE(Logger::category::CONFIG, Logger::severity::INFO,
             "  Debug context: " << (m_bUseDebugContext?"true":"false"));
+    AVG_TRACE(Logger::category::CONFIG, Logger::severity::INFO,
+            "  Render batching: " << (m_bUseRenderBatching?"true":"false"));
+    AVG_TRACE(Logger::category::CONFIG, Logger::severity::INFO,
+            "  Texture atlas: " << (m_bUseTextureAtlas?"true":"false"));
 }
 
 std::string GLConfig::shaderUsageToString(ShaderUsage su)
@@ -44,6 +44,8 @@ struct AVG_API GLConfig {
     int m_MultiSampleSamples;
     ShaderUsage m_ShaderUsage;
     bool m_bUseDebugContext;
+    bool m_bUseRenderBatching;
+    bool m_bUseTextureAtlas;
 };
 
 }
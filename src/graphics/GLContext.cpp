@@ -23,6 +23,7 @@
 
 #include "ShaderRegistry.h"
 #include "StandardShader.h"
+#include "RenderBatcher.h"
 #include "GLContextManager.h"
 
 #include "../base/Backtrace.h"
@@ -132,10 +133,13 @@ void GLContext::init(const GLConfig& glConfig, bool bOwnsContext)
     checkError("init: glEnable(GL_STENCIL_TEST)");
 
     m_pStandardShader = new StandardShader(this);
+    m_pRenderBatcher = new RenderBatcher(this);
+    m_pRenderBatcher->setEnabled(m_GLConfig.m_bUseRenderBatching);
 }
 
 void GLContext::deleteObjects()
 {
+    delete m_pRenderBatcher;
     delete m_pStandardShader;
     for (unsigned i=0; i<m_FBOIDs.size(); ++i) {
         glproc::DeleteFramebuffers(1, &(m_FBOIDs[i]));
@@ -172,6 +176,11 @@ StandardShader* GLContext::getStandardShader()
     return m_pStandardShader;
 }
 
+RenderBatcher* GLContext::getRenderBatcher()
+{
+    return m_pRenderBatcher;
+}
+
 bool GLContext::useGPUYUVConversion() const
 {
     return (m_MajorGLVersion > 1) || isGLES();
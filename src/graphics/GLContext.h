@@ -38,6 +38,7 @@ typedef boost::shared_ptr<GLContext> GLContextPtr;
 class ShaderRegistry;
 typedef boost::shared_ptr<ShaderRegistry> ShaderRegistryPtr;
 class StandardShader;
+class RenderBatcher;
 
 class AVG_API GLContext
 {
@@ -48,6 +49,7 @@ public:
     virtual void activate()=0;
     ShaderRegistryPtr getShaderRegistry() const;
     StandardShader* getStandardShader();
+    RenderBatcher* getRenderBatcher();
     bool useGPUYUVConversion() const;
     GLConfig::ShaderUsage getShaderUsage() const;
 
@@ -72,6 +74,7 @@ public:
     bool arePBOsSupported();
     OGLMemoryMode getMemoryMode();
     bool isGLES() const;
+    void getVersion(int& major, int& minor) const;
     bool isVendor(const std::string& sWantedVendor) const;
     bool isRenderer(const std::string& sWantedRenderer) const;
     virtual bool useDepthBuffer() const;
@@ -95,7 +98,6 @@ protected:
     void init(const GLConfig& glConfig, bool bOwnsContext);
     void deleteObjects();
 
-    void getVersion(int& major, int& minor) const;
     bool ownsContext() const;
 
     void setCurrent();
@@ -110,6 +112,7 @@ private:
     
     ShaderRegistryPtr m_pShaderRegistry;
     StandardShader* m_pStandardShader;
+    RenderBatcher* m_pRenderBatcher;
 
     GLBufferCache m_PBOCache;
     std::vector<unsigned int> m_FBOIDs;
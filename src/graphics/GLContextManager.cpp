@@ -25,11 +25,14 @@
 #include "../base/Logger.h"
 #include "../base/Backtrace.h"
 #include "../base/ScopeTimer.h"
+#include "../base/StringHelper.h"
 
+#include "Bitmap.h"
 #include "GLTexture.h"
 #include "MCTexture.h"
 #include "VertexArray.h"
 #include "MCFBO.h"
+#include "TextureAtlas.h"
 #include "ShaderRegistry.h"
 
 #ifdef __APPLE__
@@ -63,6 +66,8 @@ bool GLContextManager::isActive()
 }
 
 GLContextManager::GLContextManager()
+    : m_bDeferredUploadsPlanned(false),
+      m_TexUploadBudget(0)
 {
 //    AVG_ASSERT(!s_pGLContextManager);
     s_pGLContextManager = this;
@@ -72,6 +77,10 @@ GLContextManager::~GLContextManager()
 {
     m_pPendingTexCreates.clear();
     m_pPendingTexUploads.clear();
+    m_PendingTexSubUploads.clear();
+    m_DeferredTexUploads.clear();
+    m_PlannedTexSlices.clear();
+    m_pTextureAtlases.clear();
     m_PendingTexDeletes.clear();
 
     m_pPendingFBOCreates.clear();
@@ -164,17 +173,33 @@ void GLContextManager::createShader(const string& sID)
     pContext->activate();
 }
 
-void GLContextManager::scheduleTexUpload(MCTexturePtr pTex, BitmapPtr pBmp)
+void GLContextManager::scheduleTexUpload(MCTexturePtr pTex, BitmapPtr pBmp,
+        bool bDeferred)
 {
-    m_pPendingTexUploads[pTex] = pBmp;
+    vector<DeferredTexUpload>::iterator it;
+    for (it=m_DeferredTexUploads.begin(); it!=m_DeferredTexUploads.end(); ++it) {
+        if (!it->m_bSubUpload && it->m_pTex == pTex) {
+            // The new bitmap replaces the old one completely.
+            m_DeferredTexUploads.erase(it);
+            break;
+        }
+    }
+    if (bDeferred && m_TexUploadBudget > 0) {
+        m_pPendingTexUploads.erase(pTex);
+        m_DeferredTexUploads.push_back(DeferredTexUpload(pTex, pBmp));
+        pTex->setUploadPending(true);
+    } else {
+        m_pPendingTexUploads[pTex] = pBmp;
+        pTex->setUploadPending(false);
+    }
 }
 
 MCTexturePtr GLContextManager::createTextureFromBmp(BitmapPtr pBmp, bool bMipmap,
-        bool bForcePOT, int potBorderColor)
+        bool bForcePOT, int potBorderColor, bool bDeferred)
 {
     MCTexturePtr pTex = createTexture(pBmp->getSize(), pBmp->getPixelFormat(), bMipmap,
             bForcePOT, potBorderColor);
-    scheduleTexUpload(pTex, pBmp);
+    scheduleTexUpload(pTex, pBmp, bDeferred);
     return pTex;
 }
 
@@ -183,6 +208,146 @@ void GLContextManager::deleteTexture(unsigned texID)
     m_PendingTexDeletes.push_back(texID);
 }
 
+void GLContextManager::scheduleTexSubUpload(MCTexturePtr pTex, BitmapPtr pBmp, 
+        const IntPoint& pos, bool bDeferred)
+{
+    vector<DeferredTexUpload>::iterator it;
+    for (it=m_DeferredTexUploads.begin(); it!=m_DeferredTexUploads.end(); ++it) {
+        if (it->m_bSubUpload && it->m_pBmp == pBmp) {
+            // The bitmap has moved, e.g. because its texture atlas was compacted.
+            m_DeferredTexUploads.erase(it);
+            break;
+        }
+    }
+    if (bDeferred && m_TexUploadBudget > 0) {
+        m_DeferredTexUploads.push_back(DeferredTexUpload(pTex, pBmp, true, pos));
+    } else {
+        m_PendingTexSubUploads.push_back(TexSubUpload(pTex, pBmp, pos));
+    }
+}
+
+bool GLContextManager::isTexSubUploadPending(const BitmapPtr& pBmp) const
+{
+    for (unsigned i=0; i<m_DeferredTexUploads.size(); ++i) {
+        const DeferredTexUpload& upload = m_DeferredTexUploads[i];
+        if (upload.m_bSubUpload && upload.m_pBmp == pBmp) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GLContextManager::prioritizeTexUpload(const MCTexturePtr& pTex)
+{
+    for (unsigned i=0; i<m_DeferredTexUploads.size(); ++i) {
+        if (!m_DeferredTexUploads[i].m_bSubUpload && 
+                m_DeferredTexUploads[i].m_pTex == pTex)
+        {
+            m_DeferredTexUploads[i].m_bPrioritized = true;
+            return;
+        }
+    }
+}
+
+void GLContextManager::prioritizeTexSubUpload(const BitmapPtr& pBmp)
+{
+    for (unsigned i=0; i<m_DeferredTexUploads.size(); ++i) {
+        DeferredTexUpload& upload = m_DeferredTexUploads[i];
+        if (upload.m_bSubUpload && upload.m_pBmp == pBmp) {
+            upload.m_bPrioritized = true;
+            return;
+        }
+    }
+}
+
+void GLContextManager::setTexUploadBudget(int numBytes)
+{
+    if (numBytes < 0) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE,
+                "Texture upload budget must be 0 or greater (was " +
+                toString(numBytes) + ").");
+    }
+    m_TexUploadBudget = numBytes;
+}
+
+int GLContextManager::getTexUploadBudget() const
+{
+    return m_TexUploadBudget;
+}
+
+int GLContextManager::getNumPendingTexUploads() const
+{
+    return int(m_DeferredTexUploads.size());
+}
+
+long long GLContextManager::getPendingTexUploadBytes() const
+{
+    long long numBytes = 0;
+    for (unsigned i=0; i<m_DeferredTexUploads.size(); ++i) {
+        numBytes += m_DeferredTexUploads[i].getBytesLeft();
+    }
+    return numBytes;
+}
+
+int GLContextManager::getTexUploadFramesToDrain() const
+{
+    long long numBytes = getPendingTexUploadBytes();
+    if (numBytes == 0) {
+        return 0;
+    } else if (m_TexUploadBudget == 0) {
+        return 1;
+    } else {
+        return int((numBytes+m_TexUploadBudget-1)/m_TexUploadBudget);
+    }
+}
+
+TextureAtlasEntryPtr GLContextManager::createAtlasEntryFromBmp(BitmapPtr pBmp,
+        bool bDeferred)
+{
+    GLContext* pContext = GLContext::getCurrent();
+    if (!pContext || !pContext->getConfig().m_bUseTextureAtlas ||
+            pixelFormatIsCompressed(pBmp->getPixelFormat()))
+    {
+        return TextureAtlasEntryPtr();
+    }
+    IntPoint pageSize(1024, 1024);
+    if (pContext->getMaxTexSize() < pageSize.x) {
+        pageSize = IntPoint(pContext->getMaxTexSize(), pContext->getMaxTexSize());
+    }
+    if (!TextureAtlas::fits(pBmp->getSize(), pageSize)) {
+        return TextureAtlasEntryPtr();
+    }
+    PixelFormat pf = pBmp->getPixelFormat();
+    TextureAtlasPtr& pAtlas = m_pTextureAtlases[pf];
+    if (!pAtlas) {
+        pAtlas = TextureAtlasPtr(new TextureAtlas(pf, pageSize));
+    }
+    return pAtlas->addBitmap(pBmp, bDeferred);
+}
+
+static ProfilingZoneID CompactAtlasProfilingZone("Compact texture atlases");
+
+void GLContextManager::compactTextureAtlases()
+{
+    ScopeTimer timer(CompactAtlasProfilingZone);
+    TextureAtlasMap::iterator it;
+    for (it=m_pTextureAtlases.begin(); it!=m_pTextureAtlases.end(); ++it) {
+        if (it->second->needsCompaction()) {
+            it->second->compact();
+        }
+    }
+}
+
+int GLContextManager::getNumAtlasPages() const
+{
+    int numPages = 0;
+    TextureAtlasMap::const_iterator it;
+    for (it=m_pTextureAtlases.begin(); it!=m_pTextureAtlases.end(); ++it) {
+        numPages += it->second->getNumPages();
+    }
+    return numPages;
+}
+
 VertexArrayPtr GLContextManager::createVertexArray(int reserveVerts,
         int reserveIndexes)
 {
@@ -237,6 +402,12 @@ void GLContextManager::uploadDataForContext()
         BitmapPtr pBmp = it->second;
         pTex->moveBmpToTexture(pContext, pBmp);
     }
+    uploadDeferredTexSlices(pContext);
+
+    for (unsigned i=0; i<m_PendingTexSubUploads.size(); ++i) {
+        TexSubUpload& upload = m_PendingTexSubUploads[i];
+        upload.m_pTex->moveBmpToSubTexture(pContext, upload.m_pBmp, upload.m_Pos);
+    }
 
     for (unsigned i=0; i<m_pPendingFBOCreates.size(); ++i) {
         m_pPendingFBOCreates[i]->initForGLContext();
@@ -255,6 +426,8 @@ void GLContextManager::reset()
     m_PendingTexDeletes.clear();
     m_pPendingTexCreates.clear();
     m_pPendingTexUploads.clear();
+    m_PendingTexSubUploads.clear();
+    finishDeferredTexUploads();
 
     m_pPendingFBOCreates.clear();
     m_pPendingShaderParamCreates.clear();
@@ -263,6 +436,160 @@ void GLContextManager::reset()
     m_PendingBufferDeletes.clear();
 }
 
+static ProfilingZoneID DeferredUploadProfilingZone("Deferred texture uploads");
+
+void GLContextManager::planDeferredTexUploads()
+{
+    // Every context gets exactly the same slices, so the plan is made once per pass.
+    m_bDeferredUploadsPlanned = true;
+    AVG_ASSERT(m_PlannedTexSlices.empty());
+    // Prioritized (i.e. visible) textures first, everything else in scheduling order.
+    vector<DeferredTexUpload*> pUploads;
+    for (unsigned i=0; i<m_DeferredTexUploads.size(); ++i) {
+        if (m_DeferredTexUploads[i].m_bPrioritized) {
+            pUploads.push_back(&m_DeferredTexUploads[i]);
+        }
+    }
+    for (unsigned i=0; i<m_DeferredTexUploads.size(); ++i) {
+        if (!m_DeferredTexUploads[i].m_bPrioritized) {
+            pUploads.push_back(&m_DeferredTexUploads[i]);
+        }
+    }
+
+    long long bytesLeft = m_TexUploadBudget;
+    for (unsigned i=0; i<pUploads.size(); ++i) {
+        DeferredTexUpload& upload = *pUploads[i];
+        IntPoint size = upload.m_pBmp->getSize();
+        int rowsLeft = size.y-upload.m_NumRowsDone;
+        if (upload.m_pTex.unique() || (upload.m_bSubUpload && upload.m_pBmp.unique())) {
+            // Nobody uses the texture or the atlas entry anymore.
+            upload.m_NumRowsPlanned = rowsLeft;
+            continue;
+        }
+        int numRows = rowsLeft;
+        if (m_TexUploadBudget != 0) {
+            if (bytesLeft <= 0) {
+                break;
+            }
+            PixelFormat pf = upload.m_pBmp->getPixelFormat();
+            // Mipmaps would be regenerated after every slice, and glTexSubImage2D can't
+            // handle arbitrary strides, so these textures are uploaded in one piece.
+            // Compressed textures are kept in one piece as well.
+            bool bTileable = !upload.m_pTex->getUseMipmap() && 
+                    !pixelFormatIsCompressed(pf) &&
+                    upload.m_pBmp->getStride() == Bitmap::getPreferredStride(size.x, pf);
+            int rowBytes = upload.m_pBmp->getLineLen();
+            if (bTileable) {
+                numRows = int(min<long long>(rowsLeft, bytesLeft/rowBytes));
+            } else if (upload.getBytesLeft() > bytesLeft) {
+                numRows = 0;
+            }
+            if (numRows == 0) {
+                if (m_PlannedTexSlices.empty()) {
+                    // Budget too small: Make at least some progress every frame.
+                    numRows = bTileable ? 1 : rowsLeft;
+                } else {
+                    break;
+                }
+            }
+            if (bTileable) {
+                bytesLeft -= (long long)(numRows)*rowBytes;
+            } else {
+                bytesLeft -= upload.getBytesLeft();
+            }
+        }
+        upload.m_NumRowsPlanned = numRows;
+        m_PlannedTexSlices.push_back(TexSlice(upload, numRows));
+    }
+}
+
+void GLContextManager::uploadDeferredTexSlices(GLContext* pContext)
+{
+    if (!m_bDeferredUploadsPlanned) {
+        planDeferredTexUploads();
+    }
+    ScopeTimer timer(DeferredUploadProfilingZone);
+    for (unsigned i=0; i<m_PlannedTexSlices.size(); ++i) {
+        TexSlice& slice = m_PlannedTexSlices[i];
+        IntPoint size = slice.m_pBmp->getSize();
+        if (slice.m_StartRow == 0 && slice.m_NumRows == size.y) {
+            if (slice.m_bSubUpload) {
+                slice.m_pTex->moveBmpToSubTexture(pContext, slice.m_pBmp, slice.m_Pos);
+            } else {
+                // Whole texture: Use the context's texture mover (i.e. a PBO if 
+                // enabled).
+                slice.m_pTex->moveBmpToTexture(pContext, slice.m_pBmp);
+            }
+        } else {
+            IntRect rect(0, slice.m_StartRow, size.x, slice.m_StartRow+slice.m_NumRows);
+            BitmapPtr pSliceBmp(new Bitmap(*slice.m_pBmp, rect));
+            slice.m_pTex->moveBmpToSubTexture(pContext, pSliceBmp, slice.m_Pos+rect.tl);
+        }
+    }
+}
+
+void GLContextManager::finishDeferredTexUploads()
+{
+    m_PlannedTexSlices.clear();
+    m_bDeferredUploadsPlanned = false;
+    vector<DeferredTexUpload>::iterator it = m_DeferredTexUploads.begin();
+    while (it != m_DeferredTexUploads.end()) {
+        it->m_NumRowsDone += it->m_NumRowsPlanned;
+        it->m_NumRowsPlanned = 0;
+        if (it->m_NumRowsDone >= it->m_pBmp->getSize().y) {
+            // Nodes decide whether to render the texture in preRender(), so the
+            // texture becomes usable in the next frame. Atlas pages are shared, so 
+            // they are never marked as pending.
+            if (!it->m_bSubUpload) {
+                it->m_pTex->setUploadPending(false);
+            }
+            it = m_DeferredTexUploads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+GLContextManager::DeferredTexUpload::DeferredTexUpload(MCTexturePtr pTex,
+        BitmapPtr pBmp, bool bSubUpload, const IntPoint& pos)
+    : m_pTex(pTex),
+      m_pBmp(pBmp),
+      m_bSubUpload(bSubUpload),
+      m_Pos(pos),
+      m_NumRowsDone(0),
+      m_NumRowsPlanned(0),
+      m_bPrioritized(false)
+{
+}
+
+long long GLContextManager::DeferredTexUpload::getBytesLeft() const
+{
+    if (pixelFormatIsCompressed(m_pBmp->getPixelFormat())) {
+        // Compressed bitmaps are always uploaded in one piece.
+        return m_NumRowsDone == 0 ? m_pBmp->getMemNeeded() : 0;
+    }
+    IntPoint size = m_pBmp->getSize();
+    return (long long)(size.y-m_NumRowsDone)*m_pBmp->getLineLen();
+}
+
+GLContextManager::TexSlice::TexSlice(const DeferredTexUpload& upload, int numRows)
+    : m_pTex(upload.m_pTex),
+      m_pBmp(upload.m_pBmp),
+      m_bSubUpload(upload.m_bSubUpload),
+      m_Pos(upload.m_Pos),
+      m_StartRow(upload.m_NumRowsDone),
+      m_NumRows(numRows)
+{
+}
+
+GLContextManager::TexSubUpload::TexSubUpload(MCTexturePtr pTex, BitmapPtr pBmp,
+        const IntPoint& pos)
+    : m_pTex(pTex),
+      m_pBmp(pBmp),
+      m_Pos(pos)
+{
+}
+
 bool GLContextManager::isGLESSupported()
 {
 #if defined __linux__
@@ -43,6 +43,10 @@ class VertexArray;
 typedef boost::shared_ptr<VertexArray> VertexArrayPtr;
 class MCFBO;
 typedef boost::shared_ptr<MCFBO> MCFBOPtr;
+class TextureAtlas;
+typedef boost::shared_ptr<TextureAtlas> TextureAtlasPtr;
+class TextureAtlasEntry;
+typedef boost::shared_ptr<TextureAtlasEntry> TextureAtlasEntryPtr;
 
 class AVG_API GLContextManager
 {
@@ -75,10 +79,33 @@ public:
         return pParam;
     }
 
-    void scheduleTexUpload(MCTexturePtr pTex, BitmapPtr pBmp);
+    // Deferred uploads are spread over several frames if there is an upload budget.
+    // Until they are complete, MCTexture::isUploadPending() returns true.
+    void scheduleTexUpload(MCTexturePtr pTex, BitmapPtr pBmp, bool bDeferred=false);
     MCTexturePtr createTextureFromBmp(BitmapPtr pBmp, bool bMipmap=false, 
-            bool bForcePOT=false, int potBorderColor=0);
+            bool bForcePOT=false, int potBorderColor=0, bool bDeferred=false);
     void deleteTexture(unsigned texID);
+    // Deferred sub-uploads are identified by their bitmap. A new upload of the same
+    // bitmap replaces a deferred one.
+    void scheduleTexSubUpload(MCTexturePtr pTex, BitmapPtr pBmp, const IntPoint& pos,
+            bool bDeferred=false);
+    bool isTexSubUploadPending(const BitmapPtr& pBmp) const;
+
+    // Moves a deferred upload to the front of the queue, e.g. because the texture is
+    // visible.
+    void prioritizeTexUpload(const MCTexturePtr& pTex);
+    void prioritizeTexSubUpload(const BitmapPtr& pBmp);
+    // Max. number of bytes of deferred uploads per frame. 0 means no limit.
+    void setTexUploadBudget(int numBytes);
+    int getTexUploadBudget() const;
+    int getNumPendingTexUploads() const;
+    long long getPendingTexUploadBytes() const;
+    int getTexUploadFramesToDrain() const;
+
+    // Returns an empty pointer if the bitmap can't be placed in an atlas.
+    TextureAtlasEntryPtr createAtlasEntryFromBmp(BitmapPtr pBmp, bool bDeferred=false);
+    void compactTextureAtlases();
+    int getNumAtlasPages() const;
 
     VertexArrayPtr createVertexArray(int reserveVerts = 0, int reserveIndexes = 0);
     typedef std::map<const GLContext*, unsigned> BufferIDMap;
@@ -91,12 +118,53 @@ public:
     static bool isGLESSupported();
 
 private:
+    void planDeferredTexUploads();
+    void uploadDeferredTexSlices(GLContext* pContext);
+    void finishDeferredTexUploads();
+
     std::vector<GLContext*> m_pContexts;
 
     std::vector<MCTexturePtr> m_pPendingTexCreates;
     typedef std::map<MCTexturePtr, BitmapPtr> TexUploadMap;
     TexUploadMap m_pPendingTexUploads;
     std::vector<unsigned> m_PendingTexDeletes;
+    struct TexSubUpload {
+        TexSubUpload(MCTexturePtr pTex, BitmapPtr pBmp, const IntPoint& pos);
+        MCTexturePtr m_pTex;
+        BitmapPtr m_pBmp;
+        IntPoint m_Pos;
+    };
+    std::vector<TexSubUpload> m_PendingTexSubUploads;
+
+    struct DeferredTexUpload {
+        DeferredTexUpload(MCTexturePtr pTex, BitmapPtr pBmp, bool bSubUpload=false,
+                const IntPoint& pos=IntPoint(0,0));
+        long long getBytesLeft() const;
+        MCTexturePtr m_pTex;
+        BitmapPtr m_pBmp;
+        bool m_bSubUpload;
+        IntPoint m_Pos;
+        int m_NumRowsDone;
+        int m_NumRowsPlanned;
+        bool m_bPrioritized;
+    };
+    std::vector<DeferredTexUpload> m_DeferredTexUploads;
+    // Rows of deferred uploads that are uploaded to all contexts in the current pass.
+    struct TexSlice {
+        TexSlice(const DeferredTexUpload& upload, int numRows);
+        MCTexturePtr m_pTex;
+        BitmapPtr m_pBmp;
+        bool m_bSubUpload;
+        IntPoint m_Pos;
+        int m_StartRow;
+        int m_NumRows;
+    };
+    std::vector<TexSlice> m_PlannedTexSlices;
+    bool m_bDeferredUploadsPlanned;
+    int m_TexUploadBudget;
+
+    typedef std::map<PixelFormat, TextureAtlasPtr> TextureAtlasMap;
+    TextureAtlasMap m_pTextureAtlases;
 
     std::vector<MCFBOPtr> m_pPendingFBOCreates;
     std::vector<MCShaderParamPtr> m_pPendingShaderParamCreates;
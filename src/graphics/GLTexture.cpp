@@ -80,9 +80,16 @@ void GLTexture::init()
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     IntPoint size = getGLSize();
     PixelFormat pf = getPF();
-    glTexImage2D(GL_TEXTURE_2D, 0, getGLInternalFormat(), size.x, size.y, 0,
-            getGLFormat(pf), getGLType(pf), 0);
-    GLContext::checkError("GLTexture: glTexImage2D()");
+    if (pixelFormatIsCompressed(pf)) {
+        // Storage is allocated by the first upload (see moveBmpToSubTexture()), so
+        // the real data can usually be uploaded at once.
+        m_bStorageAllocated = false;
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, getGLInternalFormat(), size.x, size.y, 0,
+                getGLFormat(pf), getGLType(pf), 0);
+        GLContext::checkError("GLTexture: glTexImage2D()");
+        m_bStorageAllocated = true;
+    }
     if (getUseMipmap()) {
         glproc::GenerateMipmap(GL_TEXTURE_2D);
         GLContext::checkError("GLTexture::GLTexture generateMipmap()");
@@ -93,7 +100,7 @@ void GLTexture::init()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_WrapMode.getS());
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_WrapMode.getT());
 
-    if (getUsePOT()) {
+    if (getUsePOT() && !pixelFormatIsCompressed(pf)) {
         // Make sure the texture is transparent and black before loading stuff 
         // into it to avoid garbage at the borders.
         // In the case of UV textures, we set the border color to 128...
@@ -129,6 +136,12 @@ void GLTexture::generateMipmaps()
 
 void GLTexture::moveBmpToTexture(BitmapPtr pBmp)
 {
+    if (pixelFormatIsCompressed(getPF())) {
+        // Compressed data is uploaded as-is, so there's nothing a TextureMover could
+        // add.
+        moveBmpToSubTexture(pBmp, IntPoint(0,0));
+        return;
+    }
     unsigned usage = GL_DYNAMIC_DRAW;
     if (getPF() == A8 && m_pContext->isVendor("ATI")) {
         // Workaround for https://github.com/libavg/libavg/issues/687
@@ -138,8 +151,69 @@ void GLTexture::moveBmpToTexture(BitmapPtr pBmp)
     pMover->moveBmpToTexture(pBmp, *this);
 }
 
+void GLTexture::moveBmpToSubTexture(BitmapPtr pBmp, const IntPoint& pos)
+{
+    AVG_ASSERT(pBmp->getPixelFormat() == getPF());
+    IntPoint size = pBmp->getSize();
+    AVG_ASSERT(pos.x >= 0 && pos.y >= 0 && pos.x+size.x <= getGLSize().x &&
+            pos.y+size.y <= getGLSize().y);
+    activate(WrapMode());
+    if (pixelFormatIsCompressed(getPF())) {
+        AVG_ASSERT(pos.x%4 == 0 && pos.y%4 == 0);
+        AVG_ASSERT(pBmp->getStride() == pBmp->getLineLen());
+        if (!m_bStorageAllocated) {
+            m_bStorageAllocated = true;
+            if (pos == IntPoint(0,0) && size == getGLSize()) {
+                glproc::CompressedTexImage2D(GL_TEXTURE_2D, 0, getGLInternalFormat(),
+                        size.x, size.y, 0, pBmp->getMemNeeded(), pBmp->getPixels());
+                GLContext::checkError(
+                        "GLTexture::moveBmpToSubTexture: glCompressedTexImage2D()");
+                return;
+            }
+            allocEmptyCompressedStorage();
+        }
+        glproc::CompressedTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y,
+                getGLInternalFormat(), pBmp->getMemNeeded(), pBmp->getPixels());
+        GLContext::checkError(
+                "GLTexture::moveBmpToSubTexture: glCompressedTexSubImage2D()");
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y,
+                getGLFormat(getPF()), getGLType(getPF()), pBmp->getPixels());
+        GLContext::checkError("GLTexture::moveBmpToSubTexture: glTexSubImage2D()");
+    }
+    generateMipmaps();
+}
+
+void GLTexture::allocEmptyCompressedStorage()
+{
+    // Fills the texture with transparent black blocks. All-zero blocks decode to 
+    // black in the BC and ETC2 formats, but are illegal in ASTC and decode to the 
+    // error color there, so ASTC gets void-extent (constant color) blocks.
+    PixelFormat pf = getPF();
+    IntPoint size = getGLSize();
+    int texMemNeeded = getMemNeeded();
+    unsigned char * pBlocks = new unsigned char[texMemNeeded];
+    memset(pBlocks, 0, texMemNeeded);
+    if (pf == ASTC_4x4) {
+        static const unsigned char voidExtentHeader[] =
+                {0xFC, 0xFD, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        int bytesPerBlock = getBytesPerBlock(pf);
+        for (int i=0; i<texMemNeeded; i+=bytesPerBlock) {
+            memcpy(pBlocks+i, voidExtentHeader, sizeof(voidExtentHeader));
+        }
+    }
+    glproc::CompressedTexImage2D(GL_TEXTURE_2D, 0, getGLInternalFormat(), 
+            size.x, size.y, 0, texMemNeeded, pBlocks);
+    GLContext::checkError("GLTexture::allocEmptyCompressedStorage()");
+    delete[] pBlocks;
+}
+
 BitmapPtr GLTexture::moveTextureToBmp(int mipmapLevel)
 {
+    if (pixelFormatIsCompressed(getPF())) {
+        throw Exception(AVG_ERR_UNSUPPORTED, 
+                "Compressed textures can't be read back to a bitmap.");
+    }
     TextureMoverPtr pMover = TextureMover::create(getGLSize(), getPF(), GL_DYNAMIC_READ);
     return pMover->moveTextureToBmp(*this, mipmapLevel);
 }
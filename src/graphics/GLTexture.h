@@ -48,16 +48,20 @@ public:
     void generateMipmaps();
 
     void moveBmpToTexture(BitmapPtr pBmp);
+    void moveBmpToSubTexture(BitmapPtr pBmp, const IntPoint& pos);
     BitmapPtr moveTextureToBmp(int mipmapLevel=0);
 
     unsigned getID() const;
 
 private:
+    void allocEmptyCompressedStorage();
+
     GLContext* m_pContext;
 
     WrapMode m_WrapMode;
     static unsigned s_LastTexID;
     unsigned m_TexID;
+    bool m_bStorageAllocated;
 };
 
 typedef boost::shared_ptr<GLTexture> GLTexturePtr;
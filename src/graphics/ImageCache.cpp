@@ -25,6 +25,7 @@
 #include "../base/OSHelper.h"
 #include "../base/ConfigMgr.h"
 #include "../base/Logger.h"
+#include "../base/StringHelper.h"
 
 using namespace std;
 
@@ -63,6 +64,11 @@ ImageCache::ImageCache()
     AVG_TRACE(Logger::category::CONFIG, Logger::severity::INFO,
             "Image cache size: CPU=" << m_CPUCacheCapacity/(1024*1024) <<
             "MB, GPU=" << m_GPUCacheCapacity/(1024*1024) << "MB" << endl);
+
+    string sDiskCacheDir;
+    ConfigMgr::get()->getStringOption("scr", "imgdiskcache", "", sDiskCacheDir);
+    int diskCacheSize = ConfigMgr::get()->getIntOption("scr", "imgdiskcachesize", 1024);
+    setDiskCache(sDiskCacheDir, (long long)(diskCacheSize)*1024*1024);
 }
 
 ImageCache::~ImageCache()
@@ -115,6 +121,16 @@ CachedImagePtr ImageCache::getImage(const std::string& sFilename,
     return pImg;
 }
 
+CachedImagePtr ImageCache::findImage(const std::string& sFilename) const
+{
+    ImageMap::const_iterator it = m_pImageMap.find(sFilename);
+    if (it == m_pImageMap.end()) {
+        return CachedImagePtr();
+    } else {
+        return *(it->second);
+    }
+}
+
 void ImageCache::onTexLoad(const std::string& sFilename)
 {
     CachedImagePtr pImg = *(m_pImageMap[sFilename]);
@@ -170,6 +186,25 @@ int ImageCache::getNumGPUImages() const
     return numGPUImages;
 }
 
+void ImageCache::setDiskCache(const std::string& sDir, long long capacity)
+{
+    if (sDir == "") {
+        m_pDiskCache = DiskImageCachePtr();
+    } else {
+        if (capacity < 0) {
+            throw Exception(AVG_ERR_OUT_OF_RANGE,
+                    "Disk cache capacity must be 0 or greater (was " + 
+                    toString(capacity) + ").");
+        }
+        m_pDiskCache = DiskImageCachePtr(new DiskImageCache(sDir, capacity));
+    }
+}
+
+DiskImageCache* ImageCache::getDiskCache()
+{
+    return m_pDiskCache.get();
+}
+
 void ImageCache::unloadAllTextures()
 {
     for (LRUListType::const_iterator it=m_pLRUList.begin(); it!=m_pLRUList.end(); ++it) {
@@ -27,6 +27,7 @@
 #include "../base/GLMHelper.h"
 
 #include "CachedImage.h"
+#include "DiskImageCache.h"
 #include "TexInfo.h"
 
 #include <boost/shared_ptr.hpp>
@@ -55,12 +56,20 @@ class AVG_API ImageCache
         long long getMemUsed(CachedImage::StorageType st);
         CachedImagePtr getImage(const std::string& sFilename,
                 TexCompression compression);
+        // Returns an empty pointer if the image isn't cached. Doesn't change reference
+        // counts.
+        CachedImagePtr findImage(const std::string& sFilename) const;
         void onTexLoad(const std::string& sFilename);
         void onImageUnused(const std::string& sFilename, CachedImage::StorageType st);
         void onSizeChange(int sizeDiff, CachedImage::StorageType st);
         int getNumCPUImages() const;
         int getNumGPUImages() const;
 
+        // An empty directory disables the disk cache.
+        void setDiskCache(const std::string& sDir, long long capacity);
+        // Returns 0 if there is no disk cache.
+        DiskImageCache* getDiskCache();
+
         void unloadAllTextures();
         void dump() const;
 
@@ -90,6 +99,8 @@ class AVG_API ImageCache
         long long m_CPUCacheUsed;
         long long m_GPUCacheUsed;
 
+        DiskImageCachePtr m_pDiskCache;
+
         static ImageCache * s_pImageCache;
 };
 
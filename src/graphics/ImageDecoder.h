@@ -0,0 +1,63 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _ImageDecoder_H_
+#define _ImageDecoder_H_
+
+#include "../api.h"
+#include "PixelFormat.h"
+
+#include "../base/GLMHelper.h"
+#include "../base/UTF8String.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace avg {
+
+class Bitmap;
+typedef boost::shared_ptr<Bitmap> BitmapPtr;
+
+class ImageDecoder;
+typedef boost::shared_ptr<ImageDecoder> ImageDecoderPtr;
+
+// Decodes one family of image file formats. Decoders are registered with the
+// BitmapLoader and must be usable from several threads at once.
+class AVG_API ImageDecoder {
+public:
+    ImageDecoder();
+    virtual ~ImageDecoder();
+
+    // pHeader contains the first headerSize bytes of the file.
+    virtual bool canDecode(const unsigned char* pHeader, int headerSize) const = 0;
+
+    // Decodes straight into a bitmap of the requested pixel format if the decoder
+    // supports it; otherwise, the BitmapLoader converts the result. Returns an empty
+    // pointer if the file uses features the decoder can't handle. If targetSize is
+    // nonzero, the decoder may return a smaller image that is still at least as large
+    // as targetSize.
+    virtual BitmapPtr decode(const UTF8String& sFName, PixelFormat pf,
+            const IntPoint& targetSize) const = 0;
+};
+
+}
+
+#endif
@@ -45,6 +45,7 @@ public:
     virtual ~ImagingProjection();
 
     void setColor(const Pixel32& color);
+    void setTexCoordRect(const FRect& texCoordRect);
     void draw(GLContext* pContext, const OGLShaderPtr& pShader);
 
 private:
@@ -53,6 +54,7 @@ private:
     IntPoint m_SrcSize;
     IntRect m_DestRect;
     IntPoint m_Offset;
+    FRect m_TexCoordRect;
     Pixel32 m_Color;
     VertexArrayPtr m_pVA;
     Mat4fGLShaderParamPtr m_pTransformParam;
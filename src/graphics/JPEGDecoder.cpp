@@ -0,0 +1,232 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "JPEGDecoder.h"
+
+#include "Bitmap.h"
+#include "BitmapLoader.h"
+
+#include "../base/Exception.h"
+#include "../base/ScopeTimer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+#include <vector>
+
+using namespace std;
+
+namespace avg {
+
+// libjpeg errors are handled by longjmp()ing back to the caller, so all code that calls
+// into libjpeg lives in functions that have no objects with destructors.
+struct JPEGReadState {
+    jpeg_decompress_struct m_CInfo;
+    jpeg_error_mgr m_ErrorMgr;
+    jmp_buf m_JmpBuf;
+    char m_szError[JMSG_LENGTH_MAX];
+};
+
+static void onJPEGError(j_common_ptr pCInfo)
+{
+    JPEGReadState* pState = (JPEGReadState*)pCInfo->client_data;
+    (*pCInfo->err->format_message)(pCInfo, pState->m_szError);
+    longjmp(pState->m_JmpBuf, 1);
+}
+
+static void onJPEGMessage(j_common_ptr pCInfo)
+{
+}
+
+static bool readJPEGHeader(JPEGReadState* pState, FILE* pFile)
+{
+    jpeg_decompress_struct* pCInfo = &pState->m_CInfo;
+    if (setjmp(pState->m_JmpBuf)) {
+        return false;
+    }
+    jpeg_stdio_src(pCInfo, pFile);
+    jpeg_read_header(pCInfo, TRUE);
+    return true;
+}
+
+static bool readJPEGImage(JPEGReadState* pState, J_COLOR_SPACE colorSpace,
+        int scaleDenom, JSAMPARRAY ppRows)
+{
+    jpeg_decompress_struct* pCInfo = &pState->m_CInfo;
+    if (setjmp(pState->m_JmpBuf)) {
+        return false;
+    }
+    pCInfo->out_color_space = colorSpace;
+    pCInfo->scale_num = 1;
+    pCInfo->scale_denom = scaleDenom;
+    jpeg_start_decompress(pCInfo);
+    while (pCInfo->output_scanline < pCInfo->output_height) {
+        jpeg_read_scanlines(pCInfo, ppRows+pCInfo->output_scanline,
+                pCInfo->output_height-pCInfo->output_scanline);
+    }
+    jpeg_finish_decompress(pCInfo);
+    return true;
+}
+
+static bool calcJPEGOutputSize(JPEGReadState* pState, int scaleDenom, IntPoint& size)
+{
+    jpeg_decompress_struct* pCInfo = &pState->m_CInfo;
+    if (setjmp(pState->m_JmpBuf)) {
+        return false;
+    }
+    pCInfo->scale_num = 1;
+    pCInfo->scale_denom = scaleDenom;
+    jpeg_calc_output_dimensions(pCInfo);
+    size = IntPoint(pCInfo->output_width, pCInfo->output_height);
+    return true;
+}
+
+static int getScaleDenom(const IntPoint& imageSize, const IntPoint& targetSize)
+{
+    if (targetSize.x <= 0 && targetSize.y <= 0) {
+        return 1;
+    }
+    int scaleDenom = 8;
+    while (scaleDenom > 1 &&
+            ((imageSize.x+scaleDenom-1)/scaleDenom < targetSize.x ||
+             (imageSize.y+scaleDenom-1)/scaleDenom < targetSize.y))
+    {
+        scaleDenom /= 2;
+    }
+    return scaleDenom;
+}
+
+// Returns the libjpeg output color space that matches pf or JCS_UNKNOWN if libjpeg
+// can't deliver pf.
+static J_COLOR_SPACE getColorSpace(PixelFormat pf)
+{
+    switch (pf) {
+        case I8:
+            return JCS_GRAYSCALE;
+        case R8G8B8:
+            return JCS_RGB;
+#ifdef JCS_EXTENSIONS
+        case B8G8R8:
+            return JCS_EXT_BGR;
+        case B8G8R8A8:
+            return JCS_EXT_BGRA;
+        case B8G8R8X8:
+            return JCS_EXT_BGRX;
+        case R8G8B8A8:
+            return JCS_EXT_RGBA;
+        case R8G8B8X8:
+            return JCS_EXT_RGBX;
+#endif
+        default:
+            return JCS_UNKNOWN;
+    }
+}
+
+JPEGDecoder::JPEGDecoder()
+{
+}
+
+JPEGDecoder::~JPEGDecoder()
+{
+}
+
+bool JPEGDecoder::canDecode(const unsigned char* pHeader, int headerSize) const
+{
+    return headerSize >= 3 && pHeader[0] == 0xFF && pHeader[1] == 0xD8 &&
+            pHeader[2] == 0xFF;
+}
+
+static ProfilingZoneID JPEGDecodeProfilingZone("libjpeg decode", true);
+
+BitmapPtr JPEGDecoder::decode(const UTF8String& sFName, PixelFormat pf,
+        const IntPoint& targetSize) const
+{
+    ScopeTimer timer(JPEGDecodeProfilingZone);
+    FILE* pFile = fopen(sFName.c_str(), "rb");
+    if (!pFile) {
+        return BitmapPtr();
+    }
+    JPEGReadState state;
+    memset(state.m_szError, 0, sizeof(state.m_szError));
+    state.m_CInfo.err = jpeg_std_error(&state.m_ErrorMgr);
+    state.m_ErrorMgr.error_exit = onJPEGError;
+    state.m_ErrorMgr.output_message = onJPEGMessage;
+    jpeg_create_decompress(&state.m_CInfo);
+    state.m_CInfo.client_data = &state;
+
+    BitmapPtr pBmp;
+    bool bOK = readJPEGHeader(&state, pFile);
+    bool bSupported = true;
+    PixelFormat convertPF = NO_PIXELFORMAT;
+    if (bOK) {
+        J_COLOR_SPACE srcColorSpace = state.m_CInfo.jpeg_color_space;
+        if (srcColorSpace == JCS_CMYK || srcColorSpace == JCS_YCCK) {
+            // Adobe CMYK jpegs need inversion handling that libjpeg doesn't do.
+            bSupported = false;
+        }
+    }
+    if (bOK && bSupported) {
+        PixelFormat destPF = pf;
+        J_COLOR_SPACE colorSpace = getColorSpace(destPF);
+        if (colorSpace == JCS_UNKNOWN) {
+            destPF = BitmapLoader::get()->getDefaultPixelFormat(false);
+            colorSpace = getColorSpace(destPF);
+            if (colorSpace == JCS_UNKNOWN) {
+                // libjpeg can't decode to 32 bit without JCS_EXTENSIONS, so we
+                // decode to RGB and convert afterwards.
+                convertPF = (pf == NO_PIXELFORMAT) ? destPF : pf;
+                destPF = R8G8B8;
+                colorSpace = JCS_RGB;
+            }
+        }
+        IntPoint imageSize(state.m_CInfo.image_width, state.m_CInfo.image_height);
+        int scaleDenom = getScaleDenom(imageSize, targetSize);
+        IntPoint size;
+        bOK = calcJPEGOutputSize(&state, scaleDenom, size);
+        if (bOK) {
+            pBmp = BitmapPtr(new Bitmap(size, destPF, sFName));
+            vector<JSAMPROW> pRows(size.y);
+            for (int y = 0; y < size.y; ++y) {
+                pRows[y] = pBmp->getPixels()+y*pBmp->getStride();
+            }
+            bOK = readJPEGImage(&state, colorSpace, scaleDenom, &pRows[0]);
+        }
+    }
+    jpeg_destroy_decompress(&state.m_CInfo);
+    fclose(pFile);
+    if (!bOK) {
+        throw Exception(AVG_ERR_FILEIO, string("Error decoding '") + sFName + "': " +
+                state.m_szError);
+    }
+    if (!bSupported) {
+        return BitmapPtr();
+    }
+    if (convertPF != NO_PIXELFORMAT) {
+        BitmapPtr pDestBmp(new Bitmap(pBmp->getSize(), convertPF, sFName));
+        pDestBmp->copyPixels(*pBmp);
+        pBmp = pDestBmp;
+    }
+    return pBmp;
+}
+
+}
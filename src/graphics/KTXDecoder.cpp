@@ -0,0 +1,154 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "KTXDecoder.h"
+
+#include "Bitmap.h"
+#include "OGLHelper.h"
+
+#include "../base/Exception.h"
+#include "../base/ScopeTimer.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sstream>
+
+using namespace std;
+
+namespace avg {
+
+static const unsigned char KTXIdentifier[12] = 
+        {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+static const uint32_t KTXEndianness = 0x04030201;
+
+struct KTXHeader {
+    unsigned char m_Identifier[12];
+    uint32_t m_Endianness;
+    uint32_t m_GLType;
+    uint32_t m_GLTypeSize;
+    uint32_t m_GLFormat;
+    uint32_t m_GLInternalFormat;
+    uint32_t m_GLBaseInternalFormat;
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_Depth;
+    uint32_t m_NumArrayElements;
+    uint32_t m_NumFaces;
+    uint32_t m_NumMipmapLevels;
+    uint32_t m_KeyValueDataSize;
+};
+
+static uint32_t swapBytes(uint32_t i)
+{
+    return (i >> 24) | ((i >> 8) & 0xFF00) | ((i << 8) & 0xFF0000) | (i << 24);
+}
+
+static PixelFormat glFormatToPixelFormat(uint32_t glInternalFormat)
+{
+    switch (glInternalFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+            return BC1;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return BC3;
+        case GL_COMPRESSED_RGB8_ETC2:
+            return ETC2_RGB8;
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+            return ETC2_RGBA8;
+        case GL_COMPRESSED_RGBA_ASTC_4x4_KHR:
+            return ASTC_4x4;
+        default:
+            return NO_PIXELFORMAT;
+    }
+}
+
+KTXDecoder::KTXDecoder()
+{
+}
+
+KTXDecoder::~KTXDecoder()
+{
+}
+
+bool KTXDecoder::canDecode(const unsigned char* pHeader, int headerSize) const
+{
+    return headerSize >= 12 && memcmp(pHeader, KTXIdentifier, 12) == 0;
+}
+
+static ProfilingZoneID KTXLoadProfilingZone("KTX load", true);
+
+BitmapPtr KTXDecoder::decode(const UTF8String& sFName, PixelFormat pf,
+        const IntPoint& targetSize) const
+{
+    ScopeTimer timer(KTXLoadProfilingZone);
+    FILE* pFile = fopen(sFName.c_str(), "rb");
+    if (!pFile) {
+        return BitmapPtr();
+    }
+    string sError;
+    BitmapPtr pBmp;
+    KTXHeader header;
+    if (fread(&header, sizeof(header), 1, pFile) != 1) {
+        sError = "File truncated.";
+    } else {
+        bool bSwap = (header.m_Endianness != KTXEndianness);
+        uint32_t* pFields = &header.m_Endianness;
+        int numFields = int((sizeof(header)-sizeof(header.m_Identifier))/4);
+        for (int i = 0; bSwap && i < numFields; ++i) {
+            pFields[i] = swapBytes(pFields[i]);
+        }
+        PixelFormat filePF = glFormatToPixelFormat(header.m_GLInternalFormat);
+        uint32_t imageSize;
+        if (filePF == NO_PIXELFORMAT || header.m_GLFormat != 0) {
+            stringstream ss;
+            ss << "Texture format 0x" << hex << header.m_GLInternalFormat <<
+                    " not supported.";
+            sError = ss.str();
+        } else if (header.m_Height == 0 || header.m_Depth > 1 || 
+                header.m_NumArrayElements > 1 || header.m_NumFaces != 1)
+        {
+            sError = "Only 2D textures are supported.";
+        } else if (fseek(pFile, header.m_KeyValueDataSize, SEEK_CUR) != 0 ||
+                fread(&imageSize, sizeof(imageSize), 1, pFile) != 1)
+        {
+            sError = "File truncated.";
+        } else {
+            if (bSwap) {
+                imageSize = swapBytes(imageSize);
+            }
+            IntPoint size(header.m_Width, header.m_Height);
+            pBmp = BitmapPtr(new Bitmap(size, filePF, sFName));
+            if (int(imageSize) != pBmp->getMemNeeded()) {
+                sError = "Unexpected image size.";
+            } else if (fread(pBmp->getPixels(), imageSize, 1, pFile) != 1) {
+                sError = "File truncated.";
+            }
+        }
+    }
+    fclose(pFile);
+    if (!sError.empty()) {
+        throw Exception(AVG_ERR_FILEIO, string("Error loading '") + sFName + "': " +
+                sError);
+    }
+    return pBmp;
+}
+
+}
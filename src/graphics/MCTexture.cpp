@@ -42,7 +42,8 @@ using namespace std;
 MCTexture::MCTexture(const IntPoint& size, PixelFormat pf, bool bMipmap, bool bForcePOT,
         int potBorderColor)
     : TexInfo(size, pf, bMipmap, usePOT(bForcePOT, bMipmap), potBorderColor),
-      m_bIsDirty(true)
+      m_bIsDirty(true),
+      m_bUploadPending(false)
 {
     ObjectCounter::get()->incRef(&typeid(*this));
 }
@@ -65,6 +66,13 @@ void MCTexture::moveBmpToTexture(GLContext* pContext, BitmapPtr pBmp)
     m_bIsDirty = true;
 }
 
+void MCTexture::moveBmpToSubTexture(GLContext* pContext, BitmapPtr pBmp, 
+        const IntPoint& pos)
+{
+    getTex(pContext)->moveBmpToSubTexture(pBmp, pos);
+    m_bIsDirty = true;
+}
+
 void MCTexture::setDirty()
 {
     m_bIsDirty = true;
@@ -80,6 +88,16 @@ void MCTexture::resetDirty()
     m_bIsDirty = false;
 }
 
+void MCTexture::setUploadPending(bool bPending)
+{
+    m_bUploadPending = bPending;
+}
+
+bool MCTexture::isUploadPending() const
+{
+    return m_bUploadPending;
+}
+
 const GLTexturePtr& MCTexture::getTex(GLContext* pContext) const
 {
     TexMap::const_iterator it = m_pTextures.find(pContext);
@@ -53,6 +53,7 @@ public:
     void initForGLContext(GLContext* pContext);
 
     void moveBmpToTexture(GLContext* pContext, BitmapPtr pBmp);
+    void moveBmpToSubTexture(GLContext* pContext, BitmapPtr pBmp, const IntPoint& pos);
 
     const GLTexturePtr& getTex(GLContext* pContext) const;
 
@@ -60,6 +61,9 @@ public:
     bool isDirty() const;
     void resetDirty();
 
+    void setUploadPending(bool bPending);
+    bool isUploadPending() const;
+
 private:
 #ifdef __APPLE__
     typedef boost::unordered_map<GLContext*, GLTexturePtr> TexMap;
@@ -69,6 +73,7 @@ private:
     TexMap m_pTextures;
 
     bool m_bIsDirty;
+    bool m_bUploadPending;
 };
 
 typedef boost::shared_ptr<MCTexture> MCTexturePtr;
@@ -87,6 +87,8 @@ namespace glproc {
     PFNGLBLENDCOLORPROC BlendColor;
     PFNGLACTIVETEXTUREPROC ActiveTexture;
     PFNGLGENERATEMIPMAPPROC GenerateMipmap;
+    PFNGLCOMPRESSEDTEXIMAGE2DPROC CompressedTexImage2D;
+    PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC CompressedTexSubImage2D;
 
     PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus;
     PFNGLGENFRAMEBUFFERSPROC GenFramebuffers;
@@ -377,6 +379,10 @@ namespace glproc {
         ActiveTexture = (PFNGLACTIVETEXTUREPROC)getFuzzyProcAddress("glActiveTexture");
         GenerateMipmap = (PFNGLGENERATEMIPMAPPROC)getFuzzyProcAddress
                 ("glGenerateMipmap");
+        CompressedTexImage2D = (PFNGLCOMPRESSEDTEXIMAGE2DPROC)getFuzzyProcAddress
+                ("glCompressedTexImage2D");
+        CompressedTexSubImage2D = (PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC)getFuzzyProcAddress
+                ("glCompressedTexSubImage2D");
         
         CheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)
                 getFuzzyProcAddress("glCheckFramebufferStatus");
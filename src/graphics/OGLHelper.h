@@ -66,6 +66,19 @@
     #define GPU_MEMORY_INFO_EVICTED_MEMORY_NVX            0x904B
 #endif
 
+// Block-compressed texture formats. Older headers don't define all of them.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT               0x83F0
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT              0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+    #define GL_COMPRESSED_RGB8_ETC2                       0x9274
+    #define GL_COMPRESSED_RGBA8_ETC2_EAC                  0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+    #define GL_COMPRESSED_RGBA_ASTC_4x4_KHR               0x93B0
+#endif
+
 #include <string>
 
 #ifndef APIENTRY
@@ -145,6 +158,12 @@ typedef void (GL_APIENTRYP PFNGLBLENDCOLORPROC) (GLclampf red, GLclampf green,
         GLclampf blue, GLclampf alpha);
 typedef void (GL_APIENTRYP PFNGLACTIVETEXTUREPROC) (GLenum texture);
 typedef void (GL_APIENTRYP PFNGLGENERATEMIPMAPPROC) (GLenum target);
+typedef void (GL_APIENTRYP PFNGLCOMPRESSEDTEXIMAGE2DPROC) (GLenum target, GLint level,
+        GLenum internalformat, GLsizei width, GLsizei height, GLint border,
+        GLsizei imageSize, const GLvoid* data);
+typedef void (GL_APIENTRYP PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC) (GLenum target, GLint level,
+        GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format,
+        GLsizei imageSize, const GLvoid* data);
 typedef GLenum (GL_APIENTRYP PFNGLCHECKFRAMEBUFFERSTATUSPROC) (GLenum target);
 typedef void (GL_APIENTRYP PFNGLGENFRAMEBUFFERSPROC) (GLsizei n, GLuint* framebuffers);
 typedef void (GL_APIENTRYP PFNGLBINDFRAMEBUFFERPROC) (GLenum target, GLuint framebuffer);
@@ -215,6 +234,8 @@ namespace glproc {
     extern AVG_API PFNGLBLENDCOLORPROC BlendColor;
     extern AVG_API PFNGLACTIVETEXTUREPROC ActiveTexture;
     extern AVG_API PFNGLGENERATEMIPMAPPROC GenerateMipmap;
+    extern AVG_API PFNGLCOMPRESSEDTEXIMAGE2DPROC CompressedTexImage2D;
+    extern AVG_API PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC CompressedTexSubImage2D;
 
     extern AVG_API PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus;
     extern AVG_API PFNGLGENFRAMEBUFFERSPROC GenFramebuffers;
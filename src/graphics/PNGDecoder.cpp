@@ -0,0 +1,205 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "PNGDecoder.h"
+
+#include "Bitmap.h"
+#include "BitmapLoader.h"
+
+#include "../base/Exception.h"
+#include "../base/ScopeTimer.h"
+
+#include <png.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace std;
+
+namespace avg {
+
+// libpng reports errors by longjmp()ing back to the caller, so all code that calls
+// into libpng lives in functions that have no objects with destructors.
+struct PNGReadState {
+    FILE* m_pFile;
+    png_structp m_pPNG;
+    png_infop m_pInfo;
+    png_uint_32 m_Width;
+    png_uint_32 m_Height;
+    bool m_bAlpha;
+    char m_szError[256];
+};
+
+static void onPNGError(png_structp pPNG, png_const_charp pszMsg)
+{
+    PNGReadState* pState = (PNGReadState*)png_get_error_ptr(pPNG);
+    strncpy(pState->m_szError, pszMsg, sizeof(pState->m_szError)-1);
+    longjmp(png_jmpbuf(pPNG), 1);
+}
+
+static void onPNGWarning(png_structp pPNG, png_const_charp pszMsg)
+{
+}
+
+static bool readPNGHeader(PNGReadState* pState)
+{
+    png_structp pPNG = pState->m_pPNG;
+    png_infop pInfo = pState->m_pInfo;
+    if (setjmp(png_jmpbuf(pPNG))) {
+        return false;
+    }
+    png_init_io(pPNG, pState->m_pFile);
+    png_read_info(pPNG, pInfo);
+    pState->m_Width = png_get_image_width(pPNG, pInfo);
+    pState->m_Height = png_get_image_height(pPNG, pInfo);
+    pState->m_bAlpha = (png_get_color_type(pPNG, pInfo) & PNG_COLOR_MASK_ALPHA) ||
+            png_get_valid(pPNG, pInfo, PNG_INFO_tRNS);
+    return true;
+}
+
+static bool readPNGImage(PNGReadState* pState, PixelFormat pf, png_bytepp ppRows)
+{
+    png_structp pPNG = pState->m_pPNG;
+    png_infop pInfo = pState->m_pInfo;
+    if (setjmp(png_jmpbuf(pPNG))) {
+        return false;
+    }
+    int colorType = png_get_color_type(pPNG, pInfo);
+    int bitDepth = png_get_bit_depth(pPNG, pInfo);
+    if (colorType == PNG_COLOR_TYPE_PALETTE) {
+        png_set_palette_to_rgb(pPNG);
+    }
+    if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8) {
+        png_set_expand_gray_1_2_4_to_8(pPNG);
+    }
+    if (png_get_valid(pPNG, pInfo, PNG_INFO_tRNS)) {
+        png_set_tRNS_to_alpha(pPNG);
+    }
+    if (bitDepth == 16) {
+        png_set_strip_16(pPNG);
+    }
+    if (!(colorType & PNG_COLOR_MASK_COLOR)) {
+        png_set_gray_to_rgb(pPNG);
+    }
+    if (getBytesPerPixel(pf) == 4) {
+        if (!pState->m_bAlpha) {
+            png_set_filler(pPNG, 0xFF, PNG_FILLER_AFTER);
+        }
+    } else {
+        if (pState->m_bAlpha) {
+            png_set_strip_alpha(pPNG);
+        }
+    }
+    if (pixelFormatIsBlueFirst(pf)) {
+        png_set_bgr(pPNG);
+    }
+    png_set_interlace_handling(pPNG);
+    png_read_update_info(pPNG, pInfo);
+    if (png_get_rowbytes(pPNG, pInfo) != pState->m_Width*getBytesPerPixel(pf)) {
+        png_error(pPNG, "Unexpected row size after transformation.");
+    }
+    png_read_image(pPNG, ppRows);
+    png_read_end(pPNG, 0);
+    return true;
+}
+
+static bool canDecodeDirectly(PixelFormat pf)
+{
+    switch (pf) {
+        case B8G8R8A8:
+        case B8G8R8X8:
+        case R8G8B8A8:
+        case R8G8B8X8:
+        case B8G8R8:
+        case R8G8B8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+PNGDecoder::PNGDecoder()
+{
+}
+
+PNGDecoder::~PNGDecoder()
+{
+}
+
+bool PNGDecoder::canDecode(const unsigned char* pHeader, int headerSize) const
+{
+    return headerSize >= 8 && png_sig_cmp((png_const_bytep)pHeader, 0, 8) == 0;
+}
+
+static ProfilingZoneID PNGDecodeProfilingZone("libpng decode", true);
+
+BitmapPtr PNGDecoder::decode(const UTF8String& sFName, PixelFormat pf,
+        const IntPoint& targetSize) const
+{
+    ScopeTimer timer(PNGDecodeProfilingZone);
+    PNGReadState state;
+    state.m_pFile = fopen(sFName.c_str(), "rb");
+    if (!state.m_pFile) {
+        return BitmapPtr();
+    }
+    memset(state.m_szError, 0, sizeof(state.m_szError));
+    state.m_pPNG = png_create_read_struct(PNG_LIBPNG_VER_STRING, &state, onPNGError,
+            onPNGWarning);
+    if (state.m_pPNG) {
+        state.m_pInfo = png_create_info_struct(state.m_pPNG);
+    } else {
+        state.m_pInfo = 0;
+    }
+    if (!state.m_pInfo) {
+        if (state.m_pPNG) {
+            png_destroy_read_struct(&state.m_pPNG, 0, 0);
+        }
+        fclose(state.m_pFile);
+        throw Exception(AVG_ERR_FILEIO, string("Error decoding '") + sFName +
+                "': Can't allocate libpng structures.");
+    }
+
+    BitmapPtr pBmp;
+    bool bOK = readPNGHeader(&state);
+    if (bOK) {
+        PixelFormat destPF = pf;
+        if (!canDecodeDirectly(destPF)) {
+            destPF = BitmapLoader::get()->getDefaultPixelFormat(state.m_bAlpha);
+        }
+        IntPoint size(state.m_Width, state.m_Height);
+        pBmp = BitmapPtr(new Bitmap(size, destPF, sFName));
+        vector<png_bytep> pRows(size.y);
+        for (int y = 0; y < size.y; ++y) {
+            pRows[y] = pBmp->getPixels()+y*pBmp->getStride();
+        }
+        bOK = readPNGImage(&state, destPF, &pRows[0]);
+    }
+    png_destroy_read_struct(&state.m_pPNG, &state.m_pInfo, 0);
+    fclose(state.m_pFile);
+    if (!bOK) {
+        throw Exception(AVG_ERR_FILEIO, string("Error decoding '") + sFName + "': " +
+                state.m_szError);
+    }
+    return pBmp;
+}
+
+}
@@ -100,6 +100,16 @@ string getPixelFormatString(PixelFormat pf)
             return "I32F";
         case JPEG:
             return "JPEG";
+        case BC1:
+            return "BC1";
+        case BC3:
+            return "BC3";
+        case ETC2_RGB8:
+            return "ETC2_RGB8";
+        case ETC2_RGBA8:
+            return "ETC2_RGBA8";
+        case ASTC_4x4:
+            return "ASTC_4x4";
         case NO_PIXELFORMAT:
             return "NO_PIXELFORMAT";
         default:
@@ -199,6 +209,21 @@ PixelFormat stringToPixelFormat(const string& s)
     if (s == "JPEG") {
         return JPEG;
     }
+    if (s == "BC1") {
+        return BC1;
+    }
+    if (s == "BC3") {
+        return BC3;
+    }
+    if (s == "ETC2_RGB8") {
+        return ETC2_RGB8;
+    }
+    if (s == "ETC2_RGBA8") {
+        return ETC2_RGBA8;
+    }
+    if (s == "ASTC_4x4") {
+        return ASTC_4x4;
+    }
     return NO_PIXELFORMAT;
 }
 
@@ -228,7 +253,7 @@ bool pixelFormatIsBayer(PixelFormat pf)
 bool pixelFormatHasAlpha(PixelFormat pf)
 {
     return pf == B8G8R8A8 || pf == A8B8G8R8 || pf == R8G8B8A8 || pf == A8R8G8B8 ||
-            pf == YCbCrA420p;
+            pf == YCbCrA420p || pf == BC3 || pf == ETC2_RGBA8 || pf == ASTC_4x4;
 }
 
 bool pixelFormatIsPlanar(PixelFormat pf)
@@ -241,6 +266,12 @@ bool AVG_API pixelFormatIsBlueFirst(PixelFormat pf)
     return pf == B5G6R5 || pf == B8G8R8 || pf == B8G8R8X8 || pf == B8G8R8A8;
 }
 
+bool pixelFormatIsCompressed(PixelFormat pf)
+{
+    return pf == BC1 || pf == BC3 || pf == ETC2_RGB8 || pf == ETC2_RGBA8 ||
+            pf == ASTC_4x4;
+}
+
 unsigned getNumPixelFormatPlanes(PixelFormat pf)
 {
     switch (pf) {
@@ -297,4 +328,28 @@ unsigned getBytesPerPixel(PixelFormat pf)
     }
 }
 
+unsigned getBytesPerBlock(PixelFormat pf)
+{
+    switch (pf) {
+        case BC1:
+        case ETC2_RGB8:
+            return 8;
+        case BC3:
+        case ETC2_RGBA8:
+        case ASTC_4x4:
+            return 16;
+        default:
+            AVG_LOG_ERROR("getBytesPerBlock(): " << getPixelFormatString(pf) <<
+                    " is not a block-compressed format.");
+            AVG_ASSERT(false);
+            return 0;
+    }
+}
+
+IntPoint getNumBlocks(const IntPoint& size, PixelFormat pf)
+{
+    AVG_ASSERT(pixelFormatIsCompressed(pf));
+    return IntPoint((size.x+3)/4, (size.y+3)/4);
+}
+
 }
@@ -23,6 +23,8 @@
 #define _PixelFormat_H_
 
 #include "../api.h"
+#include "../base/GLMHelper.h"
+
 #include <string>
 #include <vector>
 
@@ -48,6 +50,11 @@ typedef enum {
     R32G32B32A32F, // 32bit per channel float rgba
     I32F,
     JPEG,
+    BC1,           // Block-compressed formats, 4x4 pixels per block
+    BC3,
+    ETC2_RGB8,
+    ETC2_RGBA8,
+    ASTC_4x4,
     NO_PIXELFORMAT
 } PixelFormat;
 
@@ -61,8 +68,11 @@ bool AVG_API pixelFormatIsBayer(PixelFormat pf);
 bool AVG_API pixelFormatHasAlpha(PixelFormat pf);
 bool AVG_API pixelFormatIsPlanar(PixelFormat pf);
 bool AVG_API pixelFormatIsBlueFirst(PixelFormat pf);
+bool AVG_API pixelFormatIsCompressed(PixelFormat pf);
 unsigned AVG_API getNumPixelFormatPlanes(PixelFormat pf);
 unsigned AVG_API getBytesPerPixel(PixelFormat pf);
+unsigned AVG_API getBytesPerBlock(PixelFormat pf);
+IntPoint AVG_API getNumBlocks(const IntPoint& size, PixelFormat pf);
 
 }
 #endif
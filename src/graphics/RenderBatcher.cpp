@@ -0,0 +1,216 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "RenderBatcher.h"
+
+#include "GLTexture.h"
+#include "StandardShader.h"
+#include "SubVertexArray.h"
+#include "VertexArray.h"
+
+#include "../base/Exception.h"
+
+using namespace std;
+
+namespace avg {
+
+// Keeps the batch vertex array well below the 16 bit index limit of GLES.
+static const int MAX_BATCH_VERTS = 16384;
+
+BatchState::BatchState()
+    : m_pTex(0),
+      m_ColorModel(2),
+      m_bPremultipliedAlpha(false),
+      m_BlendMode(GLContext::BLEND_BLEND),
+      m_Alpha(1.0f)
+{
+}
+
+BatchState::BatchState(GLTexture* pTex, const WrapMode& wrapMode, int colorModel,
+        bool bPremultipliedAlpha, GLContext::BlendMode blendMode, float alpha)
+    : m_pTex(pTex),
+      m_WrapMode(wrapMode),
+      m_ColorModel(colorModel),
+      m_bPremultipliedAlpha(bPremultipliedAlpha),
+      m_BlendMode(blendMode),
+      m_Alpha(alpha)
+{
+}
+
+bool BatchState::operator ==(const BatchState& other) const
+{
+    return m_pTex == other.m_pTex && 
+            m_WrapMode.getS() == other.m_WrapMode.getS() &&
+            m_WrapMode.getT() == other.m_WrapMode.getT() &&
+            m_ColorModel == other.m_ColorModel &&
+            m_bPremultipliedAlpha == other.m_bPremultipliedAlpha &&
+            m_BlendMode == other.m_BlendMode &&
+            m_Alpha == other.m_Alpha;
+}
+
+bool BatchState::operator !=(const BatchState& other) const
+{
+    return !(*this == other);
+}
+
+RenderBatcher::Item::Item(const glm::mat4& transform, SubVertexArray* pSubVA)
+    : m_Transform(transform),
+      m_pSubVA(pSubVA)
+{
+}
+
+RenderBatcher::RenderBatcher(GLContext* pContext)
+    : m_pContext(pContext),
+      m_bEnabled(true),
+      m_pVA(0),
+      m_NumItemVerts(0),
+      m_NumDrawCalls(0),
+      m_NumBatchedDraws(0)
+{
+}
+
+RenderBatcher::~RenderBatcher()
+{
+}
+
+void RenderBatcher::setEnabled(bool bEnabled)
+{
+    flush();
+    m_bEnabled = bEnabled;
+}
+
+bool RenderBatcher::isEnabled() const
+{
+    return m_bEnabled;
+}
+
+void RenderBatcher::begin(VertexArray* pVA)
+{
+    m_pVA = pVA;
+    m_Items.clear();
+    m_NumItemVerts = 0;
+    if (!m_pBatchVA) {
+        m_pBatchVA = VertexArrayPtr(new VertexArray(2000, 3000));
+        m_pBatchVA->initForGLContext(m_pContext);
+    }
+    m_pBatchVA->reset();
+    m_NumDrawCalls = 0;
+    m_NumBatchedDraws = 0;
+}
+
+void RenderBatcher::draw(const BatchState& state, const glm::mat4& transform,
+        SubVertexArray& subVA)
+{
+    if (!m_bEnabled || !m_pVA || !isAffine2D(transform)) {
+        flush();
+        activateState(state, transform);
+        subVA.draw();
+        m_NumDrawCalls++;
+        return;
+    }
+    if (!m_Items.empty() && 
+            (state != m_State || m_NumItemVerts+subVA.getNumVerts() > MAX_BATCH_VERTS))
+    {
+        flush();
+    }
+    m_State = state;
+    m_Items.push_back(Item(transform, &subVA));
+    m_NumItemVerts += subVA.getNumVerts();
+}
+
+void RenderBatcher::flush()
+{
+    if (m_Items.empty()) {
+        return;
+    }
+    if (m_Items.size() == 1) {
+        // Nothing to merge: Draw directly from the node vertex array.
+        activateState(m_State, m_Items[0].m_Transform);
+        m_Items[0].m_pSubVA->draw();
+    } else {
+        if (m_pBatchVA->getNumVerts()+m_NumItemVerts > MAX_BATCH_VERTS) {
+            m_pBatchVA->reset();
+        }
+        unsigned startVertex = m_pBatchVA->getNumVerts();
+        unsigned startIndex = m_pBatchVA->getNumIndexes();
+        for (unsigned i = 0; i < m_Items.size(); ++i) {
+            m_Items[i].m_pSubVA->appendTransformed(*m_pBatchVA, m_Items[i].m_Transform);
+        }
+        m_pBatchVA->update(m_pContext);
+        m_pBatchVA->activate(m_pContext);
+        // Vertices are already in clip coordinates.
+        activateState(m_State, glm::mat4(1.0f));
+        m_pBatchVA->draw(startIndex, m_pBatchVA->getNumIndexes()-startIndex, startVertex,
+                m_pBatchVA->getNumVerts()-startVertex);
+        m_pVA->activate(m_pContext);
+        m_NumBatchedDraws += int(m_Items.size());
+    }
+    m_NumDrawCalls++;
+    m_Items.clear();
+    m_NumItemVerts = 0;
+}
+
+void RenderBatcher::end()
+{
+    flush();
+    m_pVA = 0;
+}
+
+int RenderBatcher::getNumDrawCalls() const
+{
+    return m_NumDrawCalls;
+}
+
+int RenderBatcher::getNumBatchedDraws() const
+{
+    return m_NumBatchedDraws;
+}
+
+void RenderBatcher::activateState(const BatchState& state, const glm::mat4& transform)
+{
+    StandardShader* pShader = m_pContext->getStandardShader();
+    if (state.m_pTex) {
+        state.m_pTex->activate(state.m_WrapMode, GL_TEXTURE0);
+        pShader->setColorModel(state.m_ColorModel);
+        pShader->disableColorspaceMatrix();
+        pShader->setGamma(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+        pShader->setPremultipliedAlpha(state.m_bPremultipliedAlpha);
+        pShader->setMask(false);
+    } else {
+        pShader->setUntextured();
+    }
+    m_pContext->setBlendColor(glm::vec4(1.0f, 1.0f, 1.0f, state.m_Alpha));
+    m_pContext->setBlendMode(state.m_BlendMode, state.m_bPremultipliedAlpha);
+    pShader->setAlpha(state.m_Alpha);
+    pShader->setTransform(transform);
+    pShader->activate();
+}
+
+bool RenderBatcher::isAffine2D(const glm::mat4& transform)
+{
+    // Vertices can only be transformed on the CPU if z and w don't depend on the 
+    // vertex position.
+    return transform[0][2] == 0 && transform[1][2] == 0 && transform[3][2] == 0 &&
+            transform[0][3] == 0 && transform[1][3] == 0 && transform[3][3] == 1;
+}
+
+}
@@ -0,0 +1,110 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _RenderBatcher_H_
+#define _RenderBatcher_H_
+
+#include "../api.h"
+
+#include "GLContext.h"
+#include "WrapMode.h"
+
+#include "../base/GLMHelper.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace avg {
+
+class GLTexture;
+class VertexArray;
+typedef boost::shared_ptr<VertexArray> VertexArrayPtr;
+class SubVertexArray;
+
+// Shader and blend state of a draw call that can be merged with others.
+struct AVG_API BatchState {
+    BatchState();
+    BatchState(GLTexture* pTex, const WrapMode& wrapMode, int colorModel,
+            bool bPremultipliedAlpha, GLContext::BlendMode blendMode, float alpha);
+
+    bool operator ==(const BatchState& other) const;
+    bool operator !=(const BatchState& other) const;
+
+    GLTexture* m_pTex;  // 0 for untextured draws.
+    WrapMode m_WrapMode;
+    int m_ColorModel;
+    bool m_bPremultipliedAlpha;
+    GLContext::BlendMode m_BlendMode;
+    float m_Alpha;
+};
+
+// Collects consecutive draws that share the same BatchState. When the state changes
+// or flush() is called, the collected vertices are transformed on the CPU and drawn 
+// with a single draw call. Everything that touches GL state directly needs to call 
+// flush() first.
+class AVG_API RenderBatcher {
+public:
+    RenderBatcher(GLContext* pContext);
+    virtual ~RenderBatcher();
+
+    void setEnabled(bool bEnabled);
+    bool isEnabled() const;
+
+    // pVA is the vertex array the SubVertexArrays passed to draw() belong to. It must
+    // be active during rendering.
+    void begin(VertexArray* pVA);
+    void draw(const BatchState& state, const glm::mat4& transform, 
+            SubVertexArray& subVA);
+    void flush();
+    void end();
+
+    int getNumDrawCalls() const;
+    int getNumBatchedDraws() const;
+
+private:
+    struct Item {
+        Item(const glm::mat4& transform, SubVertexArray* pSubVA);
+
+        glm::mat4 m_Transform;
+        SubVertexArray* m_pSubVA;
+    };
+
+    void activateState(const BatchState& state, const glm::mat4& transform);
+    static bool isAffine2D(const glm::mat4& transform);
+
+    GLContext* m_pContext;
+    bool m_bEnabled;
+    VertexArray* m_pVA;
+    VertexArrayPtr m_pBatchVA;
+
+    BatchState m_State;
+    std::vector<Item> m_Items;
+    int m_NumItemVerts;
+
+    int m_NumDrawCalls;
+    int m_NumBatchedDraws;
+};
+
+}
+
+#endif
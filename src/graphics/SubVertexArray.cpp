@@ -38,6 +38,12 @@ using namespace boost;
 namespace avg {
 
 SubVertexArray::SubVertexArray()
+    : m_pVA(0),
+      m_StartVertex(0),
+      m_StartIndex(0),
+      m_NumVerts(0),
+      m_NumIndexes(0),
+      m_Generation(-1)
 {
 }
 
@@ -46,13 +52,27 @@ SubVertexArray::~SubVertexArray()
 }
 
 void SubVertexArray::init(VertexArray* pVertexArray, unsigned startVertex,
-        unsigned startIndex)
+        unsigned startIndex, int generation)
 {
     m_pVA = pVertexArray;
     m_StartVertex = startVertex;
     m_StartIndex = startIndex;
     m_NumVerts = 0;
     m_NumIndexes = 0;
+    m_Generation = generation;
+}
+
+bool SubVertexArray::reuse(VertexArray* pVertexArray, unsigned startVertex,
+        unsigned startIndex, int generation)
+{
+    if (m_pVA == pVertexArray && m_Generation == generation-1 && 
+            m_StartVertex == startVertex && m_StartIndex == startIndex)
+    {
+        m_Generation = generation;
+        return true;
+    } else {
+        return false;
+    }
 }
 
 void SubVertexArray::appendTriIndexes(int v0, int v1, int v2)
@@ -72,6 +92,7 @@ void SubVertexArray::addLineData(Pixel32 color, const glm::vec2& p1, const glm::
         float width, float tc1, float tc2)
 {
     m_pVA->addLineData(color, p1, p2, width, tc1, tc2);
+    m_NumVerts += 4;
     m_NumIndexes += 6;
 }
 
@@ -82,11 +103,23 @@ void SubVertexArray::appendVertexData(VertexDataPtr pVertexes)
     m_NumIndexes += pVertexes->getNumIndexes();
 }
 
+void SubVertexArray::appendTransformed(VertexData& dest, const glm::mat4& transform)
+        const
+{
+    dest.appendTransformedData(*m_pVA, m_StartVertex, m_NumVerts, m_StartIndex, 
+            m_NumIndexes, transform);
+}
+
 int SubVertexArray::getNumVerts() const
 {
     return m_NumVerts;
 }
 
+int SubVertexArray::getNumIndexes() const
+{
+    return m_NumIndexes;
+}
+
 void SubVertexArray::draw()
 {
     m_pVA->draw(m_StartIndex, m_NumIndexes, m_StartVertex, m_StartIndex);
@@ -37,7 +37,10 @@ class AVG_API SubVertexArray {
 public:
     SubVertexArray();
     ~SubVertexArray();
-    void init(VertexArray* pVertexArray, unsigned startVertex, unsigned startIndex);
+    void init(VertexArray* pVertexArray, unsigned startVertex, unsigned startIndex,
+            int generation);
+    bool reuse(VertexArray* pVertexArray, unsigned startVertex, unsigned startIndex,
+            int generation);
 
     void appendPos(const glm::vec2& pos, 
             const glm::vec2& texPos, const Pixel32& color = Pixel32(0,0,0,0));
@@ -46,7 +49,9 @@ public:
     void addLineData(Pixel32 color, const glm::vec2& p1, const glm::vec2& p2, 
             float width, float tc1=0, float tc2=1);
     void appendVertexData(VertexDataPtr pVertexes);
+    void appendTransformed(VertexData& dest, const glm::mat4& transform) const;
     int getNumVerts() const;
+    int getNumIndexes() const;
 
     void draw();
     void dump() const;
@@ -58,6 +63,7 @@ private:
     unsigned m_StartIndex;
     int m_NumVerts;
     int m_NumIndexes;
+    int m_Generation;
 };
 
 inline void SubVertexArray::appendPos(const glm::vec2& pos, 
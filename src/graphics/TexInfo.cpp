@@ -82,7 +82,20 @@ TexInfo::TexInfo(const IntPoint& size, PixelFormat pf, bool bMipmap, bool bUsePO
                 + toString(maxTexSize));
     }
 
-    if (getGLType(m_pf) == GL_FLOAT && !isFloatFormatSupported()) {
+    if (pixelFormatIsCompressed(m_pf)) {
+        if (!isCompressedFormatSupported(m_pf)) {
+            throw Exception(AVG_ERR_UNSUPPORTED, "Texture format " +
+                    getPixelFormatString(m_pf) + 
+                    " not supported by OpenGL configuration.");
+        }
+        // Compressed textures can't be rendered to, so mipmaps can't be generated.
+        m_bMipmap = false;
+        if (m_bUsePOT && (m_Size.x%4 != 0 || m_Size.y%4 != 0)) {
+            throw Exception(AVG_ERR_UNSUPPORTED, "Compressed texture size (" +
+                    toString(m_Size) + ") must be a multiple of 4 if power-of-two " +
+                    "textures are used.");
+        }
+    } else if (getGLType(m_pf) == GL_FLOAT && !isFloatFormatSupported()) {
         throw Exception(AVG_ERR_UNSUPPORTED, 
                 "Float textures not supported by OpenGL configuration.");
     }
@@ -109,7 +122,12 @@ PixelFormat TexInfo::getPF() const
     
 int TexInfo::getMemNeeded() const
 {
-    return m_GLSize.x*m_GLSize.y*getBytesPerPixel(m_pf);
+    if (pixelFormatIsCompressed(m_pf)) {
+        IntPoint numBlocks = getNumBlocks(m_GLSize, m_pf);
+        return numBlocks.x*numBlocks.y*getBytesPerBlock(m_pf);
+    } else {
+        return m_GLSize.x*m_GLSize.y*getBytesPerPixel(m_pf);
+    }
 }
 
 IntPoint TexInfo::getMipmapSize(int level) const
@@ -127,6 +145,29 @@ bool TexInfo::isFloatFormatSupported()
     return queryOGLExtension("GL_ARB_texture_float");
 }
 
+bool TexInfo::isCompressedFormatSupported(PixelFormat pf)
+{
+    switch (pf) {
+        case BC1:
+        case BC3:
+            return queryOGLExtension("GL_EXT_texture_compression_s3tc");
+        case ETC2_RGB8:
+        case ETC2_RGBA8: {
+                // ETC2 is part of OpenGL ES 3.0 and OpenGL 4.3.
+                GLContext* pContext = GLContext::getCurrent();
+                int majorVer;
+                int minorVer;
+                pContext->getVersion(majorVer, minorVer);
+                return (pContext->isGLES() && majorVer >= 3) ||
+                        queryOGLExtension("GL_ARB_ES3_compatibility");
+            }
+        case ASTC_4x4:
+            return queryOGLExtension("GL_KHR_texture_compression_astc_ldr");
+        default:
+            return false;
+    }
+}
+
 int TexInfo::getGLFormat(PixelFormat pf)
 {
     switch (pf) {
@@ -211,6 +252,16 @@ int TexInfo::getGLInternalFormat() const
         case R8G8B8:
         case B5G6R5:
             return GL_RGB;
+        case BC1:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case ETC2_RGB8:
+            return GL_COMPRESSED_RGB8_ETC2;
+        case ETC2_RGBA8:
+            return GL_COMPRESSED_RGBA8_ETC2_EAC;
+        case ASTC_4x4:
+            return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
         default:
             AVG_ASSERT(false);
             return 0;
@@ -52,9 +52,11 @@ public:
     PixelFormat getPF() const;
     int getMemNeeded() const;
 
+    bool getUseMipmap() const;
     IntPoint getMipmapSize(int level) const;
 
     static bool isFloatFormatSupported();
+    static bool isCompressedFormatSupported(PixelFormat pf);
     static int getGLFormat(PixelFormat pf);
     static int getGLType(PixelFormat pf);
     int getGLInternalFormat() const;
@@ -62,7 +64,6 @@ public:
     void dump() const;
     
 protected:
-    bool getUseMipmap() const;
     bool getUsePOT() const;
     int getPOTBorderColor() const;
 
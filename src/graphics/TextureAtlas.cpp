@@ -0,0 +1,342 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "TextureAtlas.h"
+
+#include "Bitmap.h"
+#include "MCTexture.h"
+#include "GLContextManager.h"
+
+#include "../base/Exception.h"
+#include "../base/ObjectCounter.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace avg {
+
+TextureAtlasEntry::TextureAtlasEntry(const TextureAtlasPtr& pAtlas, BitmapPtr pBmp)
+    : m_pAtlas(pAtlas),
+      m_PageIndex(-1),
+      m_ShelfIndex(-1),
+      m_Version(0),
+      m_bUploadPending(false)
+{
+    ObjectCounter::get()->incRef(&typeid(*this));
+    // Add a border that repeats the edge pixels so bilinear filtering at the image
+    // edges behaves like GL_CLAMP_TO_EDGE.
+    IntPoint size = pBmp->getSize();
+    m_pBmp = BitmapPtr(new Bitmap(size+IntPoint(2,2), pBmp->getPixelFormat(), 
+            pBmp->getName()));
+    Bitmap innerBmp(*m_pBmp, IntRect(IntPoint(1,1), size+IntPoint(1,1)));
+    innerBmp.copyPixels(*pBmp);
+    int bpp = m_pBmp->getBytesPerPixel();
+    int stride = m_pBmp->getStride();
+    for (int y=1; y<=size.y; ++y) {
+        unsigned char* pLine = m_pBmp->getPixels()+y*stride;
+        memcpy(pLine, pLine+bpp, bpp);
+        memcpy(pLine+(size.x+1)*bpp, pLine+size.x*bpp, bpp);
+    }
+    unsigned char* pPixels = m_pBmp->getPixels();
+    memcpy(pPixels, pPixels+stride, m_pBmp->getLineLen());
+    memcpy(pPixels+(size.y+1)*stride, pPixels+size.y*stride, m_pBmp->getLineLen());
+}
+
+TextureAtlasEntry::~TextureAtlasEntry()
+{
+    m_pAtlas->removeEntry(this);
+    ObjectCounter::get()->decRef(&typeid(*this));
+}
+
+const MCTexturePtr& TextureAtlasEntry::getTex() const
+{
+    return m_pAtlas->m_Pages[m_PageIndex].m_pTex;
+}
+
+IntPoint TextureAtlasEntry::getSize() const
+{
+    return m_pBmp->getSize()-IntPoint(2,2);
+}
+
+FRect TextureAtlasEntry::getTexCoordRect() const
+{
+    glm::vec2 pageSize(m_pAtlas->m_PageSize);
+    glm::vec2 pos(m_Pos+IntPoint(1,1));
+    glm::vec2 size(getSize());
+    return FRect(pos/pageSize, (pos+size)/pageSize);
+}
+
+int TextureAtlasEntry::getVersion() const
+{
+    return m_Version;
+}
+
+int TextureAtlasEntry::getMemNeeded() const
+{
+    return m_pBmp->getSize().x*m_pBmp->getSize().y*m_pBmp->getBytesPerPixel();
+}
+
+bool TextureAtlasEntry::isUploadPending() const
+{
+    if (m_bUploadPending) {
+        m_bUploadPending = GLContextManager::get()->isTexSubUploadPending(m_pBmp);
+    }
+    return m_bUploadPending;
+}
+
+void TextureAtlasEntry::prioritizeUpload() const
+{
+    GLContextManager::get()->prioritizeTexSubUpload(m_pBmp);
+}
+
+
+TextureAtlas::Shelf::Shelf(int y, int height)
+    : m_Y(y),
+      m_Height(height),
+      m_NextX(0),
+      m_NumEntries(0)
+{
+}
+
+TextureAtlas::Page::Page(MCTexturePtr pTex)
+    : m_pTex(pTex),
+      m_NextShelfY(0),
+      m_NumEntries(0)
+{
+}
+
+
+TextureAtlas::TextureAtlas(PixelFormat pf, const IntPoint& pageSize)
+    : m_PF(pf),
+      m_PageSize(pageSize),
+      m_UsedArea(0)
+{
+    ObjectCounter::get()->incRef(&typeid(*this));
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    AVG_ASSERT(m_pEntries.empty());
+    ObjectCounter::get()->decRef(&typeid(*this));
+}
+
+bool TextureAtlas::fits(const IntPoint& size, const IntPoint& pageSize)
+{
+    // Only small images go into the atlas. Larger images don't gain much from batching
+    // and would fragment the pages.
+    return size.x+2 <= pageSize.x/4 && size.y+2 <= pageSize.y/4;
+}
+
+TextureAtlasEntryPtr TextureAtlas::addBitmap(BitmapPtr pBmp, bool bDeferred)
+{
+    AVG_ASSERT(pBmp->getPixelFormat() == m_PF);
+    AVG_ASSERT(fits(pBmp->getSize(), m_PageSize));
+    TextureAtlasEntryPtr pEntry(new TextureAtlasEntry(shared_from_this(), pBmp));
+    place(pEntry.get());
+    m_pEntries.push_back(pEntry.get());
+    m_UsedArea += pEntry->m_pBmp->getSize().x*pEntry->m_pBmp->getSize().y;
+    upload(pEntry.get(), bDeferred);
+    return pEntry;
+}
+
+bool TextureAtlas::needsCompaction() const
+{
+    // Compact if the entries would fit into at least one page less with room to spare.
+    long long pageArea = (long long)m_PageSize.x*m_PageSize.y;
+    return m_Pages.size() > 1 && m_UsedArea < (long long)(m_Pages.size()-1)*pageArea/2;
+}
+
+static bool entryHeightGreater(const TextureAtlasEntry* pEntry1, 
+        const TextureAtlasEntry* pEntry2)
+{
+    return pEntry1->getSize().y > pEntry2->getSize().y;
+}
+
+void TextureAtlas::compact()
+{
+    vector<TextureAtlasEntry*> pOldEntries = m_pEntries;
+    vector<int> oldPageIndexes;
+    vector<IntPoint> oldPositions;
+    stable_sort(pOldEntries.begin(), pOldEntries.end(), entryHeightGreater);
+    for (unsigned i=0; i<pOldEntries.size(); ++i) {
+        oldPageIndexes.push_back(pOldEntries[i]->m_PageIndex);
+        oldPositions.push_back(pOldEntries[i]->m_Pos);
+    }
+    for (unsigned i=0; i<m_Pages.size(); ++i) {
+        m_Pages[i].m_Shelves.clear();
+        m_Pages[i].m_NextShelfY = 0;
+        m_Pages[i].m_NumEntries = 0;
+    }
+    for (unsigned i=0; i<pOldEntries.size(); ++i) {
+        place(pOldEntries[i]);
+    }
+    // Page textures are kept, so entries that didn't move don't need to be uploaded 
+    // again. Empty pages are always at the end after repacking.
+    for (unsigned i=0; i<pOldEntries.size(); ++i) {
+        TextureAtlasEntry* pEntry = pOldEntries[i];
+        if (pEntry->m_PageIndex != oldPageIndexes[i] || pEntry->m_Pos != oldPositions[i])
+        {
+            pEntry->m_Version++;
+            // The entry's texture coordinates change immediately, so its pixels have
+            // to move in the same frame.
+            upload(pEntry, false);
+        }
+    }
+    removeEmptyPages();
+}
+
+PixelFormat TextureAtlas::getPixelFormat() const
+{
+    return m_PF;
+}
+
+int TextureAtlas::getNumPages() const
+{
+    return int(m_Pages.size());
+}
+
+int TextureAtlas::getNumEntries() const
+{
+    return int(m_pEntries.size());
+}
+
+long long TextureAtlas::getMemUsed() const
+{
+    return (long long)m_Pages.size()*m_PageSize.x*m_PageSize.y*getBytesPerPixel(m_PF);
+}
+
+void TextureAtlas::place(TextureAtlasEntry* pEntry)
+{
+    for (unsigned i=0; i<m_Pages.size(); ++i) {
+        if (placeInPage(pEntry, i)) {
+            return;
+        }
+    }
+    MCTexturePtr pTex = GLContextManager::get()->createTexture(m_PageSize, m_PF);
+    m_Pages.push_back(Page(pTex));
+    bool bPlaced = placeInPage(pEntry, int(m_Pages.size())-1);
+    AVG_ASSERT(bPlaced);
+}
+
+bool TextureAtlas::placeInPage(TextureAtlasEntry* pEntry, int pageIndex)
+{
+    Page& page = m_Pages[pageIndex];
+    IntPoint size = pEntry->m_pBmp->getSize();
+
+    // Use the lowest shelf that has room, but avoid wasting space by putting small 
+    // images on tall shelves as long as a new shelf can be opened.
+    int bestShelf = -1;
+    int fallbackShelf = -1;
+    for (unsigned i=0; i<page.m_Shelves.size(); ++i) {
+        const Shelf& shelf = page.m_Shelves[i];
+        if (shelf.m_Height >= size.y && shelf.m_NextX+size.x <= m_PageSize.x) {
+            if (shelf.m_Height <= size.y+size.y/2+1) {
+                if (bestShelf == -1 || shelf.m_Height < page.m_Shelves[bestShelf].m_Height)
+                {
+                    bestShelf = i;
+                }
+            } else if (fallbackShelf == -1) {
+                fallbackShelf = i;
+            }
+        }
+    }
+    if (bestShelf == -1) {
+        if (page.m_NextShelfY+size.y <= m_PageSize.y) {
+            page.m_Shelves.push_back(Shelf(page.m_NextShelfY, size.y));
+            page.m_NextShelfY += size.y;
+            bestShelf = int(page.m_Shelves.size())-1;
+        } else {
+            bestShelf = fallbackShelf;
+        }
+    }
+    if (bestShelf == -1) {
+        return false;
+    }
+
+    Shelf& shelf = page.m_Shelves[bestShelf];
+    pEntry->m_PageIndex = pageIndex;
+    pEntry->m_ShelfIndex = bestShelf;
+    pEntry->m_Pos = IntPoint(shelf.m_NextX, shelf.m_Y);
+    shelf.m_NextX += size.x;
+    shelf.m_NumEntries++;
+    page.m_NumEntries++;
+    return true;
+}
+
+void TextureAtlas::upload(TextureAtlasEntry* pEntry, bool bDeferred)
+{
+    GLContextManager::get()->scheduleTexSubUpload(pEntry->getTex(), pEntry->m_pBmp, 
+            pEntry->m_Pos, bDeferred);
+    pEntry->m_bUploadPending = GLContextManager::get()->isTexSubUploadPending(
+            pEntry->m_pBmp);
+}
+
+void TextureAtlas::removeEntry(TextureAtlasEntry* pEntry)
+{
+    vector<TextureAtlasEntry*>::iterator it = 
+            find(m_pEntries.begin(), m_pEntries.end(), pEntry);
+    AVG_ASSERT(it != m_pEntries.end());
+    m_pEntries.erase(it);
+    m_UsedArea -= pEntry->m_pBmp->getSize().x*pEntry->m_pBmp->getSize().y;
+    freeSpace(pEntry);
+}
+
+void TextureAtlas::freeSpace(TextureAtlasEntry* pEntry)
+{
+    Page& page = m_Pages[pEntry->m_PageIndex];
+    Shelf& shelf = page.m_Shelves[pEntry->m_ShelfIndex];
+    shelf.m_NumEntries--;
+    page.m_NumEntries--;
+    // Apart from the last entry in a shelf, space is only reclaimed once the complete 
+    // shelf is empty. Fragmentation is dealt with by compact().
+    if (pEntry->m_Pos.x+pEntry->m_pBmp->getSize().x == shelf.m_NextX) {
+        shelf.m_NextX = pEntry->m_Pos.x;
+    }
+    if (shelf.m_NumEntries == 0) {
+        shelf.m_NextX = 0;
+        while (!page.m_Shelves.empty() && page.m_Shelves.back().m_NumEntries == 0) {
+            page.m_NextShelfY = page.m_Shelves.back().m_Y;
+            page.m_Shelves.pop_back();
+        }
+    }
+    if (page.m_NumEntries == 0) {
+        removeEmptyPages();
+    }
+}
+
+void TextureAtlas::removeEmptyPages()
+{
+    for (int i=int(m_Pages.size())-1; i>=0; --i) {
+        if (m_Pages[i].m_NumEntries == 0) {
+            m_Pages.erase(m_Pages.begin()+i);
+            for (unsigned j=0; j<m_pEntries.size(); ++j) {
+                if (m_pEntries[j]->m_PageIndex > i) {
+                    m_pEntries[j]->m_PageIndex--;
+                }
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,135 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _TextureAtlas_H_
+#define _TextureAtlas_H_
+
+#include "../api.h"
+
+#include "PixelFormat.h"
+
+#include "../base/GLMHelper.h"
+#include "../base/Rect.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+
+#include <vector>
+
+namespace avg {
+
+class MCTexture;
+typedef boost::shared_ptr<MCTexture> MCTexturePtr;
+class Bitmap;
+typedef boost::shared_ptr<Bitmap> BitmapPtr;
+class TextureAtlas;
+typedef boost::shared_ptr<TextureAtlas> TextureAtlasPtr;
+
+// A rectangle in one of the pages of a TextureAtlas. The rectangle is freed when the
+// entry is deleted. Entries can move to a different position or page when the atlas
+// is compacted; getVersion() changes in this case.
+class AVG_API TextureAtlasEntry {
+public:
+    virtual ~TextureAtlasEntry();
+
+    const MCTexturePtr& getTex() const;
+    IntPoint getSize() const;
+    FRect getTexCoordRect() const;
+    int getVersion() const;
+    int getMemNeeded() const;
+    // True while a deferred upload of the entry hasn't completed.
+    bool isUploadPending() const;
+    void prioritizeUpload() const;
+
+private:
+    friend class TextureAtlas;
+    TextureAtlasEntry(const TextureAtlasPtr& pAtlas, BitmapPtr pBmp);
+
+    TextureAtlasPtr m_pAtlas;
+    BitmapPtr m_pBmp;   // Including the border.
+    int m_PageIndex;
+    int m_ShelfIndex;
+    IntPoint m_Pos;
+    int m_Version;
+    mutable bool m_bUploadPending;
+};
+
+typedef boost::shared_ptr<TextureAtlasEntry> TextureAtlasEntryPtr;
+
+// Packs small bitmaps of one pixel format into shared texture pages so they can be
+// drawn without switching textures. Bitmaps are stored with a one pixel border that 
+// repeats the edge pixels, so filtering doesn't pick up neighbouring images.
+class AVG_API TextureAtlas: public boost::enable_shared_from_this<TextureAtlas> {
+public:
+    TextureAtlas(PixelFormat pf, const IntPoint& pageSize);
+    virtual ~TextureAtlas();
+
+    static bool fits(const IntPoint& size, const IntPoint& pageSize);
+
+    // Deferred entries are uploaded within the texture upload budget.
+    TextureAtlasEntryPtr addBitmap(BitmapPtr pBmp, bool bDeferred=false);
+    bool needsCompaction() const;
+    void compact();
+
+    PixelFormat getPixelFormat() const;
+    int getNumPages() const;
+    int getNumEntries() const;
+    long long getMemUsed() const;
+
+private:
+    friend class TextureAtlasEntry;
+
+    struct Shelf {
+        Shelf(int y, int height);
+
+        int m_Y;
+        int m_Height;
+        int m_NextX;
+        int m_NumEntries;
+    };
+
+    struct Page {
+        Page(MCTexturePtr pTex);
+
+        MCTexturePtr m_pTex;
+        std::vector<Shelf> m_Shelves;
+        int m_NextShelfY;
+        int m_NumEntries;
+    };
+
+    void place(TextureAtlasEntry* pEntry);
+    bool placeInPage(TextureAtlasEntry* pEntry, int pageIndex);
+    void upload(TextureAtlasEntry* pEntry, bool bDeferred);
+    void removeEntry(TextureAtlasEntry* pEntry);
+    void freeSpace(TextureAtlasEntry* pEntry);
+    void removeEmptyPages();
+
+    PixelFormat m_PF;
+    IntPoint m_PageSize;
+    std::vector<Page> m_Pages;
+    std::vector<TextureAtlasEntry*> m_pEntries;
+    long long m_UsedArea;
+};
+
+}
+
+#endif
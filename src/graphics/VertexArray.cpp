@@ -42,8 +42,26 @@ const unsigned VertexArray::TEX_INDEX = 0;
 const unsigned VertexArray::POS_INDEX = 1;
 const unsigned VertexArray::COLOR_INDEX = 2;
 
+static void bufferSubData(GLenum target, unsigned offset, unsigned size,
+        const void* pData)
+{
+#ifdef AVG_ENABLE_EGL
+    glBufferSubData(target, offset, size, pData);
+#else
+    glproc::BufferSubData(target, offset, size, pData);
+#endif
+}
+
+VertexArray::UploadState::UploadState()
+    : m_VertexBufferSize(0),
+      m_IndexBufferSize(0)
+{
+}
+
 VertexArray::VertexArray(int reserveVerts, int reserveIndexes)
-    : VertexData(reserveVerts, reserveIndexes)
+    : VertexData(reserveVerts, reserveIndexes),
+      m_Generation(0),
+      m_NumBytesUploaded(0)
 {
     GLContext* pContext = GLContext::getCurrent();
     m_bUseMapBuffer = (!pContext->isGLES());
@@ -59,6 +77,7 @@ void VertexArray::initForGLContext(GLContext* pContext)
     m_VertexBufferIDMap[pContext] = vertexBufferID;
     glproc::GenBuffers(1, &indexBufferID);
     m_IndexBufferIDMap[pContext] = indexBufferID;
+    m_UploadStateMap[pContext] = UploadState();
 }
 
 VertexArray::~VertexArray()
@@ -71,22 +90,27 @@ void VertexArray::update(GLContext* pContext)
 {
     AVG_ASSERT(!m_VertexBufferIDMap.empty());
     if (hasDataChanged()) {
-        unsigned vertexBufferID = m_VertexBufferIDMap[pContext];
-        transferBuffer(GL_ARRAY_BUFFER, vertexBufferID, 
-                getReserveVerts()*sizeof(Vertex), 
-                getNumVerts()*sizeof(Vertex), getVertexPointer());
-        unsigned indexBufferID = m_IndexBufferIDMap[pContext];
-#ifdef AVG_ENABLE_EGL        
-        transferBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferID, 
-                getReserveIndexes()*sizeof(unsigned short),
-                getNumIndexes()*sizeof(unsigned short), getIndexPointer());
-#else
-        transferBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferID, 
-                getReserveIndexes()*sizeof(unsigned int),
-                getNumIndexes()*sizeof(unsigned int), getIndexPointer());
-#endif
+        // Every context needs to see each change, so the ranges are kept per context
+        // until they have been uploaded there.
+        UploadStateMap::iterator it;
+        for (it=m_UploadStateMap.begin(); it!=m_UploadStateMap.end(); ++it) {
+            it->second.m_DirtyVerts.add(getDirtyVertexRange());
+            it->second.m_DirtyIndexes.add(getDirtyIndexRange());
+        }
+        resetDataChanged();
+    }
+    UploadState& state = m_UploadStateMap[pContext];
+    unsigned numBytes = transferBuffer(GL_ARRAY_BUFFER, m_VertexBufferIDMap[pContext],
+            state.m_VertexBufferSize, getReserveVerts()*sizeof(Vertex), sizeof(Vertex),
+            getNumVerts(), state.m_DirtyVerts, getVertexPointer());
+    numBytes += transferBuffer(GL_ELEMENT_ARRAY_BUFFER,
+            m_IndexBufferIDMap[pContext], state.m_IndexBufferSize,
+            getReserveIndexes()*sizeof(GL_INDEX_TYPE), sizeof(GL_INDEX_TYPE),
+            getNumIndexes(), state.m_DirtyIndexes, getIndexPointer());
+    if (numBytes > 0) {
         GLContext::checkError("VertexArray::update()");
     }
+    m_NumBytesUploaded += numBytes;
 }
 
 void VertexArray::activate(GLContext* pContext)
@@ -136,24 +160,67 @@ void VertexArray::draw(unsigned startIndex, unsigned numIndexes, unsigned startV
     GLContext::checkError("VertexArray::draw()");
 }
 
+void VertexArray::reset()
+{
+    VertexData::reset();
+    m_Generation++;
+    m_NumBytesUploaded = 0;
+}
+
 void VertexArray::startSubVA(SubVertexArray& subVA)
 {
-    subVA.init(this, getNumVerts(), getNumIndexes());
+    subVA.init(this, getNumVerts(), getNumIndexes(), m_Generation);
 }
 
-void VertexArray::transferBuffer(GLenum target, unsigned bufferID, unsigned reservedSize, 
-        unsigned usedSize, const void* pData)
+bool VertexArray::reuseSubVA(SubVertexArray& subVA)
 {
-    glproc::BindBuffer(target, bufferID);
-    if (m_bUseMapBuffer) {
-        glproc::BufferData(target, reservedSize, 0, GL_STREAM_DRAW);
-        void * pBuffer = glproc::MapBuffer(target, GL_WRITE_ONLY);
-        memcpy(pBuffer, pData, usedSize);
-        glproc::UnmapBuffer(target);
+    // If subVA was written at the same position in the previous pass, its data is 
+    // still in the buffer (and on the GPU) and doesn't need to be emitted again.
+    if (subVA.reuse(this, getNumVerts(), getNumIndexes(), m_Generation)) {
+        skipData(subVA.getNumVerts(), subVA.getNumIndexes());
+        return true;
     } else {
-        glproc::BufferData(target, usedSize, pData, GL_STREAM_DRAW);
+        return false;
     }
 }
 
+unsigned VertexArray::getNumBytesUploaded() const
+{
+    return m_NumBytesUploaded;
 }
 
+unsigned VertexArray::transferBuffer(GLenum target, unsigned bufferID, 
+        unsigned& bufferSize, unsigned reservedSize, unsigned elementSize,
+        unsigned numElements, DirtyRange& dirtyRange, const void* pData)
+{
+    unsigned usedSize = numElements*elementSize;
+    dirtyRange.clip(numElements);
+    if (bufferSize != reservedSize) {
+        // Buffer has grown or hasn't been filled yet: Upload everything.
+        glproc::BindBuffer(target, bufferID);
+        glproc::BufferData(target, reservedSize, 0, GL_DYNAMIC_DRAW);
+        if (usedSize > 0) {
+            if (m_bUseMapBuffer) {
+                void * pBuffer = glproc::MapBuffer(target, GL_WRITE_ONLY);
+                memcpy(pBuffer, pData, usedSize);
+                glproc::UnmapBuffer(target);
+            } else {
+                bufferSubData(target, 0, usedSize, pData);
+            }
+        }
+        bufferSize = reservedSize;
+        dirtyRange.clear();
+        return usedSize;
+    } else if (!dirtyRange.isEmpty()) {
+        unsigned offset = dirtyRange.m_Start*elementSize;
+        unsigned size = (dirtyRange.m_End-dirtyRange.m_Start)*elementSize;
+        glproc::BindBuffer(target, bufferID);
+        bufferSubData(target, offset, size, (const char*)pData+offset);
+        dirtyRange.clear();
+        return size;
+    } else {
+        return 0;
+    }
+}
+
+}
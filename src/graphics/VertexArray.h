@@ -49,18 +49,36 @@ public:
     void draw(GLContext* pContext);
     void draw(unsigned startIndex, unsigned numIndexes, unsigned startVertex,
             unsigned numVertexes);
+    virtual void reset();
 
     void startSubVA(SubVertexArray& subVA);
+    bool reuseSubVA(SubVertexArray& subVA);
+    // Bytes uploaded to all contexts since the last reset().
+    unsigned getNumBytesUploaded() const;
 
 private:
-    void transferBuffer(GLenum target, unsigned bufferID, unsigned reservedSize, 
-            unsigned usedSize, const void* pData);
+    struct UploadState {
+        UploadState();
+
+        unsigned m_VertexBufferSize;
+        unsigned m_IndexBufferSize;
+        DirtyRange m_DirtyVerts;
+        DirtyRange m_DirtyIndexes;
+    };
+
+    unsigned transferBuffer(GLenum target, unsigned bufferID, unsigned& bufferSize,
+            unsigned reservedSize, unsigned elementSize, unsigned numElements,
+            DirtyRange& dirtyRange, const void* pData);
 
     typedef std::map<const GLContext*, unsigned> BufferIDMap;
     BufferIDMap m_VertexBufferIDMap;
     BufferIDMap m_IndexBufferIDMap;
+    typedef std::map<const GLContext*, UploadState> UploadStateMap;
+    UploadStateMap m_UploadStateMap;
 
     bool m_bUseMapBuffer;
+    int m_Generation;
+    unsigned m_NumBytesUploaded;
 };
 
 typedef boost::shared_ptr<VertexArray> VertexArrayPtr;
@@ -28,6 +28,7 @@
 #include "../base/ObjectCounter.h"
 
 #include <iostream>
+#include <limits>
 #include <stddef.h>
 #include <string.h>
 
@@ -39,6 +40,36 @@ namespace avg {
 const int VertexData::MIN_VERTEXES = 100;
 const int VertexData::MIN_INDEXES = 100;
 
+DirtyRange::DirtyRange()
+{
+    clear();
+}
+
+void DirtyRange::add(const DirtyRange& range)
+{
+    if (!range.isEmpty()) {
+        add(range.m_Start, range.m_End);
+    }
+}
+
+void DirtyRange::clip(int maxEnd)
+{
+    if (m_End > maxEnd) {
+        m_End = maxEnd;
+    }
+}
+
+void DirtyRange::clear()
+{
+    m_Start = numeric_limits<int>::max();
+    m_End = 0;
+}
+
+bool DirtyRange::isEmpty() const
+{
+    return m_Start >= m_End;
+}
+
 glm::vec2 Vertex::posAsVec()
 {
     return glm::make_vec2(m_Pos);
@@ -49,8 +80,7 @@ VertexData::VertexData(int reserveVerts, int reserveIndexes)
     : m_NumVerts(0),
       m_NumIndexes(0),
       m_ReserveVerts(reserveVerts),
-      m_ReserveIndexes(reserveIndexes),
-      m_bDataChanged(true)
+      m_ReserveIndexes(reserveIndexes)
 {
     ObjectCounter::get()->incRef(&typeid(*this));
     if (m_ReserveVerts < MIN_VERTEXES) {
@@ -84,7 +114,7 @@ void VertexData::appendPos(const glm::vec2& pos, const glm::vec2& texPos,
     pVertex->m_Tex[0] = (GLfloat)(texPos.x);
     pVertex->m_Tex[1] = (GLfloat)(texPos.y);
     pVertex->m_Color = color;
-    m_bDataChanged = true;
+    m_DirtyVerts.add(m_NumVerts, m_NumVerts+1);
     m_NumVerts++;
 }
 
@@ -96,6 +126,7 @@ void VertexData::appendTriIndexes(int v0, int v1, int v2)
     m_pIndexData[m_NumIndexes] = v0;
     m_pIndexData[m_NumIndexes+1] = v1;
     m_pIndexData[m_NumIndexes+2] = v2;
+    m_DirtyIndexes.add(m_NumIndexes, m_NumIndexes+3);
     m_NumIndexes += 3;
 }
 
@@ -110,6 +141,7 @@ void VertexData::appendQuadIndexes(int v0, int v1, int v2, int v3)
     m_pIndexData[m_NumIndexes+3] = v1;
     m_pIndexData[m_NumIndexes+4] = v2;
     m_pIndexData[m_NumIndexes+5] = v3;
+    m_DirtyIndexes.add(m_NumIndexes, m_NumIndexes+6);
     m_NumIndexes += 6;
 }
 
@@ -141,24 +173,71 @@ void VertexData::appendVertexData(const VertexDataPtr& pVertexes)
     for (int i=0; i<numIndexes; ++i) {
         m_pIndexData[oldNumIndexes+i] = pVertexes->m_pIndexData[i] + oldNumVerts;
     }
-    m_bDataChanged = true;
+    m_DirtyVerts.add(oldNumVerts, m_NumVerts);
+    m_DirtyIndexes.add(oldNumIndexes, m_NumIndexes);
+}
+
+void VertexData::appendTransformedData(const VertexData& src, unsigned startVertex,
+        int numVerts, unsigned startIndex, int numIndexes, const glm::mat4& transform)
+{
+    // Only the 2D affine part of the transform is applied.
+    int oldNumVerts = m_NumVerts;
+    int oldNumIndexes = m_NumIndexes;
+    m_NumVerts += numVerts;
+    m_NumIndexes += numIndexes;
+    if (m_NumVerts > m_ReserveVerts || m_NumIndexes > m_ReserveIndexes) {
+        grow();
+    }
+
+    const Vertex* pSrcVertex = &(src.m_pVertexData[startVertex]);
+    Vertex* pDestVertex = &(m_pVertexData[oldNumVerts]);
+    for (int i=0; i<numVerts; ++i) {
+        float x = pSrcVertex->m_Pos[0];
+        float y = pSrcVertex->m_Pos[1];
+        pDestVertex->m_Pos[0] = transform[0][0]*x + transform[1][0]*y + transform[3][0];
+        pDestVertex->m_Pos[1] = transform[0][1]*x + transform[1][1]*y + transform[3][1];
+        pDestVertex->m_Tex[0] = pSrcVertex->m_Tex[0];
+        pDestVertex->m_Tex[1] = pSrcVertex->m_Tex[1];
+        pDestVertex->m_Color = pSrcVertex->m_Color;
+        pSrcVertex++;
+        pDestVertex++;
+    }
+    const GL_INDEX_TYPE* pSrcIndex = &(src.m_pIndexData[startIndex]);
+    int indexOffset = oldNumVerts-int(startVertex);
+    for (int i=0; i<numIndexes; ++i) {
+        m_pIndexData[oldNumIndexes+i] = pSrcIndex[i] + indexOffset;
+    }
+    m_DirtyVerts.add(oldNumVerts, m_NumVerts);
+    m_DirtyIndexes.add(oldNumIndexes, m_NumIndexes);
 }
 
 bool VertexData::hasDataChanged() const
 {
-    return m_bDataChanged;
+    return !m_DirtyVerts.isEmpty() || !m_DirtyIndexes.isEmpty();
 }
 
 void VertexData::resetDataChanged()
 {
-    m_bDataChanged = false;
+    m_DirtyVerts.clear();
+    m_DirtyIndexes.clear();
+}
+
+const DirtyRange& VertexData::getDirtyVertexRange() const
+{
+    return m_DirtyVerts;
+}
+
+const DirtyRange& VertexData::getDirtyIndexRange() const
+{
+    return m_DirtyIndexes;
 }
 
 void VertexData::reset()
 {
+    // Buffer contents are kept so unchanged ranges can be reused in the next pass.
+    // Dirty ranges stay pending until they have been uploaded.
     m_NumVerts = 0;
     m_NumIndexes = 0;
-    m_bDataChanged = false;
 }
 
 FRect VertexData::calcBoundingRect() const
@@ -206,9 +285,7 @@ void VertexData::dump(unsigned startVertex, int numVerts, unsigned startIndex,
 
 void VertexData::grow()
 {
-    bool bChanged = false;
     if (m_NumVerts >= m_ReserveVerts-1) {
-        bChanged = true;
         int oldReserveVerts = m_ReserveVerts;
         m_ReserveVerts = int(m_ReserveVerts*1.5);
 #ifdef AVG_ENABLE_EGL
@@ -226,7 +303,6 @@ void VertexData::grow()
         delete[] pVertexData;
     }
     if (m_NumIndexes >= m_ReserveIndexes-6) {
-        bChanged = true;
         int oldReserveIndexes = m_ReserveIndexes;
         m_ReserveIndexes = int(m_ReserveIndexes*1.5);
         if (m_ReserveIndexes < m_NumIndexes) {
@@ -237,9 +313,6 @@ void VertexData::grow()
         memcpy(m_pIndexData, pIndexData, sizeof(GL_INDEX_TYPE)*oldReserveIndexes);
         delete[] pIndexData;
     }
-    if (bChanged) {
-        m_bDataChanged = true;
-    }
 }
 
 const Vertex * VertexData::getVertexPointer() const
@@ -262,6 +335,13 @@ int VertexData::getReserveIndexes() const
     return m_ReserveIndexes;
 }
 
+void VertexData::skipData(int numVerts, int numIndexes)
+{
+    m_NumVerts += numVerts;
+    m_NumIndexes += numIndexes;
+    AVG_ASSERT(m_NumVerts <= m_ReserveVerts && m_NumIndexes <= m_ReserveIndexes);
+}
+
 std::ostream& operator<<(std::ostream& os, const Vertex& v)
 {
     os << "  ((" << v.m_Pos[0] << ", " << v.m_Pos[1] << "), (" 
@@ -44,6 +44,20 @@ struct Vertex {
 class VertexData;
 typedef boost::shared_ptr<VertexData> VertexDataPtr;
 
+// Half-open range [m_Start, m_End) of vertexes or indexes that have been written
+// since the last upload.
+struct AVG_API DirtyRange {
+    DirtyRange();
+    void add(int start, int end);
+    void add(const DirtyRange& range);
+    void clip(int maxEnd);
+    void clear();
+    bool isEmpty() const;
+
+    int m_Start;
+    int m_End;
+};
+
 #ifdef AVG_ENABLE_EGL
 #define GL_INDEX_TYPE unsigned short 
 #else
@@ -62,9 +76,14 @@ public:
     void addLineData(Pixel32 color, const glm::vec2& p1, const glm::vec2& p2, 
             float width, float tc1=0, float tc2=1);
     void appendVertexData(const VertexDataPtr& pVertexes);
+    void appendTransformedData(const VertexData& src, unsigned startVertex, 
+            int numVerts, unsigned startIndex, int numIndexes, 
+            const glm::mat4& transform);
     bool hasDataChanged() const;
     void resetDataChanged();
-    void reset();
+    const DirtyRange& getDirtyVertexRange() const;
+    const DirtyRange& getDirtyIndexRange() const;
+    virtual void reset();
     FRect calcBoundingRect() const;
 
     int getNumVerts() const;
@@ -79,6 +98,7 @@ public:
 protected:
     int getReserveVerts() const;
     int getReserveIndexes() const;
+    void skipData(int numVerts, int numIndexes);
 
     static const int MIN_VERTEXES;
     static const int MIN_INDEXES;
@@ -93,9 +113,20 @@ private:
     Vertex * m_pVertexData;
     GL_INDEX_TYPE * m_pIndexData;
 
-    bool m_bDataChanged;
+    DirtyRange m_DirtyVerts;
+    DirtyRange m_DirtyIndexes;
 };
 
+inline void DirtyRange::add(int start, int end)
+{
+    if (start < m_Start) {
+        m_Start = start;
+    }
+    if (end > m_End) {
+        m_End = end;
+    }
+}
+
 std::ostream& operator<<(std::ostream& os, const Vertex& v);
 
 }
@@ -0,0 +1,461 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "YUVConversion.h"
+#include "Bitmap.h"
+
+#include "../base/Exception.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define AVG_YUV_X86
+    #include <emmintrin.h>
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define AVG_TARGET_SSE2
+        #define AVG_TARGET_AVX2
+    #else
+        #define AVG_TARGET_SSE2 __attribute__((target("sse2")))
+        #define AVG_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define AVG_YUV_NEON
+    #include <arm_neon.h>
+#endif
+
+using namespace std;
+
+namespace avg {
+
+// Fixed point coefficients with 8 fractional bits. These are the same values 
+// YUVtoBGR32Pixel() and YUVJtoBGR32Pixel() use, and all implementations produce
+// identical results.
+struct YUVCoeffs {
+    short m_YOffset;
+    short m_Y;
+    short m_BU;
+    short m_GU;
+    short m_GV;
+    short m_RV;
+};
+
+static const YUVCoeffs MPEG_COEFFS = {16, 298, 516, -100, -208, 409};
+static const YUVCoeffs JPEG_COEFFS = {0, 256, 452, -88, -182, 358};
+
+// Converts one line. pU and pV point to the chroma samples of the line.
+typedef void (*YUVLineFunc)(const unsigned char* pY, const unsigned char* pU,
+        const unsigned char* pV, unsigned char* pDest, int width, 
+        const YUVCoeffs& coeffs, bool bBGR);
+
+static inline unsigned char clampChannel(int c)
+{
+    if (c < 0) {
+        return 0;
+    } else if (c > 255) {
+        return 255;
+    } else {
+        return (unsigned char)c;
+    }
+}
+
+static void convertLinePart(const unsigned char* pY, const unsigned char* pU,
+        const unsigned char* pV, unsigned char* pDest, int start, int width, 
+        const YUVCoeffs& coeffs, bool bBGR)
+{
+    int bIndex = bBGR ? 0 : 2;
+    int rIndex = bBGR ? 2 : 0;
+    for (int x = start; x < width; ++x) {
+        int y1 = coeffs.m_Y*(pY[x]-coeffs.m_YOffset);
+        int u1 = pU[x/2]-128;
+        int v1 = pV[x/2]-128;
+        unsigned char* pPixel = pDest+x*4;
+        pPixel[bIndex] = clampChannel((y1 + coeffs.m_BU*u1) >> 8);
+        pPixel[1] = clampChannel((y1 + coeffs.m_GU*u1 + coeffs.m_GV*v1) >> 8);
+        pPixel[rIndex] = clampChannel((y1 + coeffs.m_RV*v1) >> 8);
+        pPixel[3] = 255;
+    }
+}
+
+static void convertLineC(const unsigned char* pY, const unsigned char* pU,
+        const unsigned char* pV, unsigned char* pDest, int width, 
+        const YUVCoeffs& coeffs, bool bBGR)
+{
+    convertLinePart(pY, pU, pV, pDest, 0, width, coeffs, bBGR);
+}
+
+#ifdef AVG_YUV_X86
+// The multiplications are done using pmaddwd on interleaved 16 bit values, so the 
+// intermediate results have 32 bits just like in the C version.
+
+AVG_TARGET_SSE2
+static inline __m128i calcChannelSSE2(__m128i yu, __m128i yuCoeffs, __m128i v0,
+        __m128i v0Coeffs)
+{
+    return _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu, yuCoeffs), 
+            _mm_madd_epi16(v0, v0Coeffs)), 8);
+}
+
+// Converts 8 pixels given as 16 bit y, u and v values.
+AVG_TARGET_SSE2
+static inline void convert8SSE2(__m128i y, __m128i u, __m128i v, unsigned char* pDest,
+        const YUVCoeffs& coeffs, bool bBGR)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bCoeffs = _mm_setr_epi16(coeffs.m_Y, coeffs.m_BU, coeffs.m_Y, 
+            coeffs.m_BU, coeffs.m_Y, coeffs.m_BU, coeffs.m_Y, coeffs.m_BU);
+    const __m128i gCoeffs = _mm_setr_epi16(coeffs.m_Y, coeffs.m_GU, coeffs.m_Y, 
+            coeffs.m_GU, coeffs.m_Y, coeffs.m_GU, coeffs.m_Y, coeffs.m_GU);
+    const __m128i gvCoeffs = _mm_setr_epi16(coeffs.m_GV, 0, coeffs.m_GV, 0, 
+            coeffs.m_GV, 0, coeffs.m_GV, 0);
+    const __m128i rCoeffs = _mm_setr_epi16(coeffs.m_Y, coeffs.m_RV, coeffs.m_Y, 
+            coeffs.m_RV, coeffs.m_Y, coeffs.m_RV, coeffs.m_Y, coeffs.m_RV);
+    const __m128i maxVal = _mm_set1_epi16(255);
+
+    __m128i yuLo = _mm_unpacklo_epi16(y, u);
+    __m128i yuHi = _mm_unpackhi_epi16(y, u);
+    __m128i yvLo = _mm_unpacklo_epi16(y, v);
+    __m128i yvHi = _mm_unpackhi_epi16(y, v);
+    __m128i v0Lo = _mm_unpacklo_epi16(v, zero);
+    __m128i v0Hi = _mm_unpackhi_epi16(v, zero);
+
+    __m128i b = _mm_packs_epi32(calcChannelSSE2(yuLo, bCoeffs, zero, zero),
+            calcChannelSSE2(yuHi, bCoeffs, zero, zero));
+    __m128i g = _mm_packs_epi32(calcChannelSSE2(yuLo, gCoeffs, v0Lo, gvCoeffs),
+            calcChannelSSE2(yuHi, gCoeffs, v0Hi, gvCoeffs));
+    __m128i r = _mm_packs_epi32(calcChannelSSE2(yvLo, rCoeffs, zero, zero),
+            calcChannelSSE2(yvHi, rCoeffs, zero, zero));
+    b = _mm_min_epi16(_mm_max_epi16(b, zero), maxVal);
+    g = _mm_min_epi16(_mm_max_epi16(g, zero), maxVal);
+    r = _mm_min_epi16(_mm_max_epi16(r, zero), maxVal);
+    if (!bBGR) {
+        __m128i tmp = b;
+        b = r;
+        r = tmp;
+    }
+    // Combine to 16 bit values containing (b, g) and (r, 255), then interleave.
+    __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+    __m128i ra = _mm_or_si128(r, _mm_set1_epi16(short(0xFF00)));
+    _mm_storeu_si128((__m128i*)pDest, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(pDest+16), _mm_unpackhi_epi16(bg, ra));
+}
+
+AVG_TARGET_SSE2
+static void convertLineSSE2(const unsigned char* pY, const unsigned char* pU,
+        const unsigned char* pV, unsigned char* pDest, int width, 
+        const YUVCoeffs& coeffs, bool bBGR)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i yOffset = _mm_set1_epi16(coeffs.m_YOffset);
+    const __m128i uvOffset = _mm_set1_epi16(128);
+    int x = 0;
+    for (; x+16 <= width; x += 16) {
+        __m128i y = _mm_loadu_si128((const __m128i*)(pY+x));
+        __m128i u = _mm_loadl_epi64((const __m128i*)(pU+x/2));
+        __m128i v = _mm_loadl_epi64((const __m128i*)(pV+x/2));
+        // Each chroma sample is used for two pixels.
+        u = _mm_unpacklo_epi8(u, u);
+        v = _mm_unpacklo_epi8(v, v);
+
+        __m128i yLo = _mm_sub_epi16(_mm_unpacklo_epi8(y, zero), yOffset);
+        __m128i uLo = _mm_sub_epi16(_mm_unpacklo_epi8(u, zero), uvOffset);
+        __m128i vLo = _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), uvOffset);
+        convert8SSE2(yLo, uLo, vLo, pDest+x*4, coeffs, bBGR);
+
+        __m128i yHi = _mm_sub_epi16(_mm_unpackhi_epi8(y, zero), yOffset);
+        __m128i uHi = _mm_sub_epi16(_mm_unpackhi_epi8(u, zero), uvOffset);
+        __m128i vHi = _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), uvOffset);
+        convert8SSE2(yHi, uHi, vHi, pDest+x*4+32, coeffs, bBGR);
+    }
+    convertLinePart(pY, pU, pV, pDest, x, width, coeffs, bBGR);
+}
+
+AVG_TARGET_AVX2
+static inline __m256i calcChannelAVX2(__m256i yu, __m256i yuCoeffs, __m256i v0,
+        __m256i v0Coeffs)
+{
+    return _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yu, yuCoeffs), 
+            _mm256_madd_epi16(v0, v0Coeffs)), 8);
+}
+
+AVG_TARGET_AVX2
+static inline __m256i setCoeffPairsAVX2(short c1, short c2)
+{
+    return _mm256_set1_epi32(int((unsigned short)c1 | ((unsigned int)c2 << 16)));
+}
+
+// unpack, madd and pack operate on the two 128 bit lanes separately. Unpacking and
+// packing again restores the original order, so only the final interleave needs 
+// a permute.
+AVG_TARGET_AVX2
+static void convertLineAVX2(const unsigned char* pY, const unsigned char* pU,
+        const unsigned char* pV, unsigned char* pDest, int width, 
+        const YUVCoeffs& coeffs, bool bBGR)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i yOffset = _mm256_set1_epi16(coeffs.m_YOffset);
+    const __m256i uvOffset = _mm256_set1_epi16(128);
+    const __m256i bCoeffs = setCoeffPairsAVX2(coeffs.m_Y, coeffs.m_BU);
+    const __m256i gCoeffs = setCoeffPairsAVX2(coeffs.m_Y, coeffs.m_GU);
+    const __m256i gvCoeffs = setCoeffPairsAVX2(coeffs.m_GV, 0);
+    const __m256i rCoeffs = setCoeffPairsAVX2(coeffs.m_Y, coeffs.m_RV);
+    const __m256i maxVal = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi16(short(0xFF00));
+    int x = 0;
+    for (; x+16 <= width; x += 16) {
+        __m128i u8 = _mm_loadl_epi64((const __m128i*)(pU+x/2));
+        __m128i v8 = _mm_loadl_epi64((const __m128i*)(pV+x/2));
+        __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(pY+x)));
+        __m256i u = _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8));
+        __m256i v = _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8));
+        y = _mm256_sub_epi16(y, yOffset);
+        u = _mm256_sub_epi16(u, uvOffset);
+        v = _mm256_sub_epi16(v, uvOffset);
+
+        __m256i yuLo = _mm256_unpacklo_epi16(y, u);
+        __m256i yuHi = _mm256_unpackhi_epi16(y, u);
+        __m256i yvLo = _mm256_unpacklo_epi16(y, v);
+        __m256i yvHi = _mm256_unpackhi_epi16(y, v);
+        __m256i v0Lo = _mm256_unpacklo_epi16(v, zero);
+        __m256i v0Hi = _mm256_unpackhi_epi16(v, zero);
+
+        __m256i b = _mm256_packs_epi32(calcChannelAVX2(yuLo, bCoeffs, zero, zero),
+                calcChannelAVX2(yuHi, bCoeffs, zero, zero));
+        __m256i g = _mm256_packs_epi32(calcChannelAVX2(yuLo, gCoeffs, v0Lo, gvCoeffs),
+                calcChannelAVX2(yuHi, gCoeffs, v0Hi, gvCoeffs));
+        __m256i r = _mm256_packs_epi32(calcChannelAVX2(yvLo, rCoeffs, zero, zero),
+                calcChannelAVX2(yvHi, rCoeffs, zero, zero));
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), maxVal);
+        g = _mm256_min_epi16(_mm256_max_epi16(g, zero), maxVal);
+        r = _mm256_min_epi16(_mm256_max_epi16(r, zero), maxVal);
+        if (!bBGR) {
+            __m256i tmp = b;
+            b = r;
+            r = tmp;
+        }
+        __m256i bg = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+        __m256i ra = _mm256_or_si256(r, alpha);
+        __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+        __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+        _mm256_storeu_si256((__m256i*)(pDest+x*4), _mm256_permute2x128_si256(lo, hi, 
+                0x20));
+        _mm256_storeu_si256((__m256i*)(pDest+x*4+32), _mm256_permute2x128_si256(lo, hi,
+                0x31));
+    }
+    convertLinePart(pY, pU, pV, pDest, x, width, coeffs, bBGR);
+}
+
+static bool cpuHasSSE2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool cpuHasAVX2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool bOSXSave = (info[2] & (1 << 27)) != 0;
+    bool bAVX = (info[2] & (1 << 28)) != 0;
+    if (!bOSXSave || !bAVX || (_xgetbv(0) & 6) != 6) {
+        // The OS doesn't save the AVX registers.
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef AVG_YUV_NEON
+static inline uint8x8_t calcChannelNEON(int16x8_t y, int16x8_t u, int16x8_t v, 
+        short yCoeff, short uCoeff, short vCoeff)
+{
+    int32x4_t lo = vmull_n_s16(vget_low_s16(y), yCoeff);
+    lo = vmlal_n_s16(lo, vget_low_s16(u), uCoeff);
+    lo = vmlal_n_s16(lo, vget_low_s16(v), vCoeff);
+    int32x4_t hi = vmull_n_s16(vget_high_s16(y), yCoeff);
+    hi = vmlal_n_s16(hi, vget_high_s16(u), uCoeff);
+    hi = vmlal_n_s16(hi, vget_high_s16(v), vCoeff);
+    int16x8_t c = vcombine_s16(vshrn_n_s32(lo, 8), vshrn_n_s32(hi, 8));
+    return vqmovun_s16(c);
+}
+
+static inline int16x8_t widenNEON(uint8x8_t val, int16x8_t offset)
+{
+    return vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(val)), offset);
+}
+
+static void convertLineNEON(const unsigned char* pY, const unsigned char* pU,
+        const unsigned char* pV, unsigned char* pDest, int width, 
+        const YUVCoeffs& coeffs, bool bBGR)
+{
+    const int16x8_t yOffset = vdupq_n_s16(coeffs.m_YOffset);
+    const int16x8_t uvOffset = vdupq_n_s16(128);
+    int bIndex = bBGR ? 0 : 2;
+    int rIndex = bBGR ? 2 : 0;
+    int x = 0;
+    for (; x+16 <= width; x += 16) {
+        uint8x16_t y8 = vld1q_u8(pY+x);
+        uint8x8_t u8 = vld1_u8(pU+x/2);
+        uint8x8_t v8 = vld1_u8(pV+x/2);
+        // Each chroma sample is used for two pixels.
+        uint8x8x2_t u8x2 = vzip_u8(u8, u8);
+        uint8x8x2_t v8x2 = vzip_u8(v8, v8);
+
+        int16x8_t yLo = widenNEON(vget_low_u8(y8), yOffset);
+        int16x8_t yHi = widenNEON(vget_high_u8(y8), yOffset);
+        int16x8_t uLo = widenNEON(u8x2.val[0], uvOffset);
+        int16x8_t uHi = widenNEON(u8x2.val[1], uvOffset);
+        int16x8_t vLo = widenNEON(v8x2.val[0], uvOffset);
+        int16x8_t vHi = widenNEON(v8x2.val[1], uvOffset);
+
+        uint8x16x4_t pixels;
+        pixels.val[bIndex] = vcombine_u8(
+                calcChannelNEON(yLo, uLo, vLo, coeffs.m_Y, coeffs.m_BU, 0),
+                calcChannelNEON(yHi, uHi, vHi, coeffs.m_Y, coeffs.m_BU, 0));
+        pixels.val[1] = vcombine_u8(
+                calcChannelNEON(yLo, uLo, vLo, coeffs.m_Y, coeffs.m_GU, coeffs.m_GV),
+                calcChannelNEON(yHi, uHi, vHi, coeffs.m_Y, coeffs.m_GU, coeffs.m_GV));
+        pixels.val[rIndex] = vcombine_u8(
+                calcChannelNEON(yLo, uLo, vLo, coeffs.m_Y, 0, coeffs.m_RV),
+                calcChannelNEON(yHi, uHi, vHi, coeffs.m_Y, 0, coeffs.m_RV));
+        pixels.val[3] = vdupq_n_u8(255);
+        vst4q_u8(pDest+x*4, pixels);
+    }
+    convertLinePart(pY, pU, pV, pDest, x, width, coeffs, bBGR);
+}
+#endif
+
+struct YUVImpl {
+    YUVLineFunc m_pFunc;
+    const char* m_pszName;
+};
+
+// All implementations this cpu supports, slowest first.
+static vector<YUVImpl> getSupportedImpls()
+{
+    vector<YUVImpl> impls;
+    YUVImpl cImpl = {&convertLineC, "C"};
+    impls.push_back(cImpl);
+#ifdef AVG_YUV_X86
+    if (cpuHasSSE2()) {
+        YUVImpl impl = {&convertLineSSE2, "SSE2"};
+        impls.push_back(impl);
+    }
+    if (cpuHasAVX2()) {
+        YUVImpl impl = {&convertLineAVX2, "AVX2"};
+        impls.push_back(impl);
+    }
+#endif
+#ifdef AVG_YUV_NEON
+    YUVImpl neonImpl = {&convertLineNEON, "NEON"};
+    impls.push_back(neonImpl);
+#endif
+    return impls;
+}
+
+static const YUVImpl& getImpl()
+{
+    static YUVImpl impl = getSupportedImpls().back();
+    return impl;
+}
+
+static void convertBmp(const Bitmap& yBmp, const Bitmap& uBmp, const Bitmap& vBmp,
+        bool bJPEG, Bitmap& destBmp, YUVLineFunc pConvertLine)
+{
+    PixelFormat destPF = destBmp.getPixelFormat();
+    AVG_ASSERT(destPF == B8G8R8X8 || destPF == B8G8R8A8 || destPF == R8G8B8X8 ||
+            destPF == R8G8B8A8);
+    bool bBGR = (destPF == B8G8R8X8 || destPF == B8G8R8A8);
+    const YUVCoeffs& coeffs = bJPEG ? JPEG_COEFFS : MPEG_COEFFS;
+
+    int height = min(yBmp.getSize().y, destBmp.getSize().y);
+    int width = min(yBmp.getSize().x, destBmp.getSize().x);
+    // 4:2:0 if the chroma planes have half the height of the luma plane.
+    bool b420 = (uBmp.getSize().y < yBmp.getSize().y);
+
+    const unsigned char* pYLine = yBmp.getPixels();
+    unsigned char* pDestLine = destBmp.getPixels();
+    for (int y = 0; y < height; ++y) {
+        int chromaLine = b420 ? y/2 : y;
+        const unsigned char* pULine = uBmp.getPixels()+chromaLine*uBmp.getStride();
+        const unsigned char* pVLine = vBmp.getPixels()+chromaLine*vBmp.getStride();
+        pConvertLine(pYLine, pULine, pVLine, pDestLine, width, coeffs, bBGR);
+        pYLine += yBmp.getStride();
+        pDestLine += destBmp.getStride();
+    }
+}
+
+void YUVtoRGB32(const Bitmap& yBmp, const Bitmap& uBmp, const Bitmap& vBmp,
+        bool bJPEG, Bitmap& destBmp)
+{
+    convertBmp(yBmp, uBmp, vBmp, bJPEG, destBmp, getImpl().m_pFunc);
+}
+
+void YUVtoRGB32(const Bitmap& yBmp, const Bitmap& uBmp, const Bitmap& vBmp,
+        bool bJPEG, Bitmap& destBmp, const string& sImpl)
+{
+    vector<YUVImpl> impls = getSupportedImpls();
+    for (unsigned i = 0; i < impls.size(); ++i) {
+        if (sImpl == impls[i].m_pszName) {
+            convertBmp(yBmp, uBmp, vBmp, bJPEG, destBmp, impls[i].m_pFunc);
+            return;
+        }
+    }
+    throw Exception(AVG_ERR_UNSUPPORTED, 
+            "YUV conversion using "+sImpl+" not supported on this cpu.");
+}
+
+vector<string> getSupportedYUVConversionImpls()
+{
+    vector<YUVImpl> impls = getSupportedImpls();
+    vector<string> names;
+    for (unsigned i = 0; i < impls.size(); ++i) {
+        names.push_back(impls[i].m_pszName);
+    }
+    return names;
+}
+
+string getYUVConversionImpl()
+{
+    return getImpl().m_pszName;
+}
+
+}
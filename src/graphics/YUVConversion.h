@@ -0,0 +1,54 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _YUVConversion_H_
+#define _YUVConversion_H_
+
+#include "../api.h"
+
+#include <string>
+#include <vector>
+
+namespace avg {
+
+class Bitmap;
+
+// Converts planar YCbCr 4:2:0 or 4:2:2 to B8G8R8X8, B8G8R8A8, R8G8B8X8 or R8G8B8A8.
+// The chroma subsampling is derived from the height of the chroma planes. bJPEG 
+// selects the full range (JPEG) matrix instead of the video range (MPEG) one. Alpha 
+// is set to 255 in the same pass. Uses SSE2, AVX2 or NEON if the cpu supports it.
+AVG_API void YUVtoRGB32(const Bitmap& yBmp, const Bitmap& uBmp, const Bitmap& vBmp,
+        bool bJPEG, Bitmap& destBmp);
+
+// Name of the instruction set YUVtoRGB32() uses on this cpu.
+AVG_API std::string getYUVConversionImpl();
+
+// Names of all instruction sets YUVtoRGB32() can use on this cpu, starting with "C".
+AVG_API std::vector<std::string> getSupportedYUVConversionImpls();
+
+// Same as YUVtoRGB32(), but uses the given instruction set instead of the fastest 
+// one. Used to test the individual kernels against each other.
+AVG_API void YUVtoRGB32(const Bitmap& yBmp, const Bitmap& uBmp, const Bitmap& vBmp,
+        bool bJPEG, Bitmap& destBmp, const std::string& sImpl);
+
+}
+
+#endif
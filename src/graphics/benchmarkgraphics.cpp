@@ -36,9 +36,19 @@
 #include "FilterGauss.h"
 #include "FilterBlur.h"
 #include "FilterBandpass.h"
+#include "YUVConversion.h"
+#include "GdkPixbufDecoder.h"
+#ifdef AVG_ENABLE_PNG_DECODER
+#include "PNGDecoder.h"
+#endif
+#ifdef AVG_ENABLE_JPEG_DECODER
+#include "JPEGDecoder.h"
+#endif
 
 #include "../base/TimeSource.h"
 
+#include "../video/WrapFFMpeg.h"
+
 #include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -88,6 +98,77 @@ public:
     }
 };
 
+class DecodeImagePerfTest: public PerfTestBase {
+public:
+    DecodeImagePerfTest(const string& sName, ImageDecoder* pDecoder,
+            const string& sFName, const IntPoint& targetSize=IntPoint(0,0))
+        : PerfTestBase(sName),
+          m_pDecoder(pDecoder),
+          m_sFName(sFName),
+          m_TargetSize(targetSize)
+    {
+    }
+
+    void run()
+    {
+        BitmapPtr pBmp = m_pDecoder->decode(m_sFName, NO_PIXELFORMAT, m_TargetSize);
+    }
+
+private:
+    ImageDecoderPtr m_pDecoder;
+    string m_sFName;
+    IntPoint m_TargetSize;
+};
+
+class GdkPixbufPNGPerfTest: public DecodeImagePerfTest {
+public:
+    GdkPixbufPNGPerfTest()
+        : DecodeImagePerfTest("GdkPixbufPNGPerfTest", new GdkPixbufDecoder(),
+                "../test/media/rgb24alpha-64x64.png")
+    {
+    }
+};
+
+class GdkPixbufJPEGPerfTest: public DecodeImagePerfTest {
+public:
+    GdkPixbufJPEGPerfTest()
+        : DecodeImagePerfTest("GdkPixbufJPEGPerfTest", new GdkPixbufDecoder(),
+                "../test/media/freidrehen.jpg")
+    {
+    }
+};
+
+#ifdef AVG_ENABLE_PNG_DECODER
+class LibPNGPerfTest: public DecodeImagePerfTest {
+public:
+    LibPNGPerfTest()
+        : DecodeImagePerfTest("LibPNGPerfTest", new PNGDecoder(),
+                "../test/media/rgb24alpha-64x64.png")
+    {
+    }
+};
+#endif
+
+#ifdef AVG_ENABLE_JPEG_DECODER
+class LibJPEGPerfTest: public DecodeImagePerfTest {
+public:
+    LibJPEGPerfTest()
+        : DecodeImagePerfTest("LibJPEGPerfTest", new JPEGDecoder(),
+                "../test/media/freidrehen.jpg")
+    {
+    }
+};
+
+class LibJPEGDownscalePerfTest: public DecodeImagePerfTest {
+public:
+    LibJPEGDownscalePerfTest()
+        : DecodeImagePerfTest("LibJPEGDownscalePerfTest", new JPEGDecoder(),
+                "../test/media/freidrehen.jpg", IntPoint(40, 30))
+    {
+    }
+};
+#endif
+
 class FillI8PerfTest: public PerfTestBase {
 public:
     FillI8PerfTest() 
@@ -233,9 +314,107 @@ private:
         
 };
 
+// 1080p video frame conversion, libavg vs. swscale.
+class YUVVideoPerfTestBase: public PerfTestBase {
+public:
+    YUVVideoPerfTestBase(const string& sName, bool b420)
+        : PerfTestBase(sName)
+    {
+        IntPoint size(1920, 1080);
+        IntPoint chromaSize(size.x/2, size.y);
+        if (b420) {
+            chromaSize.y = size.y/2;
+        }
+        m_pYBmp = BitmapPtr(new Bitmap(size, I8));
+        m_pUBmp = BitmapPtr(new Bitmap(chromaSize, I8));
+        m_pVBmp = BitmapPtr(new Bitmap(chromaSize, I8));
+        m_pDestBmp = BitmapPtr(new Bitmap(size, B8G8R8X8));
+        FilterFill<Pixel8>(Pixel8(128)).applyInPlace(m_pYBmp);
+        FilterFill<Pixel8>(Pixel8(64)).applyInPlace(m_pUBmp);
+        FilterFill<Pixel8>(Pixel8(192)).applyInPlace(m_pVBmp);
+    }
+
+protected:
+    BitmapPtr m_pYBmp;
+    BitmapPtr m_pUBmp;
+    BitmapPtr m_pVBmp;
+    BitmapPtr m_pDestBmp;
+};
+
+class YUV420ToBGRAPerfTest: public YUVVideoPerfTestBase {
+public:
+    YUV420ToBGRAPerfTest() 
+        : YUVVideoPerfTestBase("YUV420ToBGRAPerfTest ("+getYUVConversionImpl()+")", 
+                true)
+    {
+    }
+
+    void run()
+    {
+        YUVtoRGB32(*m_pYBmp, *m_pUBmp, *m_pVBmp, false, *m_pDestBmp);
+    }
+};
+
+class YUV422ToBGRAPerfTest: public YUVVideoPerfTestBase {
+public:
+    YUV422ToBGRAPerfTest() 
+        : YUVVideoPerfTestBase("YUV422ToBGRAPerfTest ("+getYUVConversionImpl()+")", 
+                false)
+    {
+    }
+
+    void run()
+    {
+        YUVtoRGB32(*m_pYBmp, *m_pUBmp, *m_pVBmp, false, *m_pDestBmp);
+    }
+};
+
+template<bool B420>
+class SWSYUVToBGRAPerfTest: public YUVVideoPerfTestBase {
+public:
+    SWSYUVToBGRAPerfTest() 
+        : YUVVideoPerfTestBase(B420 ? "SWSYUV420ToBGRAPerfTest" : 
+                "SWSYUV422ToBGRAPerfTest", B420)
+    {
+        IntPoint size = m_pYBmp->getSize();
+        m_pSwsContext = sws_getContext(size.x, size.y, 
+                B420 ? AV_PIX_FMT_YUV420P : AV_PIX_FMT_YUV422P, size.x, size.y, 
+                AV_PIX_FMT_BGRA, SWS_BICUBIC, 0, 0, 0);
+    }
+
+    ~SWSYUVToBGRAPerfTest()
+    {
+        sws_freeContext(m_pSwsContext);
+    }
+
+    void run()
+    {
+        const uint8_t* pSrc[3] = {m_pYBmp->getPixels(), m_pUBmp->getPixels(), 
+                m_pVBmp->getPixels()};
+        int srcStrides[3] = {m_pYBmp->getStride(), m_pUBmp->getStride(), 
+                m_pVBmp->getStride()};
+        uint8_t* pDest[1] = {m_pDestBmp->getPixels()};
+        int destStrides[1] = {m_pDestBmp->getStride()};
+        sws_scale(m_pSwsContext, pSrc, srcStrides, 0, m_pYBmp->getSize().y, pDest, 
+                destStrides);
+    }
+
+private:
+    SwsContext* m_pSwsContext;
+};
+
 void runPerformanceTests()
 {
     runPerformanceTest<LoadPNGPerfTest>();
+    runPerformanceTest<GdkPixbufPNGPerfTest>();
+#ifdef AVG_ENABLE_PNG_DECODER
+    runPerformanceTest<LibPNGPerfTest>();
+#endif
+    runPerformanceTest<GdkPixbufJPEGPerfTest>();
+#ifdef AVG_ENABLE_JPEG_DECODER
+    runPerformanceTest<LibJPEGPerfTest>();
+    runPerformanceTest<LibJPEGDownscalePerfTest>();
+#endif
     runPerformanceTest<FillI8PerfTest>();
     runPerformanceTest<FillRGBPerfTest>();
     runPerformanceTest<FillRGBAPerfTest>();
@@ -244,6 +423,10 @@ void runPerformanceTests()
     runPerformanceTest<CopyRGBPerfTest>();
     runPerformanceTest<CopyRGBAPerfTest>();
     runPerformanceTest<YUV2RGBPerfTest>(200);
+    runPerformanceTest<YUV420ToBGRAPerfTest>(200);
+    runPerformanceTest<SWSYUVToBGRAPerfTest<true> >(200);
+    runPerformanceTest<YUV422ToBGRAPerfTest>(200);
+    runPerformanceTest<SWSYUVToBGRAPerfTest<false> >(200);
 }
 
 int main(int nargs, char** args)
@@ -37,6 +37,10 @@
 #include "PBO.h"
 #include "ImageCache.h"
 #include "CachedImage.h"
+#include "VertexArray.h"
+#include "SubVertexArray.h"
+#include "TextureAtlas.h"
+#include "MCTexture.h"
 
 #include "../base/TestSuite.h"
 #include "../base/Exception.h"
@@ -45,6 +49,8 @@
 #include "../base/FileHelper.h"
 #include "../base/OSHelper.h"
 
+#include "../glm/gtc/matrix_transform.hpp"
+
 #include <math.h>
 #include <iostream>
 
@@ -505,6 +511,156 @@ private:
 };
 
 
+class TextureAtlasTest: public GraphicsTest {
+public:
+    TextureAtlasTest()
+        : GraphicsTest("TextureAtlasTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        GLContextManager* pCM = GLContextManager::get();
+        BitmapPtr pOrigBmp = loadTestBmp("rgb24alpha-64x64");
+        IntPoint pageSize(512, 512);
+        TEST(TextureAtlas::fits(pOrigBmp->getSize(), pageSize));
+        TEST(!TextureAtlas::fits(IntPoint(127, 10), pageSize));
+        TextureAtlasPtr pAtlas(new TextureAtlas(pOrigBmp->getPixelFormat(), pageSize));
+
+        cerr << "    Testing allocation" << endl;
+        vector<TextureAtlasEntryPtr> pEntries;
+        for (int i=0; i<60; ++i) {
+            pEntries.push_back(pAtlas->addBitmap(pOrigBmp));
+        }
+        pCM->uploadData();
+        TEST(pAtlas->getNumEntries() == 60);
+        TEST(pAtlas->getNumPages() == 2);
+        long long pageMem = 512*512*getBytesPerPixel(pOrigBmp->getPixelFormat());
+        TEST(pAtlas->getMemUsed() == 2*pageMem);
+        TEST(pEntries[0]->getTex() == pEntries[1]->getTex());
+        TEST(pEntries[0]->getTex() != pEntries[59]->getTex());
+        TEST(pEntries[0]->getSize() == pOrigBmp->getSize());
+        FRect texRect = pEntries[0]->getTexCoordRect();
+        TEST(almostEqual(texRect.tl, glm::vec2(1.f/512, 1.f/512)));
+        TEST(almostEqual(texRect.br, glm::vec2(65.f/512, 65.f/512)));
+        TEST(pEntries[1]->getTexCoordRect().tl.x > texRect.br.x);
+        testEntryContents(pEntries[58], pOrigBmp, "atlas-entry");
+
+        cerr << "    Testing compaction" << endl;
+        TEST(!pAtlas->needsCompaction());
+        pEntries.erase(pEntries.begin()+1, pEntries.begin()+50);
+        TEST(pAtlas->getNumEntries() == 11);
+        TEST(pAtlas->needsCompaction());
+        int oldVersion = pEntries[10]->getVersion();
+        pAtlas->compact();
+        pCM->uploadData();
+        TEST(!pAtlas->needsCompaction());
+        TEST(pAtlas->getNumPages() == 1);
+        TEST(pAtlas->getMemUsed() == pageMem);
+        TEST(pEntries[0]->getVersion() == 0);
+        TEST(pEntries[10]->getVersion() != oldVersion);
+        TEST(pEntries[0]->getTex() == pEntries[10]->getTex());
+        testEntryContents(pEntries[10], pOrigBmp, "atlas-compacted");
+
+        cerr << "    Testing release" << endl;
+        pEntries.clear();
+        TEST(pAtlas->getNumEntries() == 0);
+        TEST(pAtlas->getNumPages() == 0);
+        TEST(pAtlas->getMemUsed() == 0);
+        pCM->uploadData();
+    }
+
+private:
+    void testEntryContents(TextureAtlasEntryPtr pEntry, BitmapPtr pOrigBmp,
+            const string& sName)
+    {
+        BitmapPtr pPageBmp = pEntry->getTex()->getTex(GLContext::getCurrent())->
+                moveTextureToBmp();
+        FRect texRect = pEntry->getTexCoordRect();
+        glm::vec2 pageSize = pPageBmp->getSize();
+        IntPoint pos(int(texRect.tl.x*pageSize.x+0.5), int(texRect.tl.y*pageSize.y+0.5));
+        Bitmap entryBmp(*pPageBmp, IntRect(pos, pos+pEntry->getSize()));
+        testEqual(entryBmp, *pOrigBmp, sName, 0.01, 0.1);
+    }
+};
+
+
+class VertexArrayTest: public GraphicsTest {
+public:
+    VertexArrayTest()
+        : GraphicsTest("VertexArrayTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        GLContextManager* pCM = GLContextManager::get();
+        GLContext* pContext = GLContext::getCurrent();
+        VertexArrayPtr pVA = pCM->createVertexArray();
+        pCM->uploadData();
+        SubVertexArray subVA1;
+        SubVertexArray subVA2;
+
+        // First pass: Everything is uploaded.
+        appendQuad(pVA, subVA1);
+        appendQuad(pVA, subVA2);
+        pVA->update(pContext);
+        TEST(pVA->getNumBytesUploaded() == 
+                8*sizeof(Vertex)+12*sizeof(GL_INDEX_TYPE));
+
+        // Nothing changed: Nothing is uploaded.
+        pVA->reset();
+        TEST(pVA->reuseSubVA(subVA1));
+        TEST(pVA->reuseSubVA(subVA2));
+        TEST(pVA->getNumVerts() == 8);
+        TEST(pVA->getNumIndexes() == 12);
+        pVA->update(pContext);
+        TEST(pVA->getNumBytesUploaded() == 0);
+
+        // Second quad changed: Only the second quad is uploaded.
+        pVA->reset();
+        TEST(pVA->reuseSubVA(subVA1));
+        appendQuad(pVA, subVA2);
+        pVA->update(pContext);
+        TEST(pVA->getNumBytesUploaded() == 4*sizeof(Vertex)+6*sizeof(GL_INDEX_TYPE));
+        // Updating again in the same pass doesn't reset the count.
+        pVA->update(pContext);
+        TEST(pVA->getNumBytesUploaded() == 4*sizeof(Vertex)+6*sizeof(GL_INDEX_TYPE));
+
+        // First quad skipped: The second quad moves and can't be reused.
+        pVA->reset();
+        TEST(!pVA->reuseSubVA(subVA2));
+        appendQuad(pVA, subVA2);
+        pVA->reset();
+        TEST(!pVA->reuseSubVA(subVA1));
+
+        // Copy for batching: Positions are transformed, indexes are rebased.
+        VertexData batchData;
+        batchData.appendPos(glm::vec2(0,0), glm::vec2(0,0));
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(10, 20, 0));
+        transform = glm::scale(transform, glm::vec3(2, 2, 1));
+        subVA2.appendTransformed(batchData, transform);
+        TEST(batchData.getNumVerts() == 5);
+        TEST(batchData.getNumIndexes() == 6);
+        const Vertex* pVertexes = batchData.getVertexPointer();
+        TEST(pVertexes[3].m_Pos[0] == 12 && pVertexes[3].m_Pos[1] == 22);
+        TEST(pVertexes[3].m_Tex[0] == 1 && pVertexes[3].m_Tex[1] == 1);
+        TEST(batchData.getIndexPointer()[0] == 2);
+    }
+
+private:
+    void appendQuad(VertexArrayPtr pVA, SubVertexArray& subVA)
+    {
+        pVA->startSubVA(subVA);
+        subVA.appendPos(glm::vec2(0,0), glm::vec2(0,0));
+        subVA.appendPos(glm::vec2(1,0), glm::vec2(1,0));
+        subVA.appendPos(glm::vec2(1,1), glm::vec2(1,1));
+        subVA.appendPos(glm::vec2(0,1), glm::vec2(0,1));
+        subVA.appendQuadIndexes(1, 0, 2, 3);
+    }
+};
+
+
 class GPUTestSuite: public TestSuite {
 public:
     GPUTestSuite(const string& sVariant) 
@@ -512,6 +668,8 @@ public:
     {
         addTest(TestPtr(new TextureMoverTest));
         addTest(TestPtr(new ImageCacheTest));
+        addTest(TestPtr(new TextureAtlasTest));
+        addTest(TestPtr(new VertexArrayTest));
         addTest(TestPtr(new BrightnessFilterTest));
         addTest(TestPtr(new HueSatFilterTest));
         addTest(TestPtr(new InvertFilterTest));
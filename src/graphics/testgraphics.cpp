@@ -47,6 +47,14 @@
 #include "FilterGetAlpha.h"
 #include "FilterResizeBilinear.h"
 #include "FilterUnmultiplyAlpha.h"
+#include "YUVConversion.h"
+#include "GdkPixbufDecoder.h"
+#ifdef AVG_ENABLE_PNG_DECODER
+#include "PNGDecoder.h"
+#endif
+#ifdef AVG_ENABLE_JPEG_DECODER
+#include "JPEGDecoder.h"
+#endif
 
 #include "../base/TestSuite.h"
 #include "../base/Exception.h"
@@ -301,6 +309,8 @@ public:
         {
             cerr << "    Testing YUV->RGB conversion." << endl;
             testYUV2RGB();
+            testYUV2RGBKernels(false);
+            testYUV2RGBKernels(true);
         }
         runSaveTest(B8G8R8A8);
         runSaveTest(B8G8R8X8);
@@ -440,6 +450,92 @@ private:
         testEqual(*pRGBBmp, "YUV2RGBResult1", B8G8R8X8, 0.5, 0.5);
     }
 
+    void testYUV2RGBKernels(bool bJPEG)
+    {
+        // Every kernel the cpu supports is compared against the C kernel, which is
+        // compared against the per-pixel functions. Odd widths and widths that 
+        // aren't multiples of the vector size exercise the tails of the kernels.
+        vector<string> impls = getSupportedYUVConversionImpls();
+        cerr << "      " << (bJPEG ? "JPEG" : "MPEG") << ", default: " 
+                << getYUVConversionImpl() << ", testing:";
+        for (unsigned i=0; i<impls.size(); ++i) {
+            cerr << " " << impls[i];
+        }
+        cerr << endl;
+        TEST(impls[0] == "C");
+        int widths[] = {1, 2, 7, 15, 16, 17, 31, 32, 33, 37, 63};
+        for (int i=0; i<2; ++i) {
+            bool b420 = (i == 0);
+            for (unsigned w=0; w<sizeof(widths)/sizeof(int); ++w) {
+                IntPoint size(widths[w], 5);
+                BitmapPtr pYBmp(new Bitmap(size, I8));
+                BitmapPtr pUBmp;
+                BitmapPtr pVBmp;
+                initYUVBmps(size, b420, pYBmp, pUBmp, pVBmp);
+
+                BitmapPtr pBaselineBmp = calcYUV2RGBBaseline(pYBmp, pUBmp, pVBmp, 
+                        b420, bJPEG);
+                BitmapPtr pCBmp(new Bitmap(size, B8G8R8A8));
+                YUVtoRGB32(*pYBmp, *pUBmp, *pVBmp, bJPEG, *pCBmp, "C");
+                TEST(*pCBmp == *pBaselineBmp);
+                for (unsigned j=1; j<impls.size(); ++j) {
+                    BitmapPtr pRGBBmp(new Bitmap(size, B8G8R8A8));
+                    YUVtoRGB32(*pYBmp, *pUBmp, *pVBmp, bJPEG, *pRGBBmp, impls[j]);
+                    if (!(*pRGBBmp == *pCBmp)) {
+                        cerr << "        " << impls[j] << " differs from C, width " 
+                                << size.x << (b420 ? ", 4:2:0" : ", 4:2:2") << endl;
+                    }
+                    TEST(*pRGBBmp == *pCBmp);
+                }
+                BitmapPtr pRGBBmp(new Bitmap(size, B8G8R8A8));
+                YUVtoRGB32(*pYBmp, *pUBmp, *pVBmp, bJPEG, *pRGBBmp);
+                TEST(*pRGBBmp == *pCBmp);
+            }
+        }
+    }
+
+    void initYUVBmps(const IntPoint& size, bool b420, BitmapPtr pYBmp, 
+            BitmapPtr& pUBmp, BitmapPtr& pVBmp)
+    {
+        IntPoint chromaSize((size.x+1)/2, b420 ? (size.y+1)/2 : size.y);
+        pUBmp = BitmapPtr(new Bitmap(chromaSize, I8));
+        pVBmp = BitmapPtr(new Bitmap(chromaSize, I8));
+        for (int y=0; y<size.y; ++y) {
+            for (int x=0; x<size.x; ++x) {
+                pYBmp->getPixels()[y*pYBmp->getStride()+x] = (x*7+y*31)%256;
+            }
+        }
+        for (int y=0; y<chromaSize.y; ++y) {
+            for (int x=0; x<chromaSize.x; ++x) {
+                pUBmp->getPixels()[y*pUBmp->getStride()+x] = (x*13+y*57)%256;
+                pVBmp->getPixels()[y*pVBmp->getStride()+x] = 255-(x*11+y*43)%256;
+            }
+        }
+    }
+
+    BitmapPtr calcYUV2RGBBaseline(BitmapPtr pYBmp, BitmapPtr pUBmp, BitmapPtr pVBmp,
+            bool b420, bool bJPEG)
+    {
+        IntPoint size = pYBmp->getSize();
+        BitmapPtr pBaselineBmp(new Bitmap(size, B8G8R8A8));
+        for (int y=0; y<size.y; ++y) {
+            int cy = b420 ? y/2 : y;
+            const unsigned char* pY = pYBmp->getPixels()+y*pYBmp->getStride();
+            const unsigned char* pU = pUBmp->getPixels()+cy*pUBmp->getStride();
+            const unsigned char* pV = pVBmp->getPixels()+cy*pVBmp->getStride();
+            Pixel32* pDest = (Pixel32*)(pBaselineBmp->getPixels()+
+                    y*pBaselineBmp->getStride());
+            for (int x=0; x<size.x; ++x) {
+                if (bJPEG) {
+                    YUVJtoBGR32Pixel(pDest+x, pY[x], pU[x/2], pV[x/2]);
+                } else {
+                    YUVtoBGR32Pixel(pDest+x, pY[x], pU[x/2], pV[x/2]);
+                }
+            }
+        }
+        return pBaselineBmp;
+    }
+
 };
 
 class FilterColorizeTest: public GraphicsTest {
@@ -551,6 +647,9 @@ public:
         runPFTests(B8G8R8A8);
         runPFTests(R8G8B8A8);
         runPFTests(R8G8B8);
+        runCopyTest(R8G8B8, B8G8R8X8);
+        runCopyTest(B8G8R8A8, R8G8B8A8);
+        runCopyTest(R8G8B8X8, B8G8R8);
     }
 
 private:
@@ -568,6 +667,32 @@ private:
             TEST(*pBmp == baselineBmp);
         }
     }
+
+    void runCopyTest(PixelFormat srcPF, PixelFormat destPF) {
+        checkCopyFlipped(initBmp(srcPF), destPF);
+        // Wider bitmaps exercise the vectorized loops and odd widths their tails.
+        int widths[] = {15, 16, 17, 33, 50};
+        for (unsigned i=0; i<sizeof(widths)/sizeof(int); ++i) {
+            BitmapPtr pSrcBmp(new Bitmap(IntPoint(widths[i], 3), srcPF));
+            for (int y=0; y<3; ++y) {
+                unsigned char* pLine = pSrcBmp->getPixels()+y*pSrcBmp->getStride();
+                for (int x=0; x<widths[i]*pSrcBmp->getBytesPerPixel(); ++x) {
+                    pLine[x] = (x*7+y*13)%256;
+                }
+            }
+            checkCopyFlipped(pSrcBmp, destPF);
+        }
+    }
+
+    void checkCopyFlipped(BitmapPtr pSrcBmp, PixelFormat destPF) {
+        BitmapPtr pBaselineBmp(new Bitmap(pSrcBmp->getSize(), destPF));
+        pBaselineBmp->copyPixels(*pSrcBmp);
+        FilterFlipRGB(false).applyInPlace(pBaselineBmp);
+
+        Bitmap destBmp(pSrcBmp->getSize(), destPF);
+        FilterFlipRGB::copyFlipped(*pSrcBmp, destBmp);
+        TEST(destBmp == *pBaselineBmp);
+    }
 };
 
 class FilterFlipUVTest: public GraphicsTest {
@@ -623,6 +748,70 @@ private:
     }
 };
 
+class ImageDecoderTest: public GraphicsTest {
+public:
+    ImageDecoderTest()
+        : GraphicsTest("ImageDecoderTest", 2)
+    {
+    }
+
+    void runTests() 
+    {
+        BitmapPtr pBmp;
+#ifdef AVG_ENABLE_PNG_DECODER
+        ImageDecoderPtr pPNGDecoder(new PNGDecoder());
+        runDecoderTest(pPNGDecoder, "rgb24alpha-64x64.png", NO_PIXELFORMAT);
+        runDecoderTest(pPNGDecoder, "rgb24-64x64.png", NO_PIXELFORMAT);
+        runDecoderTest(pPNGDecoder, "rgb24-64x64.png", R8G8B8);
+        runDecoderTest(pPNGDecoder, "greyscale.png", NO_PIXELFORMAT);
+#endif
+#ifdef AVG_ENABLE_JPEG_DECODER
+        ImageDecoderPtr pJPEGDecoder(new JPEGDecoder());
+        runDecoderTest(pJPEGDecoder, "freidrehen.jpg", NO_PIXELFORMAT);
+        runDecoderTest(pJPEGDecoder, "freidrehen.jpg", R8G8B8);
+        cerr << "    Testing jpeg downscaling." << endl;
+        pBmp = pJPEGDecoder->decode(getMediaDir()+"/freidrehen.jpg",
+                NO_PIXELFORMAT, IntPoint(40, 30));
+        TEST(pBmp->getSize() == IntPoint(40, 30));
+#endif
+        cerr << "    Testing format conversion in BitmapLoader." << endl;
+        pBmp = loadBitmap(getMediaDir()+"/rgb24-64x64.png", I8);
+        TEST(pBmp->getPixelFormat() == I8);
+
+        cerr << "    Testing compressed textures." << endl;
+        pBmp = loadBitmap(getMediaDir()+"/rgb24-64x64.dds");
+        TEST(pBmp->getPixelFormat() == BC1);
+        TEST(pBmp->getSize() == IntPoint(64, 64));
+        TEST(pBmp->getMemNeeded() == 64*64/2);
+        pBmp = loadBitmap(getMediaDir()+"/rgb24alpha-64x64.ktx");
+        TEST(pBmp->getPixelFormat() == BC3);
+        TEST(pBmp->getMemNeeded() == 64*64);
+        BitmapPtr pCopyBmp(new Bitmap(*pBmp));
+        TEST(memcmp(pCopyBmp->getPixels(), pBmp->getPixels(), pBmp->getMemNeeded()) == 0);
+        BitmapPtr pSubBmp(new Bitmap(*pBmp, IntRect(4, 8, 64, 64)));
+        TEST(pSubBmp->getNumLines() == 14);
+        TEST(pSubBmp->getPixels() == pBmp->getPixels()+2*pBmp->getStride()+16);
+        bool bExceptionThrown = false;
+        try {
+            loadBitmap(getMediaDir()+"/rgb24alpha-64x64.ktx", R8G8B8A8);
+        } catch (Exception&) {
+            bExceptionThrown = true;
+        }
+        TEST(bExceptionThrown);
+    }
+
+private:
+    void runDecoderTest(ImageDecoderPtr pDecoder, const string& sFName, PixelFormat pf)
+    {
+        cerr << "    Testing " << sFName << ", " << pf << endl;
+        string sPath = getMediaDir()+"/"+sFName;
+        BitmapPtr pBmp = pDecoder->decode(sPath, pf, IntPoint(0,0));
+        BitmapPtr pBaselineBmp = GdkPixbufDecoder().decode(sPath, pf, IntPoint(0,0));
+        TEST(pBmp->getPixelFormat() == pBaselineBmp->getPixelFormat());
+        testEqual(*pBmp, *pBaselineBmp, "ImageDecoder_"+sFName);
+    }
+};
+
 class FilterConvolTest: public GraphicsTest {
 public:
     FilterConvolTest()
@@ -1015,6 +1204,7 @@ public:
         addTest(TestPtr(new FilterFlipRGBTest));
         addTest(TestPtr(new FilterFlipUVTest));
         addTest(TestPtr(new FilterComboTest));
+        addTest(TestPtr(new ImageDecoderTest));
         addTest(TestPtr(new FilterHighpassTest));
         addTest(TestPtr(new FilterGaussTest));
         addTest(TestPtr(new FilterBlurTest));
@@ -107,6 +107,7 @@ CMUCamera::CMUCamera(long long guid, bool bFW800, IntPoint size,
 
 CMUCamera::~CMUCamera()
 {
+    stopCaptureThread();
     m_pCamera->StopImageAcquisition();
     delete m_pCamera;
 }
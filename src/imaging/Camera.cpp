@@ -24,6 +24,7 @@
 #include "../base/Logger.h"
 #include "../base/Exception.h"
 #include "../base/ScopeTimer.h"
+#include "../base/TimeSource.h"
 #include "../graphics/Filterfliprgb.h"
 
 #if defined(AVG_ENABLE_1394_2)
@@ -51,16 +52,72 @@ namespace avg {
 
 using namespace std;
 
+CameraFrame::CameraFrame()
+    : m_CaptureTime(0)
+{
+}
+
+CameraFrame::CameraFrame(BitmapPtr pBmp, long long captureTime)
+    : m_pBmp(pBmp),
+      m_CaptureTime(captureTime)
+{
+}
+
 Camera::Camera(PixelFormat camPF, PixelFormat destPF, IntPoint size, float frameRate)
     : m_CamPF(camPF),
       m_DestPF(destPF),
       m_Size(size),
-      m_FrameRate(frameRate)
+      m_FrameRate(frameRate),
+      m_pCaptureThread(0),
+      m_bStopCapture(false),
+      m_NumDroppedFrames(0)
 {
 //    cerr << "Camera: " << getPixelFormatString(camPF) << "-->" 
 //        << getPixelFormatString(destPF) << endl;
 }
 
+Camera::~Camera()
+{
+    // Too late to stop the thread here: It would call getFrame() on a partially
+    // destroyed object.
+    AVG_ASSERT(!m_pCaptureThread);
+}
+
+void Camera::startCaptureThread()
+{
+    if (!m_pCaptureThread) {
+        m_bStopCapture = false;
+        m_NumDroppedFrames = 0;
+        m_pCaptureThread = new boost::thread(&Camera::runCaptureThread, this);
+    }
+}
+
+void Camera::stopCaptureThread()
+{
+    if (m_pCaptureThread) {
+        m_bStopCapture = true;
+        m_pCaptureThread->join();
+        delete m_pCaptureThread;
+        m_pCaptureThread = 0;
+        m_LatestFrame.clear();
+    }
+}
+
+bool Camera::isCaptureThreadRunning() const
+{
+    return m_pCaptureThread != 0;
+}
+
+bool Camera::getLatestFrame(CameraFrame& frame)
+{
+    return m_LatestFrame.read(frame);
+}
+
+int Camera::getNumDroppedFrames() const
+{
+    return m_NumDroppedFrames;
+}
+
 PixelFormat Camera::getCamPF() const
 {
     return m_CamPF;
@@ -82,14 +139,17 @@ BitmapPtr Camera::convertCamFrameToDestPF(BitmapPtr pCamBmp)
 {
     ScopeTimer Timer(CameraConvertProfilingZone);
     BitmapPtr pDestBmp = BitmapPtr(new Bitmap(pCamBmp->getSize(), m_DestPF));
-    pDestBmp->copyPixels(*pCamBmp);
-    if (m_CamPF == R8G8B8 && m_DestPF == B8G8R8X8) {
-        pDestBmp->setPixelFormat(R8G8B8X8);
-        FilterFlipRGB().applyInPlace(pDestBmp);
-    }
-    if (m_CamPF != R8G8B8 && m_DestPF == R8G8B8X8) {
-        pDestBmp->setPixelFormat(B8G8R8X8);
-        FilterFlipRGB().applyInPlace(pDestBmp);
+    bool bFlipRGB = (m_CamPF == R8G8B8 && m_DestPF == B8G8R8X8) ||
+            (m_CamPF != R8G8B8 && m_DestPF == R8G8B8X8);
+    int camBPP = pCamBmp->getBytesPerPixel();
+    if (bFlipRGB && (camBPP == 3 || camBPP == 4)) {
+        // Convert and flip in one pass.
+        FilterFlipRGB::copyFlipped(*pCamBmp, *pDestBmp);
+    } else {
+        pDestBmp->copyPixels(*pCamBmp);
+        if (bFlipRGB) {
+            FilterFlipRGB(false).applyInPlace(pDestBmp);
+        }
     }
 
     return pDestBmp;
@@ -105,6 +165,29 @@ float Camera::getFrameRate() const
     return m_FrameRate;
 }
 
+CameraFrame Camera::getFrame(bool bWait)
+{
+    BitmapPtr pBmp = getImage(bWait);
+    return CameraFrame(pBmp, TimeSource::get()->getCurrentMicrosecs());
+}
+
+void Camera::runCaptureThread()
+{
+    while (!m_bStopCapture) {
+        try {
+            CameraFrame frame = getFrame(true);
+            if (frame.m_pBmp) {
+                if (!m_LatestFrame.write(frame)) {
+                    m_NumDroppedFrames++;
+                }
+            }
+        } catch (const Exception& ex) {
+            AVG_LOG_ERROR("Camera capture thread: " << ex.getStr());
+            break;
+        }
+    }
+}
+
 PixelFormat Camera::fwBayerStringToPF(unsigned long reg)
 {
     string sBayerFormat((char*)&reg, 4);
@@ -24,10 +24,14 @@
 
 #include "../avgconfigwrapper.h"
 #include "../graphics/Bitmap.h"
+#include "../base/TripleBuffer.h"
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include "CameraInfo.h"
 
+#include <atomic>
+
 #include <string>
 #include <list>
 #include <map>
@@ -61,12 +65,34 @@ enum CameraFeature {
     CAM_FEATURE_UNSUPPORTED
 };
 
+// A captured image together with the time it was captured, in microseconds on the
+// TimeSource clock. Drivers that don't report capture times use the time the image was
+// received.
+struct AVG_API CameraFrame
+{
+    CameraFrame();
+    CameraFrame(BitmapPtr pBmp, long long captureTime);
+
+    BitmapPtr m_pBmp;
+    long long m_CaptureTime;
+};
+
 class AVG_API Camera
 {
 public:
     Camera(PixelFormat camPF, PixelFormat destPF, IntPoint size, float frameRate);
-    virtual ~Camera() {};
+    virtual ~Camera();
     virtual void startCapture() {};
+
+    // The capture thread calls getFrame(true) in a loop and keeps the latest frame in a
+    // mailbox, so consumers never wait for the camera. While it is running, frames must
+    // only be fetched using getLatestFrame(). Derived classes must stop the thread in
+    // their destructor.
+    void startCaptureThread();
+    void stopCaptureThread();
+    bool isCaptureThreadRunning() const;
+    bool getLatestFrame(CameraFrame& frame);
+    int getNumDroppedFrames() const;
     
     PixelFormat getCamPF() const;
     void setCamPF(PixelFormat pf);
@@ -76,6 +102,7 @@ public:
     IntPoint getImgSize();
     float getFrameRate() const;
     virtual BitmapPtr getImage(bool bWait) = 0;
+    virtual CameraFrame getFrame(bool bWait);
 
     virtual const std::string& getDevice() const = 0; 
     virtual const std::string& getDriverName() const = 0; 
@@ -94,11 +121,18 @@ protected:
 
 private:
     Camera();
+    void runCaptureThread();
+
     PixelFormat m_CamPF;
     PixelFormat m_DestPF;
 
     IntPoint m_Size;
     float m_FrameRate;
+
+    boost::thread* m_pCaptureThread;
+    std::atomic<bool> m_bStopCapture;
+    TripleBuffer<CameraFrame> m_LatestFrame;
+    std::atomic<int> m_NumDroppedFrames;
 };
 
 
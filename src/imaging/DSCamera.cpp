@@ -56,6 +56,7 @@ DSCamera::DSCamera(std::string sDevice, IntPoint size, PixelFormat camPF,
 
 DSCamera::~DSCamera()
 {
+    stopCaptureThread();
     close();
 }
 
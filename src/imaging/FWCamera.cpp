@@ -158,6 +158,7 @@ FWCamera::FWCamera(unsigned long long guid, int unit, bool bFW800, IntPoint size
 
 FWCamera::~FWCamera()
 {
+    stopCaptureThread();
 #ifdef AVG_ENABLE_1394_2
     dc1394_video_set_transmission(m_pCamera, DC1394_OFF);
     dc1394_capture_stop(m_pCamera);
@@ -61,8 +61,20 @@ FakeCamera::FakeCamera(std::vector<std::string>& pictures)
     }
 }
 
+FakeCamera::FakeCamera(const vector<BitmapPtr>& frames, float frameRate)
+    : Camera(frames.at(0)->getPixelFormat(), frames.at(0)->getPixelFormat(),
+            frames.at(0)->getSize(), frameRate),
+      m_pBmpQ(new std::queue<BitmapPtr>()),
+      m_bIsOpen(false)
+{
+    for (unsigned i = 0; i < frames.size(); ++i) {
+        m_pBmpQ->push(frames[i]);
+    }
+}
+
 FakeCamera::~FakeCamera()
 {
+    stopCaptureThread();
 }
 
 void FakeCamera::open()
@@ -79,7 +91,7 @@ void FakeCamera::close()
 BitmapPtr FakeCamera::getImage(bool bWait)
 {
     if (bWait) {
-        msleep(100);
+        msleep(int(1000/getFrameRate()));
     }
     if (!m_bIsOpen || !bWait || m_pBmpQ->empty()) {
         return BitmapPtr();
@@ -28,6 +28,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include <string>
+#include <vector>
 #include <queue>
 
 namespace avg {
@@ -39,6 +40,8 @@ class AVG_API FakeCamera: public Camera
 public:
     FakeCamera(PixelFormat camPF, PixelFormat destPF);
     FakeCamera(std::vector<std::string>& pictures);
+    // Delivers the frames in order at the given frame rate.
+    FakeCamera(const std::vector<BitmapPtr>& frames, float frameRate);
     virtual ~FakeCamera();
     virtual void open();
     virtual void close();
@@ -39,6 +39,8 @@
 #include <linux/videodev2.h>
 #include <jpeglib.h>
 
+#include <boost/thread/mutex.hpp>
+
 #include <stdio.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -66,6 +68,110 @@ namespace {
 
 namespace avg {
 
+// The driver needs at least this many queued buffers to keep capturing.
+static const int MIN_QUEUED_BUFFERS = 2;
+
+// Owns the memory-mapped capture buffers. A buffer can be lent to a bitmap returned by
+// getImage(). It's enqueued again when the bitmap is deleted, and all buffers are
+// unmapped once neither the camera nor any bitmap refers to them anymore.
+class V4LBufferPool {
+public:
+    V4LBufferPool(int fd)
+        : m_Fd(fd),
+          m_NumLent(0)
+    {
+    }
+
+    ~V4LBufferPool()
+    {
+        for (unsigned i = 0; i < m_Buffers.size(); ++i) {
+            int err = munmap(m_Buffers[i].m_pStart, m_Buffers[i].m_Length);
+            AVG_ASSERT(err != -1);
+        }
+    }
+
+    void addBuffer(void* pStart, size_t length)
+    {
+        Buffer buffer;
+        buffer.m_pStart = pStart;
+        buffer.m_Length = length;
+        m_Buffers.push_back(buffer);
+    }
+
+    int getNumBuffers() const
+    {
+        return int(m_Buffers.size());
+    }
+
+    unsigned char* getBuffer(int i) const
+    {
+        return (unsigned char*)m_Buffers[i].m_pStart;
+    }
+
+    bool lendBuffer()
+    {
+        boost::mutex::scoped_lock lock(m_Mutex);
+        if (m_NumLent+1 > getNumBuffers()-MIN_QUEUED_BUFFERS) {
+            return false;
+        }
+        m_NumLent++;
+        return true;
+    }
+
+    void returnBuffer(int i)
+    {
+        boost::mutex::scoped_lock lock(m_Mutex);
+        m_NumLent--;
+        if (m_Fd != -1) {
+            struct v4l2_buffer buf;
+            CLEAR(buf);
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = i;
+            if (xioctl(m_Fd, VIDIOC_QBUF, &buf) == -1) {
+                AVG_LOG_ERROR("V4L Camera: failed to enqueue image buffer.");
+            }
+        }
+    }
+
+    // Called when the device is closed. Buffers returned after this aren't enqueued.
+    void detach()
+    {
+        boost::mutex::scoped_lock lock(m_Mutex);
+        m_Fd = -1;
+    }
+
+private:
+    struct Buffer {
+        void* m_pStart;
+        size_t m_Length;
+    };
+
+    boost::mutex m_Mutex;
+    int m_Fd;
+    vector<Buffer> m_Buffers;
+    int m_NumLent;
+};
+
+class LentBufferDeleter {
+public:
+    LentBufferDeleter(V4LBufferPoolPtr pPool, int index)
+        : m_pPool(pPool),
+          m_Index(index)
+    {
+    }
+
+    void operator()(Bitmap* pBmp)
+    {
+        delete pBmp;
+        m_pPool->returnBuffer(m_Index);
+    }
+
+private:
+    V4LBufferPoolPtr m_pPool;
+    int m_Index;
+};
+
 V4LCamera::V4LCamera(string sDevice, int channel, IntPoint size, PixelFormat camPF,
         PixelFormat destPF, float frameRate)
     : Camera(camPF, destPF, size, frameRate),
@@ -118,17 +224,16 @@ V4LCamera::~V4LCamera()
 
 void V4LCamera::close()
 {
+    stopCaptureThread();
     enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     int rc = xioctl(m_Fd, VIDIOC_STREAMOFF, &type);
     if (rc == -1) {
         AVG_LOG_ERROR("VIDIOC_STREAMOFF");
     }
-    vector<Buffer>::iterator it;
-    for (it = m_vBuffers.begin(); it != m_vBuffers.end(); ++it) {
-        int err = munmap(it->start, it->length);
-        AVG_ASSERT (err != -1);
+    if (m_pBufferPool) {
+        m_pBufferPool->detach();
+        m_pBufferPool = V4LBufferPoolPtr();
     }
-    m_vBuffers.clear();
 
     ::close(m_Fd);
     AVG_TRACE(Logger::category::CONFIG, Logger::severity::INFO, "V4L2 Camera closed");
@@ -167,6 +272,11 @@ int V4LCamera::getV4LPF(PixelFormat pf)
 }
 
 BitmapPtr V4LCamera::getImage(bool bWait)
+{
+    return getFrame(bWait).m_pBmp;
+}
+
+CameraFrame V4LCamera::getFrame(bool bWait)
 {
     struct v4l2_buffer buf;
     CLEAR(buf);
@@ -189,12 +299,12 @@ BitmapPtr V4LCamera::getImage(bool bWait)
         // caught signal or something else
         if (rc == -1) {
             AVG_LOG_WARNING("V4L2: select failed.");
-            return BitmapPtr();
+            return CameraFrame();
         }
         // timeout
         if (rc == 0) {
             AVG_LOG_WARNING("V4L2: Timeout while waiting for image data");
-            return BitmapPtr();
+            return CameraFrame();
         }
     }
 
@@ -204,14 +314,14 @@ BitmapPtr V4LCamera::getImage(bool bWait)
     // dequeue filled buffer
     if (xioctl (m_Fd, VIDIOC_DQBUF, &buf) == -1) {
         if (errno == EAGAIN) {
-            return BitmapPtr();
+            return CameraFrame();
         } else {
             cerr << strerror(errno) << endl;
             AVG_ASSERT(false);
         }
     }
 
-    unsigned char * pCaptureBuffer = (unsigned char*)m_vBuffers[buf.index].start;
+    unsigned char * pCaptureBuffer = m_pBufferPool->getBuffer(buf.index);
 
     BitmapPtr pDestBmp;
     if (getCamPF() == JPEG) {
@@ -228,6 +338,14 @@ BitmapPtr V4LCamera::getImage(bool bWait)
             default:
                 lineLen = getImgSize().x*getBytesPerPixel(getCamPF());
         }
+        if (canLendCaptureBuffers() && m_pBufferPool->lendBuffer()) {
+            // No conversion necessary, so the capture buffer itself is returned. It's
+            // enqueued again when the bitmap is deleted.
+            BitmapPtr pBmp(new Bitmap(getImgSize(), getCamPF(), pCaptureBuffer,
+                    lineLen, false, "CameraBmp"), 
+                    LentBufferDeleter(m_pBufferPool, buf.index));
+            return CameraFrame(pBmp, getCaptureTime(buf));
+        }
         BitmapPtr pCamBmp = BitmapPtr(new Bitmap(getImgSize(), getCamPF(),
                 pCaptureBuffer, lineLen, false, "TempCameraBmp"));
         pDestBmp = convertCamFrameToDestPF(pCamBmp);
@@ -240,7 +358,24 @@ BitmapPtr V4LCamera::getImage(bool bWait)
         AVG_ASSERT_MSG(false, "V4L Camera: failed to enqueue image buffer.");
     }
 
-    return pDestBmp;
+    return CameraFrame(pDestBmp, getCaptureTime(buf));
+}
+
+long long V4LCamera::getCaptureTime(const struct v4l2_buffer& buf) const
+{
+#ifdef V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC
+    // The driver timestamp is taken when the frame was captured. TimeSource uses the
+    // monotonic clock as well, so it can be used directly.
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        return (long long)(buf.timestamp.tv_sec)*1000000 + buf.timestamp.tv_usec;
+    }
+#endif
+    return TimeSource::get()->getCurrentMicrosecs();
+}
+
+bool V4LCamera::canLendCaptureBuffers() const
+{
+    return getCamPF() == getDestPF() && getCamPF() != YCbCr420p;
 }
 
 bool V4LCamera::isCameraAvailable()
@@ -546,7 +681,7 @@ void V4LCamera::startCapture()
     unsigned int i;
     enum v4l2_buf_type type;
 
-    for (i = 0; i < m_vBuffers.size(); ++i) {
+    for (i = 0; i < unsigned(m_pBufferPool->getNumBuffers()); ++i) {
         struct v4l2_buffer buf;
 
         CLEAR(buf);
@@ -708,10 +843,9 @@ void V4LCamera::initMMap()
         AVG_ASSERT(false);
     }
 
-    m_vBuffers.clear();
+    m_pBufferPool = V4LBufferPoolPtr(new V4LBufferPool(m_Fd));
 
     for (int i = 0; i < int(req.count); ++i) {
-        Buffer tmp;
         struct v4l2_buffer buf;
 
         CLEAR (buf);
@@ -724,19 +858,17 @@ void V4LCamera::initMMap()
             AVG_ASSERT(false);
         }
 
-        tmp.length = buf.length;
-
-        tmp.start = mmap (NULL /* start anywhere */,
+        void* pStart = mmap (NULL /* start anywhere */,
             buf.length,
             PROT_READ | PROT_WRITE /* required */,
             MAP_SHARED /* recommended */,
             m_Fd, buf.m.offset);
 
-        if (MAP_FAILED == tmp.start) {
+        if (MAP_FAILED == pStart) {
             AVG_ASSERT(false);
         }
 
-        m_vBuffers.push_back(tmp);
+        m_pBufferPool->addBuffer(pStart, buf.length);
     }
 }
 
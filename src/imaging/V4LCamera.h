@@ -26,26 +26,29 @@
 #include "../avgconfigwrapper.h"
 
 #include "Camera.h"
+
+#include <boost/shared_ptr.hpp>
+
 #include <string>
 #include <vector>
 
+struct v4l2_buffer;
+
 namespace avg {
 
 typedef unsigned int V4LCID_t;
 
-class AVG_API V4LCamera: public Camera {
-
-    struct Buffer {
-        void * start;
-        size_t length;
-    };
+class V4LBufferPool;
+typedef boost::shared_ptr<V4LBufferPool> V4LBufferPoolPtr;
 
+class AVG_API V4LCamera: public Camera {
 public:
     V4LCamera(std::string sDevice, int channel, IntPoint size, PixelFormat camPF,
             PixelFormat destPF, float frameRate);
     virtual ~V4LCamera();
 
     virtual BitmapPtr getImage(bool bWait);
+    virtual CameraFrame getFrame(bool bWait);
     virtual bool isCameraAvailable();
 
     virtual const std::string& getDevice() const;
@@ -76,6 +79,8 @@ private:
     static void getCameraControls(int deviceNumber, CameraInfo* camInfo);
 
     BitmapPtr decompressJpegFrame(unsigned char* pCaptureBuffer);
+    bool canLendCaptureBuffers() const;
+    long long getCaptureTime(const struct v4l2_buffer& buf) const;
 
     void setFeature(V4LCID_t v4lFeature, int value);
     V4LCID_t getFeatureID(CameraFeature feature) const;
@@ -93,7 +98,7 @@ private:
     std::string m_sDevice;
     std::string m_sDriverName;
     std::string m_sModelName;
-    std::vector<Buffer> m_vBuffers;
+    V4LBufferPoolPtr m_pBufferPool;
     bool m_bCameraAvailable;
     unsigned m_v4lPF;
 };
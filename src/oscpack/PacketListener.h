@@ -39,6 +39,9 @@ public:
     virtual ~PacketListener() {}
     virtual void ProcessPacket( const char *data, int size, 
             const IpEndpointName& remoteEndpoint ) = 0;
+    // Called after ProcessPacket() has been called for all packets that were received
+    // together.
+    virtual void PacketBatchComplete() {}
 };
 
 #endif /* INCLUDED_PACKETLISTENER_H */
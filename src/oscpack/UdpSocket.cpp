@@ -409,6 +409,7 @@ public:
                     int size = socketListeners_[i].second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
                     if( size > 0 ){
                         socketListeners_[i].first->ProcessPacket( data, size, remoteEndpoint );
+                        socketListeners_[i].first->PacketBatchComplete();
                         if( break_ )
                             break;
                     }
@@ -550,6 +551,9 @@ void SocketReceiveMultiplexer::AsynchronousBreak()
 typedef ssize_t socklen_t;
 #endif
 
+// Maximum number of datagrams read from a socket each time it becomes readable.
+static const int MAX_RECEIVE_BATCH_SIZE = 16;
+
 
 static void SockaddrFromIpEndpointName( struct sockaddr_in& sockAddr, const IpEndpointName& endpoint )
 {
@@ -714,6 +718,52 @@ public:
         return result;
     }
 
+    // Reads up to maxPackets datagrams without blocking. Datagram i is stored at
+    // data + i*size. Returns the number of datagrams read.
+    int ReceiveBatch( IpEndpointName *remoteEndpoints, char *data, int size,
+            int *packetSizes, int maxPackets )
+    {
+        assert( isBound_ );
+        assert( maxPackets <= MAX_RECEIVE_BATCH_SIZE );
+
+        struct sockaddr_in fromAddrs[ MAX_RECEIVE_BATCH_SIZE ];
+        int numPackets = 0;
+#ifdef __linux__
+        // One system call for the whole batch.
+        struct mmsghdr msgs[ MAX_RECEIVE_BATCH_SIZE ];
+        struct iovec iovecs[ MAX_RECEIVE_BATCH_SIZE ];
+        memset( msgs, 0, sizeof(msgs) );
+        for( int i = 0; i < maxPackets; ++i ){
+            iovecs[i].iov_base = data + i*size;
+            iovecs[i].iov_len = size;
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &fromAddrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(fromAddrs[i]);
+        }
+        int result = recvmmsg( socket_, msgs, maxPackets, MSG_DONTWAIT, 0 );
+        if( result < 0 )
+            return 0;
+        for( ; numPackets < result; ++numPackets )
+            packetSizes[numPackets] = (int)msgs[numPackets].msg_len;
+#else
+        while( numPackets < maxPackets ){
+            socklen_t fromAddrLen = sizeof(fromAddrs[numPackets]);
+            int result = recvfrom(socket_, data + numPackets*size, size, MSG_DONTWAIT,
+                    (struct sockaddr *) &fromAddrs[numPackets], (socklen_t*)&fromAddrLen);
+            if( result < 0 )
+                break;
+            packetSizes[numPackets] = result;
+            ++numPackets;
+        }
+#endif
+        for( int i = 0; i < numPackets; ++i ){
+            remoteEndpoints[i].address = ntohl(fromAddrs[i].sin_addr.s_addr);
+            remoteEndpoints[i].port = ntohs(fromAddrs[i].sin_port);
+        }
+        return numPackets;
+    }
+
     int Socket() { return socket_; }
 };
 
@@ -896,8 +946,9 @@ public:
         std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
 
         const int MAX_BUFFER_SIZE = 65536;
-        char *data = new char[ MAX_BUFFER_SIZE ];
-        IpEndpointName remoteEndpoint;
+        char *data = new char[ MAX_BUFFER_SIZE*MAX_RECEIVE_BATCH_SIZE ];
+        int packetSizes[ MAX_RECEIVE_BATCH_SIZE ];
+        IpEndpointName remoteEndpoints[ MAX_RECEIVE_BATCH_SIZE ];
 
         struct timeval timeout;
 
@@ -934,12 +985,19 @@ public:
 
                 if( FD_ISSET( i->second->impl_->Socket(), &tempfds ) ){
 
-                    int size = i->second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
-                    if( size > 0 ){
-                        i->first->ProcessPacket( data, size, remoteEndpoint );
-                        if( break_ )
-                            break;
+                    // Everything that arrived since the last select() is handled as
+                    // one batch. If more is pending, select() returns immediately.
+                    int numPackets = i->second->impl_->ReceiveBatch( remoteEndpoints,
+                            data, MAX_BUFFER_SIZE, packetSizes, MAX_RECEIVE_BATCH_SIZE );
+                    for( int j = 0; j < numPackets && !break_; ++j ){
+                        if( packetSizes[j] > 0 )
+                            i->first->ProcessPacket( data + j*MAX_BUFFER_SIZE,
+                                    packetSizes[j], remoteEndpoints[j] );
                     }
+                    if( numPackets > 0 )
+                        i->first->PacketBatchComplete();
+                    if( break_ )
+                        break;
                 }
             }
 
@@ -37,6 +37,7 @@
 #include "../base/ObjectCounter.h"
 
 #include "../graphics/GLContext.h"
+#include "../graphics/RenderBatcher.h"
 #include "../graphics/Color.h"
 
 #include <object.h>
@@ -111,6 +112,7 @@ void AreaNode::connectDisplay()
         notifySubscribers("SIZE_CHANGED", m_RelViewport.size());
     }
     m_bTransformChanged = true;
+    invalidateHitBounds();
     Node::connectDisplay();
 }
 
@@ -186,6 +188,7 @@ void AreaNode::setAngle(float angle)
 {
     m_Angle = fmod(angle, 2*(float)M_PI);
     m_bTransformChanged = true;
+    invalidateHitBounds();
 }
 
 glm::vec2 AreaNode::getPivot() const
@@ -203,6 +206,7 @@ void AreaNode::setPivot(const glm::vec2& pt)
     m_Pivot.y = pt.y;
     m_bHasCustomPivot = true;
     m_bTransformChanged = true;
+    invalidateHitBounds();
 }
 
 const std::string& AreaNode::getElementOutlineColor() const
@@ -241,6 +245,17 @@ void AreaNode::getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements)
     }
 }
 
+bool AreaNode::getHitBounds(FRect& bounds)
+{
+    bounds = localToParentBounds(FRect(glm::vec2(0,0), getSize()));
+    return true;
+}
+
+void AreaNode::calcGeometry()
+{
+    calcTransform();
+}
+
 void AreaNode::preRender(const VertexArrayPtr& pVA, bool bIsParentActive,
         float parentEffectiveOpacity)
 {
@@ -254,10 +269,18 @@ void AreaNode::maybeRender(GLContext* pContext, const glm::mat4& parentTransform
 {
     AVG_ASSERT(getState() == NS_CANRENDER);
     if (isVisible()) {
+        if (!usesRenderBatcher()) {
+            pContext->getRenderBatcher()->flush();
+        }
         render(pContext, parentTransform*m_LocalTransform);
     }
 }
 
+bool AreaNode::usesRenderBatcher() const
+{
+    return false;
+}
+
 void AreaNode::renderOutlines(const VertexArrayPtr& pVA, Pixel32 parentColor)
 {
     Pixel32 effColor = getEffectiveOutlineColor(parentColor);
@@ -306,6 +329,7 @@ void AreaNode::setViewport(float x, float y, float width, float height)
         notifySubscribers("SIZE_CHANGED", m_RelViewport.size());
     }
     m_bTransformChanged = true;
+    invalidateHitBounds();
 }
 
 const FRect& AreaNode::getRelViewport() const
@@ -340,6 +364,19 @@ Pixel32 AreaNode::getEffectiveOutlineColor(Pixel32 parentColor) const
     }
 }
 
+FRect AreaNode::localToParentBounds(const FRect& localBounds) const
+{
+    if (getAngle() == 0) {
+        return FRect(toGlobal(localBounds.tl), toGlobal(localBounds.br));
+    }
+    glm::vec2 p0 = toGlobal(localBounds.tl);
+    FRect bounds(p0, p0);
+    bounds.expand(toGlobal(glm::vec2(localBounds.br.x, localBounds.tl.y)));
+    bounds.expand(toGlobal(localBounds.br));
+    bounds.expand(toGlobal(glm::vec2(localBounds.tl.x, localBounds.br.y)));
+    return bounds;
+}
+
 void AreaNode::calcTransform()
 {
     if (m_bTransformChanged) {
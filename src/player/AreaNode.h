@@ -85,7 +85,9 @@ class AVG_API AreaNode: public Node
         virtual glm::vec2 toGlobal(const glm::vec2& localPos) const;
         
         virtual void getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements);
+        virtual bool getHitBounds(FRect& bounds);
 
+        virtual void calcGeometry();
         virtual void preRender(const VertexArrayPtr& pVA, bool bIsParentActive,
                 float parentEffectiveOpacity);
         virtual void maybeRender(GLContext* pContext, const glm::mat4& parentTransform);
@@ -104,6 +106,10 @@ class AVG_API AreaNode: public Node
         AreaNode(const std::string& sPublisherName);
         glm::vec2 getUserSize() const;
         Pixel32 getEffectiveOutlineColor(Pixel32 parentColor) const;
+        FRect localToParentBounds(const FRect& localBounds) const;
+        // Nodes that don't draw through the RenderBatcher may change GL state 
+        // directly, so queued draws are flushed before they render.
+        virtual bool usesRenderBatcher() const;
 
     private:
         void calcTransform();
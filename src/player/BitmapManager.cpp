@@ -29,14 +29,27 @@
 #include  <stdlib.h>
 
 #include "../base/OSHelper.h"
+#include "../base/Logger.h"
+#include "../base/StringHelper.h"
+#include "../base/TimeSource.h"
+
+#include "../graphics/Bitmap.h"
+#include "../graphics/ImageCache.h"
+
+#include <algorithm>
 
 using namespace std;
 
 namespace avg {
 
+static const unsigned MAX_LATENCIES = 1000;
+
 BitmapManager * BitmapManager::s_pBitmapManager=0;
 
 BitmapManager::BitmapManager()
+    : m_NextRequestID(1),
+      m_MaxCallbacksPerFrame(0),
+      m_NextLatencyIndex(0)
 {
     if (s_pBitmapManager) {
         throw Exception(AVG_ERR_UNKNOWN, "BitmapMananger has already been instantiated.");
@@ -55,10 +68,16 @@ BitmapManager::~BitmapManager()
     while (!m_pCmdQueue->empty()) {
         m_pCmdQueue->pop();
     }
+    m_RequestQueue.clear();
     while (!m_pMsgQueue->empty()) {
         m_pMsgQueue->pop();
     }
     stopThreads();
+    if (!m_Latencies.empty()) {
+        AVG_TRACE(Logger::category::PROFILE, Logger::severity::INFO,
+                "Async bitmap load latency: p50 " << getLatencyPercentile(50)
+                << " ms, p99 " << getLatencyPercentile(99) << " ms");
+    }
     s_pBitmapManager = 0;
 }
 
@@ -70,22 +89,49 @@ BitmapManager* BitmapManager::get()
     return s_pBitmapManager;
 }
 
-void BitmapManager::loadBitmapPy(const UTF8String& sUtf8FileName,
-        const boost::python::object& pyFunc, PixelFormat pf)
+int BitmapManager::loadBitmapPy(const UTF8String& sUtf8FileName,
+        const boost::python::object& pyFunc, PixelFormat pf,
+        BitmapManagerMsg::Priority priority, const glm::vec2& targetSize)
 {
-    std::string sFileName = convertUTF8ToFilename(sUtf8FileName);
     BitmapManagerMsgPtr pMsg = BitmapManagerMsgPtr(
-            new BitmapManagerMsg(sUtf8FileName, pyFunc, pf));
-    internalLoadBitmap(pMsg);
+            new BitmapManagerMsg(sUtf8FileName, pyFunc, pf, priority,
+                    IntPoint(targetSize)));
+    return internalLoadBitmap(pMsg);
 }
 
-void BitmapManager::loadBitmap(const UTF8String& sUtf8FileName,
-        IBitmapLoadedListener* pLoadedListener, PixelFormat pf)
+int BitmapManager::loadBitmap(const UTF8String& sUtf8FileName,
+        IBitmapLoadedListener* pLoadedListener, PixelFormat pf,
+        BitmapManagerMsg::Priority priority, const IntPoint& targetSize)
 {
-    std::string sFileName = convertUTF8ToFilename(sUtf8FileName);
     BitmapManagerMsgPtr pMsg = BitmapManagerMsgPtr(
-            new BitmapManagerMsg(sUtf8FileName, pLoadedListener, pf));
-    internalLoadBitmap(pMsg);
+            new BitmapManagerMsg(sUtf8FileName, pLoadedListener, pf, priority,
+                    targetSize));
+    return internalLoadBitmap(pMsg);
+}
+
+bool BitmapManager::cancel(int requestID)
+{
+    RequestMap::iterator it = m_pRequests.find(requestID);
+    if (it == m_pRequests.end()) {
+        return false;
+    }
+    BitmapManagerMsgPtr pMsg = it->second;
+    m_pRequests.erase(it);
+    pMsg->cancel();
+
+    LoadMap::iterator loadIt = m_Loads.find(getLoadKey(pMsg));
+    if (loadIt != m_Loads.end()) {
+        Load& load = loadIt->second;
+        bool bAllCancelled = load.m_pMsg->isCancelled();
+        for (unsigned i=0; i<load.m_pFollowers.size(); ++i) {
+            bAllCancelled &= load.m_pFollowers[i]->isCancelled();
+        }
+        // If a thread is already loading the file, the result is discarded later.
+        if (bAllCancelled && m_RequestQueue.remove(load.m_pMsg)) {
+            m_Loads.erase(loadIt);
+        }
+    }
+    return true;
 }
 
 void BitmapManager::setNumThreads(int numThreads)
@@ -94,16 +140,139 @@ void BitmapManager::setNumThreads(int numThreads)
     startThreads(numThreads);
 }
 
+void BitmapManager::setMaxCallbacksPerFrame(int maxCallbacks)
+{
+    if (maxCallbacks < 0) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE,
+                "Max. callbacks per frame must be 0 or greater (was " +
+                toString(maxCallbacks) + ").");
+    }
+    m_MaxCallbacksPerFrame = maxCallbacks;
+}
+
+int BitmapManager::getMaxCallbacksPerFrame() const
+{
+    return m_MaxCallbacksPerFrame;
+}
+
+int BitmapManager::getNumPendingRequests() const
+{
+    return int(m_pRequests.size());
+}
+
+int BitmapManager::getQueueLength() const
+{
+    return m_RequestQueue.size();
+}
+
+float BitmapManager::getLatencyPercentile(float percentile) const
+{
+    if (percentile < 0 || percentile > 100) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE,
+                "Percentile must be between 0 and 100 (was " + toString(percentile) +
+                ").");
+    }
+    if (m_Latencies.empty()) {
+        return 0;
+    }
+    vector<float> latencies = m_Latencies;
+    unsigned i = unsigned(percentile/100*(latencies.size()-1)+0.5f);
+    nth_element(latencies.begin(), latencies.begin()+i, latencies.end());
+    return latencies[i];
+}
+
 void BitmapManager::onFrameEnd()
 {
     while (!m_pMsgQueue->empty()) {
         BitmapManagerMsgPtr pMsg = m_pMsgQueue->pop();
-        pMsg->executeCallback();
+        LoadMap::iterator it = m_Loads.find(getLoadKey(pMsg));
+        AVG_ASSERT(it != m_Loads.end() && it->second.m_pMsg == pMsg);
+        Load& load = it->second;
+        addReadyMsg(pMsg);
+        for (unsigned i=0; i<load.m_pFollowers.size(); ++i) {
+            BitmapManagerMsgPtr pFollower = load.m_pFollowers[i];
+            if (!pFollower->isCancelled()) {
+                pFollower->setResult(*pMsg);
+                addReadyMsg(pFollower);
+            }
+        }
+        m_Loads.erase(it);
+    }
+
+    int numCallbacks = 0;
+    for (int i=0; i<BitmapManagerMsg::NUM_PRIORITIES; ++i) {
+        deque<BitmapManagerMsgPtr>& readyMsgs = m_pReadyMsgs[i];
+        while (!readyMsgs.empty() && 
+                (m_MaxCallbacksPerFrame == 0 || numCallbacks < m_MaxCallbacksPerFrame))
+        {
+            BitmapManagerMsgPtr pMsg = readyMsgs.front();
+            readyMsgs.pop_front();
+            if (pMsg->isCancelled()) {
+                continue;
+            }
+            m_pRequests.erase(pMsg->getID());
+            float latency = TimeSource::get()->getCurrentMicrosecs()/1000.0f - 
+                    pMsg->getStartTime();
+            if (m_Latencies.size() < MAX_LATENCIES) {
+                m_Latencies.push_back(latency);
+            } else {
+                m_Latencies[m_NextLatencyIndex] = latency;
+            }
+            m_NextLatencyIndex = (m_NextLatencyIndex+1) % MAX_LATENCIES;
+            numCallbacks++;
+            pMsg->executeCallback();
+        }
     }
 }
 
-void BitmapManager::internalLoadBitmap(BitmapManagerMsgPtr pMsg)
+BitmapManager::LoadKey BitmapManager::getLoadKey(BitmapManagerMsgPtr pMsg)
+{
+    return LoadKey(pMsg->getFilename(), pMsg->getPixelFormat(), pMsg->getTargetSize());
+}
+
+BitmapManager::LoadKey::LoadKey(const string& sFilename, PixelFormat pf,
+        const IntPoint& targetSize)
+    : m_sFilename(sFilename),
+      m_PF(pf),
+      m_TargetSize(targetSize)
 {
+}
+
+bool BitmapManager::LoadKey::operator <(const LoadKey& other) const
+{
+    if (m_sFilename != other.m_sFilename) {
+        return m_sFilename < other.m_sFilename;
+    }
+    if (m_PF != other.m_PF) {
+        return m_PF < other.m_PF;
+    }
+    if (m_TargetSize.x != other.m_TargetSize.x) {
+        return m_TargetSize.x < other.m_TargetSize.x;
+    }
+    return m_TargetSize.y < other.m_TargetSize.y;
+}
+
+int BitmapManager::internalLoadBitmap(BitmapManagerMsgPtr pMsg)
+{
+    int id = m_NextRequestID++;
+    pMsg->setID(id);
+    m_pRequests[id] = pMsg;
+    if (loadFromCache(pMsg)) {
+        return id;
+    }
+
+    BitmapManagerMsg::Priority priority = pMsg->getPriority();
+    LoadMap::iterator it = m_Loads.find(getLoadKey(pMsg));
+    if (it != m_Loads.end()) {
+        Load& load = it->second;
+        load.m_pFollowers.push_back(pMsg);
+        if (priority < load.m_Priority) {
+            load.m_Priority = priority;
+            m_RequestQueue.raisePriority(load.m_pMsg, priority);
+        }
+        return id;
+    }
+
 #ifdef WIN32
     int rc = _access(pMsg->getFilename().c_str(), 04);
 #else
@@ -115,9 +284,46 @@ void BitmapManager::internalLoadBitmap(BitmapManagerMsgPtr pMsg)
                 std::string("BitmapManager can't open output file '") +
                 pMsg->getFilename() + "'. Reason: " +
                 strerror(errno)));
-        m_pMsgQueue->push(pMsg);
+        addReadyMsg(pMsg);
+    } else {
+        Load& load = m_Loads[getLoadKey(pMsg)];
+        load.m_pMsg = pMsg;
+        load.m_Priority = priority;
+        m_RequestQueue.push(pMsg, priority);
+        m_pCmdQueue->pushCmd(boost::bind(&BitmapManagerThread::loadNextBitmap, _1));
+    }
+    return id;
+}
+
+bool BitmapManager::loadFromCache(BitmapManagerMsgPtr pMsg)
+{
+    if (!ImageCache::exists()) {
+        return false;
+    }
+    CachedImagePtr pImage = ImageCache::get()->findImage(pMsg->getFilename());
+    if (!pImage || !pImage->getBmp()) {
+        return false;
+    }
+    BitmapPtr pCachedBmp = pImage->getBmp();
+    PixelFormat pf = pMsg->getPixelFormat();
+    bool bUsable;
+    if (pf == NO_PIXELFORMAT) {
+        // Compressed images aren't what loadBitmap() would return.
+        bUsable = pCachedBmp->getPixelFormat() != B5G6R5;
     } else {
-        m_pCmdQueue->pushCmd(boost::bind(&BitmapManagerThread::loadBitmap, _1, pMsg));
+        bUsable = pCachedBmp->getPixelFormat() == pf;
+    }
+    if (bUsable) {
+        pMsg->setBitmap(BitmapPtr(new Bitmap(*pCachedBmp)));
+        addReadyMsg(pMsg);
+    }
+    return bUsable;
+}
+
+void BitmapManager::addReadyMsg(BitmapManagerMsgPtr pMsg)
+{
+    if (!pMsg->isCancelled()) {
+        m_pReadyMsgs[pMsg->getPriority()].push_back(pMsg);
     }
 }
 
@@ -125,7 +331,7 @@ void BitmapManager::startThreads(int numThreads)
 {
     for (int i=0; i<numThreads; ++i) {
         boost::thread* pThread = new boost::thread(
-                BitmapManagerThread(*m_pCmdQueue, *m_pMsgQueue));
+                BitmapManagerThread(*m_pCmdQueue, m_RequestQueue, *m_pMsgQueue));
         m_pBitmapManagerThreads.push_back(pThread);
     }
 }
@@ -26,6 +26,7 @@
 
 #include "BitmapManagerThread.h"
 #include "BitmapManagerMsg.h"
+#include "BitmapRequestQueue.h"
 
 #include "../base/Queue.h"
 #include "../base/IFrameEndListener.h"
@@ -33,6 +34,8 @@
 #include <boost/thread.hpp>
 
 #include <vector>
+#include <deque>
+#include <map>
 
 namespace avg {
 
@@ -42,16 +45,46 @@ class AVG_API BitmapManager : public IFrameEndListener
         BitmapManager();
         ~BitmapManager();
         static BitmapManager* get();
-        void loadBitmapPy(const UTF8String& sUtf8FileName,
-                const boost::python::object& pyFunc, PixelFormat pf=NO_PIXELFORMAT);
-        void loadBitmap(const UTF8String& sUtf8FileName,
-                IBitmapLoadedListener* pLoadedListener, PixelFormat pf=NO_PIXELFORMAT);
+        // The load functions return an id that can be passed to cancel(). If
+        // targetSize is nonzero, decoders that support it (jpeg) may return a
+        // downscaled bitmap that is still at least as large as targetSize.
+        int loadBitmapPy(const UTF8String& sUtf8FileName,
+                const boost::python::object& pyFunc, PixelFormat pf=NO_PIXELFORMAT,
+                BitmapManagerMsg::Priority priority=BitmapManagerMsg::VISIBLE,
+                const glm::vec2& targetSize=glm::vec2(0,0));
+        int loadBitmap(const UTF8String& sUtf8FileName,
+                IBitmapLoadedListener* pLoadedListener, PixelFormat pf=NO_PIXELFORMAT,
+                BitmapManagerMsg::Priority priority=BitmapManagerMsg::VISIBLE,
+                const IntPoint& targetSize=IntPoint(0,0));
+        // Returns false if the callback has already been called.
+        bool cancel(int requestID);
         void setNumThreads(int numThreads);
+        // 0 means no limit.
+        void setMaxCallbacksPerFrame(int maxCallbacks);
+        int getMaxCallbacksPerFrame() const;
+
+        int getNumPendingRequests() const;
+        int getQueueLength() const;
+        // Time between the load request and the callback in milliseconds, over the 
+        // last requests.
+        float getLatencyPercentile(float percentile) const;
 
         virtual void onFrameEnd();
         
     private:
-        void internalLoadBitmap(BitmapManagerMsgPtr pMsg);
+        struct LoadKey {
+            LoadKey(const std::string& sFilename, PixelFormat pf,
+                    const IntPoint& targetSize);
+            bool operator <(const LoadKey& other) const;
+
+            std::string m_sFilename;
+            PixelFormat m_PF;
+            IntPoint m_TargetSize;
+        };
+        static LoadKey getLoadKey(BitmapManagerMsgPtr pMsg);
+        int internalLoadBitmap(BitmapManagerMsgPtr pMsg);
+        bool loadFromCache(BitmapManagerMsgPtr pMsg);
+        void addReadyMsg(BitmapManagerMsgPtr pMsg);
         void startThreads(int numThreads);
         void stopThreads();
 
@@ -59,7 +92,29 @@ class AVG_API BitmapManager : public IFrameEndListener
 
         std::vector<boost::thread*> m_pBitmapManagerThreads;
         BitmapManagerThread::CQueuePtr m_pCmdQueue;
+        BitmapRequestQueue m_RequestQueue;
         BitmapManagerMsgQueuePtr m_pMsgQueue;
+
+        // Requests whose callback hasn't been called yet.
+        typedef std::map<int, BitmapManagerMsgPtr> RequestMap;
+        RequestMap m_pRequests;
+        int m_NextRequestID;
+
+        // Requests for the same file are coalesced: Only the first one is loaded, the
+        // others get a copy of its result.
+        struct Load {
+            BitmapManagerMsgPtr m_pMsg;
+            std::vector<BitmapManagerMsgPtr> m_pFollowers;
+            BitmapManagerMsg::Priority m_Priority;
+        };
+        typedef std::map<LoadKey, Load> LoadMap;
+        LoadMap m_Loads;
+
+        std::deque<BitmapManagerMsgPtr> m_pReadyMsgs[BitmapManagerMsg::NUM_PRIORITIES];
+        int m_MaxCallbacksPerFrame;
+
+        std::vector<float> m_Latencies;
+        unsigned m_NextLatencyIndex;
 };
 
 }
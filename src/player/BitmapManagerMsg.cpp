@@ -26,23 +26,27 @@
 #include "../base/Exception.h"
 #include "../base/TimeSource.h"
 
+#include "../graphics/Bitmap.h"
+
 
 namespace avg {
 
 BitmapManagerMsg::BitmapManagerMsg(const UTF8String& sFilename,
-        const boost::python::object& onLoadedCb, PixelFormat pf) 
+        const boost::python::object& onLoadedCb, PixelFormat pf, Priority priority,
+        const IntPoint& targetSize) 
 {
     ObjectCounter::get()->incRef(&typeid(*this));
-    init(sFilename, pf);
+    init(sFilename, pf, priority, targetSize);
     m_OnLoadedCb = onLoadedCb;
     m_pLoadedListener = 0;
 }
 
 BitmapManagerMsg::BitmapManagerMsg(const UTF8String& sFilename,
-        IBitmapLoadedListener* pLoadedListener, PixelFormat pf)
+        IBitmapLoadedListener* pLoadedListener, PixelFormat pf, Priority priority,
+        const IntPoint& targetSize)
 {
     ObjectCounter::get()->incRef(&typeid(*this));
-    init(sFilename, pf);
+    init(sFilename, pf, priority, targetSize);
     m_OnLoadedCb = boost::python::object();
     m_pLoadedListener = pLoadedListener;
 }
@@ -55,11 +59,16 @@ BitmapManagerMsg::~BitmapManagerMsg()
     ObjectCounter::get()->decRef(&typeid(*this));
 }
 
-void BitmapManagerMsg::init(const UTF8String& sFilename, PixelFormat pf)
+void BitmapManagerMsg::init(const UTF8String& sFilename, PixelFormat pf,
+        Priority priority, const IntPoint& targetSize)
 {
     m_sFilename = sFilename;
     m_StartTime = TimeSource::get()->getCurrentMicrosecs()/1000.0f;
     m_PF = pf;
+    m_TargetSize = targetSize;
+    m_Priority = priority;
+    m_ID = 0;
+    m_bCancelled = false;
     m_MsgType = REQUEST;
     m_pEx = 0;
 }
@@ -94,7 +103,6 @@ const UTF8String BitmapManagerMsg::getFilename()
 
 float BitmapManagerMsg::getStartTime()
 {
-    AVG_ASSERT(m_MsgType == REQUEST);
     return m_StartTime;
 }
     
@@ -104,6 +112,37 @@ PixelFormat BitmapManagerMsg::getPixelFormat()
     return m_PF;
 }
 
+const IntPoint& BitmapManagerMsg::getTargetSize() const
+{
+    AVG_ASSERT(m_MsgType == REQUEST);
+    return m_TargetSize;
+}
+
+BitmapManagerMsg::Priority BitmapManagerMsg::getPriority() const
+{
+    return m_Priority;
+}
+
+void BitmapManagerMsg::setID(int id)
+{
+    m_ID = id;
+}
+
+int BitmapManagerMsg::getID() const
+{
+    return m_ID;
+}
+
+void BitmapManagerMsg::cancel()
+{
+    m_bCancelled = true;
+}
+
+bool BitmapManagerMsg::isCancelled() const
+{
+    return m_bCancelled;
+}
+
 void BitmapManagerMsg::setBitmap(BitmapPtr pBmp)
 {
     AVG_ASSERT(m_MsgType == REQUEST);
@@ -118,4 +157,18 @@ void BitmapManagerMsg::setError(const Exception& ex)
     m_pEx = new Exception(ex);
 }
 
+void BitmapManagerMsg::setResult(const BitmapManagerMsg& otherMsg)
+{
+    switch (otherMsg.m_MsgType) {
+        case BITMAP:
+            setBitmap(BitmapPtr(new Bitmap(*otherMsg.m_pBmp)));
+            break;
+        case ERROR:
+            setError(*otherMsg.m_pEx);
+            break;
+        default:
+            AVG_ASSERT(false);
+    }
+}
+
 }
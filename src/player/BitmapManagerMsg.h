@@ -28,6 +28,7 @@
 #include "../base/Queue.h"
 #include "../base/UTF8String.h"
 #include "../base/Exception.h"
+#include "../base/GLMHelper.h"
 
 #include "../graphics/PixelFormat.h"
 
@@ -45,30 +46,50 @@ class AVG_API BitmapManagerMsg
 {
 public:
     enum MsgType {REQUEST, BITMAP, ERROR};
+    // Requests with lower values are loaded and delivered first.
+    enum Priority {VISIBLE, PREFETCH, BACKGROUND, NUM_PRIORITIES};
 
+    // If targetSize is nonzero, the bitmap may be returned downscaled as long as it
+    // is still at least as large as targetSize.
     BitmapManagerMsg(const UTF8String& sFilename,
-            const boost::python::object& onLoadedCb, PixelFormat pf);
+            const boost::python::object& onLoadedCb, PixelFormat pf, Priority priority,
+            const IntPoint& targetSize);
     BitmapManagerMsg(const UTF8String& sFilename,
-            IBitmapLoadedListener* pLoadedListener, PixelFormat pf);
+            IBitmapLoadedListener* pLoadedListener, PixelFormat pf, Priority priority,
+            const IntPoint& targetSize);
     virtual ~BitmapManagerMsg();
-    void init(const UTF8String& sFilename, PixelFormat pf);
+    void init(const UTF8String& sFilename, PixelFormat pf, Priority priority,
+            const IntPoint& targetSize);
 
     void executeCallback();
     const UTF8String getFilename();
     float getStartTime();
     PixelFormat getPixelFormat();
+    const IntPoint& getTargetSize() const;
+    Priority getPriority() const;
+    void setID(int id);
+    int getID() const;
+    void cancel();
+    bool isCancelled() const;
     void setBitmap(BitmapPtr pBmp);
     void setError(const Exception& ex);
+    // Delivers the result of another request for the same file. The bitmap is copied
+    // so the callbacks can't interfere with each other.
+    void setResult(const BitmapManagerMsg& otherMsg);
 
     MsgType getType() { return m_MsgType; };
 
 private:
     UTF8String m_sFilename;
     float m_StartTime;
+    Priority m_Priority;
+    int m_ID;
+    bool m_bCancelled;
     BitmapPtr m_pBmp;
     boost::python::object m_OnLoadedCb;
     IBitmapLoadedListener* m_pLoadedListener;
     PixelFormat m_PF;
+    IntPoint m_TargetSize;
     MsgType m_MsgType;
     Exception* m_pEx;
 };
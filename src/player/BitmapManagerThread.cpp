@@ -32,8 +32,10 @@
 
 namespace avg {
 
-BitmapManagerThread::BitmapManagerThread(CQueue& cmdQ, BitmapManagerMsgQueue& MsgQueue)
+BitmapManagerThread::BitmapManagerThread(CQueue& cmdQ, BitmapRequestQueue& requestQueue,
+        BitmapManagerMsgQueue& MsgQueue)
     : WorkerThread<BitmapManagerThread>("BitmapManager", cmdQ),
+      m_RequestQueue(requestQueue),
       m_MsgQueue(MsgQueue),
       m_TotalLatency(0),
       m_NumBmpsLoaded(0)
@@ -57,13 +59,22 @@ void BitmapManagerThread::deinit()
 
 static ProfilingZoneID LoaderProfilingZone("loadBitmap", true);
 
+void BitmapManagerThread::loadNextBitmap()
+{
+    BitmapManagerMsgPtr pRequest = m_RequestQueue.pop();
+    if (pRequest) {
+        loadBitmap(pRequest);
+    }
+}
+
 void BitmapManagerThread::loadBitmap(BitmapManagerMsgPtr pRequest)
 {
     BitmapPtr pBmp;
     ScopeTimer timer(LoaderProfilingZone);
     float startTime = pRequest->getStartTime();
     try {
-        pBmp = avg::loadBitmap(pRequest->getFilename(), pRequest->getPixelFormat());
+        pBmp = avg::loadBitmap(pRequest->getFilename(), pRequest->getPixelFormat(),
+                pRequest->getTargetSize());
         pRequest->setBitmap(pBmp);
     } catch (const Exception& ex) {
         pRequest->setError(ex);
@@ -25,6 +25,7 @@
 #include "../api.h"
 
 #include "BitmapManagerMsg.h"
+#include "BitmapRequestQueue.h"
 
 #include "../base/WorkerThread.h"
 
@@ -36,13 +37,18 @@ namespace avg {
 class AVG_API BitmapManagerThread : public WorkerThread<BitmapManagerThread>
 {
     public:
-        BitmapManagerThread(CQueue& cmdQ, BitmapManagerMsgQueue& MsgQueue);
+        BitmapManagerThread(CQueue& cmdQ, BitmapRequestQueue& requestQueue,
+                BitmapManagerMsgQueue& MsgQueue);
                 
+        // Loads the request with the highest priority. One command is queued for every
+        // request; if the request has been cancelled, this does nothing.
+        void loadNextBitmap();
         void loadBitmap(BitmapManagerMsgPtr pRequest);
         
     private:
         virtual bool work();
         virtual void deinit();
+        BitmapRequestQueue& m_RequestQueue;
         BitmapManagerMsgQueue& m_MsgQueue;
 
         float m_TotalLatency;
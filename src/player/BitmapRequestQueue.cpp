@@ -0,0 +1,116 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "BitmapRequestQueue.h"
+
+#include "../base/Exception.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace avg {
+
+typedef boost::unique_lock<boost::mutex> lock_guard;
+
+BitmapRequestQueue::BitmapRequestQueue()
+{
+}
+
+BitmapRequestQueue::~BitmapRequestQueue()
+{
+}
+
+void BitmapRequestQueue::push(BitmapManagerMsgPtr pRequest,
+        BitmapManagerMsg::Priority priority)
+{
+    lock_guard lock(m_Mutex);
+    m_Requests[priority].push_back(pRequest);
+}
+
+BitmapManagerMsgPtr BitmapRequestQueue::pop()
+{
+    lock_guard lock(m_Mutex);
+    for (int i=0; i<BitmapManagerMsg::NUM_PRIORITIES; ++i) {
+        if (!m_Requests[i].empty()) {
+            BitmapManagerMsgPtr pRequest = m_Requests[i].front();
+            m_Requests[i].pop_front();
+            return pRequest;
+        }
+    }
+    return BitmapManagerMsgPtr();
+}
+
+bool BitmapRequestQueue::remove(BitmapManagerMsgPtr pRequest)
+{
+    lock_guard lock(m_Mutex);
+    for (int i=0; i<BitmapManagerMsg::NUM_PRIORITIES; ++i) {
+        if (removeFromList(m_Requests[i], pRequest)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BitmapRequestQueue::raisePriority(BitmapManagerMsgPtr pRequest,
+        BitmapManagerMsg::Priority priority)
+{
+    lock_guard lock(m_Mutex);
+    for (int i=priority+1; i<BitmapManagerMsg::NUM_PRIORITIES; ++i) {
+        if (removeFromList(m_Requests[i], pRequest)) {
+            m_Requests[priority].push_back(pRequest);
+            return;
+        }
+    }
+}
+
+void BitmapRequestQueue::clear()
+{
+    lock_guard lock(m_Mutex);
+    for (int i=0; i<BitmapManagerMsg::NUM_PRIORITIES; ++i) {
+        m_Requests[i].clear();
+    }
+}
+
+int BitmapRequestQueue::size() const
+{
+    lock_guard lock(m_Mutex);
+    int numRequests = 0;
+    for (int i=0; i<BitmapManagerMsg::NUM_PRIORITIES; ++i) {
+        numRequests += int(m_Requests[i].size());
+    }
+    return numRequests;
+}
+
+bool BitmapRequestQueue::removeFromList(RequestList& requests,
+        BitmapManagerMsgPtr pRequest)
+{
+    RequestList::iterator it = find(requests.begin(), requests.end(), pRequest);
+    if (it != requests.end()) {
+        requests.erase(it);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+}
@@ -0,0 +1,66 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _BitmapRequestQueue_H_
+#define _BitmapRequestQueue_H_
+
+#include "../api.h"
+
+#include "BitmapManagerMsg.h"
+
+#include <boost/thread/mutex.hpp>
+
+#include <deque>
+
+namespace avg {
+
+// Load requests that haven't been picked up by a BitmapManagerThread yet. Requests with
+// higher priority are handed out first, requests with the same priority in FIFO order.
+// Can be accessed from all threads.
+class AVG_API BitmapRequestQueue
+{
+public:
+    BitmapRequestQueue();
+    virtual ~BitmapRequestQueue();
+
+    void push(BitmapManagerMsgPtr pRequest, BitmapManagerMsg::Priority priority);
+    // Returns an empty pointer if there are no requests.
+    BitmapManagerMsgPtr pop();
+    // Returns false if the request has already been popped.
+    bool remove(BitmapManagerMsgPtr pRequest);
+    // Moves the request to the end of a higher-priority list. Does nothing if the
+    // request already has the same or a higher priority or has been popped.
+    void raisePriority(BitmapManagerMsgPtr pRequest, BitmapManagerMsg::Priority priority);
+    void clear();
+    int size() const;
+
+private:
+    typedef std::deque<BitmapManagerMsgPtr> RequestList;
+    static bool removeFromList(RequestList& requests, BitmapManagerMsgPtr pRequest);
+
+    RequestList m_Requests[BitmapManagerMsg::NUM_PRIORITIES];
+    mutable boost::mutex m_Mutex;
+};
+
+}
+
+#endif
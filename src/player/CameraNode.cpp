@@ -29,6 +29,7 @@
 #include "../base/Exception.h"
 #include "../base/ScopeTimer.h"
 #include "../base/XMLHelper.h"
+#include "../base/TimeSource.h"
 
 #include "../graphics/Filterfill.h"
 #include "../graphics/TextureMover.h"
@@ -77,9 +78,13 @@ void CameraNode::registerType()
 CameraNode::CameraNode(const ArgList& args, const string& sPublisherName)
     : RasterNode(sPublisherName),
       m_bIsPlaying(false),
+      m_bCaptureStarted(false),
       m_FrameNum(0),
+      m_CurCaptureTime(0),
       m_bAutoUpdateCameraImage(true),
       m_bNewBmp(false),
+      m_bMeasureLatency(false),
+      m_FrameLatency(0),
       m_bNewSurface(false)
 {
     args.setMembers(this);
@@ -156,7 +161,7 @@ void CameraNode::disconnect(bool bKill)
 
 void CameraNode::play()
 {
-    if (getState() == NS_CANRENDER) {
+    if (getState() == NS_CANRENDER && !m_bIsPlaying) {
         open();
     }
     m_bIsPlaying = true;
@@ -164,6 +169,9 @@ void CameraNode::play()
 
 void CameraNode::stop()
 {
+    if (m_pCamera) {
+        m_pCamera->stopCaptureThread();
+    }
     m_bIsPlaying = false;
 }
 
@@ -303,7 +311,13 @@ float CameraNode::getFPS() const
 
 void CameraNode::open()
 {
-    m_pCamera->startCapture();
+    // The driver-level capture keeps running after stop(), so only the capture thread
+    // is restarted by play().
+    if (!m_bCaptureStarted) {
+        m_pCamera->startCapture();
+        m_bCaptureStarted = true;
+    }
+    m_pCamera->startCaptureThread();
     setViewport(-32767, -32767, -32767, -32767);
     PixelFormat pf = getPixelFormat();
     IntPoint size = getMediaSize();
@@ -331,6 +345,16 @@ int CameraNode::getFrameNum() const
     return m_FrameNum;
 }
 
+float CameraNode::getFrameLatency() const
+{
+    return float(m_FrameLatency)/1000;
+}
+
+int CameraNode::getNumDroppedFrames() const
+{
+    return m_pCamera->getNumDroppedFrames();
+}
+
 static ProfilingZoneID CameraFetchImage("Camera fetch image");
 static ProfilingZoneID CameraDownloadProfilingZone("Camera tex download");
 
@@ -350,6 +374,7 @@ void CameraNode::preRender(const VertexArrayPtr& pVA, bool bIsParentActive,
                 GLContextManager::get()->scheduleTexUpload(m_pTex, m_pCurBmp);
                 scheduleFXRender();
                 m_bNewBmp = false;
+                m_bMeasureLatency = true;
             } else if (m_bNewSurface) {
                 BitmapPtr pBmp;
                 PixelFormat pf = getPixelFormat();
@@ -376,6 +401,10 @@ void CameraNode::render(GLContext* pContext, const glm::mat4& transform)
     if (m_bIsPlaying) {
         ScopeTimer Timer(CameraProfilingZone);
         blt32(pContext, transform);
+        if (m_bMeasureLatency) {
+            m_FrameLatency = TimeSource::get()->getCurrentMicrosecs()-m_CurCaptureTime;
+            m_bMeasureLatency = false;
+        }
     }
 }
 
@@ -386,18 +415,20 @@ PixelFormat CameraNode::getPixelFormat()
 
 void CameraNode::updateToLatestCameraImage()
 {
-    BitmapPtr pTmpBmp = m_pCamera->getImage(false);
-    while (pTmpBmp) {
+    // The capture thread only keeps the latest frame, so this never waits for the
+    // camera.
+    CameraFrame frame;
+    if (m_pCamera->getLatestFrame(frame)) {
         m_bNewBmp = true;
-        m_pCurBmp = pTmpBmp;
-        pTmpBmp = m_pCamera->getImage(false);
+        m_pCurBmp = frame.m_pBmp;
+        m_CurCaptureTime = frame.m_CaptureTime;
     }
 }
 
 void CameraNode::updateCameraImage()
 {
     if (!m_bAutoUpdateCameraImage) {
-        m_pCurBmp = m_pCamera->getImage(false);
+        updateToLatestCameraImage();
     }
 }
 
@@ -102,6 +102,8 @@ class AVG_API CameraNode : public RasterNode
         virtual void render(GLContext* pContext, const glm::mat4& transform);
 
         int getFrameNum() const;
+        float getFrameLatency() const;
+        int getNumDroppedFrames() const;
         IntPoint getMediaSize();
         virtual BitmapPtr getBitmap();
 
@@ -122,10 +124,14 @@ class AVG_API CameraNode : public RasterNode
         bool m_bIsPlaying;
     
         CameraPtr m_pCamera;
+        bool m_bCaptureStarted;
         int m_FrameNum;
         BitmapPtr m_pCurBmp;
+        long long m_CurCaptureTime;
         bool m_bAutoUpdateCameraImage;
         bool m_bNewBmp;
+        bool m_bMeasureLatency;
+        long long m_FrameLatency;
         bool m_bNewSurface;
 
         MCTexturePtr m_pTex;
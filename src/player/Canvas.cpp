@@ -22,6 +22,7 @@
 #include "Canvas.h"
 
 #include "Player.h"
+#include "PreRenderThreadPool.h"
 #include "AVGNode.h"
 #include "OffscreenCanvas.h"
 #include "RasterNode.h"
@@ -32,6 +33,7 @@
 #include "../base/ScopeTimer.h"
 
 #include "../graphics/StandardShader.h"
+#include "../graphics/RenderBatcher.h"
 #include "../graphics/GLContextManager.h"
 #include "../graphics/MCFBO.h"
 
@@ -233,11 +235,17 @@ Player* Canvas::getPlayer() const
 }
 
 static ProfilingZoneID PreRenderProfilingZone("PreRender");
+static ProfilingZoneID CalcGeometryProfilingZone("PreRender: calc geometry");
 static ProfilingZoneID VATransferProfilingZone("VA Transfer");
 
 void Canvas::preRender()
 {
     ScopeTimer Timer(PreRenderProfilingZone);
+    PreRenderThreadPool* pPreRenderPool = m_pPlayer->getPreRenderThreadPool();
+    if (pPreRenderPool) {
+        ScopeTimer calcTimer(CalcGeometryProfilingZone);
+        pPreRenderPool->calcGeometry(m_pRootNode.get());
+    }
     m_pVertexArray->reset();
     createStdSubVA();
     m_pRootNode->preRender(m_pVertexArray, true, 1.0f);
@@ -269,7 +277,9 @@ void Canvas::renderWindow(WindowPtr pWindow, MCFBOPtr pFBO, const IntRect& viewp
     }
     {
         ScopeTimer Timer(VATransferProfilingZone);
+        unsigned numBytesUploaded = m_pVertexArray->getNumBytesUploaded();
         m_pVertexArray->update(pContext);
+        Timer.addToCounter(m_pVertexArray->getNumBytesUploaded()-numBytesUploaded);
     }
     clearGLBuffers(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT | GL_DEPTH_BUFFER_BIT,
             !pFBO);
@@ -277,7 +287,11 @@ void Canvas::renderWindow(WindowPtr pWindow, MCFBOPtr pFBO, const IntRect& viewp
     m_pVertexArray->activate(pContext);
     {
         ScopeTimer timer(RootRenderProfilingZone);
+        RenderBatcher* pBatcher = pContext->getRenderBatcher();
+        pBatcher->begin(m_pVertexArray.get());
         m_pRootNode->maybeRender(pContext, projMat);
+        pBatcher->end();
+        timer.addToCounter(pBatcher->getNumDrawCalls());
     }
     renderOutlines(pContext, projMat);
 }
@@ -310,6 +324,9 @@ void Canvas::renderOutlines(GLContext* pContext, const glm::mat4& transform)
 
 void Canvas::createStdSubVA()
 {
+    if (m_pVertexArray->reuseSubVA(m_StdSubVA)) {
+        return;
+    }
     m_pVertexArray->startSubVA(m_StdSubVA);
     Pixel32 color(0, 0, 0, 0);
     m_StdSubVA.appendPos(vec2(0,0), vec2(0,0), color); 
@@ -340,6 +357,9 @@ void Canvas::resetFXSchedule()
 void Canvas::clip(GLContext* pContext, const glm::mat4& transform, SubVertexArray& va,
         GLenum stencilOp)
 {
+    // Everything queued so far needs to be drawn with the old clip region.
+    pContext->getRenderBatcher()->flush();
+
     // Disable drawing to color buffer
     glColorMask(0, 0, 0, 0);
 
@@ -242,6 +242,14 @@ void CircleNode::calcFillVertexes(const VertexDataPtr& pVertexData, Pixel32 colo
     }
 }
 
+bool CircleNode::getHitBounds(FRect& bounds)
+{
+    FilledVectorNode::getHitBounds(bounds);
+    float r = m_Radius+getStrokeWidth()/2;
+    expandHitBounds(bounds, FRect(m_Pos.x-r, m_Pos.y-r, m_Pos.x+r, m_Pos.y+r));
+    return true;
+}
+
 bool CircleNode::isInside(const glm::vec2& pos)
 {
     return (glm::length(pos-m_Pos) <= m_Radius+getStrokeWidth()/2);
@@ -121,6 +121,11 @@ vector<CursorEventPtr> Contact::getEvents() const
     return m_Events;
 }
 
+CursorEventPtr Contact::getLastEvent() const
+{
+    return m_Events.back();
+}
+
 void Contact::addEvent(CursorEventPtr pEvent)
 {
     pEvent->setCursorID(m_CursorID);
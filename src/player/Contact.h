@@ -61,6 +61,7 @@ public:
     glm::vec2 getMotionVec() const;
     float getDistanceTravelled() const;
     std::vector<CursorEventPtr> getEvents() const;
+    CursorEventPtr getLastEvent() const;
 
     void addEvent(CursorEventPtr pEvent);
     void sendEventToListeners(CursorEventPtr pCursorEvent);
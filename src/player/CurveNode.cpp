@@ -165,6 +165,15 @@ void CurveNode::calcVertexes(const VertexDataPtr& pVertexData, Pixel32 color)
     }
 }
 
+bool CurveNode::getHitBounds(FRect& bounds)
+{
+    VectorNode::getHitBounds(bounds);
+    if (!m_AABBs.empty()) {
+        expandHitBounds(bounds, (*m_AABBs.back())[0]);
+    }
+    return true;
+}
+
 bool CurveNode::isInside(const glm::vec2& pos)
 {
     glm::vec2 globalPos = toGlobal(pos);
@@ -72,6 +72,7 @@ class AVG_API CurveNode : public VectorNode
         glm::vec2 getPtOnCurve(float t) const;
 
         virtual void calcVertexes(const VertexDataPtr& pVertexData, Pixel32 color);
+        virtual bool getHitBounds(FRect& bounds);
 
     protected:
         bool isInside(const glm::vec2& pos);
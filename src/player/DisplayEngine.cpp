@@ -147,6 +147,7 @@ void DisplayEngine::initRender()
     m_TimeSpentWaiting = 0;
     m_StartTime = TimeSource::get()->getCurrentMicrosecs();
     m_LastFrameTime = m_StartTime;
+    m_FrameTimeStats.reset(m_StartTime);
     m_bInitialized = true;
     if (m_VBRate != 0) {
         setVBlankRate(m_VBRate);
@@ -170,6 +171,20 @@ void DisplayEngine::deinitRender()
             "  Framerate achieved: " << actualFramerate);
     AVG_TRACE(Logger::category::PROFILE,  Logger::severity::INFO,
             "  Frames too late: " << m_FramesTooLate);
+    AVG_TRACE(Logger::category::PROFILE,  Logger::severity::INFO,
+            "  Frame time percentiles (ms): p50=" << m_FrameTimeStats.getPercentile(50)
+            << ", p95=" << m_FrameTimeStats.getPercentile(95)
+            << ", p99=" << m_FrameTimeStats.getPercentile(99)
+            << ", max=" << m_FrameTimeStats.getMaxFrameTime());
+    for (int i = 0; i < FrameTimeStats::NUM_PHASES; ++i) {
+        FrameTimeStats::Phase phase = FrameTimeStats::Phase(i);
+        int numJankFrames = m_FrameTimeStats.getNumJankFrames(phase);
+        if (numJankFrames > 0) {
+            AVG_TRACE(Logger::category::PROFILE,  Logger::severity::INFO,
+                    "    Late in " << FrameTimeStats::getPhaseName(phase) << ": "
+                    << numJankFrames);
+        }
+    }
     AVG_TRACE(Logger::category::PROFILE,  Logger::severity::INFO,
             "  Percent of time spent waiting: " 
             << float (m_TimeSpentWaiting)/(10000*TotalTime));
@@ -228,6 +243,16 @@ bool DisplayEngine::wasFrameLate()
     return m_bFrameLate;
 }
 
+void DisplayEngine::startFramePhase(FrameTimeStats::Phase phase)
+{
+    m_FrameTimeStats.startPhase(phase, TimeSource::get()->getCurrentMicrosecs());
+}
+
+const FrameTimeStats& DisplayEngine::getFrameTimeStats() const
+{
+    return m_FrameTimeStats;
+}
+
 void DisplayEngine::setGamma(float red, float green, float blue)
 {
     if (m_pWindows.empty()) {
@@ -264,6 +289,7 @@ const WindowPtr DisplayEngine::getWindow(unsigned i) const
 void DisplayEngine::endFrame()
 {
     frameWait();
+    startFramePhase(FrameTimeStats::SWAP);
     swapBuffers();
 #ifdef __APPLE__
     // Hack/Workaround for bug #661: When the window is completely occluded, mac
@@ -288,6 +314,7 @@ void DisplayEngine::frameWait()
     m_NumFrames++;
 
     m_FrameWaitStartTime = TimeSource::get()->getCurrentMicrosecs();
+    m_FrameTimeStats.startPhase(FrameTimeStats::WAIT, m_FrameWaitStartTime);
     m_TargetTime = m_LastFrameTime+(long long)(1000000/m_Framerate);
     m_bFrameLate = false;
     if (m_VBRate == 0) {
@@ -329,6 +356,7 @@ void DisplayEngine::checkJitter()
         m_bFrameLate = true;
         m_FramesTooLate++;
     }
+    m_FrameTimeStats.endFrame(frameTime, m_bFrameLate);
 
     m_LastFrameTime = frameTime;
     m_TimeSpentWaiting += m_LastFrameTime-m_FrameWaitStartTime;
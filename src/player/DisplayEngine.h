@@ -24,6 +24,7 @@
 
 #include "../api.h"
 #include "InputDevice.h"
+#include "FrameTimeStats.h"
 
 #include "../graphics/GLConfig.h"
 
@@ -61,6 +62,8 @@ class AVG_API DisplayEngine: public InputDevice
         float getEffectiveFramerate();
         void setVBlankRate(int rate);
         bool wasFrameLate();
+        void startFramePhase(FrameTimeStats::Phase phase);
+        const FrameTimeStats& getFrameTimeStats() const;
         void setGamma(float Red, float Green, float Blue);
         void setMousePos(const IntPoint& pos);
         int getKeyModifierState() const;
@@ -106,6 +109,7 @@ class AVG_API DisplayEngine: public InputDevice
         bool m_bFrameLate;
 
         float m_EffFramerate;
+        FrameTimeStats m_FrameTimeStats;
 };
 
 typedef boost::shared_ptr<DisplayEngine> DisplayEnginePtr;
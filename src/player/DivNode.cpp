@@ -38,6 +38,8 @@
 #include <iostream>
 #include <sstream>
 #include <limits>
+#include <algorithm>
+#include <iterator>
 
 using namespace std;
 using namespace boost;
@@ -61,7 +63,9 @@ void DivNode::registerType()
 }
 
 DivNode::DivNode(const ArgList& args, const string& sPublisherName)
-    : AreaNode(sPublisherName)
+    : AreaNode(sPublisherName),
+      m_ClipVASize(0,0),
+      m_bHitIndexDirty(true)
 {
     args.setMembers(this);
     ObjectCounter::get()->incRef(&typeid(*this));
@@ -171,6 +175,7 @@ void DivNode::insertChild(NodePtr pChild, unsigned i)
     }
     std::vector<NodePtr>::iterator pos = m_Children.begin()+i;
     m_Children.insert(pos, pChild);
+    childHitBoundsChanged(0);
     try {
         pChild->setParent(this, getState(), getCanvas());
     } catch (Exception&) {
@@ -192,6 +197,7 @@ void DivNode::reorderChild(NodePtr pChild, unsigned j)
     m_Children.erase(m_Children.begin()+i);
     std::vector<NodePtr>::iterator pos = m_Children.begin()+j;
     m_Children.insert(pos, pChild);
+    childHitBoundsChanged(0);
 }
 
 void DivNode::reorderChild(unsigned i, unsigned j)
@@ -204,6 +210,7 @@ void DivNode::reorderChild(unsigned i, unsigned j)
     m_Children.erase(m_Children.begin()+i);
     std::vector<NodePtr>::iterator pos = m_Children.begin()+j;
     m_Children.insert(pos, pChild);
+    childHitBoundsChanged(0);
 }
 
 unsigned DivNode::indexOf(NodePtr pChild)
@@ -248,6 +255,7 @@ void DivNode::removeChild(NodePtr pChild, bool bKill)
                 getID()+"::removeChild: index "+toString(i)+" out of bounds."));
     }
     m_Children.erase(m_Children.begin()+i);
+    childHitBoundsChanged(0);
 }
 
 void DivNode::removeChild(unsigned i, bool bKill)
@@ -278,19 +286,37 @@ void DivNode::setMediaDir(const UTF8String& sMediaDir)
     checkReload();
 }
 
+// Divs with fewer children are hit-tested linearly.
+static const unsigned MIN_CHILDREN_FOR_HIT_GRID = 16;
+// Child bounds are enlarged by this amount to compensate for rounding errors.
+static const float HIT_BOUNDS_TOLERANCE = 0.01f;
+
 void DivNode::getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements)
 {
     if (reactsToMouseEvents() &&
             ((getSize() == glm::vec2(0,0) ||
              (pos.x >= 0 && pos.y >= 0 && pos.x < getSize().x && pos.y < getSize().y))))
     {
-        for (int i = getNumChildren()-1; i >= 0; i--) {
-            NodePtr pCurChild = getChild(i);
-            glm::vec2 relPos = pCurChild->toLocal(pos);
-            pCurChild->getElementsByPos(relPos, pElements);
-            if (!pElements->empty()) {
-                pElements->append(getSharedThis());
-                return;
+        if (getNumChildren() < MIN_CHILDREN_FOR_HIT_GRID) {
+            for (int i = getNumChildren()-1; i >= 0; i--) {
+                if (getChildElementsByPos(i, pos, pElements)) {
+                    return;
+                }
+            }
+        } else {
+            updateHitIndex();
+            m_HitGrid.getCandidates(pos, m_HitCandidates);
+            if (!m_UnboundedChildren.empty()) {
+                vector<int> candidates;
+                merge(m_HitCandidates.begin(), m_HitCandidates.end(),
+                        m_UnboundedChildren.begin(), m_UnboundedChildren.end(),
+                        back_inserter(candidates));
+                m_HitCandidates.swap(candidates);
+            }
+            for (int i = int(m_HitCandidates.size())-1; i >= 0; i--) {
+                if (getChildElementsByPos(m_HitCandidates[i], pos, pElements)) {
+                    return;
+                }
             }
         }
         // pos isn't in any of the children.
@@ -301,19 +327,153 @@ void DivNode::getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements)
     }
 }
 
+bool DivNode::getHitBounds(FRect& bounds)
+{
+    if (getSize() != glm::vec2(0,0)) {
+        return AreaNode::getHitBounds(bounds);
+    }
+    // Without an explicit size, the div reacts wherever its children do.
+    updateHitIndex();
+    if (!m_UnboundedChildren.empty()) {
+        return false;
+    }
+    bool bHasBounds = false;
+    FRect childBounds;
+    for (unsigned i = 0; i < m_ChildHitBounds.size(); ++i) {
+        const FRect& curBounds = m_ChildHitBounds[i];
+        if (curBounds.tl.x > curBounds.br.x || curBounds.tl.y > curBounds.br.y) {
+            // Child doesn't react anywhere.
+            continue;
+        }
+        if (bHasBounds) {
+            childBounds.expand(curBounds);
+        } else {
+            childBounds = curBounds;
+            bHasBounds = true;
+        }
+    }
+    if (bHasBounds) {
+        bounds = localToParentBounds(childBounds);
+    } else {
+        // No children, so the div never reacts.
+        bounds = FRect(getPos(), getPos());
+    }
+    return true;
+}
+
+void DivNode::childHitBoundsChanged(Node* pChild)
+{
+    bool bWasClean = !m_bHitIndexDirty && m_DirtyHitChildren.empty();
+    if (!m_bHitIndexDirty) {
+        if (pChild && m_DirtyHitChildren.size() < max(size_t(16), m_Children.size()/8)) {
+            m_DirtyHitChildren.push_back(pChild);
+        } else {
+            m_bHitIndexDirty = true;
+            m_DirtyHitChildren.clear();
+        }
+    }
+    // If the index already had pending changes, the parent has been notified before.
+    if (bWasClean && getSize() == glm::vec2(0,0)) {
+        invalidateHitBounds();
+    }
+}
+
+bool DivNode::getChildElementsByPos(unsigned i, const glm::vec2& pos,
+        NodeChainPtr& pElements)
+{
+    const NodePtr& pCurChild = m_Children[i];
+    glm::vec2 relPos = pCurChild->toLocal(pos);
+    pCurChild->getElementsByPos(relPos, pElements);
+    if (!pElements->empty()) {
+        pElements->append(getSharedThis());
+        return true;
+    }
+    return false;
+}
+
+static FRect enlargeHitBounds(const FRect& bounds)
+{
+    glm::vec2 tolerance(HIT_BOUNDS_TOLERANCE, HIT_BOUNDS_TOLERANCE);
+    return FRect(bounds.tl-tolerance, bounds.br+tolerance);
+}
+
+void DivNode::updateHitIndex()
+{
+    if (!m_bHitIndexDirty) {
+        for (unsigned i = 0; i < m_DirtyHitChildren.size(); ++i) {
+            Node* pChild = m_DirtyHitChildren[i];
+            unsigned childIndex = 0;
+            while (m_Children[childIndex].get() != pChild) {
+                childIndex++;
+                AVG_ASSERT(childIndex < m_Children.size());
+            }
+            FRect bounds;
+            bool bBounded = pChild->getHitBounds(bounds);
+            bool bWasBounded = !binary_search(m_UnboundedChildren.begin(),
+                    m_UnboundedChildren.end(), int(childIndex));
+            if (bBounded != bWasBounded) {
+                m_bHitIndexDirty = true;
+                break;
+            }
+            if (bBounded) {
+                m_ChildHitBounds[childIndex] = enlargeHitBounds(bounds);
+                if (m_HitGrid.getNumEntries() > 0) {
+                    m_HitGrid.update(childIndex, m_ChildHitBounds[childIndex]);
+                }
+            }
+        }
+        m_DirtyHitChildren.clear();
+    }
+    if (m_bHitIndexDirty) {
+        m_ChildHitBounds.resize(m_Children.size());
+        m_UnboundedChildren.clear();
+        for (unsigned i = 0; i < m_Children.size(); ++i) {
+            FRect bounds;
+            if (m_Children[i]->getHitBounds(bounds)) {
+                m_ChildHitBounds[i] = enlargeHitBounds(bounds);
+            } else {
+                m_ChildHitBounds[i] = FRect(0, 0, -1, -1);
+                m_UnboundedChildren.push_back(i);
+            }
+        }
+        if (m_Children.size() >= MIN_CHILDREN_FOR_HIT_GRID) {
+            m_HitGrid.build(m_ChildHitBounds);
+        } else {
+            m_HitGrid.clear();
+        }
+        m_DirtyHitChildren.clear();
+        m_bHitIndexDirty = false;
+    }
+}
+
+void DivNode::calcSubtreeGeometry()
+{
+    calcGeometry();
+    if (getActive()) {
+        for (unsigned i = 0; i < getNumChildren(); i++) {
+            m_Children[i]->calcSubtreeGeometry();
+        }
+    }
+}
+
 void DivNode::preRender(const VertexArrayPtr& pVA, bool bIsParentActive, 
         float parentEffectiveOpacity)
 {
     AreaNode::preRender(pVA, bIsParentActive, parentEffectiveOpacity);
     if (getActive()) {
         if (getCrop() && getSize() != glm::vec2(0,0)) {
-            pVA->startSubVA(m_ClipVA);
             glm::vec2 viewport = getSize();
-            m_ClipVA.appendPos(glm::vec2(0,0), glm::vec2(0,0), Pixel32(0,0,0,0));
-            m_ClipVA.appendPos(glm::vec2(0,viewport.y), glm::vec2(0,0), Pixel32(0,0,0,0));
-            m_ClipVA.appendPos(glm::vec2(viewport.x,0), glm::vec2(0,0), Pixel32(0,0,0,0));
-            m_ClipVA.appendPos(viewport, glm::vec2(0,0), Pixel32(0,0,0,0));
-            m_ClipVA.appendQuadIndexes(0, 1, 2, 3);
+            if (viewport != m_ClipVASize || !pVA->reuseSubVA(m_ClipVA)) {
+                pVA->startSubVA(m_ClipVA);
+                m_ClipVA.appendPos(glm::vec2(0,0), glm::vec2(0,0), Pixel32(0,0,0,0));
+                m_ClipVA.appendPos(glm::vec2(0,viewport.y), glm::vec2(0,0),
+                        Pixel32(0,0,0,0));
+                m_ClipVA.appendPos(glm::vec2(viewport.x,0), glm::vec2(0,0),
+                        Pixel32(0,0,0,0));
+                m_ClipVA.appendPos(viewport, glm::vec2(0,0), Pixel32(0,0,0,0));
+                m_ClipVA.appendQuadIndexes(0, 1, 2, 3);
+                m_ClipVASize = viewport;
+            }
         }
         for (unsigned i = 0; i < getNumChildren(); i++) {
             m_Children[i]->preRender(pVA, bIsParentActive, getEffectiveOpacity());
@@ -334,6 +494,12 @@ void DivNode::render(GLContext* pContext, const glm::mat4& transform)
     }
 }
 
+bool DivNode::usesRenderBatcher() const
+{
+    // Children flush the batch themselves if necessary.
+    return true;
+}
+
 void DivNode::renderOutlines(const VertexArrayPtr& pVA, Pixel32 parentColor)
 {
     Pixel32 effColor = getEffectiveOutlineColor(parentColor);
@@ -28,6 +28,7 @@
 #include "../graphics/SubVertexArray.h"
 
 #include "../base/UTF8String.h"
+#include "../base/SpatialGrid.h"
 
 #include <string>
 
@@ -69,6 +70,11 @@ class AVG_API DivNode : public AreaNode
         void setMediaDir(const UTF8String& mediaDir);
 
         void getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements);
+        virtual bool getHitBounds(FRect& bounds);
+        // Called by children whose hit bounds changed. pChild == 0 means that the
+        // set or order of children changed.
+        void childHitBoundsChanged(Node* pChild);
+        virtual void calcSubtreeGeometry();
         virtual void preRender(const VertexArrayPtr& pVA, bool bIsParentActive, 
                 float parentEffectiveOpacity);
         virtual void render(GLContext* pContext, const glm::mat4& transform);
@@ -79,16 +85,32 @@ class AVG_API DivNode : public AreaNode
 
         virtual std::string dump(int indent = 0);
         IntPoint getMediaSize();
+
+    protected:
+        virtual bool usesRenderBatcher() const;
    
     private:
         bool isChildTypeAllowed(const std::string& sType);
+        bool getChildElementsByPos(unsigned i, const glm::vec2& pos,
+                NodeChainPtr& pElements);
+        void updateHitIndex();
 
         UTF8String m_sMediaDir;
         bool m_bCrop;
 
         SubVertexArray m_ClipVA;
+        glm::vec2 m_ClipVASize;
 
         std::vector<NodePtr> m_Children;
+
+        // Hit test acceleration. m_ChildHitBounds contains an empty rectangle for
+        // children without bounds; these are also listed in m_UnboundedChildren.
+        bool m_bHitIndexDirty;
+        std::vector<Node*> m_DirtyHitChildren;
+        std::vector<FRect> m_ChildHitBounds;
+        std::vector<int> m_UnboundedChildren;
+        SpatialGrid m_HitGrid;
+        std::vector<int> m_HitCandidates;
 };
 
 }
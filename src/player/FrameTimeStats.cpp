@@ -0,0 +1,202 @@
+//
+//  libavg - Media Playback Engine.
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "FrameTimeStats.h"
+
+#include "../base/Exception.h"
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+namespace avg {
+
+// Histogram resolution is 0.1 ms. Frames longer than 100 ms end up in an overflow
+// bucket.
+static const int BUCKET_WIDTH = 100;
+static const int NUM_BUCKETS = 1000;
+
+static const string s_PhaseNames[] = {
+    "other", "timers", "events", "offscreen", "preRender", "render", "wait", "swap"
+};
+
+FrameTimeStats::FrameTimeStats(int windowSize)
+    : m_FrameTimes(windowSize, 0),
+      m_Buckets(NUM_BUCKETS+1, 0)
+{
+    AVG_ASSERT(windowSize > 0);
+    reset(0);
+}
+
+void FrameTimeStats::reset(long long startTime)
+{
+    fill(m_FrameTimes.begin(), m_FrameTimes.end(), 0);
+    fill(m_Buckets.begin(), m_Buckets.end(), 0);
+    m_WritePos = 0;
+    m_NumFrames = 0;
+    m_FrameStartTime = startTime;
+    m_PhaseStartTime = startTime;
+    m_CurPhase = OTHER;
+    m_NumJankFrames = 0;
+    m_LastJankPhase = OTHER;
+    for (int i = 0; i < NUM_PHASES; ++i) {
+        m_PhaseTimes[i] = 0;
+        m_JankCounts[i] = 0;
+    }
+}
+
+void FrameTimeStats::startPhase(Phase phase, long long time)
+{
+    m_PhaseTimes[m_CurPhase] += time-m_PhaseStartTime;
+    m_CurPhase = phase;
+    m_PhaseStartTime = time;
+}
+
+void FrameTimeStats::endFrame(long long time, bool bLate)
+{
+    startPhase(OTHER, time);
+
+    int frameTime = int(time-m_FrameStartTime);
+    if (m_NumFrames == int(m_FrameTimes.size())) {
+        m_Buckets[getBucket(m_FrameTimes[m_WritePos])]--;
+    } else {
+        m_NumFrames++;
+    }
+    m_FrameTimes[m_WritePos] = frameTime;
+    m_Buckets[getBucket(frameTime)]++;
+    m_WritePos = (m_WritePos+1) % m_FrameTimes.size();
+
+    if (bLate) {
+        Phase dominantPhase = OTHER;
+        for (int i = 0; i < NUM_PHASES; ++i) {
+            if (m_PhaseTimes[i] > m_PhaseTimes[dominantPhase]) {
+                dominantPhase = Phase(i);
+            }
+        }
+        m_NumJankFrames++;
+        m_JankCounts[dominantPhase]++;
+        m_LastJankPhase = dominantPhase;
+    }
+
+    for (int i = 0; i < NUM_PHASES; ++i) {
+        m_PhaseTimes[i] = 0;
+    }
+    m_FrameStartTime = time;
+}
+
+int FrameTimeStats::getWindowSize() const
+{
+    return int(m_FrameTimes.size());
+}
+
+int FrameTimeStats::getNumFrames() const
+{
+    return m_NumFrames;
+}
+
+float FrameTimeStats::getPercentile(float percent) const
+{
+    if (percent < 0 || percent > 100) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE,
+                "FrameTimeStats::getPercentile: percent must be between 0 and 100.");
+    }
+    if (m_NumFrames == 0) {
+        return 0;
+    }
+    int rank = max(1, int(ceil(percent/100*m_NumFrames)));
+    int numFrames = 0;
+    for (int bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+        numFrames += m_Buckets[bucket];
+        if (numFrames >= rank) {
+            // The upper bound of the bucket, but never more than the longest frame.
+            return min(float((bucket+1)*BUCKET_WIDTH)/1000, getMaxFrameTime());
+        }
+    }
+
+    // The percentile is in the overflow bucket, so look at the frames themselves.
+    vector<int> longFrames;
+    for (int i = 0; i < m_NumFrames; ++i) {
+        if (getBucket(m_FrameTimes[i]) == NUM_BUCKETS) {
+            longFrames.push_back(m_FrameTimes[i]);
+        }
+    }
+    vector<int>::iterator it = longFrames.begin()+(rank-numFrames-1);
+    nth_element(longFrames.begin(), it, longFrames.end());
+    return float(*it)/1000;
+}
+
+float FrameTimeStats::getMaxFrameTime() const
+{
+    int maxTime = 0;
+    for (int i = 0; i < m_NumFrames; ++i) {
+        maxTime = max(maxTime, m_FrameTimes[i]);
+    }
+    return float(maxTime)/1000;
+}
+
+float FrameTimeStats::getLastFrameTime() const
+{
+    if (m_NumFrames == 0) {
+        return 0;
+    }
+    int lastPos = (m_WritePos+m_FrameTimes.size()-1) % m_FrameTimes.size();
+    return float(m_FrameTimes[lastPos])/1000;
+}
+
+int FrameTimeStats::getNumJankFrames() const
+{
+    return m_NumJankFrames;
+}
+
+int FrameTimeStats::getNumJankFrames(Phase phase) const
+{
+    AVG_ASSERT(phase >= 0 && phase < NUM_PHASES);
+    return m_JankCounts[phase];
+}
+
+FrameTimeStats::Phase FrameTimeStats::getLastJankPhase() const
+{
+    return m_LastJankPhase;
+}
+
+const string& FrameTimeStats::getPhaseName(Phase phase)
+{
+    AVG_ASSERT(phase >= 0 && phase < NUM_PHASES);
+    return s_PhaseNames[phase];
+}
+
+FrameTimeStats::Phase FrameTimeStats::getPhaseFromName(const string& sName)
+{
+    for (int i = 0; i < NUM_PHASES; ++i) {
+        if (s_PhaseNames[i] == sName) {
+            return Phase(i);
+        }
+    }
+    throw Exception(AVG_ERR_INVALID_ARGS, "Unknown frame phase '" + sName + "'.");
+}
+
+int FrameTimeStats::getBucket(int frameTime) const
+{
+    return max(0, min(frameTime/BUCKET_WIDTH, NUM_BUCKETS));
+}
+
+}
@@ -0,0 +1,91 @@
+//
+//  libavg - Media Playback Engine.
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _FrameTimeStats_H_
+#define _FrameTimeStats_H_
+
+#include "../api.h"
+
+#include <string>
+#include <vector>
+
+namespace avg {
+
+// Keeps a histogram of the durations of the last windowSize frames and attributes
+// late frames to the phase of the frame that took longest. The phases correspond to
+// the profiling zones in Player::doFrame(), but are timed independently of them so
+// the statistics are available without profiling enabled.
+class AVG_API FrameTimeStats
+{
+    public:
+        enum Phase {
+            OTHER,
+            TIMERS,
+            EVENTS,
+            OFFSCREEN,
+            PRERENDER,
+            RENDER,
+            WAIT,
+            SWAP,
+            NUM_PHASES
+        };
+
+        FrameTimeStats(int windowSize=600);
+
+        void reset(long long startTime);
+        void startPhase(Phase phase, long long time);
+        void endFrame(long long time, bool bLate);
+
+        int getWindowSize() const;
+        int getNumFrames() const;
+        float getPercentile(float percent) const;
+        float getMaxFrameTime() const;
+        float getLastFrameTime() const;
+
+        int getNumJankFrames() const;
+        int getNumJankFrames(Phase phase) const;
+        Phase getLastJankPhase() const;
+
+        static const std::string& getPhaseName(Phase phase);
+        static Phase getPhaseFromName(const std::string& sName);
+
+    private:
+        int getBucket(int frameTime) const;
+
+        // Frame durations in microseconds, used as a ring buffer.
+        std::vector<int> m_FrameTimes;
+        int m_WritePos;
+        int m_NumFrames;
+        std::vector<int> m_Buckets;
+
+        long long m_FrameStartTime;
+        long long m_PhaseStartTime;
+        Phase m_CurPhase;
+        long long m_PhaseTimes[NUM_PHASES];
+
+        int m_NumJankFrames;
+        int m_JankCounts[NUM_PHASES];
+        Phase m_LastJankPhase;
+};
+
+}
+
+#endif
@@ -29,7 +29,6 @@
 #include "../graphics/ImageCache.h"
 #include "../graphics/CachedImage.h"
 #include "../graphics/GLContextManager.h"
-#include "../graphics/Filterfliprgb.h"
 
 #include "OGLSurface.h"
 #include "OffscreenCanvas.h"
@@ -41,12 +40,13 @@ using namespace std;
 
 namespace avg {
 
-GPUImage::GPUImage(OGLSurface * pSurface, bool bUseMipmaps)
+GPUImage::GPUImage(OGLSurface * pSurface, bool bUseMipmaps, bool bAllowAtlas)
     : m_sFilename(""),
       m_pSurface(pSurface),
       m_State(CPU),
       m_Source(NONE),
-      m_bUseMipmaps(bUseMipmaps)
+      m_bUseMipmaps(bUseMipmaps),
+      m_bAllowAtlas(bAllowAtlas)
 {
     ObjectCounter::get()->incRef(&typeid(*this));
     assertValid();
@@ -109,7 +109,9 @@ void GPUImage::setFilename(const std::string& sFilename, TexCompression comp)
     assertValid();
     CachedImagePtr pImage = ImageCache::get()->getImage(sFilename, comp);
     BitmapPtr pBmp = pImage->getBmp();
-    if (comp == TEXCOMPRESSION_B5G6R5 && pBmp->hasAlpha()) {
+    if (comp == TEXCOMPRESSION_B5G6R5 && pBmp->hasAlpha() &&
+            !pixelFormatIsCompressed(pBmp->getPixelFormat()))
+    {
         pImage->decBmpRef();
         throw Exception(AVG_ERR_UNSUPPORTED, 
                 "B5G6R5-compressed textures with an alpha channel are not supported.");
@@ -134,7 +136,9 @@ void GPUImage::setBitmap(BitmapPtr pBmp, TexCompression comp)
     if (!pBmp) {
         throw Exception(AVG_ERR_UNSUPPORTED, "setBitmap(): bitmap must not be None!");
     }
-    if (comp == TEXCOMPRESSION_B5G6R5 && pBmp->hasAlpha()) {
+    if (comp == TEXCOMPRESSION_B5G6R5 && pBmp->hasAlpha() &&
+            !pixelFormatIsCompressed(pBmp->getPixelFormat()))
+    {
         throw Exception(AVG_ERR_UNSUPPORTED, 
                 "B5G6R5-compressed textures with an alpha channel are not supported.");
     }
@@ -142,14 +146,7 @@ void GPUImage::setBitmap(BitmapPtr pBmp, TexCompression comp)
     changeSource(BITMAP);
     m_pBmp = BitmapPtr(new Bitmap(pBmp->getSize(), pBmp->getPixelFormat(), ""));
     m_pBmp->copyPixels(*pBmp);
-    if (comp == TEXCOMPRESSION_B5G6R5) {
-        BitmapPtr pDestBmp = BitmapPtr(new Bitmap(pBmp->getSize(), B5G6R5, ""));
-        if (!BitmapLoader::get()->isBlueFirst()) {
-            FilterFlipRGB().applyInPlace(m_pBmp);
-        }
-        pDestBmp->copyPixels(*m_pBmp);
-        m_pBmp = pDestBmp;
-    }
+    m_pBmp = CachedImage::applyCompression(m_pBmp, comp);
     if (m_State == GPU) {
         setupBitmapSurface();
     }
@@ -239,16 +236,29 @@ GPUImage::Source GPUImage::getSource()
 void GPUImage::setupImageSurface()
 {
     PixelFormat pf = m_pImage->getBmp()->getPixelFormat();
-    m_pImage->incTexRef(m_bUseMipmaps);
-    MCTexturePtr pTex = m_pImage->getTex();
-    m_pSurface->create(pf, pTex);
+    m_pImage->incTexRef(m_bUseMipmaps, m_bAllowAtlas);
+    TextureAtlasEntryPtr pAtlasEntry = m_pImage->getAtlasEntry();
+    if (pAtlasEntry) {
+        m_pSurface->create(pf, pAtlasEntry);
+    } else {
+        MCTexturePtr pTex = m_pImage->getTex();
+        m_pSurface->create(pf, pTex);
+    }
 }
 
 void GPUImage::setupBitmapSurface()
 {
     GLContextManager* pCM = GLContextManager::get();
-    MCTexturePtr pTex = pCM->createTextureFromBmp(m_pBmp, m_bUseMipmaps);
-    m_pSurface->create(m_pBmp->getPixelFormat(), pTex);
+    TextureAtlasEntryPtr pAtlasEntry;
+    if (m_bAllowAtlas && !m_bUseMipmaps) {
+        pAtlasEntry = pCM->createAtlasEntryFromBmp(m_pBmp);
+    }
+    if (pAtlasEntry) {
+        m_pSurface->create(m_pBmp->getPixelFormat(), pAtlasEntry);
+    } else {
+        MCTexturePtr pTex = pCM->createTextureFromBmp(m_pBmp, m_bUseMipmaps);
+        m_pSurface->create(m_pBmp->getPixelFormat(), pTex);
+    }
 }
 
 bool GPUImage::changeSource(Source newSource)
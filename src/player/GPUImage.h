@@ -48,7 +48,7 @@ class AVG_API GPUImage
         enum State {CPU, GPU};
         enum Source {NONE, FILE, BITMAP, SCENE};
 
-        GPUImage(OGLSurface * pSurface, bool bUseMipmaps);
+        GPUImage(OGLSurface * pSurface, bool bUseMipmaps, bool bAllowAtlas=false);
         virtual ~GPUImage();
 
         virtual void moveToGPU();
@@ -87,6 +87,7 @@ class AVG_API GPUImage
         State m_State;
         Source m_Source;
         bool m_bUseMipmaps;
+        bool m_bAllowAtlas;
 };
 
 typedef boost::shared_ptr<GPUImage> GPUImagePtr;
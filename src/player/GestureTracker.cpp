@@ -0,0 +1,262 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "GestureTracker.h"
+
+#include "CanvasNode.h"
+#include "Contact.h"
+#include "CursorEvent.h"
+#include "DivNode.h"
+#include "Player.h"
+#include "PublisherDefinition.h"
+
+#include "../base/Exception.h"
+#include "../base/MathHelper.h"
+
+using namespace std;
+
+namespace avg {
+
+GestureTracker::GestureTracker(const string& sTypeName)
+    : Publisher(sTypeName),
+      m_bRunning(false)
+{
+}
+
+GestureTracker::~GestureTracker()
+{
+    if (m_bRunning && Player::exists()) {
+        GestureTracker::stop();
+    }
+}
+
+void GestureTracker::start()
+{
+    if (!m_bRunning) {
+        Player::get()->registerPreRenderListener(this);
+        Player::get()->registerPlaybackEndListener(this);
+        m_bRunning = true;
+    }
+}
+
+void GestureTracker::stop()
+{
+    if (m_bRunning) {
+        Player::get()->unregisterPreRenderListener(this);
+        Player::get()->unregisterPlaybackEndListener(this);
+        m_bRunning = false;
+    }
+}
+
+bool GestureTracker::isRunning() const
+{
+    return m_bRunning;
+}
+
+void GestureTracker::onPreRender()
+{
+    update();
+}
+
+void GestureTracker::onPlaybackEnd()
+{
+    stop();
+}
+
+
+void TapTracker::registerType()
+{
+    PublisherDefinitionPtr pPubDef = PublisherDefinition::create("TapTracker");
+    pPubDef->addMessage("OUT_OF_RANGE");
+    pPubDef->addMessage("TIMEOUT");
+}
+
+TapTracker::TapTracker(float maxDist, float maxTime)
+    : GestureTracker("TapTracker"),
+      m_MaxDist(maxDist),
+      m_MaxTime(maxTime),
+      m_MaxPixelDist(0),
+      m_StartTime(0)
+{
+}
+
+TapTracker::~TapTracker()
+{
+}
+
+void TapTracker::start(ContactPtr pContact)
+{
+    m_pContact = pContact;
+    m_pLastEvent = pContact->getLastEvent();
+    m_StartPos = m_pLastEvent->getPos();
+    m_MaxPixelDist = m_MaxDist*Player::get()->getPixelsPerMM();
+    restartTimer();
+    GestureTracker::start();
+}
+
+void TapTracker::setContact(ContactPtr pContact)
+{
+    m_pContact = pContact;
+    m_pLastEvent = CursorEventPtr();
+}
+
+void TapTracker::restartTimer()
+{
+    m_StartTime = Player::get()->getFrameTime();
+}
+
+void TapTracker::update()
+{
+    if (!isRunning()) {
+        return;
+    }
+    if (m_MaxTime >= 0 && Player::get()->getFrameTime()-m_StartTime > m_MaxTime) {
+        stop();
+        notifySubscribers("TIMEOUT");
+        return;
+    }
+    if (m_pContact) {
+        CursorEventPtr pEvent = m_pContact->getLastEvent();
+        if (pEvent != m_pLastEvent) {
+            m_pLastEvent = pEvent;
+            if (glm::length(pEvent->getPos()-m_StartPos) > m_MaxPixelDist) {
+                stop();
+                notifySubscribers("OUT_OF_RANGE");
+            }
+        }
+    }
+}
+
+void TapTracker::stop()
+{
+    GestureTracker::stop();
+    m_pContact = ContactPtr();
+    m_pLastEvent = CursorEventPtr();
+}
+
+
+void DragTracker::registerType()
+{
+    PublisherDefinitionPtr pPubDef = PublisherDefinition::create("DragTracker");
+    pPubDef->addMessage("DETECTED");
+    pPubDef->addMessage("FAILED");
+    pPubDef->addMessage("MOTION");
+}
+
+DragTracker::DragTracker(int direction, float directionTolerance, float minDragDist)
+    : GestureTracker("DragTracker"),
+      m_Direction(Direction(direction)),
+      m_DirectionTolerance(directionTolerance),
+      m_MinDragDist(minDragDist),
+      m_MinPixelDist(0),
+      m_bDetected(false)
+{
+    if (direction < ANY_DIRECTION || direction > HORIZONTAL) {
+        throw Exception(AVG_ERR_INVALID_ARGS, "DragTracker: Invalid direction.");
+    }
+}
+
+DragTracker::~DragTracker()
+{
+}
+
+void DragTracker::start(ContactPtr pContact, NodePtr pCoordSysNode)
+{
+    m_pContact = pContact;
+    m_pRelNode = pCoordSysNode;
+    if (!boost::dynamic_pointer_cast<CanvasNode>(m_pRelNode)) {
+        m_pRelNode = m_pRelNode->getParent();
+    }
+    m_pLastEvent = pContact->getLastEvent();
+    m_StartPos = pContact->getRelPos(m_pRelNode, m_pLastEvent->getPos());
+    m_MinPixelDist = m_MinDragDist*Player::get()->getPixelsPerMM();
+    m_bDetected = (m_MinDragDist == 0);
+    GestureTracker::start();
+}
+
+const glm::vec2& DragTracker::getStartPos() const
+{
+    return m_StartPos;
+}
+
+void DragTracker::update()
+{
+    if (!isRunning()) {
+        return;
+    }
+    CursorEventPtr pEvent = getLastMotionEvent();
+    if (pEvent == m_pLastEvent) {
+        return;
+    }
+    m_pLastEvent = pEvent;
+    glm::vec2 offset = m_pContact->getRelPos(m_pRelNode, pEvent->getPos()) - m_StartPos;
+    if (!m_bDetected) {
+        if (glm::length(offset) <= m_MinPixelDist) {
+            return;
+        }
+        if (!angleFits(offset)) {
+            stop();
+            notifySubscribers("FAILED");
+            return;
+        }
+        m_bDetected = true;
+        notifySubscribers("DETECTED");
+        if (!isRunning()) {
+            return;
+        }
+    }
+    notifySubscribers("MOTION", offset);
+}
+
+void DragTracker::stop()
+{
+    GestureTracker::stop();
+    m_pContact = ContactPtr();
+    m_pRelNode = NodePtr();
+    m_pLastEvent = CursorEventPtr();
+}
+
+CursorEventPtr DragTracker::getLastMotionEvent() const
+{
+    // The up event itself is handled by the recognizer.
+    CursorEventPtr pEvent = m_pContact->getLastEvent();
+    if (pEvent->getType() == Event::CURSOR_UP) {
+        vector<CursorEventPtr> events = m_pContact->getEvents();
+        pEvent = events[events.size()-2];
+    }
+    return pEvent;
+}
+
+bool DragTracker::angleFits(const glm::vec2& offset) const
+{
+    float angle = fabs(getAngle(offset));
+    switch (m_Direction) {
+        case VERTICAL:
+            return (M_PI/2-m_DirectionTolerance < angle &&
+                    angle < M_PI/2+m_DirectionTolerance);
+        case HORIZONTAL:
+            return (angle < m_DirectionTolerance || angle > M_PI-m_DirectionTolerance);
+        default:
+            return true;
+    }
+}
+
+}
@@ -0,0 +1,143 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _GestureTracker_H_
+#define _GestureTracker_H_
+
+#include "../api.h"
+
+#include "Publisher.h"
+
+#include "../base/GLMHelper.h"
+#include "../base/IPreRenderListener.h"
+#include "../base/IPlaybackEndListener.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace avg {
+
+class Contact;
+typedef boost::shared_ptr<class Contact> ContactPtr;
+class CursorEvent;
+typedef boost::shared_ptr<class CursorEvent> CursorEventPtr;
+class Node;
+typedef boost::shared_ptr<class Node> NodePtr;
+
+// Per-frame contact checks of the single-contact gesture recognizers. While running,
+// a tracker is updated once per frame after all events have been dispatched and only
+// notifies its subscribers when the recognizer state needs to change, so recognizers
+// don't need a python callback for every contact motion event.
+class AVG_API GestureTracker: public Publisher, IPreRenderListener, IPlaybackEndListener
+{
+public:
+    virtual ~GestureTracker();
+
+    // Runs the per-frame checks immediately. Recognizers call this before handling
+    // an up event so motion since the last frame isn't lost.
+    virtual void update() = 0;
+    virtual void stop();
+    bool isRunning() const;
+
+    virtual void onPreRender();
+    virtual void onPlaybackEnd();
+
+protected:
+    GestureTracker(const std::string& sTypeName);
+    void start();
+
+private:
+    bool m_bRunning;
+};
+
+// Distance and timeout checks for tap, doubletap and hold recognizers. Notifies
+// OUT_OF_RANGE if the contact moves further than maxDist mm from its start position
+// and TIMEOUT if the tracker runs longer than maxTime ms (if maxTime >= 0). Stops
+// after the first notification.
+class AVG_API TapTracker: public GestureTracker
+{
+public:
+    static void registerType();
+
+    TapTracker(float maxDist, float maxTime=-1);
+    virtual ~TapTracker();
+
+    void start(ContactPtr pContact);
+    // Replaces the tracked contact (or clears it if pContact is empty). The distance
+    // is still measured from the start position of the first contact.
+    void setContact(ContactPtr pContact);
+    void restartTimer();
+    virtual void update();
+    virtual void stop();
+
+private:
+    float m_MaxDist;
+    float m_MaxTime;
+
+    ContactPtr m_pContact;
+    CursorEventPtr m_pLastEvent;
+    glm::vec2 m_StartPos;
+    float m_MaxPixelDist;
+    long long m_StartTime;
+};
+
+typedef boost::shared_ptr<TapTracker> TapTrackerPtr;
+
+// Drag detection and motion for DragRecognizer. Positions are relative to the parent
+// of the coordinate system node (or to the node itself if it's a canvas). Until the
+// contact has moved minDragDist mm in a direction that fits, the tracker notifies
+// DETECTED or FAILED once. After that, it notifies MOTION with the offset from the
+// start position whenever the contact has moved.
+class AVG_API DragTracker: public GestureTracker
+{
+public:
+    enum Direction {ANY_DIRECTION, VERTICAL, HORIZONTAL};
+
+    static void registerType();
+
+    DragTracker(int direction, float directionTolerance, float minDragDist);
+    virtual ~DragTracker();
+
+    void start(ContactPtr pContact, NodePtr pCoordSysNode);
+    const glm::vec2& getStartPos() const;
+    virtual void update();
+    virtual void stop();
+
+private:
+    CursorEventPtr getLastMotionEvent() const;
+    bool angleFits(const glm::vec2& offset) const;
+
+    Direction m_Direction;
+    float m_DirectionTolerance;
+    float m_MinDragDist;
+
+    ContactPtr m_pContact;
+    NodePtr m_pRelNode;
+    CursorEventPtr m_pLastEvent;
+    glm::vec2 m_StartPos;
+    float m_MinPixelDist;
+    bool m_bDetected;
+};
+
+typedef boost::shared_ptr<DragTracker> DragTrackerPtr;
+
+}
+
+#endif
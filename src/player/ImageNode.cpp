@@ -61,7 +61,7 @@ ImageNode::ImageNode(const ArgList& args, const string& sPublisherName)
       m_Compression(TEXCOMPRESSION_NONE)
 {
     args.setMembers(this);
-    m_pGPUImage = GPUImagePtr(new GPUImage(getSurface(), getMipmap()));
+    m_pGPUImage = GPUImagePtr(new GPUImage(getSurface(), getMipmap(), true));
     m_Compression = string2TexCompression(args.getArgVal<string>("compression"));
     setHRef(m_href);
     ObjectCounter::get()->incRef(&typeid(*this));
@@ -102,7 +102,7 @@ void ImageNode::disconnect(bool bKill)
     }
     if (bKill) {
         RasterNode::disconnect(bKill);
-        m_pGPUImage = GPUImagePtr(new GPUImage(getSurface(), getMipmap()));
+        m_pGPUImage = GPUImagePtr(new GPUImage(getSurface(), getMipmap(), true));
         m_href = "";
     } else {
         m_pGPUImage->moveToCPU();
@@ -161,11 +161,15 @@ void ImageNode::preRender(const VertexArrayPtr& pVA, bool bIsParentActive,
     ScopeTimer timer(PrerenderProfilingZone);
     AreaNode::preRender(pVA, bIsParentActive, parentEffectiveOpacity);
     if (isVisible() && m_pGPUImage->getSource() != GPUImage::NONE) {
-        if (m_pGPUImage->getCanvas()) {
-            // Force FX render every frame for canvas nodes.
-            getSurface()->setDirty();
+        if (getSurface()->isUploadPending()) {
+            getSurface()->prioritizeUpload();
+        } else {
+            if (m_pGPUImage->getCanvas()) {
+                // Force FX render every frame for canvas nodes.
+                getSurface()->setDirty();
+            }
+            scheduleFXRender();
         }
-        scheduleFXRender();
     }
     calcVertexArray(pVA);
 }
@@ -175,7 +179,7 @@ static ProfilingZoneID RenderProfilingZone("ImageNode::render");
 void ImageNode::render(GLContext* pContext, const glm::mat4& transform)
 {
     ScopeTimer Timer(RenderProfilingZone);
-    if (m_pGPUImage->getSource() != GPUImage::NONE) {
+    if (m_pGPUImage->getSource() != GPUImage::NONE && !getSurface()->isUploadPending()) {
         blt32(pContext, transform);
     }
 }
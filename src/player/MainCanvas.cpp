@@ -87,6 +87,7 @@ void MainCanvas::renderTree()
 {
     preRender();
     DisplayEngine* pDisplayEngine = getPlayer()->getDisplayEngine();
+    pDisplayEngine->startFramePhase(FrameTimeStats::RENDER);
     unsigned numWindows = pDisplayEngine->getNumWindows();
     for (unsigned i=0; i<numWindows; ++i) {
         ScopeTimer Timer(RootRenderProfilingZone);
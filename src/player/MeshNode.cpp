@@ -29,6 +29,7 @@
 #include "../base/Exception.h"
 #include "../base/GeomHelper.h"
 #include "../base/Triangle.h"
+#include "../graphics/RenderBatcher.h"
 #include "../graphics/VertexData.h"
 
 #include <cstdlib>
@@ -60,7 +61,8 @@ void MeshNode::registerType()
 }
 
 MeshNode::MeshNode(const ArgList& args, const string& sPublisherName)
-    : VectorNode(args, sPublisherName)
+    : VectorNode(args, sPublisherName),
+      m_bTriangleGridDirty(true)
 {
     args.setMembers(this);
     isValid(m_TexCoords);
@@ -86,6 +88,7 @@ const vector<glm::vec2>& MeshNode::getVertexCoords() const
 void MeshNode::setVertexCoords(const vector<glm::vec2>& coords)
 {
     m_VertexCoords = coords;
+    m_bTriangleGridDirty = true;
     setDrawNeeded();
 }
 
@@ -126,6 +129,7 @@ void MeshNode::setTriangles(const vector<glm::ivec3>& triangles)
         }
     }   
     m_Triangles = triangles;
+    m_bTriangleGridDirty = true;
     setDrawNeeded();
 }
 
@@ -153,34 +157,80 @@ void MeshNode::calcVertexes(const VertexDataPtr& pVertexData, Pixel32 color)
 
 void MeshNode::render(GLContext* pContext, const glm::mat4& transform)
 {
+    RenderBatcher* pBatcher = pContext->getRenderBatcher();
     if (m_bBackfaceCull) {
+        pBatcher->flush();
         glEnable(GL_CULL_FACE);
     }
     
     VectorNode::render(pContext, transform);
     
     if (m_bBackfaceCull) {
+        pBatcher->flush();
         glDisable(GL_CULL_FACE);
     }
 }
 
-bool MeshNode::isInside(const glm::vec2& pos)
+bool MeshNode::getHitBounds(FRect& bounds)
 {
-    for (unsigned int i = 0; i < m_Triangles.size(); i++) {
-        Triangle tri(
-                m_VertexCoords[m_Triangles[i].x],
-                m_VertexCoords[m_Triangles[i].y],
-                m_VertexCoords[m_Triangles[i].z]);
+    VectorNode::getHitBounds(bounds);
+    if (!m_VertexCoords.empty()) {
+        FRect coordBounds(m_VertexCoords[0], m_VertexCoords[0]);
+        for (unsigned int i = 1; i < m_VertexCoords.size(); i++) {
+            coordBounds.expand(m_VertexCoords[i]);
+        }
+        expandHitBounds(bounds, coordBounds);
+    }
+    return true;
+}
+
+// Meshes with fewer triangles are tested linearly.
+static const unsigned MIN_TRIANGLES_FOR_GRID = 32;
 
-        if (m_bBackfaceCull && (!tri.isClockwise())) {
-            continue;
+bool MeshNode::isInside(const glm::vec2& pos)
+{
+    if (m_Triangles.size() < MIN_TRIANGLES_FOR_GRID) {
+        for (unsigned int i = 0; i < m_Triangles.size(); i++) {
+            if (isInsideTriangle(i, pos)) {
+                return true;
+            }
         }
+        return false;
+    }
 
-        if (tri.isInside(pos)) {
+    if (m_bTriangleGridDirty) {
+        vector<FRect> triBounds;
+        triBounds.reserve(m_Triangles.size());
+        for (unsigned int i = 0; i < m_Triangles.size(); i++) {
+            FRect bounds(m_VertexCoords[m_Triangles[i].x], 
+                    m_VertexCoords[m_Triangles[i].x]);
+            bounds.expand(m_VertexCoords[m_Triangles[i].y]);
+            bounds.expand(m_VertexCoords[m_Triangles[i].z]);
+            triBounds.push_back(bounds);
+        }
+        m_TriangleGrid.build(triBounds);
+        m_bTriangleGridDirty = false;
+    }
+    m_TriangleGrid.getCandidates(pos, m_CandidateTris);
+    for (unsigned int i = 0; i < m_CandidateTris.size(); i++) {
+        if (isInsideTriangle(m_CandidateTris[i], pos)) {
             return true;
         }
     }
     return false;
 }
 
+bool MeshNode::isInsideTriangle(unsigned i, const glm::vec2& pos) const
+{
+    Triangle tri(
+            m_VertexCoords[m_Triangles[i].x],
+            m_VertexCoords[m_Triangles[i].y],
+            m_VertexCoords[m_Triangles[i].z]);
+
+    if (m_bBackfaceCull && (!tri.isClockwise())) {
+        return false;
+    }
+    return tri.isInside(pos);
+}
+
 }
@@ -27,6 +27,7 @@
 #include "VectorNode.h"
 
 #include "../base/GLMHelper.h"
+#include "../base/SpatialGrid.h"
 #include "../graphics/Pixel32.h"
 
 #include <vector>
@@ -58,16 +59,23 @@ class AVG_API MeshNode : public VectorNode
         virtual void calcVertexes(const VertexDataPtr& pVertexData, Pixel32 color);
         
         virtual void render(GLContext* pContext, const glm::mat4& transform);
+        virtual bool getHitBounds(FRect& bounds);
 
     protected:
         virtual bool isInside(const glm::vec2& pos);
 
     private:
+        bool isInsideTriangle(unsigned i, const glm::vec2& pos) const;
+
         std::vector<glm::vec2> m_TexCoords;
         std::vector<glm::vec2> m_VertexCoords;
         std::vector<glm::ivec3> m_Triangles;
         
         bool m_bBackfaceCull;
+
+        SpatialGrid m_TriangleGrid;
+        bool m_bTriangleGridDirty;
+        std::vector<int> m_CandidateTris;
 };
 }
 #endif
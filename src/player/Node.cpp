@@ -368,6 +368,16 @@ void Node::getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements)
 {
 }
 
+bool Node::getHitBounds(FRect& bounds)
+{
+    return false;
+}
+
+void Node::calcSubtreeGeometry()
+{
+    calcGeometry();
+}
+
 void Node::preRender(const VertexArrayPtr& pVA, bool bIsParentActive, 
         float parentEffectiveOpacity)
 {
@@ -421,6 +431,13 @@ string Node::dump(int indent)
     return dumpStr; 
 }
 
+void Node::invalidateHitBounds()
+{
+    if (m_pParent) {
+        m_pParent->childHitBoundsChanged(this);
+    }
+}
+
 void Node::setState(Node::NodeState state)
 {
 /*    
@@ -31,6 +31,7 @@
 #include "../graphics/TexInfo.h"
 
 #include "../base/GLMHelper.h"
+#include "../base/Rect.h"
 
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
@@ -116,7 +117,12 @@ class AVG_API Node: public Publisher
         virtual glm::vec2 toGlobal(const glm::vec2& pos) const;
         NodePtr getElementByPos(const glm::vec2& pos);
         virtual void getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements);
+        // Returns a rectangle in parent coordinates outside of which the node never
+        // reacts to the cursor. Returns false if there is no such rectangle.
+        virtual bool getHitBounds(FRect& bounds);
 
+        virtual void calcGeometry() {};
+        virtual void calcSubtreeGeometry();
         virtual void preRender(const VertexArrayPtr& pVA, bool bIsParentActive, 
                 float parentEffectiveOpacity);
         virtual void maybeRender(GLContext* pContext, const glm::mat4& parentTransform)
@@ -138,6 +144,7 @@ class AVG_API Node: public Publisher
         Node(const std::string& sPublisherName);
 
         bool reactsToMouseEvents();
+        void invalidateHitBounds();
             
         void setState(NodeState state);
         void initFilename(std::string& sFilename);
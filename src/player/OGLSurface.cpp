@@ -28,8 +28,10 @@
 #include "../base/ObjectCounter.h"
 
 #include "../graphics/GLContext.h"
+#include "../graphics/GLContextManager.h"
 #include "../graphics/MCTexture.h"
 #include "../graphics/GLTexture.h"
+#include "../graphics/TextureAtlas.h"
 #include "../graphics/StandardShader.h"
 
 #include <iostream>
@@ -72,6 +74,7 @@ void OGLSurface::create(PixelFormat pf, MCTexturePtr pTex0, MCTexturePtr pTex1,
     m_pMCTextures[1] = pTex1;
     m_pMCTextures[2] = pTex2;
     m_pMCTextures[3] = pTex3;
+    m_pAtlasEntry = TextureAtlasEntryPtr();
     m_bIsDirty = true;
     m_bPremultipliedAlpha = bPremultipliedAlpha;
 
@@ -88,6 +91,21 @@ void OGLSurface::create(PixelFormat pf, MCTexturePtr pTex0, MCTexturePtr pTex1,
     }
 }
 
+void OGLSurface::create(PixelFormat pf, TextureAtlasEntryPtr pAtlasEntry)
+{
+    AVG_ASSERT(!pixelFormatIsPlanar(pf));
+    AVG_ASSERT(m_WrapMode.getS() == GL_CLAMP_TO_EDGE && 
+            m_WrapMode.getT() == GL_CLAMP_TO_EDGE);
+    m_pf = pf;
+    m_Size = pAtlasEntry->getSize();
+    for (int i=0; i<4; ++i) {
+        m_pMCTextures[i] = MCTexturePtr();
+    }
+    m_pAtlasEntry = pAtlasEntry;
+    m_bIsDirty = true;
+    m_bPremultipliedAlpha = false;
+}
+
 void OGLSurface::setMask(MCTexturePtr pTex)
 {
     m_pMaskMCTexture = pTex;
@@ -100,6 +118,7 @@ void OGLSurface::destroy()
     m_pMCTextures[1] = MCTexturePtr();
     m_pMCTextures[2] = MCTexturePtr();
     m_pMCTextures[3] = MCTexturePtr();
+    m_pAtlasEntry = TextureAtlasEntryPtr();
 }
 
 void OGLSurface::activate(GLContext* pContext, const IntPoint& logicalSize) const
@@ -107,22 +126,9 @@ void OGLSurface::activate(GLContext* pContext, const IntPoint& logicalSize) cons
     StandardShader* pShader = pContext->getStandardShader();
 
     GLContext::checkError("OGLSurface::activate()");
-    switch (m_pf) {
-        case YCbCr420p:
-        case YCbCrJ420p:
-            pShader->setColorModel(1);
-            break;
-        case YCbCrA420p:
-            pShader->setColorModel(3);
-            break;
-        case A8:
-            pShader->setColorModel(2);
-            break;
-        default:
-            pShader->setColorModel(0);
-    }
+    pShader->setColorModel(getColorModel());
 
-    m_pMCTextures[0]->getTex(pContext)->activate(m_WrapMode, GL_TEXTURE0);
+    getMainTex()->getTex(pContext)->activate(m_WrapMode, GL_TEXTURE0);
 
     if (pixelFormatIsPlanar(m_pf)) {
         m_pMCTextures[1]->getTex(pContext)->activate(m_WrapMode, GL_TEXTURE1);
@@ -147,15 +153,13 @@ void OGLSurface::activate(GLContext* pContext, const IntPoint& logicalSize) cons
         glm::vec2 maskPos = m_MaskPos;
         glm::vec2 maskSize = m_MaskSize;
 
-        // Special case for pot textures: 
-        //   The tex coords in the vertex array are scaled to fit the image texture. We 
-        //   need to a) undo this and b) adjust for pot mask textures. In the npot case,
-        //   everything evaluates to (1,1);
-        glm::vec2 texSize = m_pMCTextures[0]->getGLSize();
-        glm::vec2 imgSize = m_pMCTextures[0]->getSize();
-        glm::vec2 imgScale = glm::vec2(texSize.x/imgSize.x, texSize.y/imgSize.y);
-        maskPos = maskPos/imgScale;
-        maskSize = maskSize/imgScale;
+        // Special case for pot and atlas textures: 
+        //   The tex coords in the vertex array are mapped to the part of the texture
+        //   that contains the image. We need to a) undo this and b) adjust for pot mask
+        //   textures. In the npot case, everything evaluates to (1,1);
+        FRect texRect = getTexCoordRect();
+        maskPos = texRect.tl + maskPos*texRect.size();
+        maskSize = maskSize*texRect.size();
 
         glm::vec2 maskTexSize = m_pMaskMCTexture->getGLSize();
         glm::vec2 maskImgSize = m_pMaskMCTexture->getSize();
@@ -171,6 +175,19 @@ void OGLSurface::activate(GLContext* pContext, const IntPoint& logicalSize) cons
     GLContext::checkError("OGLSurface::activate");
 }
 
+bool OGLSurface::getBatchState(GLContext* pContext, GLContext::BlendMode blendMode,
+        float alpha, BatchState& state) const
+{
+    if (pixelFormatIsPlanar(m_pf) || m_bColorIsModified || m_pMaskMCTexture ||
+            !almostEqual(m_Gamma, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)))
+    {
+        return false;
+    }
+    state = BatchState(getMainTex()->getTex(pContext).get(), m_WrapMode, 
+            getColorModel(), m_bPremultipliedAlpha, blendMode, alpha);
+    return true;
+}
+
 void OGLSurface::setMaskCoords(glm::vec2 maskPos, glm::vec2 maskSize)
 {
     // Mask coords are normalized to 0..1 over the main image size.
@@ -191,12 +208,55 @@ IntPoint OGLSurface::getSize()
 
 IntPoint OGLSurface::getTextureSize()
 {
-    return m_pMCTextures[0]->getGLSize();
+    return getMainTex()->getGLSize();
+}
+
+FRect OGLSurface::getTexCoordRect() const
+{
+    if (m_pAtlasEntry) {
+        return m_pAtlasEntry->getTexCoordRect();
+    } else {
+        glm::vec2 texSize = m_pMCTextures[0]->getGLSize();
+        glm::vec2 imgSize = m_Size;
+        return FRect(glm::vec2(0,0), 
+                glm::vec2(imgSize.x/texSize.x, imgSize.y/texSize.y));
+    }
+}
+
+int OGLSurface::getTexCoordVersion() const
+{
+    if (m_pAtlasEntry) {
+        return m_pAtlasEntry->getVersion();
+    } else {
+        return 0;
+    }
+}
+
+bool OGLSurface::isInAtlas() const
+{
+    return m_pAtlasEntry != TextureAtlasEntryPtr();
 }
 
 bool OGLSurface::isCreated() const
 {
-    return (m_pMCTextures[0] != MCTexturePtr());
+    return (m_pMCTextures[0] != MCTexturePtr() || m_pAtlasEntry);
+}
+
+bool OGLSurface::isUploadPending() const
+{
+    if (m_pAtlasEntry) {
+        return m_pAtlasEntry->isUploadPending();
+    }
+    return m_pMCTextures[0] && m_pMCTextures[0]->isUploadPending();
+}
+
+void OGLSurface::prioritizeUpload() const
+{
+    if (m_pAtlasEntry) {
+        m_pAtlasEntry->prioritizeUpload();
+    } else {
+        GLContextManager::get()->prioritizeTexUpload(m_pMCTextures[0]);
+    }
 }
 
 bool OGLSurface::isPremultipliedAlpha() const
@@ -226,6 +286,12 @@ void OGLSurface::setAlphaGamma(float gamma)
 bool OGLSurface::isDirty() const
 {
     bool bIsDirty = m_bIsDirty;
+    if (m_pAtlasEntry) {
+        // Atlas pages are shared, so their dirty flag doesn't say anything about this 
+        // surface. Atlas contents never change without a new create() call or a
+        // version change.
+        return bIsDirty;
+    }
     for (unsigned i=0; i<getNumPixelFormatPlanes(m_pf); ++i) {
         if (m_pMCTextures[i]->isDirty()) {
             bIsDirty = true;
@@ -242,6 +308,9 @@ void OGLSurface::setDirty()
 void OGLSurface::resetDirty()
 {
     m_bIsDirty = false;
+    if (m_pAtlasEntry) {
+        return;
+    }
     for (unsigned i=0; i<getNumPixelFormatPlanes(m_pf); ++i) {
         m_pMCTextures[i]->resetDirty();
     }
@@ -268,4 +337,28 @@ glm::mat4 OGLSurface::calcColorspaceMatrix() const
     return mat;
 }
 
+const MCTexturePtr& OGLSurface::getMainTex() const
+{
+    if (m_pAtlasEntry) {
+        return m_pAtlasEntry->getTex();
+    } else {
+        return m_pMCTextures[0];
+    }
+}
+
+int OGLSurface::getColorModel() const
+{
+    switch (m_pf) {
+        case YCbCr420p:
+        case YCbCrJ420p:
+            return 1;
+        case YCbCrA420p:
+            return 3;
+        case A8:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
 }
@@ -25,8 +25,10 @@
 #include "../api.h"
 
 #include "../base/GLMHelper.h"
+#include "../base/Rect.h"
 #include "../graphics/PixelFormat.h"
 #include "../graphics/WrapMode.h"
+#include "../graphics/RenderBatcher.h"
 
 #include <boost/shared_ptr.hpp>
 
@@ -34,7 +36,8 @@ namespace avg {
 
 class MCTexture;
 typedef boost::shared_ptr<MCTexture> MCTexturePtr;
-class GLContext;
+class TextureAtlasEntry;
+typedef boost::shared_ptr<TextureAtlasEntry> TextureAtlasEntryPtr;
 
 class AVG_API OGLSurface {
 public:
@@ -44,16 +47,29 @@ public:
     virtual void create(PixelFormat pf, MCTexturePtr pTex0, 
             MCTexturePtr pTex1 = MCTexturePtr(), MCTexturePtr pTex2 = MCTexturePtr(), 
             MCTexturePtr pTex3 = MCTexturePtr(), bool bPremultipliedAlpha = false);
+    void create(PixelFormat pf, TextureAtlasEntryPtr pAtlasEntry);
     void setMask(MCTexturePtr pTex);
     virtual void destroy();
     void activate(GLContext* pContext, const IntPoint& logicalSize = IntPoint(1,1)) const;
+    // Returns false if drawing the surface needs shader state that can't be shared 
+    // with other draws.
+    bool getBatchState(GLContext* pContext, GLContext::BlendMode blendMode, float alpha,
+            BatchState& state) const;
 
     void setMaskCoords(glm::vec2 maskPos, glm::vec2 maskSize);
 
     PixelFormat getPixelFormat();
     IntPoint getSize();
     IntPoint getTextureSize();
+    // Part of the texture that contains the image, in texture coordinates. 
+    FRect getTexCoordRect() const;
+    // Changes whenever getTexCoordRect() changes for the current texture.
+    int getTexCoordVersion() const;
+    bool isInAtlas() const;
     bool isCreated() const;
+    // The surface can't be rendered until its texture has been uploaded.
+    bool isUploadPending() const;
+    void prioritizeUpload() const;
     bool isPremultipliedAlpha() const;
 
     void setColorParams(const glm::vec3& gamma, const glm::vec3& brightness,
@@ -66,8 +82,11 @@ public:
 
 private:
     glm::mat4 calcColorspaceMatrix() const;
+    int getColorModel() const;
+    const MCTexturePtr& getMainTex() const;
 
     MCTexturePtr m_pMCTextures[4];
+    TextureAtlasEntryPtr m_pAtlasEntry;
     IntPoint m_Size;
     PixelFormat m_pf;
     MCTexturePtr m_pMaskMCTexture;
@@ -52,11 +52,13 @@
 #include "Window.h"
 #include "SDLWindow.h"
 #include "Contact.h"
+#include "GestureTracker.h"
 #include "KeyEvent.h"
 #include "MouseEvent.h"
 #include "EventDispatcher.h"
 #include "PublisherDefinition.h"
 #include "BitmapManager.h"
+#include "PreRenderThreadPool.h"
 #include "Timeout.h"
 #include "TypeRegistry.h"
 #include "CursorState.h"
@@ -71,6 +73,7 @@
 #include "../base/ConfigMgr.h"
 #include "../base/XMLHelper.h"
 #include "../base/ScopeTimer.h"
+#include "../base/TraceRecorder.h"
 #include "../base/WorkerThread.h"
 #include "../base/DAG.h"
 
@@ -84,6 +87,8 @@
 
 #include "../audio/AudioEngine.h"
 
+#include "../video/VideoDecoder.h"
+
 #include <libxml/xmlmemory.h>
 
 #ifdef _WIN32
@@ -114,8 +119,11 @@ Player::Player()
       m_bDisplayEngineBroken(false),
       m_bIsTraversingTree(false),
       m_pMultitouchInputDevice(),
-      m_bInHandleTimers(false),
-      m_bCurrentTimeoutDeleted(false),
+      m_NumPreRenderThreads(0),
+      m_NumVideoDecoderThreads(1),
+      m_sVideoDecoderThreadType("auto"),
+      m_bVideoZeroCopy(true),
+      m_pPreRenderThreadPool(0),
       m_bKeepWindowOpen(false),
       m_bStopOnEscape(true),
       m_bIsPlaying(false),
@@ -177,6 +185,8 @@ Player::Player()
     MeshNode::registerType();
 
     Contact::registerType();
+    TapTracker::registerType();
+    DragTracker::registerType();
 
     m_pTestHelper = TestHelperPtr(new TestHelper());
 
@@ -283,6 +293,106 @@ void Player::setMultiSampleSamples(int multiSampleSamples)
     m_GLConfig.m_MultiSampleSamples = multiSampleSamples;
 }
 
+void Player::setPreRenderThreads(int numThreads)
+{
+    if (numThreads < 0) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE,
+                "Number of prerender threads must be 0 or greater (was " +
+                toString(numThreads) + ").");
+    }
+    m_NumPreRenderThreads = numThreads;
+    if (m_bIsPlaying) {
+        delete m_pPreRenderThreadPool;
+        m_pPreRenderThreadPool = 0;
+        if (m_NumPreRenderThreads > 0) {
+            m_pPreRenderThreadPool = new PreRenderThreadPool(m_NumPreRenderThreads);
+        }
+    }
+}
+
+int Player::getPreRenderThreads() const
+{
+    return m_NumPreRenderThreads;
+}
+
+void Player::setVideoDecoderThreads(int numThreads, const string& sThreadType)
+{
+    if (numThreads < 0) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE,
+                "Number of video decoder threads must be 0 or greater (was " +
+                toString(numThreads) + ").");
+    }
+    // Throws if the thread type is invalid.
+    stringToDecoderThreadType(sThreadType);
+    m_NumVideoDecoderThreads = numThreads;
+    m_sVideoDecoderThreadType = sThreadType;
+}
+
+int Player::getVideoDecoderThreads() const
+{
+    return m_NumVideoDecoderThreads;
+}
+
+const string& Player::getVideoDecoderThreadType() const
+{
+    return m_sVideoDecoderThreadType;
+}
+
+void Player::setVideoZeroCopy(bool bZeroCopy)
+{
+    m_bVideoZeroCopy = bZeroCopy;
+}
+
+bool Player::isVideoZeroCopy() const
+{
+    return m_bVideoZeroCopy;
+}
+
+void Player::setTexUploadBudget(int numBytes)
+{
+    m_pContextManager->setTexUploadBudget(numBytes);
+}
+
+int Player::getTexUploadBudget() const
+{
+    return m_pContextManager->getTexUploadBudget();
+}
+
+void Player::startTrace()
+{
+    TraceRecorder::get()->start();
+}
+
+void Player::stopTrace()
+{
+    TraceRecorder::get()->stop();
+}
+
+bool Player::isTracing() const
+{
+    return TraceRecorder::isRecording();
+}
+
+void Player::saveTrace(const string& sFilename)
+{
+    TraceRecorder::get()->save(sFilename);
+}
+
+long long Player::getPendingTexUploadBytes() const
+{
+    return m_pContextManager->getPendingTexUploadBytes();
+}
+
+int Player::getTexUploadFramesToDrain() const
+{
+    return m_pContextManager->getTexUploadFramesToDrain();
+}
+
+PreRenderThreadPool* Player::getPreRenderThreadPool() const
+{
+    return m_pPreRenderThreadPool;
+}
+
 void Player::setAudioOptions(int samplerate, int channels)
 {
     errorIfPlaying("Player.setAudioOptions");
@@ -492,6 +602,9 @@ void Player::play()
         initPlayback();
         notifySubscribers("PLAYBACK_START");
         try {
+            if (!m_sTraceFile.empty()) {
+                startTrace();
+            }
             ThreadProfiler::get()->start();
             doFrame(true);
             while (!m_bStopping) {
@@ -562,6 +675,9 @@ void Player::initPlayback()
 
     m_pDisplayEngine->initRender();
     Display::get()->rereadScreenResolution();
+    if (m_NumPreRenderThreads > 0) {
+        m_pPreRenderThreadPool = new PreRenderThreadPool(m_NumPreRenderThreads);
+    }
     m_bStopping = false;
 
     m_FrameTime = 0;
@@ -602,6 +718,15 @@ float Player::getEffectiveFramerate()
     }
 }
 
+const FrameTimeStats& Player::getFrameTimeStats() const
+{
+    if (!m_pDisplayEngine) {
+        throw Exception(AVG_ERR_UNSUPPORTED,
+                "Player.getFrameTimeStats must be called after Player.play().");
+    }
+    return m_pDisplayEngine->getFrameTimeStats();
+}
+
 TestHelper * Player::getTestHelper()
 {
     return m_pTestHelper.get();
@@ -750,25 +875,7 @@ int Player::setOnFrameHandler(PyObject * pyfunc)
 
 bool Player::clearInterval(int id)
 {
-    vector<Timeout*>::iterator it;
-    for (it = m_PendingTimeouts.begin(); it != m_PendingTimeouts.end(); it++) {
-        if (id == (*it)->getID()) {
-            if (it == m_PendingTimeouts.begin() && m_bInHandleTimers) {
-                m_bCurrentTimeoutDeleted = true;
-            }
-            delete *it;
-            m_PendingTimeouts.erase(it);
-            return true;
-        }
-    }
-    for (it = m_NewTimeouts.begin(); it != m_NewTimeouts.end(); it++) {
-        if (id == (*it)->getID()) {
-            delete *it;
-            m_NewTimeouts.erase(it);
-            return true;
-        }
-    }
-    return false;
+    return m_Timeouts.remove(id);
 }
 
 void Player::callFromThread(PyObject * pyfunc)
@@ -997,21 +1104,29 @@ void Player::doFrame(bool bFirstFrame)
             }
             {
                 ScopeTimer Timer(TimersProfilingZone);
+                m_pDisplayEngine->startFramePhase(FrameTimeStats::TIMERS);
                 handleTimers();
             }
             {
                 ScopeTimer Timer(EventsProfilingZone);
+                m_pDisplayEngine->startFramePhase(FrameTimeStats::EVENTS);
                 m_pEventDispatcher->dispatch();
                 sendFakeEvents();
                 removeDeadEventCaptures();
             }
         }
+        m_pDisplayEngine->startFramePhase(FrameTimeStats::OFFSCREEN);
+        // Compaction can move atlas entries, so this needs to happen before any canvas
+        // calculates vertex arrays or schedules FX renders in preRender().
+        m_pContextManager->compactTextureAtlases();
         for (unsigned i = 0; i < m_pCanvases.size(); ++i) {
             ScopeTimer Timer(OffscreenProfilingZone);
             dispatchOffscreenRendering(m_pCanvases[i].get());
         }
         {
             ScopeTimer Timer(MainCanvasProfilingZone);
+            // MainCanvas::renderTree() switches to the render phase.
+            m_pDisplayEngine->startFramePhase(FrameTimeStats::PRERENDER);
             m_pMainCanvas->doFrame(m_bPythonAvailable);
         }
         GLContext::mandatoryCheckError("End of frame");
@@ -1028,6 +1143,14 @@ void Player::doFrame(bool bFirstFrame)
             m_pDisplayEngine->endFrame();
         }
     }
+    if (!bFirstFrame && m_pDisplayEngine->wasFrameLate()) {
+        const FrameTimeStats& stats = m_pDisplayEngine->getFrameTimeStats();
+        const string& sPhase = FrameTimeStats::getPhaseName(stats.getLastJankPhase());
+        AVG_TRACE(Logger::category::PROFILE, Logger::severity::INFO,
+                "Frame " << m_NumFrames << " too late: " << stats.getLastFrameTime()
+                << " ms, mostly spent in " << sPhase << ".");
+        notifySubscribers("JANK", stats.getLastFrameTime(), sPhase);
+    }
     ThreadProfiler::get()->reset();
     if (m_NumFrames == 5) {
         ThreadProfiler::get()->restart();
@@ -1118,6 +1241,37 @@ void Player::initConfig()
     }
     m_GLConfig.m_MultiSampleSamples = multiSampleSamples;
 
+    m_NumPreRenderThreads = pMgr->getIntOption("scr", "prerenderthreads", 0);
+    if (m_NumPreRenderThreads < 0) {
+        AVG_LOG_ERROR("prerenderthreads must be >= 0. Aborting")
+        exit(-1);
+    }
+
+    m_NumVideoDecoderThreads = pMgr->getIntOption("scr", "videodecoderthreads", 1);
+    if (m_NumVideoDecoderThreads < 0) {
+        AVG_LOG_ERROR("videodecoderthreads must be >= 0. Aborting")
+        exit(-1);
+    }
+    pMgr->getStringOption("scr", "videodecoderthreadtype", "auto", 
+            m_sVideoDecoderThreadType);
+    try {
+        stringToDecoderThreadType(m_sVideoDecoderThreadType);
+    } catch (Exception& e) {
+        AVG_LOG_ERROR(e.getStr() << " Aborting.");
+        exit(-1);
+    }
+    m_bVideoZeroCopy = pMgr->getBoolOption("scr", "videozerocopy", true);
+    pMgr->getStringOption("scr", "tracefile", "", m_sTraceFile);
+
+    m_GLConfig.m_bUseRenderBatching = pMgr->getBoolOption("scr", "renderbatching", true);
+    m_GLConfig.m_bUseTextureAtlas = pMgr->getBoolOption("scr", "textureatlas", true);
+    int texUploadBudget = pMgr->getIntOption("scr", "texuploadbudget", 0);
+    if (texUploadBudget < 0) {
+        AVG_LOG_ERROR("texuploadbudget must be >= 0. Aborting")
+        exit(-1);
+    }
+    m_pContextManager->setTexUploadBudget(texUploadBudget);
+
     string sShaderUsage;
     pMgr->getStringOption("scr", "shaderusage", "auto", sShaderUsage);
     if (sShaderUsage == "full") {
@@ -1514,36 +1668,14 @@ void Player::errorIfMultiDisplay(const string& sFunc) const
 
 void Player::handleTimers()
 {
-    vector<Timeout *>::iterator it;
-    m_bInHandleTimers = true;
-
-    it = m_PendingTimeouts.begin();
-    while (it != m_PendingTimeouts.end() && (*it)->isReady(getFrameTime())
-            && !m_bStopping)
-    {
-        m_bCurrentTimeoutDeleted = false;
-        (*it)->fire(getFrameTime());
-        if (m_bCurrentTimeoutDeleted) {
-            it = m_PendingTimeouts.begin();
-        } else {
-            if ((*it)->isInterval()) {
-                Timeout* pTempTimeout = *it;
-                it = m_PendingTimeouts.erase(it);
-                m_NewTimeouts.insert(m_NewTimeouts.begin(), pTempTimeout);
-            } else {
-                delete *it;
-                it = m_PendingTimeouts.erase(it);
-            }
-        }
-    }
-    for (it = m_NewTimeouts.begin(); it != m_NewTimeouts.end(); ++it) {
-        addTimeout(*it);
+    // Timeouts set by the callbacks fire in the next frame at the earliest.
+    m_Timeouts.startBatch(getFrameTime());
+    bool bFired = true;
+    while (bFired && !m_bStopping) {
+        bFired = m_Timeouts.fireNext(getFrameTime());
     }
-    m_NewTimeouts.clear();
     
     notifySubscribers("ON_FRAME");
-    
-    m_bInHandleTimers = false;
 
     if (m_bPythonAvailable) {
         std::vector<Timeout *> tempAsyncCalls;
@@ -1554,6 +1686,7 @@ void Player::handleTimers()
             m_AsyncCalls.clear();
         }
         Py_END_ALLOW_THREADS;
+        vector<Timeout *>::iterator it;
         for (it = tempAsyncCalls.begin(); it != tempAsyncCalls.end(); ++it) {
             (*it)->fire(getFrameTime());
             delete *it;
@@ -1638,15 +1771,21 @@ OffscreenCanvasPtr Player::getCanvasFromURL(const std::string& sURL)
 void Player::cleanup(bool bIsAbort)
 {
     // Kill all timeouts.
-    vector<Timeout*>::iterator it;
-    for (it = m_PendingTimeouts.begin(); it != m_PendingTimeouts.end(); it++) {
-        delete *it;
-    }
-    m_PendingTimeouts.clear();
+    m_Timeouts.clear();
     m_EventCaptureInfoMap.clear();
     m_pLastCursorStates.clear();
     m_pTestHelper->reset();
+    delete m_pPreRenderThreadPool;
+    m_pPreRenderThreadPool = 0;
     ThreadProfiler::get()->dumpStatistics();
+    if (!m_sTraceFile.empty() && isTracing()) {
+        stopTrace();
+        try {
+            saveTrace(m_sTraceFile);
+        } catch (const Exception& e) {
+            AVG_LOG_ERROR(e.getStr());
+        }
+    }
     for (unsigned i = 0; i < m_pCanvases.size(); ++i) {
         m_pCanvases[i]->stopPlayback(bIsAbort);
     }
@@ -1691,24 +1830,8 @@ void Player::cleanup(bool bIsAbort)
 
 int Player::internalSetTimeout(int time, PyObject * pyfunc, bool bIsInterval)
 {
-    Timeout* pTimeout = new Timeout(time, pyfunc, bIsInterval, getFrameTime());
-    if (m_bInHandleTimers) {
-        m_NewTimeouts.push_back(pTimeout);
-    } else {
-        addTimeout(pTimeout);
-    }
-    return pTimeout->getID();
-}
-
-
-int Player::addTimeout(Timeout* pTimeout)
-{
-    vector<Timeout*>::iterator it = m_PendingTimeouts.begin();
-    while (it != m_PendingTimeouts.end() && (**it)<*pTimeout) {
-        it++;
-    }
-    m_PendingTimeouts.insert(it, pTimeout);
-    return pTimeout->getID();
+    TimeoutPtr pTimeout(new Timeout(time, pyfunc, bIsInterval, getFrameTime()));
+    return m_Timeouts.add(pTimeout);
 }
 
 void Player::setPluginPath(const string& newPath)
@@ -27,6 +27,7 @@
 #include "DisplayParams.h"
 #include "BoostPython.h"
 #include "Event.h"
+#include "TimeoutQueue.h"
 
 #include "../audio/AudioParams.h"
 #include "../graphics/GLConfig.h"
@@ -54,6 +55,7 @@ class EventDispatcher;
 class MouseEvent;
 class CursorEvent;
 class DisplayEngine;
+class FrameTimeStats;
 class Display;
 class GLContextManager;
 class Timeout;
@@ -64,6 +66,7 @@ class Bitmap;
 class AVGNode;
 class ImageCache;
 class NodeChain;
+class PreRenderThreadPool;
 
 typedef boost::shared_ptr<Node> NodePtr;
 typedef boost::weak_ptr<Node> NodeWeakPtr;
@@ -105,6 +108,22 @@ class AVG_API Player: public Publisher
                 int multiSampleSamples, GLConfig::ShaderUsage shaderUsage,
                 bool bUseDebugContext);
         void setMultiSampleSamples(int multiSampleSamples);
+        void setPreRenderThreads(int numThreads);
+        int getPreRenderThreads() const;
+        PreRenderThreadPool* getPreRenderThreadPool() const;
+        void setVideoDecoderThreads(int numThreads, const std::string& sThreadType);
+        int getVideoDecoderThreads() const;
+        const std::string& getVideoDecoderThreadType() const;
+        void setVideoZeroCopy(bool bZeroCopy);
+        bool isVideoZeroCopy() const;
+        void setTexUploadBudget(int numBytes);
+        int getTexUploadBudget() const;
+        long long getPendingTexUploadBytes() const;
+        int getTexUploadFramesToDrain() const;
+        void startTrace();
+        void stopTrace();
+        bool isTracing() const;
+        void saveTrace(const std::string& sFilename);
         void setAudioOptions(int samplerate, int channels);
         void enableGLErrorChecks(bool bEnable);
         glm::vec2 getScreenResolution();
@@ -134,6 +153,7 @@ class AVG_API Player: public Publisher
         void setFramerate(float rate);
         void setVBlankFramerate(int rate);
         float getEffectiveFramerate();
+        const FrameTimeStats& getFrameTimeStats() const;
         TestHelper * getTestHelper();
         void setFakeFPS(float fps);
         long long getFrameTime();
@@ -254,13 +274,9 @@ class AVG_API Player: public Publisher
 
         // Timeout handling
         int internalSetTimeout(int time, PyObject * pyfunc, bool bIsInterval);
-        int addTimeout(Timeout* pTimeout);
         void handleTimers();
-        bool m_bInHandleTimers;
-        bool m_bCurrentTimeoutDeleted;
 
-        std::vector<Timeout *> m_PendingTimeouts;
-        std::vector<Timeout *> m_NewTimeouts; // Timeouts to be added this frame.
+        TimeoutQueue m_Timeouts;
         std::vector<Timeout *> m_AsyncCalls;
         boost::mutex m_AsyncCallMutex;
 
@@ -268,6 +284,12 @@ class AVG_API Player: public Publisher
         DisplayParams m_DP;
         AudioParams m_AP;
         GLConfig m_GLConfig;
+        int m_NumPreRenderThreads;
+        PreRenderThreadPool* m_pPreRenderThreadPool;
+        int m_NumVideoDecoderThreads;
+        std::string m_sVideoDecoderThreadType;
+        bool m_bVideoZeroCopy;
+        std::string m_sTraceFile;
 
         bool m_bKeepWindowOpen;
         bool m_bStopOnEscape;
@@ -162,6 +162,19 @@ void PolygonNode::calcFillVertexes(const VertexDataPtr& pVertexData, Pixel32 col
     }
 }
 
+bool PolygonNode::getHitBounds(FRect& bounds)
+{
+    FilledVectorNode::getHitBounds(bounds);
+    if (!m_Pts.empty()) {
+        FRect ptBounds(m_Pts[0], m_Pts[0]);
+        for (unsigned i = 1; i < m_Pts.size(); ++i) {
+            ptBounds.expand(m_Pts[i]);
+        }
+        expandHitBounds(bounds, ptBounds);
+    }
+    return true;
+}
+
 bool PolygonNode::isInside(const glm::vec2& pos)
 {
     return (FilledVectorNode::isInside(pos) || pointInPolygon(pos, m_Pts));
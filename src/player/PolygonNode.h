@@ -53,6 +53,7 @@ class AVG_API PolygonNode : public FilledVectorNode
 
         virtual void calcVertexes(const VertexDataPtr& pVertexData, Pixel32 color);
         virtual void calcFillVertexes(const VertexDataPtr& pVertexData, Pixel32 color);
+        virtual bool getHitBounds(FRect& bounds);
 
     protected:
         virtual bool isInside(const glm::vec2& pos);
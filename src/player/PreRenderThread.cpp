@@ -0,0 +1,61 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "PreRenderThread.h"
+#include "Node.h"
+
+#include "../base/ScopeTimer.h"
+
+namespace avg {
+
+PreRenderThread::PreRenderThread(CQueue& cmdQ, PreRenderJobQueue& doneQ)
+    : WorkerThread<PreRenderThread>("PreRender", cmdQ),
+      m_DoneQ(doneQ)
+{
+}
+
+bool PreRenderThread::work()
+{
+    waitForCommand();
+    return true;
+}
+
+static ProfilingZoneID CalcGeometryProfilingZone("PreRenderThread::calcGeometry", true);
+
+void PreRenderThread::calcGeometry(PreRenderJobPtr pJob)
+{
+    {
+        ScopeTimer timer(CalcGeometryProfilingZone);
+        for (unsigned i = 0; i < pJob->size(); ++i) {
+            try {
+                (*pJob)[i]->calcSubtreeGeometry();
+            } catch (...) {
+                // Ignored: The serial preRender pass redoes the work for this subtree
+                // and reports the error in the main thread.
+            }
+        }
+    }
+    m_DoneQ.push(pJob);
+    ThreadProfiler::get()->reset();
+}
+
+}
@@ -0,0 +1,60 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _PreRenderThread_H_
+#define _PreRenderThread_H_
+
+#include "../api.h"
+
+#include "../base/WorkerThread.h"
+#include "../base/Queue.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace avg {
+
+class Node;
+
+// A job is a list of subtree roots. Raw pointers are used so that the worker threads
+// never hold the last reference to a node.
+typedef std::vector<Node*> PreRenderJob;
+typedef boost::shared_ptr<PreRenderJob> PreRenderJobPtr;
+typedef Queue<PreRenderJob> PreRenderJobQueue;
+
+class AVG_API PreRenderThread : public WorkerThread<PreRenderThread>
+{
+    public:
+        PreRenderThread(CQueue& cmdQ, PreRenderJobQueue& doneQ);
+
+        void calcGeometry(PreRenderJobPtr pJob);
+
+    private:
+        virtual bool work();
+
+        PreRenderJobQueue& m_DoneQ;
+};
+
+}
+
+#endif
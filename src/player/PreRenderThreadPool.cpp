@@ -0,0 +1,117 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#include "PreRenderThreadPool.h"
+#include "DivNode.h"
+
+#include "../base/Exception.h"
+#include "../base/ScopeTimer.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace avg {
+
+// Divs closer to the root than this are split into their children.
+static const int MAX_SPLIT_DEPTH = 3;
+// Number of jobs per thread. More than one job per thread evens out unbalanced trees.
+static const int JOBS_PER_THREAD = 4;
+
+PreRenderThreadPool::PreRenderThreadPool(int numThreads)
+{
+    AVG_ASSERT(numThreads > 0);
+    m_pCmdQueue = PreRenderThread::CQueuePtr(new PreRenderThread::CQueue);
+    for (int i=0; i<numThreads; ++i) {
+        boost::thread* pThread = new boost::thread(
+                PreRenderThread(*m_pCmdQueue, m_DoneQueue));
+        m_pThreads.push_back(pThread);
+    }
+}
+
+PreRenderThreadPool::~PreRenderThreadPool()
+{
+    int numThreads = m_pThreads.size();
+    for (int i=0; i<numThreads; ++i) {
+        m_pCmdQueue->pushCmd(boost::bind(&PreRenderThread::stop, _1));
+    }
+    for (int i=0; i<numThreads; ++i) {
+        boost::thread* pThread = m_pThreads[i];
+        pThread->join();
+        delete pThread;
+    }
+    m_pThreads.clear();
+}
+
+int PreRenderThreadPool::getNumThreads() const
+{
+    return int(m_pThreads.size());
+}
+
+static ProfilingZoneID SplitProfilingZone("PreRender: split tree");
+static ProfilingZoneID WaitProfilingZone("PreRender: wait for threads");
+
+void PreRenderThreadPool::calcGeometry(Node* pRootNode)
+{
+    PreRenderJob subtrees;
+    {
+        ScopeTimer timer(SplitProfilingZone);
+        splitTree(pRootNode, 0, subtrees);
+    }
+    if (subtrees.size() < 2) {
+        for (unsigned i = 0; i < subtrees.size(); ++i) {
+            subtrees[i]->calcSubtreeGeometry();
+        }
+        return;
+    }
+
+    // Consecutive subtrees go into the same job to keep memory accesses local.
+    int numJobs = min(int(subtrees.size()), getNumThreads()*JOBS_PER_THREAD);
+    for (int i = 0; i < numJobs; ++i) {
+        unsigned start = subtrees.size()*i/numJobs;
+        unsigned end = subtrees.size()*(i+1)/numJobs;
+        PreRenderJobPtr pJob(new PreRenderJob(subtrees.begin()+start,
+                subtrees.begin()+end));
+        m_pCmdQueue->pushCmd(boost::bind(&PreRenderThread::calcGeometry, _1, pJob));
+    }
+    ScopeTimer timer(WaitProfilingZone);
+    for (int i = 0; i < numJobs; ++i) {
+        m_DoneQueue.pop(true);
+    }
+}
+
+void PreRenderThreadPool::splitTree(Node* pNode, int depth, PreRenderJob& subtrees)
+{
+    DivNode* pDivNode = dynamic_cast<DivNode*>(pNode);
+    if (pDivNode && depth < MAX_SPLIT_DEPTH) {
+        if (pDivNode->getActive()) {
+            pDivNode->calcGeometry();
+            for (unsigned i = 0; i < pDivNode->getNumChildren(); ++i) {
+                splitTree(pDivNode->getChild(i).get(), depth+1, subtrees);
+            }
+        }
+    } else {
+        subtrees.push_back(pNode);
+    }
+}
+
+}
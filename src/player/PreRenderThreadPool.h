@@ -0,0 +1,61 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+
+#ifndef _PreRenderThreadPool_H_
+#define _PreRenderThreadPool_H_
+
+#include "../api.h"
+
+#include "PreRenderThread.h"
+
+#include <boost/thread.hpp>
+
+#include <vector>
+
+namespace avg {
+
+class Node;
+
+// Computes node-local geometry (transforms, vector shapes) of independent subtrees in
+// parallel before the serial preRender pass. The serial pass then only emits the
+// precomputed data into the vertex array, so vertex order stays identical to
+// single-threaded rendering.
+class AVG_API PreRenderThreadPool
+{
+    public:
+        PreRenderThreadPool(int numThreads);
+        ~PreRenderThreadPool();
+
+        int getNumThreads() const;
+        void calcGeometry(Node* pRootNode);
+
+    private:
+        void splitTree(Node* pNode, int depth, PreRenderJob& subtrees);
+
+        std::vector<boost::thread*> m_pThreads;
+        PreRenderThread::CQueuePtr m_pCmdQueue;
+        PreRenderJobQueue m_DoneQueue;
+};
+
+}
+
+#endif
@@ -44,6 +44,7 @@ PublisherDefinitionRegistry::PublisherDefinitionRegistry()
     pPlayerDef->addMessage("PLAYBACK_START");
     pPlayerDef->addMessage("PLAYBACK_END");
     pPlayerDef->addMessage("ON_FRAME");
+    pPlayerDef->addMessage("JANK");
 }
 
 PublisherDefinitionRegistry::~PublisherDefinitionRegistry()
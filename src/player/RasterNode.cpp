@@ -37,6 +37,7 @@
 #include "../graphics/GLTexture.h"
 #include "../graphics/StandardShader.h"
 #include "../graphics/SubVertexArray.h"
+#include "../graphics/RenderBatcher.h"
 
 #include "../base/MathHelper.h"
 #include "../base/Logger.h"
@@ -80,7 +81,9 @@ RasterNode::RasterNode(const string& sPublisherName)
       m_bMipmap(false),
       m_Color(0,0,0,0),
       m_TileSize(-1,-1),
+      m_bVertexArrayDirty(true),
       m_pSubVA(0),
+      m_TexCoordVersion(0),
       m_bFXDirty(true)
 {
 }
@@ -207,6 +210,7 @@ void RasterNode::setWarpedVertexCoords(const VertexGrid& grid)
         m_pSubVA = new SubVertexArray();
     }
     m_TileVertices = grid;
+    m_bVertexArrayDirty = true;
 }
 
 void RasterNode::setMirror(MirrorType mirrorType)
@@ -378,6 +382,11 @@ void RasterNode::renderFX(GLContext* pContext)
         ScopeTimer Timer(FXProfilingZone);
         StandardShader* pSShader = pContext->getStandardShader();
         pSShader->setAlpha(1.0f);
+        if (m_pSurface->isInAtlas()) {
+            m_pImagingProjection->setTexCoordRect(m_pSurface->getTexCoordRect());
+        } else {
+            m_pImagingProjection->setTexCoordRect(FRect(0, 0, 1, 1));
+        }
         m_pSurface->activate(pContext, getMediaSize());
         pSShader->activate();
 
@@ -429,6 +438,15 @@ void RasterNode::scheduleFXRender()
 void RasterNode::calcVertexArray(const VertexArrayPtr& pVA)
 {
     if (m_pSurface->isCreated() && !m_bHasStdVertices && isVisible()) {
+        if (m_pSurface->getTexCoordVersion() != m_TexCoordVersion) {
+            // The image was moved inside a texture atlas.
+            calcTexCoords();
+            m_bVertexArrayDirty = true;
+            m_pSurface->setDirty();
+        }
+        if (!m_bVertexArrayDirty && pVA->reuseSubVA(*m_pSubVA)) {
+            return;
+        }
         pVA->startSubVA(*m_pSubVA);
         for (unsigned y = 0; y < m_TileVertices.size()-1; y++) {
             for (unsigned x = 0; x < m_TileVertices[0].size()-1; x++) {
@@ -444,6 +462,7 @@ void RasterNode::calcVertexArray(const VertexArrayPtr& pVA)
                         curVertex+1, curVertex, curVertex+2, curVertex+3);
             }
         }
+        m_bVertexArrayDirty = false;
     }
 }
 
@@ -456,9 +475,31 @@ void RasterNode::blt(GLContext* pContext, const glm::mat4& transform,
         const glm::vec2& destSize)
 {
     FRect destRect;
+    if (m_pFXNode) {
+        FRect relDestRect = m_pFXNode->getRelDestRect();
+        destRect = FRect(relDestRect.tl.x*destSize.x, relDestRect.tl.y*destSize.y,
+                relDestRect.br.x*destSize.x, relDestRect.br.y*destSize.y);
+    } else {
+        destRect = FRect(glm::vec2(0,0), destSize);
+    }
+    glm::vec3 pos(destRect.tl.x, destRect.tl.y, 0);
+    glm::vec3 scaleVec(destRect.size().x, destRect.size().y, 1);
+    glm::mat4 localTransform = glm::translate(transform, pos);
+    localTransform = glm::scale(localTransform, scaleVec);
 
-    StandardShader* pShader = pContext->getStandardShader();
     float opacity = getEffectiveOpacity();
+    RenderBatcher* pBatcher = pContext->getRenderBatcher();
+    BatchState batchState;
+    if (!m_pFXNode && 
+            m_pSurface->getBatchState(pContext, m_BlendMode, opacity, batchState))
+    {
+        pBatcher->draw(batchState, localTransform, *m_pSubVA);
+        return;
+    }
+
+    // FX, masks and color correction need their own shader setup.
+    pBatcher->flush();
+    StandardShader* pShader = pContext->getStandardShader();
     pContext->setBlendColor(glm::vec4(1.0f, 1.0f, 1.0f, opacity));
     pShader->setAlpha(opacity);
     if (m_pFXNode) {
@@ -474,24 +515,20 @@ void RasterNode::blt(GLContext* pContext, const glm::mat4& transform,
         pShader->setGamma(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
         pShader->setPremultipliedAlpha(true);
         pShader->setMask(false);
-
-        FRect relDestRect = m_pFXNode->getRelDestRect();
-        destRect = FRect(relDestRect.tl.x*destSize.x, relDestRect.tl.y*destSize.y,
-                relDestRect.br.x*destSize.x, relDestRect.br.y*destSize.y);
     } else {
         m_pSurface->activate(pContext, getMediaSize());
         pContext->setBlendMode(m_BlendMode, m_pSurface->isPremultipliedAlpha());
-        destRect = FRect(glm::vec2(0,0), destSize);
     }
-    glm::vec3 pos(destRect.tl.x, destRect.tl.y, 0);
-    glm::vec3 scaleVec(destRect.size().x, destRect.size().y, 1);
-    glm::mat4 localTransform = glm::translate(transform, pos);
-    localTransform = glm::scale(localTransform, scaleVec);
     pShader->setTransform(localTransform);
     pShader->activate();
     m_pSubVA->draw();
 }
 
+bool RasterNode::usesRenderBatcher() const
+{
+    return true;
+}
+
 GLContext::BlendMode RasterNode::getBlendMode() const
 {
     return m_BlendMode;
@@ -541,7 +578,10 @@ void RasterNode::downloadMask()
         
 void RasterNode::setRenderColor(const Pixel32& color)
 {
-    m_Color = color;
+    if (color != m_Color) {
+        m_Color = color;
+        m_bVertexArrayDirty = true;
+    }
 }
 
 void RasterNode::checkDisplayAvailable(std::string sMsg)
@@ -560,7 +600,8 @@ void RasterNode::newSurface()
 {
     if (m_pSurface->isCreated()) {
         m_bHasStdVertices = !(m_pSurface->getPixelFormat() == A8) &&
-                !GLContext::getCurrent()->usePOTTextures();
+                !GLContext::getCurrent()->usePOTTextures() && 
+                !m_pSurface->isInAtlas();
         if (m_bHasStdVertices) {
             m_pSubVA = &(getCanvas()->getStdSubVA());
         } else {
@@ -569,6 +610,7 @@ void RasterNode::newSurface()
 
         calcVertexGrid(m_TileVertices);
         calcTexCoords();
+        m_bVertexArrayDirty = true;
         setupFX();
     }
 }
@@ -630,10 +672,11 @@ void RasterNode::calcTileVertex(int x, int y, glm::vec2& Vertex)
 
 void RasterNode::calcTexCoords()
 {
-    glm::vec2 textureSize = glm::vec2(m_pSurface->getTextureSize());
+    FRect texCoordRect = m_pSurface->getTexCoordRect();
+    glm::vec2 texCoordOffset = texCoordRect.tl;
     glm::vec2 imageSize = glm::vec2(m_pSurface->getSize());
-    glm::vec2 texCoordExtents = glm::vec2(imageSize.x/textureSize.x,
-            imageSize.y/textureSize.y);
+    glm::vec2 texCoordExtents = texCoordRect.size();
+    m_TexCoordVersion = m_pSurface->getTexCoordVersion();
 
     glm::vec2 texSizePerTile;
     if (m_TileSize.x == -1) {
@@ -650,14 +693,14 @@ void RasterNode::calcTexCoords()
     for (unsigned y = 0; y < m_TexCoords.size(); y++) {
         for (unsigned x = 0; x < m_TexCoords[y].size(); x++) {
             if (y == m_TexCoords.size()-1) {
-                m_TexCoords[y][x].y = texCoordExtents.y;
+                m_TexCoords[y][x].y = texCoordOffset.y+texCoordExtents.y;
             } else {
-                m_TexCoords[y][x].y = texSizePerTile.y*y;
+                m_TexCoords[y][x].y = texCoordOffset.y+texSizePerTile.y*y;
             }
             if (x == m_TexCoords[y].size()-1) {
-                m_TexCoords[y][x].x = texCoordExtents.x;
+                m_TexCoords[y][x].x = texCoordOffset.x+texCoordExtents.x;
             } else {
-                m_TexCoords[y][x].x = texSizePerTile.x*x;
+                m_TexCoords[y][x].x = texCoordOffset.x+texSizePerTile.x*x;
             }
         }
     }
@@ -118,6 +118,7 @@ class AVG_API RasterNode: public AreaNode
 
         void newSurface();
         void setupFX();
+        virtual bool usesRenderBatcher() const;
 
     private:
         void downloadMask();
@@ -146,8 +147,10 @@ class AVG_API RasterNode: public AreaNode
         IntPoint m_TileSize;
         VertexGrid m_TileVertices;
         bool m_bHasStdVertices;
+        bool m_bVertexArrayDirty;
         SubVertexArray* m_pSubVA;
         std::vector<std::vector<glm::vec2> > m_TexCoords;
+        int m_TexCoordVersion;
 
         glm::vec3 m_Gamma;
         glm::vec3 m_Intensity;
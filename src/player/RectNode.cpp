@@ -168,6 +168,13 @@ void RectNode::calcFillVertexes(const VertexDataPtr& pVertexData, Pixel32 color)
     pVertexData->appendQuadIndexes(1, 0, 2, 3);
 }
   
+bool RectNode::getHitBounds(FRect& bounds)
+{
+    FilledVectorNode::getHitBounds(bounds);
+    expandHitBounds(bounds, FRect(glm::vec2(0,0), m_Rect.size()));
+    return true;
+}
+
 bool RectNode::isInside(const glm::vec2& pos)
 {
     return FilledVectorNode::isInside(pos) ||
@@ -55,6 +55,7 @@ class AVG_API RectNode : public FilledVectorNode
 
         virtual void calcVertexes(const VertexDataPtr& pVertexData, Pixel32 color);
         virtual void calcFillVertexes(const VertexDataPtr& pVertexData, Pixel32 color);
+        virtual bool getHitBounds(FRect& bounds);
 
     protected:
         virtual bool isInside(const glm::vec2& pos);
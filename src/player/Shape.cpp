@@ -23,12 +23,12 @@
 
 #include "../base/Logger.h"
 #include "../base/Exception.h"
-#include "../base/Triangle.h"
 #include "../base/Rect.h"
 
 #include "../graphics/Filterfliprgb.h"
 #include "../graphics/GLContext.h"
 #include "../graphics/OGLShader.h"
+#include "../graphics/RenderBatcher.h"
 #include "../graphics/StandardShader.h"
 #include "../graphics/Bitmap.h"
 
@@ -47,6 +47,8 @@ Shape::Shape(const WrapMode& wrapMode, bool bUseMipmaps)
     m_pSurface = new OGLSurface(wrapMode);
     m_pGPUImage = GPUImagePtr(new GPUImage(m_pSurface, bUseMipmaps));
     m_pVertexData = VertexDataPtr(new VertexData());
+    m_bVertexDataChanged = true;
+    m_bTriangleGridDirty = true;
 }
 
 Shape::~Shape()
@@ -81,13 +83,19 @@ GPUImagePtr Shape::getGPUImage()
 void Shape::setVertexData(VertexDataPtr pVertexData)
 {
     m_pVertexData = pVertexData;
+    m_bVertexDataChanged = true;
+    m_bTriangleGridDirty = true;
     m_Bounds = m_pVertexData->calcBoundingRect();
 }
 
 void Shape::setVertexArray(const VertexArrayPtr& pVA)
 {
+    if (!m_bVertexDataChanged && pVA->reuseSubVA(m_SubVA)) {
+        return;
+    }
     pVA->startSubVA(m_SubVA);
     m_SubVA.appendVertexData(m_pVertexData);
+    m_bVertexDataChanged = false;
 /*
     cerr << endl;
     cerr << "Global VA: " << endl;
@@ -97,9 +105,24 @@ void Shape::setVertexArray(const VertexArrayPtr& pVA)
 */
 }
 
-void Shape::draw(GLContext* pContext, const glm::mat4& transform, float opacity)
+void Shape::draw(GLContext* pContext, const glm::mat4& transform, float opacity,
+        GLContext::BlendMode blendMode)
 {
     bool bIsTextured = (m_pGPUImage->getSource() != GPUImage::NONE);
+    if (bIsTextured && m_pSurface->isUploadPending()) {
+        return;
+    }
+    RenderBatcher* pBatcher = pContext->getRenderBatcher();
+    BatchState batchState(0, WrapMode(), 2, false, blendMode, opacity);
+    if (!bIsTextured || (!m_pSurface->isPremultipliedAlpha() && 
+            m_pSurface->getBatchState(pContext, blendMode, opacity, batchState)))
+    {
+        pBatcher->draw(batchState, transform, m_SubVA);
+        return;
+    }
+
+    pBatcher->flush();
+    pContext->setBlendMode(blendMode);
     StandardShader* pShader = pContext->getStandardShader();
     pShader->setTransform(transform);
     pShader->setAlpha(opacity);
@@ -113,30 +136,72 @@ void Shape::draw(GLContext* pContext, const glm::mat4& transform, float opacity)
     m_SubVA.draw();
 }
 
+// Shapes with fewer triangles are tested linearly.
+static const int MIN_TRIANGLES_FOR_GRID = 32;
+
 bool Shape::isPtInside(const glm::vec2& pos)
 {
     if (!m_Bounds.contains(pos)) {
         return false;
     }
-    const Vertex* pVertexes = m_pVertexData->getVertexPointer();
-    const GL_INDEX_TYPE* pIndexes = m_pVertexData->getIndexPointer();
-    for (int i=0; i<m_pVertexData->getNumIndexes(); i+=3) {
-        const GLfloat* pPos0 = pVertexes[pIndexes[i]].m_Pos;
-        const GLfloat* pPos1 = pVertexes[pIndexes[i+1]].m_Pos;
-        const GLfloat* pPos2 = pVertexes[pIndexes[i+2]].m_Pos;
-        Triangle tri(glm::vec2(pPos0[0], pPos0[1]), glm::vec2(pPos1[0], pPos1[1]),
-                glm::vec2(pPos2[0], pPos2[1]));
-        if (tri.isInside(pos)) {
+    int numTris = m_pVertexData->getNumIndexes()/3;
+    if (numTris < MIN_TRIANGLES_FOR_GRID) {
+        for (int i=0; i<numTris; ++i) {
+            if (getTriangle(i).isInside(pos)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (m_bTriangleGridDirty) {
+        vector<FRect> triBounds;
+        triBounds.reserve(numTris);
+        for (int i=0; i<numTris; ++i) {
+            Triangle tri = getTriangle(i);
+            FRect bounds(tri.p0, tri.p0);
+            bounds.expand(tri.p1);
+            bounds.expand(tri.p2);
+            triBounds.push_back(bounds);
+        }
+        m_TriangleGrid.build(triBounds);
+        m_bTriangleGridDirty = false;
+    }
+    m_TriangleGrid.getCandidates(pos, m_CandidateTris);
+    for (unsigned i=0; i<m_CandidateTris.size(); ++i) {
+        if (getTriangle(m_CandidateTris[i]).isInside(pos)) {
             return true;
         }
     }
     return false;
 }
 
+bool Shape::getBounds(FRect& bounds) const
+{
+    if (m_pVertexData->getNumVerts() == 0) {
+        return false;
+    }
+    bounds = m_Bounds;
+    return true;
+}
+
 void Shape::discard()
 {
     m_pVertexData->reset();
+    m_bVertexDataChanged = true;
+    m_bTriangleGridDirty = true;
     m_pGPUImage->setEmpty();
 }
 
+Triangle Shape::getTriangle(int i) const
+{
+    const Vertex* pVertexes = m_pVertexData->getVertexPointer();
+    const GL_INDEX_TYPE* pIndexes = m_pVertexData->getIndexPointer();
+    const GLfloat* pPos0 = pVertexes[pIndexes[i*3]].m_Pos;
+    const GLfloat* pPos1 = pVertexes[pIndexes[i*3+1]].m_Pos;
+    const GLfloat* pPos2 = pVertexes[pIndexes[i*3+2]].m_Pos;
+    return Triangle(glm::vec2(pPos0[0], pPos0[1]), glm::vec2(pPos1[0], pPos1[1]),
+            glm::vec2(pPos2[0], pPos2[1]));
+}
+
 }
@@ -25,6 +25,9 @@
 #include "../api.h"
 
 #include "../base/GLMHelper.h"
+#include "../base/SpatialGrid.h"
+#include "../base/Triangle.h"
+#include "../graphics/GLContext.h"
 #include "../graphics/SubVertexArray.h"
 #include "../graphics/WrapMode.h"
 
@@ -52,17 +55,26 @@ class AVG_API Shape
         GPUImagePtr getGPUImage();
         void setVertexData(VertexDataPtr pVertexData);
         void setVertexArray(const VertexArrayPtr& pVA);
-        void draw(GLContext* pContext, const glm::mat4& transform, float opacity);
+        void draw(GLContext* pContext, const glm::mat4& transform, float opacity,
+            GLContext::BlendMode blendMode);
         bool isPtInside(const glm::vec2& pos);
+        bool getBounds(FRect& bounds) const;
 
         void discard();
 
     private:
+        Triangle getTriangle(int i) const;
+
         VertexDataPtr m_pVertexData;
+        bool m_bVertexDataChanged;
         SubVertexArray m_SubVA;
         OGLSurface * m_pSurface;
         GPUImagePtr m_pGPUImage;
         FRect m_Bounds;
+
+        SpatialGrid m_TriangleGrid;
+        bool m_bTriangleGridDirty;
+        std::vector<int> m_CandidateTris;
 };
 
 typedef boost::shared_ptr<Shape> ShapePtr;
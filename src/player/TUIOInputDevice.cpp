@@ -33,7 +33,6 @@
 #include "../base/Exception.h"
 
 using namespace std;
-using namespace osc;
 
 namespace avg {
 
@@ -63,8 +62,7 @@ bool TUIOInputDevice::isEnabled()
 TUIOInputDevice::TUIOInputDevice(const DivNodePtr& pEventReceiverNode, int port)
     : MultitouchInputDevice(pEventReceiverNode),
       m_pSocket(0),
-      m_RemoteIP(0),
-      m_bConnected(false)
+      m_RemoteIP(0)
 {
     if (port != 0) {
         m_Port = port;
@@ -124,146 +122,103 @@ BitmapPtr TUIOInputDevice::getUserBmp() const
     return m_pUserBmp;
 }
 
+vector<EventPtr> TUIOInputDevice::pollEvents()
+{
+    m_Parser.fetch(m_Batch);
+    processCmds();
+    return MultitouchInputDevice::pollEvents();
+}
+
 void TUIOInputDevice::ProcessPacket(const char* pData, int size, 
         const IpEndpointName& remoteEndpoint)
 {
-    lock_guard lock(getMutex());
     m_RemoteIP = remoteEndpoint.address;
-    try {
-        ReceivedPacket packet(pData, size);
-        if (packet.IsBundle()) {
-            processBundle(ReceivedBundle(packet));
-        } else {
-            processMessage(ReceivedMessage(packet));
-        }
-    } catch (osc::Exception& e) {
-        AVG_LOG_WARNING("OSC exception: " << e.what());
-    }
+    m_Parser.parsePacket(pData, size);
 }
 
-void TUIOInputDevice::processBundle(const ReceivedBundle& bundle) 
+void TUIOInputDevice::PacketBatchComplete()
 {
-    try {
-        for (ReceivedBundle::const_iterator it = bundle.ElementsBegin(); 
-                it != bundle.ElementsEnd(); ++it) 
-        {
-            if (it->IsBundle()) {
-                processBundle(ReceivedBundle(*it));
-            } else {
-                processMessage(ReceivedMessage(*it));
-            }
-        }
-    } catch (osc::Exception& e) {
-        AVG_LOG_WARNING("OSC exception: " << e.what());
-    }
+    m_Parser.publish();
 }
 
-void TUIOInputDevice::processMessage(const ReceivedMessage& msg) 
+void TUIOInputDevice::processCmds()
 {
-    try {
-        ReceivedMessageArgumentStream args = msg.ArgumentStream();
-        const char* cmd;
-        args >> cmd;
-        if (strcmp(msg.AddressPattern(), "/tuio/2Dcur") == 0) {
-            if (strcmp(cmd, "set") == 0) { 
-                processTouchSet(args);
-            } else if (strcmp(cmd, "alive") == 0) {
-                processAlive(args, Event::TOUCH);
-            } 
-        } else if (strcmp(msg.AddressPattern(), "/tuio/2Dobj") == 0) {
-            if (strcmp(cmd, "set") == 0) { 
-                processTangibleSet(args);
-            } else if (strcmp(cmd, "alive") == 0) {
-                processAlive(args, Event::TANGIBLE);
-            } 
-        } else if (strcmp(msg.AddressPattern(), "/tuioext/userid") == 0) {
-            if (strcmp(cmd, "set") == 0) { 
-                processUserID(args);
-            } else if (strcmp(cmd, "indexframe") == 0) {
-                processIndexFrame(args);
-            }
-        }
-        if (!m_bConnected && strstr(msg.AddressPattern(), "/tuio") != 0) {
-            m_bConnected = true;
-            AVG_TRACE(Logger::category::CONFIG, Logger::severity::INFO,
-                    "Receiving TUIO messages");
+    if (m_Batch.empty()) {
+        return;
+    }
+    // Uncontended, since the receiving thread doesn't lock the device.
+    lock_guard lock(getMutex());
+    for (unsigned i = 0; i < m_Batch.m_Cmds.size(); ++i) {
+        const TUIOCmd& cmd = m_Batch.m_Cmds[i];
+        switch (cmd.m_Type) {
+            case TUIOCmd::TOUCH_SET:
+                processTouchSet(cmd);
+                break;
+            case TUIOCmd::TANGIBLE_SET:
+                processTangibleSet(cmd);
+                break;
+            case TUIOCmd::ALIVE:
+                processAlive(cmd);
+                break;
+            case TUIOCmd::USER_ID:
+                processUserID(cmd);
+                break;
+            case TUIOCmd::INDEX_FRAME:
+                m_pUserBmp = cmd.m_pUserBmp;
+                break;
+            default:
+                AVG_ASSERT(false);
         }
-    } catch (osc::Exception& e) {
-        AVG_LOG_WARNING("Error parsing TUIO message: " << e.what()
-                << ". Message was " << msg);
     }
+    m_Batch.clear();
 }
 
-void TUIOInputDevice::processTouchSet(ReceivedMessageArgumentStream& args)
+void TUIOInputDevice::processTouchSet(const TUIOCmd& cmd)
 {
-    osc::int32 tuioID;
-    float xpos, ypos;
-    float xspeed, yspeed;
-    float accel;
-    args >> tuioID >> xpos >> ypos >> xspeed >> yspeed >> accel;
-    glm::vec2 pos(xpos, ypos);
-    glm::vec2 speed(xspeed, yspeed);
-    TouchStatusPtr pTouchStatus = getTouchStatus(tuioID);
-    IntPoint screenPos = getScreenPos(pos);
+    TouchStatusPtr pTouchStatus = getTouchStatus(cmd.m_TUIOID);
+    IntPoint screenPos = getScreenPos(cmd.m_Pos);
     TouchEventPtr pEvent;
     if (!pTouchStatus) {
         // Down
         pEvent = TouchEventPtr(new TouchEvent(getNextContactID(), Event::CURSOR_DOWN, 
                     screenPos, Event::TOUCH));
-        addTouchStatus((long)tuioID, pEvent);
+        addTouchStatus((long)cmd.m_TUIOID, pEvent);
     } else {
         // Move
         pEvent = TouchEventPtr(new TouchEvent(0, Event::CURSOR_MOTION, screenPos, 
                     Event::TOUCH));
         pTouchStatus->pushEvent(pEvent);
     }
-    setEventSpeed(pEvent, speed);
+    setEventSpeed(pEvent, cmd.m_Speed);
 }
 
-void TUIOInputDevice::processTangibleSet(ReceivedMessageArgumentStream& args)
+void TUIOInputDevice::processTangibleSet(const TUIOCmd& cmd)
 {
-    osc::int32 tuioID;
-    osc::int32 classID;
-    float xpos, ypos;
-    float angle;
-    float xspeed, yspeed;
-    float angleSpeed;
-    float accel;
-    float angleAccel;
-    args >> tuioID >> classID >> xpos >> ypos >> angle >> xspeed >> yspeed >> angleSpeed
-            >> accel >> angleAccel;
-    glm::vec2 pos(xpos, ypos);
-    glm::vec2 speed(xspeed, yspeed);
-    TouchStatusPtr pTouchStatus = getTouchStatus(tuioID);
-    IntPoint screenPos = getScreenPos(pos);
+    TouchStatusPtr pTouchStatus = getTouchStatus(cmd.m_TUIOID);
+    IntPoint screenPos = getScreenPos(cmd.m_Pos);
     TangibleEventPtr pEvent;
     if (!pTouchStatus) {
         // Down
-        pEvent = TangibleEventPtr(new TangibleEvent(getNextContactID(), classID, 
-                Event::CURSOR_DOWN, screenPos, speed, angle));
-        addTouchStatus((long)tuioID, pEvent);
+        pEvent = TangibleEventPtr(new TangibleEvent(getNextContactID(), cmd.m_ClassID,
+                Event::CURSOR_DOWN, screenPos, cmd.m_Speed, cmd.m_Angle));
+        addTouchStatus((long)cmd.m_TUIOID, pEvent);
     } else {
         // Move
-        pEvent = TangibleEventPtr(new TangibleEvent(0, classID, Event::CURSOR_MOTION, 
-                screenPos, speed, angle));
+        pEvent = TangibleEventPtr(new TangibleEvent(0, cmd.m_ClassID,
+                Event::CURSOR_MOTION, screenPos, cmd.m_Speed, cmd.m_Angle));
         pTouchStatus->pushEvent(pEvent);
     }
-    setEventSpeed(pEvent, speed);
+    setEventSpeed(pEvent, cmd.m_Speed);
 }
 
-void TUIOInputDevice::processAlive(ReceivedMessageArgumentStream& args, 
-        Event::Source source)
+void TUIOInputDevice::processAlive(const TUIOCmd& cmd)
 {
-    std::set<int> liveTUIOIDs;
-    int32 tuioID;
-    while (!args.Eos()) {
-        args >> tuioID;
-        liveTUIOIDs.insert(tuioID);
-    }
+    vector<int>::const_iterator firstID = m_Batch.m_LiveIDs.begin()+cmd.m_FirstLiveID;
+    std::set<int> liveTUIOIDs(firstID, firstID+cmd.m_NumLiveIDs);
 
     // Create up events for all ids not in live list.
     set<int> deadTUIOIDs;
-    getDeadIDs(liveTUIOIDs, deadTUIOIDs, source);
+    getDeadIDs(liveTUIOIDs, deadTUIOIDs, cmd.m_Source);
     set<int>::iterator it;
     for (it = deadTUIOIDs.begin(); it != deadTUIOIDs.end(); ++it) {
         int id = *it;
@@ -275,31 +230,17 @@ void TUIOInputDevice::processAlive(ReceivedMessageArgumentStream& args,
     }
 }
 
-void TUIOInputDevice::processUserID(ReceivedMessageArgumentStream& args)
+void TUIOInputDevice::processUserID(const TUIOCmd& cmd)
 {
-    osc::int32 tuioID;
-    osc::int32 userID;
-    osc::int32 jointID;
-    args >> tuioID >> userID >> jointID;
-    TouchStatusPtr pTouchStatus = getTouchStatus(tuioID);
+    TouchStatusPtr pTouchStatus = getTouchStatus(cmd.m_TUIOID);
     if (!pTouchStatus) {
         AVG_TRACE(Logger::category::EVENTS, Logger::severity::WARNING,
-                "Received /tuioext/userid, but tuio id " << tuioID <<
+                "Received /tuioext/userid, but tuio id " << cmd.m_TUIOID <<
                 " doesn't correspond to a contact.");
         return;
     }
     CursorEventPtr pEvent = pTouchStatus->getLastEvent();
-    pEvent->setUserID(userID, jointID);
-}
-
-void TUIOInputDevice::processIndexFrame(osc::ReceivedMessageArgumentStream& args)
-{
-    osc::int32 xsize;
-    osc::int32 ysize;
-    osc::Blob blob;
-    args >> xsize >> ysize >> blob >> osc::EndMessage;
-    m_pUserBmp = BitmapPtr(new Bitmap(IntPoint(xsize,ysize), I8,
-            (unsigned char*)blob.data, xsize, true));
+    pEvent->setUserID(cmd.m_UserID, cmd.m_JointID);
 }
 
 void TUIOInputDevice::setEventSpeed(CursorEventPtr pEvent, glm::vec2 speed)
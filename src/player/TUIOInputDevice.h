@@ -25,20 +25,23 @@
 #include "../api.h"
 #include "MultitouchInputDevice.h"
 #include "Event.h"
+#include "TUIOParser.h"
 #include "../oscpack/UdpSocket.h"
 #include "../oscpack/PacketListener.h"
-#include "../oscpack/OscReceivedElements.h"
-#include "../oscpack/OscPrintReceivedElements.h"
 #include "../graphics/Bitmap.h"
 
 #ifdef WIN32
 #include <windows.h>
 #endif
 
+#include <atomic>
 #include <set>
 
 namespace avg {
 
+// Packets are received and parsed in a separate thread. The parsed commands are
+// applied to the touch state in pollEvents(), so the render thread only waits for the
+// receiving thread while a batch of commands is handed over.
 class AVG_API TUIOInputDevice: public MultitouchInputDevice, PacketListener
 {
 public:
@@ -47,13 +50,14 @@ public:
     TUIOInputDevice(const DivNodePtr& pEventReceiverNode=DivNodePtr(), int port=0);
     virtual ~TUIOInputDevice();
    
+    virtual std::vector<EventPtr> pollEvents();
+
     virtual unsigned getRemoteIP() const;
     virtual BitmapPtr getUserBmp() const;
 
     virtual void ProcessPacket(const char* pData, int size, 
             const IpEndpointName& remoteEndpoint);
-    
-    virtual void processMessage(const osc::ReceivedMessage& msg);
+    virtual void PacketBatchComplete();
 
 private:
 #ifndef WIN32
@@ -61,21 +65,20 @@ private:
 #else
     static DWORD WINAPI threadFunc(LPVOID p);
 #endif
-    void processBundle(const osc::ReceivedBundle& bundle);
-    void processTouchSet(osc::ReceivedMessageArgumentStream& args);
-    void processTangibleSet(osc::ReceivedMessageArgumentStream& args);
-    void processAlive(osc::ReceivedMessageArgumentStream& args, 
-            Event::Source source);
-    void processUserID(osc::ReceivedMessageArgumentStream& args);
-    void processIndexFrame(osc::ReceivedMessageArgumentStream& args);
+    void processCmds();
+    void processTouchSet(const TUIOCmd& cmd);
+    void processTangibleSet(const TUIOCmd& cmd);
+    void processAlive(const TUIOCmd& cmd);
+    void processUserID(const TUIOCmd& cmd);
     void setEventSpeed(CursorEventPtr pEvent, glm::vec2 speed);
     void getDeadIDs(const std::set<int>& liveIDs, std::set<int>& deadIDs, 
             Event::Source source);
 
     UdpListeningReceiveSocket* m_pSocket;
-    unsigned m_RemoteIP;
+    std::atomic<unsigned> m_RemoteIP;
     int m_Port;
-    bool m_bConnected;
+    TUIOParser m_Parser;
+    TUIOBatch m_Batch;
     BitmapPtr m_pUserBmp;
 #ifndef WIN32
     pthread_t m_Thread;
@@ -0,0 +1,253 @@
+//
+//  libavg - Media Playback Engine.
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "TUIOParser.h"
+
+#include "../base/Logger.h"
+#include "../base/Exception.h"
+#include "../base/ThreadHelper.h"
+#include "../oscpack/OscPrintReceivedElements.h"
+
+#include <string.h>
+
+using namespace std;
+using namespace osc;
+
+namespace avg {
+
+bool TUIOBatch::empty() const
+{
+    return m_Cmds.empty();
+}
+
+void TUIOBatch::clear()
+{
+    // Keeps the capacity, so a batch that is reused doesn't allocate.
+    m_Cmds.clear();
+    m_LiveIDs.clear();
+}
+
+void TUIOBatch::swap(TUIOBatch& other)
+{
+    m_Cmds.swap(other.m_Cmds);
+    m_LiveIDs.swap(other.m_LiveIDs);
+}
+
+void TUIOBatch::append(const TUIOBatch& other)
+{
+    int liveIDOffset = int(m_LiveIDs.size());
+    m_LiveIDs.insert(m_LiveIDs.end(), other.m_LiveIDs.begin(), other.m_LiveIDs.end());
+    unsigned firstCmd = m_Cmds.size();
+    m_Cmds.insert(m_Cmds.end(), other.m_Cmds.begin(), other.m_Cmds.end());
+    for (unsigned i = firstCmd; i < m_Cmds.size(); ++i) {
+        m_Cmds[i].m_FirstLiveID += liveIDOffset;
+    }
+}
+
+TUIOParser::TUIOParser()
+    : m_bConnected(false)
+{
+}
+
+TUIOParser::~TUIOParser()
+{
+}
+
+void TUIOParser::parsePacket(const char* pData, int size)
+{
+    try {
+        ReceivedPacket packet(pData, size);
+        if (packet.IsBundle()) {
+            parseBundle(ReceivedBundle(packet));
+        } else {
+            parseMessage(ReceivedMessage(packet));
+        }
+    } catch (osc::Exception& e) {
+        AVG_LOG_WARNING("OSC exception: " << e.what());
+    }
+}
+
+void TUIOParser::publish()
+{
+    if (m_StagedBatch.empty()) {
+        return;
+    }
+    {
+        lock_guard lock(m_PublishMutex);
+        if (m_PublishedBatch.empty()) {
+            // Usual case: The render thread has fetched the last batch. The staged
+            // batch gets the empty buffers it returned.
+            m_PublishedBatch.swap(m_StagedBatch);
+        } else {
+            m_PublishedBatch.append(m_StagedBatch);
+        }
+    }
+    m_StagedBatch.clear();
+}
+
+void TUIOParser::fetch(TUIOBatch& batch)
+{
+    batch.clear();
+    lock_guard lock(m_PublishMutex);
+    batch.swap(m_PublishedBatch);
+}
+
+void TUIOParser::parseBundle(const ReceivedBundle& bundle)
+{
+    try {
+        for (ReceivedBundle::const_iterator it = bundle.ElementsBegin();
+                it != bundle.ElementsEnd(); ++it)
+        {
+            if (it->IsBundle()) {
+                parseBundle(ReceivedBundle(*it));
+            } else {
+                parseMessage(ReceivedMessage(*it));
+            }
+        }
+    } catch (osc::Exception& e) {
+        AVG_LOG_WARNING("OSC exception: " << e.what());
+    }
+}
+
+void TUIOParser::parseMessage(const ReceivedMessage& msg)
+{
+    try {
+        ReceivedMessageArgumentStream args = msg.ArgumentStream();
+        const char* cmd;
+        args >> cmd;
+        if (strcmp(msg.AddressPattern(), "/tuio/2Dcur") == 0) {
+            if (strcmp(cmd, "set") == 0) {
+                parseTouchSet(args);
+            } else if (strcmp(cmd, "alive") == 0) {
+                parseAlive(args, Event::TOUCH);
+            }
+        } else if (strcmp(msg.AddressPattern(), "/tuio/2Dobj") == 0) {
+            if (strcmp(cmd, "set") == 0) {
+                parseTangibleSet(args);
+            } else if (strcmp(cmd, "alive") == 0) {
+                parseAlive(args, Event::TANGIBLE);
+            }
+        } else if (strcmp(msg.AddressPattern(), "/tuioext/userid") == 0) {
+            if (strcmp(cmd, "set") == 0) {
+                parseUserID(args);
+            } else if (strcmp(cmd, "indexframe") == 0) {
+                parseIndexFrame(args);
+            }
+        }
+        if (!m_bConnected && strstr(msg.AddressPattern(), "/tuio") != 0) {
+            m_bConnected = true;
+            AVG_TRACE(Logger::category::CONFIG, Logger::severity::INFO,
+                    "Receiving TUIO messages");
+        }
+    } catch (osc::Exception& e) {
+        AVG_LOG_WARNING("Error parsing TUIO message: " << e.what()
+                << ". Message was " << msg);
+    }
+}
+
+void TUIOParser::parseTouchSet(ReceivedMessageArgumentStream& args)
+{
+    osc::int32 tuioID;
+    float xpos, ypos;
+    float xspeed, yspeed;
+    float accel;
+    args >> tuioID >> xpos >> ypos >> xspeed >> yspeed >> accel;
+    TUIOCmd& cmd = addCmd(TUIOCmd::TOUCH_SET);
+    cmd.m_TUIOID = tuioID;
+    cmd.m_Pos = glm::vec2(xpos, ypos);
+    cmd.m_Speed = glm::vec2(xspeed, yspeed);
+}
+
+void TUIOParser::parseTangibleSet(ReceivedMessageArgumentStream& args)
+{
+    osc::int32 tuioID;
+    osc::int32 classID;
+    float xpos, ypos;
+    float angle;
+    float xspeed, yspeed;
+    float angleSpeed;
+    float accel;
+    float angleAccel;
+    args >> tuioID >> classID >> xpos >> ypos >> angle >> xspeed >> yspeed >> angleSpeed
+            >> accel >> angleAccel;
+    TUIOCmd& cmd = addCmd(TUIOCmd::TANGIBLE_SET);
+    cmd.m_TUIOID = tuioID;
+    cmd.m_ClassID = classID;
+    cmd.m_Pos = glm::vec2(xpos, ypos);
+    cmd.m_Speed = glm::vec2(xspeed, yspeed);
+    cmd.m_Angle = angle;
+}
+
+void TUIOParser::parseAlive(ReceivedMessageArgumentStream& args, Event::Source source)
+{
+    // Read all ids before adding the command so a parse error doesn't leave a
+    // partial list behind.
+    unsigned firstLiveID = m_StagedBatch.m_LiveIDs.size();
+    try {
+        int32 tuioID;
+        while (!args.Eos()) {
+            args >> tuioID;
+            m_StagedBatch.m_LiveIDs.push_back(tuioID);
+        }
+    } catch (osc::Exception&) {
+        m_StagedBatch.m_LiveIDs.resize(firstLiveID);
+        throw;
+    }
+    TUIOCmd& cmd = addCmd(TUIOCmd::ALIVE);
+    cmd.m_Source = source;
+    cmd.m_FirstLiveID = firstLiveID;
+    cmd.m_NumLiveIDs = m_StagedBatch.m_LiveIDs.size()-firstLiveID;
+}
+
+void TUIOParser::parseUserID(ReceivedMessageArgumentStream& args)
+{
+    osc::int32 tuioID;
+    osc::int32 userID;
+    osc::int32 jointID;
+    args >> tuioID >> userID >> jointID;
+    TUIOCmd& cmd = addCmd(TUIOCmd::USER_ID);
+    cmd.m_TUIOID = tuioID;
+    cmd.m_UserID = userID;
+    cmd.m_JointID = jointID;
+}
+
+void TUIOParser::parseIndexFrame(ReceivedMessageArgumentStream& args)
+{
+    osc::int32 xsize;
+    osc::int32 ysize;
+    osc::Blob blob;
+    args >> xsize >> ysize >> blob >> osc::EndMessage;
+    TUIOCmd& cmd = addCmd(TUIOCmd::INDEX_FRAME);
+    cmd.m_pUserBmp = BitmapPtr(new Bitmap(IntPoint(xsize,ysize), I8,
+            (unsigned char*)blob.data, xsize, true));
+}
+
+TUIOCmd& TUIOParser::addCmd(TUIOCmd::Type type)
+{
+    m_StagedBatch.m_Cmds.push_back(TUIOCmd());
+    TUIOCmd& cmd = m_StagedBatch.m_Cmds.back();
+    cmd.m_Type = type;
+    cmd.m_FirstLiveID = 0;
+    cmd.m_NumLiveIDs = 0;
+    return cmd;
+}
+
+}
@@ -0,0 +1,109 @@
+//
+//  libavg - Media Playback Engine.
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _TUIOParser_H_
+#define _TUIOParser_H_
+
+#include "../api.h"
+#include "Event.h"
+
+#include "../base/GLMHelper.h"
+#include "../graphics/Bitmap.h"
+#include "../oscpack/OscReceivedElements.h"
+
+#include <boost/thread/mutex.hpp>
+
+#include <vector>
+
+namespace avg {
+
+// One parsed TUIO command. Which fields are valid depends on the type.
+struct AVG_API TUIOCmd {
+    enum Type {
+        TOUCH_SET,
+        TANGIBLE_SET,
+        ALIVE,
+        USER_ID,
+        INDEX_FRAME
+    };
+
+    Type m_Type;
+    int m_TUIOID;
+    int m_ClassID;
+    int m_UserID;
+    int m_JointID;
+    glm::vec2 m_Pos;
+    glm::vec2 m_Speed;
+    float m_Angle;
+    // ALIVE: The live ids are m_NumLiveIDs entries in TUIOBatch::m_LiveIDs.
+    Event::Source m_Source;
+    int m_FirstLiveID;
+    int m_NumLiveIDs;
+    BitmapPtr m_pUserBmp;
+};
+
+struct AVG_API TUIOBatch {
+    bool empty() const;
+    void clear();
+    void swap(TUIOBatch& other);
+    void append(const TUIOBatch& other);
+
+    std::vector<TUIOCmd> m_Cmds;
+    std::vector<int> m_LiveIDs;
+};
+
+// Parses TUIO packets and hands the results to another thread. The receiving thread
+// calls parsePacket() for every packet and publish() after each batch of packets; the
+// commands are staged in a batch only it touches in the meantime. fetch() is called
+// by the render thread and takes everything published since the last call. publish()
+// and fetch() share a lock that is only held to swap batches, so parsing never blocks
+// the render thread.
+class AVG_API TUIOParser
+{
+public:
+    TUIOParser();
+    virtual ~TUIOParser();
+
+    void parsePacket(const char* pData, int size);
+    void publish();
+
+    void fetch(TUIOBatch& batch);
+
+private:
+    void parseBundle(const osc::ReceivedBundle& bundle);
+    void parseMessage(const osc::ReceivedMessage& msg);
+    void parseTouchSet(osc::ReceivedMessageArgumentStream& args);
+    void parseTangibleSet(osc::ReceivedMessageArgumentStream& args);
+    void parseAlive(osc::ReceivedMessageArgumentStream& args, Event::Source source);
+    void parseUserID(osc::ReceivedMessageArgumentStream& args);
+    void parseIndexFrame(osc::ReceivedMessageArgumentStream& args);
+    TUIOCmd& addCmd(TUIOCmd::Type type);
+
+    TUIOBatch m_StagedBatch;
+    bool m_bConnected;
+
+    boost::mutex m_PublishMutex;
+    TUIOBatch m_PublishedBatch;
+};
+
+}
+
+#endif
@@ -31,6 +31,8 @@
 #include "../base/Exception.h"
 #include "../base/ObjectCounter.h"
 
+#include "../video/FFMpegBufferPool.h"
+
 #include <iostream>
 #ifdef WIN32
 #undef max
@@ -113,6 +115,11 @@ TypeMap TestHelper::getObjectCount()
     return ObjectCounter::get()->getObjectCount();
 }
 
+int TestHelper::getNumPooledVideoBuffers()
+{
+    return FFMpegBufferPool::getNumAllocatedBuffers();
+}
+
 // From InputDevice
 std::vector<EventPtr> TestHelper::pollEvents()
 {
@@ -60,6 +60,7 @@ class AVG_API TestHelper : public InputDevice
                 const std::string& sKeyString, int modifiers, const std::string& sText);
         void dumpObjects();
         TypeMap getObjectCount();
+        int getNumPooledVideoBuffers();
 
         // From InputDevice
         virtual std::vector<EventPtr> pollEvents();
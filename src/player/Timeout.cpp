@@ -50,7 +50,7 @@ Timeout::Timeout(int time, PyObject * pyfunc, bool isInterval, long long startTi
 
 Timeout::~Timeout()
 {
-    Py_DECREF(m_PyFunc);
+    Py_XDECREF(m_PyFunc);
     ObjectCounter::get()->decRef(&typeid(*this));
 }
 
@@ -69,11 +69,13 @@ void Timeout::fire(long long curTime)
     if (m_IsInterval) {
         m_NextTimeout = m_Interval + curTime;
     }
+    // The callable may clear its own timeout, so keep it alive during the call.
+    PyObject * pyFunc = m_PyFunc;
+    Py_INCREF(pyFunc);
     PyObject * arglist = Py_BuildValue("()");
-    PyObject * result = PyEval_CallObject(m_PyFunc, arglist);
-    // XXX: After the call to python, this might have been deleted 
-    // by a call to clearTimeout()!
+    PyObject * result = PyEval_CallObject(pyFunc, arglist);
     Py_DECREF(arglist);    
+    Py_DECREF(pyFunc);
     if (!result) {
         throw py::error_already_set();
     }
@@ -85,9 +87,14 @@ int Timeout::getID() const
     return m_ID;
 }
 
-bool Timeout::operator <(const Timeout& other) const
+long long Timeout::getNextTimeout() const
 {
-    return m_NextTimeout < other.m_NextTimeout;
+    return m_NextTimeout;
+}
+
+void Timeout::releaseCallable()
+{
+    Py_CLEAR(m_PyFunc);
 }
 
 }
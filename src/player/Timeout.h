@@ -26,6 +26,8 @@
 #include "WrapPython.h" 
 #include "../api.h"
 
+#include <boost/shared_ptr.hpp>
+
 namespace avg {
 
 class AVG_API Timeout
@@ -38,7 +40,10 @@ class AVG_API Timeout
         bool isInterval() const;
         void fire(long long curTime);
         int getID() const;
-        bool operator <(const Timeout& other) const;
+        long long getNextTimeout() const;
+        // Drops the reference to the python callable. Called when the timeout is 
+        // cleared, since the queue may keep the timeout itself around for a while.
+        void releaseCallable();
 
     private:
         long long m_Interval;
@@ -49,6 +54,8 @@ class AVG_API Timeout
         static int s_LastID;
 };
 
+typedef boost::shared_ptr<Timeout> TimeoutPtr;
+
 }
 
 #endif //_Timeout_H_
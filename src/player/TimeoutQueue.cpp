@@ -0,0 +1,177 @@
+//
+//  libavg - Media Playback Engine.
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "TimeoutQueue.h"
+#include "Timeout.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+namespace avg {
+
+TimeoutQueue::Entry::Entry(long long time, long long seq, TimeoutPtr pTimeout)
+    : m_Time(time),
+      m_Seq(seq),
+      m_pTimeout(pTimeout)
+{
+}
+
+bool TimeoutQueue::Entry::operator >(const Entry& other) const
+{
+    if (m_Time != other.m_Time) {
+        return m_Time > other.m_Time;
+    } else {
+        return m_Seq > other.m_Seq;
+    }
+}
+
+TimeoutQueue::TimeoutQueue()
+    : m_BatchPos(0),
+      m_NextSeq(0)
+{
+}
+
+TimeoutQueue::~TimeoutQueue()
+{
+}
+
+int TimeoutQueue::add(TimeoutPtr pTimeout)
+{
+    m_Timeouts[pTimeout->getID()] = pTimeout;
+    schedule(pTimeout);
+    return pTimeout->getID();
+}
+
+bool TimeoutQueue::remove(int id)
+{
+    TimeoutMap::iterator it = m_Timeouts.find(id);
+    if (it == m_Timeouts.end()) {
+        return false;
+    }
+    // The heap or batch entry stays and is skipped once it comes up, but the python 
+    // callable and everything it references are released now.
+    it->second->releaseCallable();
+    m_Timeouts.erase(it);
+    return true;
+}
+
+void TimeoutQueue::clear()
+{
+    m_Timeouts.clear();
+    m_Heap.clear();
+    m_Batch.clear();
+    m_BatchPos = 0;
+}
+
+int TimeoutQueue::size() const
+{
+    return int(m_Timeouts.size());
+}
+
+void TimeoutQueue::startBatch(long long time)
+{
+    // Timeouts can be left over from the last batch if a timeout threw an exception or
+    // playback was stopped. They keep their place in the queue.
+    for (unsigned i = m_BatchPos; i < m_Batch.size(); ++i) {
+        if (isPending(m_Batch[i].m_pTimeout)) {
+            push(m_Batch[i]);
+        }
+    }
+    m_Batch.clear();
+    m_BatchPos = 0;
+
+    while (!m_Heap.empty() && m_Heap.front().m_Time <= time) {
+        pop_heap(m_Heap.begin(), m_Heap.end(), greater<Entry>());
+        if (isPending(m_Heap.back().m_pTimeout)) {
+            m_Batch.push_back(m_Heap.back());
+        }
+        m_Heap.pop_back();
+    }
+}
+
+bool TimeoutQueue::fireNext(long long curTime)
+{
+    while (m_BatchPos < m_Batch.size()) {
+        TimeoutPtr pTimeout = m_Batch[m_BatchPos].m_pTimeout;
+        m_BatchPos++;
+        if (isPending(pTimeout)) {
+            try {
+                pTimeout->fire(curTime);
+            } catch (...) {
+                finishFiring(pTimeout);
+                throw;
+            }
+            finishFiring(pTimeout);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TimeoutQueue::push(const Entry& entry)
+{
+    m_Heap.push_back(entry);
+    push_heap(m_Heap.begin(), m_Heap.end(), greater<Entry>());
+}
+
+void TimeoutQueue::schedule(TimeoutPtr pTimeout)
+{
+    push(Entry(pTimeout->getNextTimeout(), m_NextSeq, pTimeout));
+    m_NextSeq++;
+    if (m_Heap.size() > 2*m_Timeouts.size()+64) {
+        compact();
+    }
+}
+
+void TimeoutQueue::finishFiring(TimeoutPtr pTimeout)
+{
+    // The timeout may have been removed by its own callback.
+    if (isPending(pTimeout)) {
+        if (pTimeout->isInterval()) {
+            schedule(pTimeout);
+        } else {
+            m_Timeouts.erase(pTimeout->getID());
+        }
+    }
+}
+
+bool TimeoutQueue::isPending(const TimeoutPtr& pTimeout) const
+{
+    TimeoutMap::const_iterator it = m_Timeouts.find(pTimeout->getID());
+    return it != m_Timeouts.end() && it->second == pTimeout;
+}
+
+void TimeoutQueue::compact()
+{
+    vector<Entry> heap;
+    heap.reserve(m_Timeouts.size());
+    for (unsigned i = 0; i < m_Heap.size(); ++i) {
+        if (isPending(m_Heap[i].m_pTimeout)) {
+            heap.push_back(m_Heap[i]);
+        }
+    }
+    m_Heap.swap(heap);
+    make_heap(m_Heap.begin(), m_Heap.end(), greater<Entry>());
+}
+
+}
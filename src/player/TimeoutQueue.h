@@ -0,0 +1,85 @@
+//
+//  libavg - Media Playback Engine.
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _TimeoutQueue_H_
+#define _TimeoutQueue_H_
+
+#include "../api.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <vector>
+
+namespace avg {
+
+class Timeout;
+typedef boost::shared_ptr<Timeout> TimeoutPtr;
+
+// Priority queue of pending timeouts and intervals. Adding a timeout is O(log n),
+// removing one is O(1): Removed timeouts stay in the heap until they reach the top or
+// the heap is compacted, but release their python callable immediately. Timeouts with
+// the same due time fire in the order they were scheduled.
+//
+// Timeouts are fired in batches: startBatch() collects everything due at the given
+// time, and fireNext() fires one of these timeouts. Timeouts added or rescheduled while
+// a batch is being fired aren't part of it, even if they are due already.
+class AVG_API TimeoutQueue
+{
+    public:
+        TimeoutQueue();
+        virtual ~TimeoutQueue();
+
+        int add(TimeoutPtr pTimeout);
+        bool remove(int id);
+        void clear();
+        int size() const;
+
+        void startBatch(long long time);
+        bool fireNext(long long curTime);
+
+    private:
+        struct Entry {
+            Entry(long long time, long long seq, TimeoutPtr pTimeout);
+            bool operator >(const Entry& other) const;
+
+            long long m_Time;
+            long long m_Seq;
+            TimeoutPtr m_pTimeout;
+        };
+
+        void push(const Entry& entry);
+        void schedule(TimeoutPtr pTimeout);
+        void finishFiring(TimeoutPtr pTimeout);
+        bool isPending(const TimeoutPtr& pTimeout) const;
+        void compact();
+
+        typedef boost::unordered_map<int, TimeoutPtr> TimeoutMap;
+        TimeoutMap m_Timeouts;
+        std::vector<Entry> m_Heap;
+        std::vector<Entry> m_Batch;
+        unsigned m_BatchPos;
+        long long m_NextSeq;
+};
+
+}
+
+#endif
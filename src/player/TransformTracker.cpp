@@ -0,0 +1,311 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "TransformTracker.h"
+
+#include "AreaNode.h"
+#include "CanvasNode.h"
+#include "Contact.h"
+#include "CursorEvent.h"
+#include "DivNode.h"
+
+#include "../base/Exception.h"
+#include "../base/MathHelper.h"
+
+using namespace std;
+
+namespace avg {
+
+static glm::mat3 translateMat(const glm::vec2& t)
+{
+    glm::mat3 m(1.0f);
+    m[2] = glm::vec3(t, 1);
+    return m;
+}
+
+static glm::mat3 rotateMat(float angle)
+{
+    glm::mat3 m(1.0f);
+    m[0] = glm::vec3(cos(angle), sin(angle), 0);
+    m[1] = glm::vec3(-sin(angle), cos(angle), 0);
+    return m;
+}
+
+static glm::mat3 scaleMat(const glm::vec2& s)
+{
+    glm::mat3 m(1.0f);
+    m[0][0] = s.x;
+    m[1][1] = s.y;
+    return m;
+}
+
+static glm::vec2 getCentroid(const vector<int>& indexes, const vector<glm::vec2>& pts)
+{
+    glm::vec2 c(0,0);
+    for (unsigned i = 0; i < indexes.size(); ++i) {
+        c += pts[indexes[i]];
+    }
+    return c/float(indexes.size());
+}
+
+// Angle from pt2 to pt1 in [0, 2*pi), like Point2D.angle().
+static float vecAngle(const glm::vec2& pt1, const glm::vec2& pt2)
+{
+    float angle = fmod((atan2(pt1.y, pt1.x) - atan2(pt2.y, pt2.x)), float(2*M_PI));
+    if (angle < 0) {
+        angle += float(2*M_PI);
+    }
+    return angle;
+}
+
+
+GestureTransform::GestureTransform(const glm::vec2& trans, float rot, float scale,
+        const glm::vec2& pivot)
+    : m_Trans(trans),
+      m_Rot(rot),
+      m_Scale(scale),
+      m_Pivot(pivot)
+{
+}
+
+const glm::vec2& GestureTransform::getTrans() const
+{
+    return m_Trans;
+}
+
+float GestureTransform::getRot() const
+{
+    return m_Rot;
+}
+
+float GestureTransform::getScale() const
+{
+    return m_Scale;
+}
+
+const glm::vec2& GestureTransform::getPivot() const
+{
+    return m_Pivot;
+}
+
+void GestureTransform::moveNode(AreaNodePtr pNode) const
+{
+    glm::vec2 nodePivot = pNode->getPivot();
+    glm::mat3 startMat = translateMat(pNode->getPos()) * translateMat(nodePivot) *
+            rotateMat(pNode->getAngle()) * translateMat(-nodePivot) *
+            scaleMat(pNode->getSize());
+    glm::mat3 newMat = translateMat(m_Pivot) * rotateMat(m_Rot) *
+            scaleMat(glm::vec2(m_Scale, m_Scale)) * translateMat(-m_Pivot) *
+            translateMat(m_Trans) * startMat;
+
+    glm::vec2 xAxis(newMat[0]);
+    glm::vec2 yAxis(newMat[1]);
+    float angle = getAngle(xAxis);
+    glm::vec2 size(glm::length(xAxis), glm::length(yAxis));
+    pNode->setAngle(angle);
+    pNode->setSize(size);
+    glm::vec2 pivot = size/2.f;
+    pNode->setPivot(pivot);
+    pNode->setPos(glm::vec2(newMat[2]) + getRotated(pivot, angle) - pivot);
+}
+
+
+TransformTracker::TransformTracker(float filterMinCutoff, float filterBeta)
+    : m_FilterMinCutoff(filterMinCutoff),
+      m_FilterBeta(filterBeta)
+{
+}
+
+TransformTracker::~TransformTracker()
+{
+}
+
+void TransformTracker::addContact(ContactPtr pContact, NodePtr pCoordSysNode)
+{
+    TrackedContact contact;
+    contact.m_pContact = pContact;
+    if (m_FilterMinCutoff > 0) {
+        contact.m_pXFilter = OneEuroFilterPtr(
+                new OneEuroFilter(m_FilterMinCutoff, m_FilterBeta));
+        contact.m_pYFilter = OneEuroFilterPtr(
+                new OneEuroFilter(m_FilterMinCutoff, m_FilterBeta));
+    }
+    m_Contacts.push_back(contact);
+    newPhase(pCoordSysNode);
+}
+
+GestureTransform TransformTracker::removeContact(ContactPtr pContact,
+        NodePtr pCoordSysNode, long long time)
+{
+    vector<TrackedContact>::iterator it;
+    for (it = m_Contacts.begin(); it != m_Contacts.end(); ++it) {
+        if (it->m_pContact == pContact) {
+            break;
+        }
+    }
+    AVG_ASSERT(it != m_Contacts.end());
+
+    GestureTransform transform;
+    if (m_Contacts.size() == 1) {
+        transform = GestureTransform(getFilteredRelPos(*it, pCoordSysNode, time) - 
+                m_LastPosns[0]);
+        m_Contacts.erase(it);
+    } else {
+        m_Contacts.erase(it);
+        newPhase(pCoordSysNode);
+    }
+    return transform;
+}
+
+void TransformTracker::clear()
+{
+    m_Contacts.clear();
+    m_LastPosns.clear();
+}
+
+int TransformTracker::getNumContacts() const
+{
+    return int(m_Contacts.size());
+}
+
+GestureTransform TransformTracker::update(NodePtr pCoordSysNode, long long time)
+{
+    if (m_Contacts.empty()) {
+        return GestureTransform();
+    }
+    m_ContactPosns.resize(m_Contacts.size());
+    for (unsigned i = 0; i < m_Contacts.size(); ++i) {
+        m_ContactPosns[i] = getFilteredRelPos(m_Contacts[i], pCoordSysNode, time);
+    }
+
+    GestureTransform transform;
+    if (m_Contacts.size() == 1) {
+        transform = GestureTransform(m_ContactPosns[0] - m_LastPosns[0]);
+        m_LastPosns[0] = m_ContactPosns[0];
+    } else {
+        calcClusterPosns(m_ContactPosns, m_Posns);
+
+        glm::vec2 startDelta = m_LastPosns[1] - m_LastPosns[0];
+        glm::vec2 curDelta = m_Posns[1] - m_Posns[0];
+        glm::vec2 pivot = (m_Posns[0] + m_Posns[1])/2.f;
+        float rot = vecAngle(curDelta, startDelta);
+        float scale;
+        if (m_LastPosns[0] == m_LastPosns[1]) {
+            scale = 1;
+        } else {
+            scale = glm::length(curDelta)/glm::length(startDelta);
+        }
+        glm::vec2 trans = pivot - (m_LastPosns[0] + m_LastPosns[1])/2.f;
+        transform = GestureTransform(trans, rot, scale, pivot);
+        m_LastPosns.swap(m_Posns);
+    }
+    return transform;
+}
+
+void TransformTracker::calcKMeans(const vector<glm::vec2>& pts, vector<int>& cluster1,
+        vector<int>& cluster2)
+{
+    AVG_ASSERT(pts.size() > 1);
+    glm::vec2 p1 = pts[0];
+    glm::vec2 p2 = pts[1];
+    glm::vec2 oldP1;
+    glm::vec2 oldP2;
+    int numIterations = 0;
+    do {
+        cluster1.clear();
+        cluster2.clear();
+        for (unsigned i = 0; i < pts.size(); ++i) {
+            if (glm::length(pts[i]-p1) < glm::length(pts[i]-p2)) {
+                cluster1.push_back(i);
+            } else {
+                cluster2.push_back(i);
+            }
+        }
+        oldP1 = p1;
+        oldP2 = p2;
+        if (!cluster1.empty()) {
+            p1 = getCentroid(cluster1, pts);
+        }
+        if (!cluster2.empty()) {
+            p2 = getCentroid(cluster2, pts);
+        }
+        numIterations++;
+    } while (!(p1 == oldP1 && p2 == oldP2) && numIterations < 50);
+
+    // Coincident points can all end up in one cluster.
+    if (cluster1.empty()) {
+        cluster1.push_back(cluster2.front());
+        cluster2.erase(cluster2.begin());
+    }
+}
+
+void TransformTracker::newPhase(NodePtr pCoordSysNode)
+{
+    m_LastPosns.clear();
+    m_ContactPosns.resize(m_Contacts.size());
+    for (unsigned i = 0; i < m_Contacts.size(); ++i) {
+        m_ContactPosns[i] = getRelPos(m_Contacts[i], pCoordSysNode);
+    }
+    if (m_Contacts.size() == 1) {
+        m_LastPosns.push_back(m_ContactPosns[0]);
+    } else if (m_Contacts.size() > 1) {
+        if (m_Contacts.size() > 2) {
+            calcKMeans(m_ContactPosns, m_Clusters[0], m_Clusters[1]);
+        }
+        calcClusterPosns(m_ContactPosns, m_LastPosns);
+    }
+}
+
+glm::vec2 TransformTracker::getRelPos(const TrackedContact& contact,
+        NodePtr pCoordSysNode) const
+{
+    NodePtr pNode = pCoordSysNode;
+    if (!boost::dynamic_pointer_cast<CanvasNode>(pNode)) {
+        pNode = pNode->getParent();
+    }
+    ContactPtr pContact = contact.m_pContact;
+    return pContact->getRelPos(pNode, pContact->getLastEvent()->getPos());
+}
+
+glm::vec2 TransformTracker::getFilteredRelPos(TrackedContact& contact,
+        NodePtr pCoordSysNode, long long time) const
+{
+    glm::vec2 pos = getRelPos(contact, pCoordSysNode);
+    if (contact.m_pXFilter) {
+        pos = glm::vec2(contact.m_pXFilter->apply(pos.x, time),
+                contact.m_pYFilter->apply(pos.y, time));
+    }
+    return pos;
+}
+
+void TransformTracker::calcClusterPosns(const vector<glm::vec2>& contactPosns,
+        vector<glm::vec2>& posns) const
+{
+    if (contactPosns.size() == 2) {
+        posns = contactPosns;
+    } else {
+        posns.resize(2);
+        posns[0] = getCentroid(m_Clusters[0], contactPosns);
+        posns[1] = getCentroid(m_Clusters[1], contactPosns);
+    }
+}
+
+}
@@ -0,0 +1,118 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _TransformTracker_H_
+#define _TransformTracker_H_
+
+#include "../api.h"
+
+#include "../base/GLMHelper.h"
+#include "../base/OneEuroFilter.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace avg {
+
+class Contact;
+typedef boost::shared_ptr<class Contact> ContactPtr;
+class Node;
+typedef boost::shared_ptr<class Node> NodePtr;
+class AreaNode;
+typedef boost::shared_ptr<class AreaNode> AreaNodePtr;
+
+// Translation, rotation around a pivot and uniform scale, as reported by
+// gesture.TransformRecognizer.
+class AVG_API GestureTransform {
+public:
+    GestureTransform(const glm::vec2& trans=glm::vec2(0,0), float rot=0, float scale=1,
+            const glm::vec2& pivot=glm::vec2(0,0));
+
+    const glm::vec2& getTrans() const;
+    float getRot() const;
+    float getScale() const;
+    const glm::vec2& getPivot() const;
+
+    void moveNode(AreaNodePtr pNode) const;
+
+private:
+    glm::vec2 m_Trans;
+    float m_Rot;
+    float m_Scale;
+    glm::vec2 m_Pivot;
+};
+
+// Computes the per-frame transform of a TransformRecognizer from all of its contacts
+// in one pass. Contact positions are relative to the parent of the coordinate system
+// node (or to the node itself if it's a canvas). With more than two contacts, the
+// contacts are grouped into two clusters whenever a contact is added or removed, and
+// the cluster centroids are used as the two transform points.
+class AVG_API TransformTracker {
+public:
+    // Contact positions are smoothed using a OneEuroFilter if filterMinCutoff > 0.
+    TransformTracker(float filterMinCutoff=-1, float filterBeta=0);
+    virtual ~TransformTracker();
+
+    void addContact(ContactPtr pContact, NodePtr pCoordSysNode);
+    // Returns the translation since the last update if this was the last contact
+    // and an identity transform otherwise.
+    GestureTransform removeContact(ContactPtr pContact, NodePtr pCoordSysNode,
+            long long time);
+    void clear();
+    int getNumContacts() const;
+
+    // Returns the transform since the last update and makes the current contact
+    // positions the reference for the next one.
+    GestureTransform update(NodePtr pCoordSysNode, long long time);
+
+    static void calcKMeans(const std::vector<glm::vec2>& pts, std::vector<int>& cluster1,
+            std::vector<int>& cluster2);
+
+private:
+    struct TrackedContact {
+        ContactPtr m_pContact;
+        OneEuroFilterPtr m_pXFilter;
+        OneEuroFilterPtr m_pYFilter;
+    };
+
+    void newPhase(NodePtr pCoordSysNode);
+    glm::vec2 getRelPos(const TrackedContact& contact, NodePtr pCoordSysNode) const;
+    glm::vec2 getFilteredRelPos(TrackedContact& contact, NodePtr pCoordSysNode,
+            long long time) const;
+    void calcClusterPosns(const std::vector<glm::vec2>& contactPosns,
+            std::vector<glm::vec2>& posns) const;
+
+    float m_FilterMinCutoff;
+    float m_FilterBeta;
+
+    std::vector<TrackedContact> m_Contacts;
+    std::vector<int> m_Clusters[2];
+    std::vector<glm::vec2> m_LastPosns;
+    std::vector<glm::vec2> m_ContactPosns;
+    std::vector<glm::vec2> m_Posns;
+};
+
+typedef boost::shared_ptr<TransformTracker> TransformTrackerPtr;
+
+}
+
+#endif
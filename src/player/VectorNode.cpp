@@ -142,6 +142,11 @@ void VectorNode::setBlendModeStr(const string& sBlendMode)
     m_BlendMode = GLContext::stringToBlendMode(sBlendMode);
 }
 
+void VectorNode::calcGeometry()
+{
+    checkRedraw();
+}
+
 static ProfilingZoneID PrerenderProfilingZone("VectorNode::prerender");
 
 void VectorNode::preRender(const VertexArrayPtr& pVA, bool bIsParentActive, 
@@ -163,7 +168,6 @@ void VectorNode::maybeRender(GLContext* pContext, const glm::mat4& parentTransfo
     if (isVisible()) {
         glm::vec3 trans(m_Translate.x, m_Translate.y, 0);
         glm::mat4 transform = glm::translate(parentTransform, trans);
-        pContext->setBlendMode(m_BlendMode);
         render(pContext, transform);
     }
 }
@@ -175,7 +179,7 @@ void VectorNode::render(GLContext* pContext, const glm::mat4& transform)
     ScopeTimer timer(RenderProfilingZone);
     float curOpacity = getEffectiveOpacity();
     if (curOpacity > 0.01) {
-        m_pShape->draw(pContext, transform, curOpacity);
+        m_pShape->draw(pContext, transform, curOpacity, m_BlendMode);
     }
 }
 
@@ -187,12 +191,22 @@ void VectorNode::getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements)
     }
 }
 
+bool VectorNode::getHitBounds(FRect& bounds)
+{
+    checkRedraw();
+    bounds = FRect(0, 0, -1, -1);
+    FRect shapeBounds;
+    if (m_pShape->getBounds(shapeBounds)) {
+        expandHitBounds(bounds, shapeBounds);
+    }
+    return true;
+}
 
 void VectorNode::setColor(const Color& color)
 {
     if (m_Color != color) {
         m_Color = color;
-        m_bDrawNeeded = true;
+        setDrawNeeded();
     }
 }
 
@@ -204,7 +218,7 @@ const Color& VectorNode::getColor() const
 void VectorNode::setStrokeWidth(float width)
 {
     if (width != m_StrokeWidth) {
-        m_bDrawNeeded = true;
+        setDrawNeeded();
         m_StrokeWidth = width;
     }
 }
@@ -253,6 +267,7 @@ string VectorNode::dump(int indent)
 void VectorNode::setDrawNeeded()
 {
     m_bDrawNeeded = true;
+    invalidateHitBounds();
 }
         
 bool VectorNode::isDrawNeeded()
@@ -528,6 +543,19 @@ bool VectorNode::isInside(const glm::vec2& pos)
 
 }
 
+void VectorNode::expandHitBounds(FRect& bounds, const FRect& rect)
+{
+    // Empty rectangles (tl > br) stand for nodes that don't react anywhere.
+    if (rect.tl.x > rect.br.x) {
+        return;
+    }
+    if (bounds.tl.x > bounds.br.x) {
+        bounds = rect;
+    } else {
+        bounds.expand(rect);
+    }
+}
+
 void VectorNode::checkRedraw()
 {
     if (m_bDrawNeeded) {
@@ -65,12 +65,14 @@ class AVG_API VectorNode : public Node
         const std::string& getBlendModeStr() const;
         void setBlendModeStr(const std::string& sBlendMode);
 
+        virtual void calcGeometry();
         virtual void preRender(const VertexArrayPtr& pVA, bool bIsParentActive, 
                 float parentEffectiveOpacity);
         virtual void maybeRender(GLContext* pContext, const glm::mat4& parentTransform);
         virtual void render(GLContext* pContext, const glm::mat4& transform);
 
         void getElementsByPos(const glm::vec2& pos, NodeChainPtr& pElements);
+        virtual bool getHitBounds(FRect& bounds);
 
         virtual void calcVertexes(const VertexDataPtr& pVertexData, Pixel32 color) = 0;
 
@@ -106,6 +108,7 @@ class AVG_API VectorNode : public Node
 
         void setTranslate(const glm::vec2& trans);
         virtual bool isInside(const glm::vec2& pos);
+        static void expandHitBounds(FRect& bounds, const FRect& rect);
         virtual void checkRedraw();
 
     private:
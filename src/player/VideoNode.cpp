@@ -65,6 +65,10 @@ void VideoNode::registerType()
         .addArg(Arg<float>("volume", 1.0, false, offsetof(VideoNode, m_Volume)))
         .addArg(Arg<bool>("enablesound", true, false,
                 offsetof(VideoNode, m_bEnableSound)))
+        .addArg(Arg<int>("decoderthreads", -1, false,
+                offsetof(VideoNode, m_DecoderThreads)))
+        .addArg(Arg<string>("decoderthreadtype", "", false,
+                offsetof(VideoNode, m_sDecoderThreadType)))
         ;
     TypeRegistry::get()->registerType(def);
 }
@@ -94,9 +98,19 @@ VideoNode::VideoNode(const ArgList& args,const string& sPublisherName)
     }
     if (m_bThreaded) {
         m_pDecoder = new AsyncVideoDecoder(m_QueueLength);
+        m_pDecoder->setUseBufferPool(Player::get()->isVideoZeroCopy());
     } else {
         m_pDecoder = new SyncVideoDecoder();
     }
+    // -1 and "" mean that the avgrc/Player settings are used.
+    if (m_DecoderThreads == -1) {
+        m_DecoderThreads = Player::get()->getVideoDecoderThreads();
+    }
+    if (m_sDecoderThreadType == "") {
+        m_sDecoderThreadType = Player::get()->getVideoDecoderThreadType();
+    }
+    m_pDecoder->setDecoderThreads(m_DecoderThreads, 
+            stringToDecoderThreadType(m_sDecoderThreadType));
 
     ObjectCounter::get()->incRef(&typeid(*this));
 }
@@ -300,6 +314,21 @@ bool VideoNode::isThreaded() const
     return m_bThreaded;
 }
 
+int VideoNode::getDecoderThreads() const
+{
+    return m_DecoderThreads;
+}
+
+const string& VideoNode::getDecoderThreadType() const
+{
+    return m_sDecoderThreadType;
+}
+
+float VideoNode::getAvgDecodeTime() const
+{
+    return m_pDecoder->getAvgDecodeTime();
+}
+
 bool VideoNode::hasAudio() const
 {
     exceptionIfUnloaded("hasAudio");
@@ -87,6 +87,9 @@ class AVG_API VideoNode: public RasterNode, IFrameEndListener
         void seekToTime(long long time);
         bool getLoop() const;
         bool isThreaded() const;
+        int getDecoderThreads() const;
+        const std::string& getDecoderThreadType() const;
+        float getAvgDecodeTime() const;
         bool hasAudio() const;
         bool hasAlpha() const;
         void setEOFCallback(PyObject * pEOFCallback);
@@ -128,6 +131,8 @@ class AVG_API VideoNode: public RasterNode, IFrameEndListener
         bool m_bThreaded;
         float m_FPS;
         int m_QueueLength;
+        int m_DecoderThreads;
+        std::string m_sDecoderThreadType;
         bool m_bEOFPending;
         PyObject * m_pEOFCallback;
         int m_FramesTooLate;
@@ -26,36 +26,55 @@
 #include "Window.h"
 
 #include "../graphics/FBO.h"
+#include "../graphics/MCFBO.h"
+#include "../graphics/MCTexture.h"
 #include "../graphics/GPURGB2YUVFilter.h"
 #include "../graphics/Filterfill.h"
 #include "../graphics/GLContext.h"
+#include "../graphics/GLContextManager.h"
+#ifndef AVG_ENABLE_EGL
+#include "../graphics/PBO.h"
+#endif
 #include "../base/StringHelper.h"
+#include "../base/ProfilingZoneID.h"
+#include "../base/ScopeTimer.h"
+#include "../base/TimeSource.h"
 
 #include <boost/bind.hpp>
 
+#include <algorithm>
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 
 using namespace std;
 using namespace boost;
 
 namespace avg {
 
+// Number of frames that can be in transit from the GPU at the same time.
+static const unsigned NUM_READBACK_PBOS = 3;
+
 VideoWriter::VideoWriter(CanvasPtr pCanvas, const string& sOutFileName, int frameRate,
-        int qMin, int qMax, bool bSyncToPlayback)
+        int qMin, int qMax, bool bSyncToPlayback, const string& sCodec, int numThreads,
+        int bitRate, int crf, int maxQueueSize, bool bDropFrames)
     : m_pCanvas(pCanvas),
       m_sOutFileName(sOutFileName),
       m_FrameRate(frameRate),
-      m_QMin(qMin),
-      m_QMax(qMax),
+      m_bUsePBOs(false),
+      m_FirstPendingPBO(0),
+      m_NumPendingPBOs(0),
+      m_bFlipY(false),
       m_bHasValidData(false),
+      m_CmdQueue(maxQueueSize > 0 ? maxQueueSize : -1),
+      m_bDropFrames(bDropFrames),
+      m_NumDroppedFrames(0),
       m_bSyncToPlayback(bSyncToPlayback),
       m_bPaused(false),
       m_PauseTime(0),
       m_bStopped(false),
       m_CurFrame(0),
-      m_StartTime(-1),
-      m_bFramePending(false)
+      m_StartTime(-1)
 {
     if (!pCanvas) {
         throw Exception(AVG_ERR_INVALID_ARGS, "VideoWriter needs a canvas to write to.");
@@ -63,6 +82,21 @@ VideoWriter::VideoWriter(CanvasPtr pCanvas, const string& sOutFileName, int fram
     if (GLContext::getCurrent()->isGLES()) {
         throw Exception(AVG_ERR_UNSUPPORTED, "VideoWriter not supported under GLES.");
     }
+    if (numThreads < 0 || maxQueueSize < 0) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE,
+                "VideoWriter: numthreads and maxqueuesize must not be negative.");
+    }
+    if (bDropFrames && maxQueueSize == 0) {
+        throw Exception(AVG_ERR_INVALID_ARGS,
+                "VideoWriter: dropframes needs a maxqueuesize.");
+    }
+    VideoWriterThread::checkCodec(sCodec);
+    m_Config.m_sCodec = sCodec;
+    m_Config.m_QMin = qMin;
+    m_Config.m_QMax = qMax;
+    m_Config.m_NumThreads = numThreads;
+    m_Config.m_BitRate = bitRate;
+    m_Config.m_CRF = crf;
 #ifdef WIN32
     int fd = _open(m_sOutFileName.c_str(), O_RDWR | O_CREAT, _S_IREAD | _S_IWRITE);
 #elif defined __linux__
@@ -83,22 +117,38 @@ VideoWriter::VideoWriter(CanvasPtr pCanvas, const string& sOutFileName, int fram
     remove(m_sOutFileName.c_str());
     CanvasPtr pMainCanvas = Player::get()->getMainCanvas();
     DisplayEngine* pDisplayEngine = Player::get()->getDisplayEngine();
+    GLContext* pOldContext = GLContext::getCurrent();
+    m_pMainGLContext = pDisplayEngine->getWindow(0)->getGLContext();
+    m_pMainGLContext->activate();
+#ifndef AVG_ENABLE_EGL
+    m_bUsePBOs = (m_pMainGLContext->getMemoryMode() == MM_PBO);
+#endif
     if (pMainCanvas == m_pCanvas) {
         m_FrameSize = pDisplayEngine->getWindowSize();
+        // Screens that consist of several windows are read synchronously.
+        if (pDisplayEngine->getNumWindows() != 1) {
+            m_bUsePBOs = false;
+        }
+        // The back buffer is bottom-up.
+        m_bFlipY = true;
     } else {
         m_FrameSize = m_pCanvas->getSize();
-        GLContext* pOldContext = GLContext::getCurrent();
-        m_pMainGLContext = pDisplayEngine->getWindow(0)->getGLContext();
-        m_pMainGLContext->activate();
         m_pFBO = dynamic_pointer_cast<OffscreenCanvas>(m_pCanvas)->
                 getFBO(m_pMainGLContext);
-        if (GLContext::getCurrent()->useGPUYUVConversion()) {
-            m_pFilter = GPURGB2YUVFilterPtr(new GPURGB2YUVFilter(m_FrameSize));
+    }
+    bool bYUVStream =
+            (VideoWriterThread::getStreamPixelFormat(sCodec) == AV_PIX_FMT_YUVJ420P);
+    if (m_bUsePBOs && m_pMainGLContext->useGPUYUVConversion() && bYUVStream) {
+        m_pFilter = GPURGB2YUVFilterPtr(new GPURGB2YUVFilter(m_FrameSize));
+        if (!m_pFBO) {
+            // The filter needs the screen contents in a texture.
+            m_pScreenFBO = GLContextManager::get()->createFBO(m_FrameSize, B8G8R8X8,
+                    1, 1, false, false, false);
         }
-        pOldContext->activate();
     }
+    pOldContext->activate();
     VideoWriterThread writer(m_CmdQueue, m_sOutFileName, m_FrameSize, m_FrameRate, 
-            qMin, qMax);
+            m_Config, m_Stats);
     m_pThread = new boost::thread(writer);
     m_pCanvas->registerPlaybackEndListener(this);
     m_pCanvas->registerFrameEndListener(this);
@@ -116,18 +166,26 @@ VideoWriter::~VideoWriter()
 void VideoWriter::stop()
 {
     if (!m_bStopped) {
-        getFrameFromPBO();
+        flushPBOs();
         if (!m_bHasValidData) {
             writeDummyFrame();
         }
 
         m_bStopped = true;
-        m_CmdQueue.pushCmd(boost::bind(&VideoWriterThread::stop, _1));
+        // Stopping doesn't wait for the encoder to make room in a bounded queue.
+        m_CmdQueue.pushCmd(boost::bind(&VideoWriterThread::stop, _1), false);
         
         m_pCanvas->unregisterFrameEndListener(this);
         m_pCanvas->unregisterPlaybackEndListener(this);
 
+        if (!m_pPBOs.empty()) {
+            GLContext* pOldContext = GLContext::getCurrent();
+            m_pMainGLContext->activate();
+            m_pPBOs.clear();
+            pOldContext->activate();
+        }
         m_pFBO = FBOPtr();
+        m_pScreenFBO = MCFBOPtr();
         m_pFilter = GPURGB2YUVFilterPtr();
     }
 }
@@ -166,29 +224,87 @@ int VideoWriter::getFramerate() const
 
 int VideoWriter::getQMin() const
 {
-    return m_QMin;
+    return m_Config.m_QMin;
 }
 
 int VideoWriter::getQMax() const
 {
-    return m_QMax;
+    return m_Config.m_QMax;
 }
 
-void VideoWriter::onFrameEnd()
+std::string VideoWriter::getCodec() const
 {
-    // The VideoWriter handles OffscreenCanvas and MainCanvas differently:
-    // For MainCanvas, it simply does a screenshot onFrameEnd and sends that to the 
-    // VideoWriterThread immediately.
-    // For OffscreenCanvas, an asynchronous PBO readback is started in onFrameEnd.
-    // In the next frame's onFrameEnd, the data is read into a bitmap and sent to 
-    // the VideoWriterThread.
-    if (m_pFBO) {
-        // Read last frame's bitmap.
-        GLContext* pOldContext = GLContext::getCurrent();
-        m_pMainGLContext->activate();
-        getFrameFromPBO();
-        pOldContext->activate();
+    return m_Config.m_sCodec;
+}
+
+int VideoWriter::getNumThreads() const
+{
+    return m_Config.m_NumThreads;
+}
+
+int VideoWriter::getBitRate() const
+{
+    return m_Config.m_BitRate;
+}
+
+int VideoWriter::getCRF() const
+{
+    return m_Config.m_CRF;
+}
+
+int VideoWriter::getMaxQueueSize() const
+{
+    return max(m_CmdQueue.getMaxSize(), 0);
+}
+
+bool VideoWriter::getDropFrames() const
+{
+    return m_bDropFrames;
+}
+
+int VideoWriter::getNumQueuedFrames() const
+{
+    return m_CmdQueue.size();
+}
+
+int VideoWriter::getNumDroppedFrames() const
+{
+    return m_NumDroppedFrames;
+}
+
+int VideoWriter::getNumEncodedFrames() const
+{
+    return m_Stats.m_NumFramesEncoded;
+}
+
+float VideoWriter::getEncoderLag() const
+{
+    return float(m_Stats.m_LastLag)/1000;
+}
+
+float VideoWriter::getMaxEncoderLag() const
+{
+    return float(m_Stats.m_MaxLag)/1000;
+}
+
+float VideoWriter::getAvgEncodeTime() const
+{
+    int numFrames = m_Stats.m_NumFramesEncoded;
+    if (numFrames == 0) {
+        return 0;
     }
+    return float(m_Stats.m_TotalEncodeTime)/numFrames/1000;
+}
+
+void VideoWriter::onFrameEnd()
+{
+    // Frames are read back asynchronously for MainCanvas and OffscreenCanvas alike:
+    // onFrameEnd starts a readback into the next PBO of a ring of NUM_READBACK_PBOS.
+    // The data is only mapped and sent to the VideoWriterThread when that PBO is
+    // needed again, so the GPU has several frames to finish the transfer and rendering
+    // never waits for it. If possible, the frame is converted to YUV on the GPU before
+    // readback.
+    // Without PBO support, frames are read synchronously.
     if (m_StartTime == -1) {
         m_StartTime = Player::get()->getFrameTime();
     }
@@ -208,57 +324,164 @@ void VideoWriter::onFrameEnd()
             }
         }
     }
-    
-    if (!m_pFBO) {
-        getFrameFromPBO();
-    }
 }
 
+static ProfilingZoneID ReadbackProfilingZone("VideoWriter: start readback");
+
 void VideoWriter::getFrameFromFBO()
 {
-    if (m_pFBO) {
-        GLContext* pOldContext = GLContext::getCurrent();
-        m_pMainGLContext->activate();
+    m_CurFrame++;
+    if (!m_bUsePBOs) {
+        BitmapPtr pBmp;
+        if (m_pFBO) {
+            GLContext* pOldContext = GLContext::getCurrent();
+            m_pMainGLContext->activate();
+            pBmp = m_pFBO->getImage();
+            pOldContext->activate();
+        } else {
+            pBmp = Player::get()->getDisplayEngine()->screenshot(GL_BACK);
+        }
+        sendFrameToEncoder(pBmp);
+        return;
+    }
+#ifndef AVG_ENABLE_EGL
+    ScopeTimer timer(ReadbackProfilingZone);
+    GLContext* pOldContext = GLContext::getCurrent();
+    m_pMainGLContext->activate();
+    if (m_pPBOs.empty()) {
+        PixelFormat pf;
         if (m_pFilter) {
-            m_pFilter->apply(m_pMainGLContext, m_pFBO->getTex());
-            FBOPtr pYUVFBO = m_pFilter->getFBO(m_pMainGLContext);
-            pYUVFBO->moveToPBO();
+            pf = m_pFilter->getFBO(m_pMainGLContext)->getPF();
+        } else if (m_pFBO) {
+            pf = m_pFBO->getPF();
         } else {
-            m_pFBO->moveToPBO();
+            pf = B8G8R8X8;
         }
-        pOldContext->activate();
-        m_bFramePending = true;
+        for (unsigned i = 0; i < NUM_READBACK_PBOS; ++i) {
+            m_pPBOs.push_back(PBOPtr(new PBO(m_FrameSize, pf, GL_STREAM_READ)));
+        }
+    }
+    if (m_NumPendingPBOs == m_pPBOs.size()) {
+        getFrameFromPBO();
+    }
+    PBOPtr pPBO = m_pPBOs[(m_FirstPendingPBO+m_NumPendingPBOs) % m_pPBOs.size()];
+    if (m_pFilter) {
+        GLTexturePtr pSrcTex;
+        if (m_pFBO) {
+            pSrcTex = m_pFBO->getTex();
+        } else {
+            readScreenToFBO();
+            pSrcTex = m_pScreenFBO->getTex()->getTex(m_pMainGLContext);
+        }
+        m_pFilter->apply(m_pMainGLContext, pSrcTex);
+        m_pFilter->getFBO(m_pMainGLContext)->moveToPBO(*pPBO);
+    } else if (m_pFBO) {
+        m_pFBO->moveToPBO(*pPBO);
     } else {
-        BitmapPtr pBmp = Player::get()->getDisplayEngine()->screenshot(GL_BACK);
-        sendFrameToEncoder(pBmp);
+        readScreenToPBO(*pPBO);
     }
+    glproc::BindBuffer(GL_PIXEL_PACK_BUFFER_EXT, 0);
+    m_NumPendingPBOs++;
+    pOldContext->activate();
+#endif
 }
 
 void VideoWriter::getFrameFromPBO()
 {
-    if (m_bFramePending) {
-        BitmapPtr pBmp;
+    // Must be called with the main GL context active.
+    AVG_ASSERT(m_NumPendingPBOs > 0);
+    BitmapPtr pBmp = getImageFromPBO(*m_pPBOs[m_FirstPendingPBO]);
+    m_FirstPendingPBO = (m_FirstPendingPBO+1) % m_pPBOs.size();
+    m_NumPendingPBOs--;
+    sendFrameToEncoder(pBmp);
+}
+
+void VideoWriter::flushPBOs()
+{
+    if (m_NumPendingPBOs > 0) {
         GLContext* pOldContext = GLContext::getCurrent();
         m_pMainGLContext->activate();
-        if (m_pFilter) {
-            pBmp = m_pFilter->getFBO(m_pMainGLContext)->getImageFromPBO();
-        } else {
-            pBmp = m_pFBO->getImageFromPBO();
+        while (m_NumPendingPBOs > 0) {
+            getFrameFromPBO();
         }
-            pOldContext->activate();
-        sendFrameToEncoder(pBmp);
-        m_bFramePending = false;
+        pOldContext->activate();
+    }
+}
+
+void VideoWriter::readScreenToPBO(PBO& pbo)
+{
+#ifndef AVG_ENABLE_EGL
+    glproc::BindFramebuffer(GL_FRAMEBUFFER, 0);
+    glReadBuffer(GL_BACK);
+    GLContext::checkError("VideoWriter::readScreenToPBO: glReadBuffer()");
+    pbo.activate();
+    glReadPixels(0, 0, m_FrameSize.x, m_FrameSize.y, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+    GLContext::checkError("VideoWriter::readScreenToPBO: glReadPixels()");
+#endif
+}
+
+void VideoWriter::readScreenToFBO()
+{
+#ifndef AVG_ENABLE_EGL
+    // Resolves multisampling as well.
+    m_pScreenFBO->activate(m_pMainGLContext);
+    glproc::BindFramebuffer(GL_READ_FRAMEBUFFER_EXT, 0);
+    glReadBuffer(GL_BACK);
+    glproc::BlitFramebuffer(0, 0, m_FrameSize.x, m_FrameSize.y, 
+            0, 0, m_FrameSize.x, m_FrameSize.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    GLContext::checkError("VideoWriter::readScreenToFBO: BlitFramebuffer()");
+    glproc::BindFramebuffer(GL_FRAMEBUFFER, 0);
+#endif
+}
+
+static ProfilingZoneID MapPBOProfilingZone("VideoWriter: map PBO");
+
+BitmapPtr VideoWriter::getImageFromPBO(PBO& pbo)
+{
+#ifdef AVG_ENABLE_EGL
+    AVG_ASSERT(false);
+    return BitmapPtr();
+#else
+    ScopeTimer timer(MapPBOProfilingZone);
+    pbo.activate();
+    PixelFormat pf = pbo.getPF();
+    BitmapPtr pBmp(new Bitmap(m_FrameSize, pf));
+    unsigned char* pPBOPixels = (unsigned char*)glproc::MapBuffer(
+            GL_PIXEL_PACK_BUFFER_EXT, GL_READ_ONLY);
+    GLContext::checkError("VideoWriter::getImageFromPBO: MapBuffer()");
+    // Screen contents are flipped while copying so they don't need an extra pass.
+    int srcStride = m_FrameSize.x*getBytesPerPixel(pf);
+    int lineLen = min(srcStride, pBmp->getStride());
+    for (int y = 0; y < m_FrameSize.y; ++y) {
+        int srcLine = m_bFlipY ? m_FrameSize.y-1-y : y;
+        memcpy(pBmp->getPixels()+y*pBmp->getStride(), pPBOPixels+srcLine*srcStride,
+                lineLen);
     }
+    glproc::UnmapBuffer(GL_PIXEL_PACK_BUFFER_EXT);
+    GLContext::checkError("VideoWriter::getImageFromPBO: UnmapBuffer()");
+    glproc::BindBuffer(GL_PIXEL_PACK_BUFFER_EXT, 0);
+    return pBmp;
+#endif
 }
 
 void VideoWriter::sendFrameToEncoder(BitmapPtr pBitmap)
 {
-    m_CurFrame++;
+    // With a bounded queue, pushCmd() blocks until the encoder catches up unless
+    // frames may be dropped. Frames and the stop command are all pushed from the main
+    // thread and only the encoder thread removes commands, so a queue that isn't full
+    // now can't fill up before the push.
+    if (m_bDropFrames && m_CmdQueue.size() >= m_CmdQueue.getMaxSize()) {
+        m_NumDroppedFrames++;
+        return;
+    }
     m_bHasValidData = true;
+    long long submitTime = TimeSource::get()->getCurrentMicrosecs();
     if (m_pFilter) {
-        m_CmdQueue.pushCmd(boost::bind(&VideoWriterThread::encodeYUVFrame, _1, pBitmap));
+        m_CmdQueue.pushCmd(boost::bind(&VideoWriterThread::encodeYUVFrame, _1, pBitmap,
+                submitTime));
     } else {
-        m_CmdQueue.pushCmd(boost::bind(&VideoWriterThread::encodeFrame, _1, pBitmap));
+        m_CmdQueue.pushCmd(boost::bind(&VideoWriterThread::encodeFrame, _1, pBitmap,
+                submitTime));
     }
 }
 
@@ -34,6 +34,7 @@
 #include <boost/thread.hpp>
 
 #include <string>
+#include <vector>
 
 namespace avg {
 
@@ -41,6 +42,10 @@ class Canvas;
 typedef boost::shared_ptr<Canvas> CanvasPtr;
 class FBO;
 typedef boost::shared_ptr<FBO> FBOPtr;
+class MCFBO;
+typedef boost::shared_ptr<MCFBO> MCFBOPtr;
+class PBO;
+typedef boost::shared_ptr<PBO> PBOPtr;
 class GPURGB2YUVFilter;
 typedef boost::shared_ptr<GPURGB2YUVFilter> GPURGB2YUVFilterPtr;
 class GLContext;
@@ -49,7 +54,9 @@ class AVG_API VideoWriter : public IFrameEndListener, IPlaybackEndListener
 {
     public:
         VideoWriter(CanvasPtr pCanvas, const std::string& sOutFileName,
-                int frameRate=30, int qMin=3, int qMax=5, bool bSyncToPlayback=true);
+                int frameRate=30, int qMin=3, int qMax=5, bool bSyncToPlayback=true,
+                const std::string& sCodec="mjpeg", int numThreads=1, int bitRate=0,
+                int crf=-1, int maxQueueSize=0, bool bDropFrames=false);
         virtual ~VideoWriter();
         void stop();
         void pause();
@@ -59,6 +66,19 @@ class AVG_API VideoWriter : public IFrameEndListener, IPlaybackEndListener
         int getFramerate() const;
         int getQMin() const;
         int getQMax() const;
+        std::string getCodec() const;
+        int getNumThreads() const;
+        int getBitRate() const;
+        int getCRF() const;
+        int getMaxQueueSize() const;
+        bool getDropFrames() const;
+
+        int getNumQueuedFrames() const;
+        int getNumDroppedFrames() const;
+        int getNumEncodedFrames() const;
+        float getEncoderLag() const;
+        float getMaxEncoderLag() const;
+        float getAvgEncodeTime() const;
 
         virtual void onFrameEnd();
         virtual void onPlaybackEnd();
@@ -66,6 +86,10 @@ class AVG_API VideoWriter : public IFrameEndListener, IPlaybackEndListener
     private:
         void getFrameFromFBO();
         void getFrameFromPBO();
+        void readScreenToPBO(PBO& pbo);
+        void readScreenToFBO();
+        BitmapPtr getImageFromPBO(PBO& pbo);
+        void flushPBOs();
 
         void sendFrameToEncoder(BitmapPtr pBitmap);
         void writeDummyFrame();
@@ -73,16 +97,24 @@ class AVG_API VideoWriter : public IFrameEndListener, IPlaybackEndListener
         CanvasPtr m_pCanvas;
         GLContext* m_pMainGLContext;
         FBOPtr m_pFBO;
+        MCFBOPtr m_pScreenFBO;
         GPURGB2YUVFilterPtr m_pFilter;
+        bool m_bUsePBOs;
+        std::vector<PBOPtr> m_pPBOs;
+        unsigned m_FirstPendingPBO;
+        unsigned m_NumPendingPBOs;
+        bool m_bFlipY;
         std::string m_sOutFileName;
         int m_FrameRate;
-        int m_QMin;
-        int m_QMax;
+        VideoWriterConfig m_Config;
         IntPoint m_FrameSize;
 
         bool m_bHasValidData;
 
         VideoWriterThread::CQueue m_CmdQueue;
+        bool m_bDropFrames;
+        int m_NumDroppedFrames;
+        VideoWriterStats m_Stats;
         boost::thread* m_pThread;
         bool m_bSyncToPlayback;
 
@@ -94,7 +126,6 @@ class AVG_API VideoWriter : public IFrameEndListener, IPlaybackEndListener
 
         int m_CurFrame;
         long long m_StartTime;
-        bool m_bFramePending;
 };
 
 }
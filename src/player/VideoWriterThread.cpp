@@ -25,6 +25,7 @@
 #include "../base/ProfilingZoneID.h"
 #include "../base/ScopeTimer.h"
 #include "../base/StringHelper.h"
+#include "../base/TimeSource.h"
 #include "../video/VideoDecoder.h"
 
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(55, 18, 102)
@@ -39,16 +40,34 @@ namespace avg {
 const unsigned int VIDEO_BUFFER_SIZE = 400000;
 #endif
 
-const AVPixelFormat STREAM_PIXEL_FORMAT = AV_PIX_FMT_YUVJ420P;
+VideoWriterConfig::VideoWriterConfig()
+    : m_sCodec("mjpeg"),
+      m_QMin(3),
+      m_QMax(5),
+      m_NumThreads(1),
+      m_BitRate(0),
+      m_CRF(-1)
+{
+}
+
+VideoWriterStats::VideoWriterStats()
+    : m_NumFramesEncoded(0),
+      m_LastLag(0),
+      m_MaxLag(0),
+      m_TotalEncodeTime(0)
+{
+}
 
 VideoWriterThread::VideoWriterThread(CQueue& cmdQueue, const string& sFilename,
-        IntPoint size, int frameRate, int qMin, int qMax)
+        IntPoint size, int frameRate, const VideoWriterConfig& config,
+        VideoWriterStats& stats)
     : WorkerThread<VideoWriterThread>(sFilename, cmdQueue, Logger::category::PROFILE),
       m_sFilename(sFilename),
       m_Size(size),
       m_FrameRate(frameRate),
-      m_QMin(qMin),
-      m_QMax(qMax),
+      m_Config(config),
+      m_Stats(stats),
+      m_StreamPixelFormat(getStreamPixelFormat(config.m_sCodec)),
       m_pOutputFormatContext()
 {
 }
@@ -57,27 +76,60 @@ VideoWriterThread::~VideoWriterThread()
 {
 }
 
+void VideoWriterThread::checkCodec(const string& sCodec)
+{
+    if (sCodec != "mjpeg" && sCodec != "h264" && sCodec != "ffv1") {
+        throw Exception(AVG_ERR_INVALID_ARGS, "VideoWriter: Unknown codec '" + sCodec +
+                "'. Must be 'mjpeg', 'h264' or 'ffv1'.");
+    }
+    lock_guard lock(VideoDecoder::s_OpenMutex);
+    av_register_all();
+    if (!findEncoder(sCodec)) {
+        throw Exception(AVG_ERR_VIDEO_INIT_FAILED, "VideoWriter: Codec '" + sCodec +
+                "' not supported by this ffmpeg build.");
+    }
+}
+
+AVPixelFormat VideoWriterThread::getStreamPixelFormat(const string& sCodec)
+{
+    if (sCodec == "ffv1") {
+        // Lossless, so the frames are stored without color space conversion.
+        return AV_PIX_FMT_RGB32;
+    } else {
+        return AV_PIX_FMT_YUVJ420P;
+    }
+}
+
 static ProfilingZoneID ProfilingZoneEncodeFrame("Encode frame", true);
 
-void VideoWriterThread::encodeYUVFrame(BitmapPtr pBmp)
+void VideoWriterThread::encodeYUVFrame(BitmapPtr pBmp, long long submitTime)
 {
-    ScopeTimer timer(ProfilingZoneEncodeFrame);
-    convertYUVImage(pBmp);
-    writeFrame(m_pConvertedFrame);
+    long long startTime = TimeSource::get()->getCurrentMicrosecs();
+    {
+        ScopeTimer timer(ProfilingZoneEncodeFrame);
+        convertYUVImage(pBmp);
+        writeFrame(m_pConvertedFrame);
+    }
+    updateStats(submitTime, startTime);
     ThreadProfiler::get()->reset();
 }
 
-void VideoWriterThread::encodeFrame(BitmapPtr pBmp)
+void VideoWriterThread::encodeFrame(BitmapPtr pBmp, long long submitTime)
 {
-    ScopeTimer timer(ProfilingZoneEncodeFrame);
-    convertRGBImage(pBmp);
-    writeFrame(m_pConvertedFrame);
+    long long startTime = TimeSource::get()->getCurrentMicrosecs();
+    {
+        ScopeTimer timer(ProfilingZoneEncodeFrame);
+        convertRGBImage(pBmp);
+        writeFrame(m_pConvertedFrame);
+    }
+    updateStats(submitTime, startTime);
     ThreadProfiler::get()->reset();
 }
 
 void VideoWriterThread::close()
 {
     if (m_pOutputFormatContext) {
+        flushEncoder();
         av_write_trailer(m_pOutputFormatContext);
         lock_guard lock(VideoDecoder::s_OpenMutex);
         avcodec_close(m_pVideoStream->codec);
@@ -128,7 +180,9 @@ void VideoWriterThread::open()
     av_register_all(); // TODO: make sure this is only done once. 
 //    av_log_set_level(AV_LOG_DEBUG);
     m_pOutputFormat = av_guess_format(0, m_sFilename.c_str(), 0);
-    m_pOutputFormat->video_codec = AV_CODEC_ID_MJPEG;
+    AVCodec* pCodec = findEncoder(m_Config.m_sCodec);
+    AVG_ASSERT(pCodec);
+    m_pOutputFormat->video_codec = pCodec->id;
 
     m_pOutputFormatContext = avformat_alloc_context();
     m_pOutputFormatContext->oformat = m_pOutputFormat;
@@ -164,10 +218,10 @@ void VideoWriterThread::open()
     }
 
     m_pFrameConversionContext = sws_getContext(m_Size.x, m_Size.y, 
-            AV_PIX_FMT_RGB32, m_Size.x, m_Size.y, STREAM_PIXEL_FORMAT, 
+            AV_PIX_FMT_RGB32, m_Size.x, m_Size.y, m_StreamPixelFormat, 
             SWS_BILINEAR, NULL, NULL, NULL);
 
-    m_pConvertedFrame = createFrame(STREAM_PIXEL_FORMAT, m_Size);
+    m_pConvertedFrame = createFrame(m_StreamPixelFormat, m_Size);
 
     avformat_write_header(m_pOutputFormatContext, 0);
 }
@@ -181,7 +235,11 @@ void VideoWriterThread::setupVideoStream()
     pCodecContext->codec_type = AVMEDIA_TYPE_VIDEO;
 
     /* put sample parameters */
-    pCodecContext->bit_rate = 400000;
+    if (m_Config.m_BitRate > 0) {
+        pCodecContext->bit_rate = m_Config.m_BitRate;
+    } else if (m_Config.m_sCodec == "mjpeg") {
+        pCodecContext->bit_rate = 400000;
+    }
     /* resolution must be a multiple of two */
     pCodecContext->width = m_Size.x;
     pCodecContext->height = m_Size.y;
@@ -192,10 +250,13 @@ void VideoWriterThread::setupVideoStream()
     pCodecContext->time_base.den = m_FrameRate;
     pCodecContext->time_base.num = 1;
 //    pCodecContext->gop_size = 12; /* emit one intra frame every twelve frames at most */
-    pCodecContext->pix_fmt = STREAM_PIXEL_FORMAT;
-    // Quality of quantization
-    pCodecContext->qmin = m_QMin;
-    pCodecContext->qmax = m_QMax;
+    pCodecContext->pix_fmt = m_StreamPixelFormat;
+    if (m_Config.m_sCodec == "mjpeg") {
+        // Quality of quantization
+        pCodecContext->qmin = m_Config.m_QMin;
+        pCodecContext->qmax = m_Config.m_QMax;
+    }
+    pCodecContext->thread_count = m_Config.m_NumThreads;
     // some formats want stream headers to be separate
     if (m_pOutputFormatContext->oformat->flags & AVFMT_GLOBALHEADER) {
         pCodecContext->flags |= CODEC_FLAG_GLOBAL_HEADER;
@@ -205,13 +266,36 @@ void VideoWriterThread::setupVideoStream()
 
 void VideoWriterThread::openVideoCodec()
 {
-    AVCodec* videoCodec = avcodec_find_encoder(m_pVideoStream->codec->codec_id);
+    AVCodec* videoCodec = findEncoder(m_Config.m_sCodec);
     AVG_ASSERT(videoCodec);
 
-    int rc = avcodec_open2(m_pVideoStream->codec, videoCodec, 0);
+    AVDictionary* pOptions = 0;
+    if (m_Config.m_sCodec == "h264") {
+        // The default preset is too slow for realtime recording of large frames.
+        av_dict_set(&pOptions, "preset", "veryfast", 0);
+        if (m_Config.m_CRF >= 0) {
+            av_dict_set(&pOptions, "crf", toString(m_Config.m_CRF).c_str(), 0);
+        }
+    } else if (m_Config.m_sCodec == "ffv1" && m_Config.m_NumThreads != 1) {
+        // Only ffv1 version 3 is encoded in slices that can be processed in parallel.
+        av_dict_set(&pOptions, "level", "3", 0);
+    }
+    int rc = avcodec_open2(m_pVideoStream->codec, videoCodec, &pOptions);
+    av_dict_free(&pOptions);
     AVG_ASSERT(rc == 0);
 }
 
+AVCodec* VideoWriterThread::findEncoder(const string& sCodec)
+{
+    if (sCodec == "h264") {
+        return avcodec_find_encoder_by_name("libx264");
+    } else if (sCodec == "ffv1") {
+        return avcodec_find_encoder(AV_CODEC_ID_FFV1);
+    } else {
+        return avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    }
+}
+
 AVFrame* VideoWriterThread::createFrame(AVPixelFormat pixelFormat, IntPoint size)
 {
     AVFrame* pPicture;
@@ -279,24 +363,34 @@ void VideoWriterThread::convertYUVImage(BitmapPtr pSrcBmp)
 
 static ProfilingZoneID ProfilingZoneWriteFrame(" Write frame", true);
 
-void VideoWriterThread::writeFrame(AVFrame* pFrame)
+bool VideoWriterThread::writeFrame(AVFrame* pFrame)
 {
+    // pFrame == 0 retrieves frames still buffered in the encoder.
     ScopeTimer timer(ProfilingZoneWriteFrame);
-    m_FramesWritten++;
     AVCodecContext* pCodecContext = m_pVideoStream->codec;
     AVPacket packet = { 0 };
     int ret;
     bool bGotOutput;
+    if (pFrame) {
+        pFrame->pts = m_FramesWritten;
+        m_FramesWritten++;
+    }
 
 #if LIBAVCODEC_VERSION_INT > AV_VERSION_INT(54, 0, 0)
     av_init_packet(&packet);
     int got_output = 0;
     ret = avcodec_encode_video2(pCodecContext, &packet, pFrame, &got_output);
     AVG_ASSERT(ret >= 0);
-    if ((pCodecContext->coded_frame->pts) != (long long)AV_NOPTS_VALUE) {
-        packet.pts = av_rescale_q(pCodecContext->coded_frame->pts,
-                pCodecContext->time_base, m_pVideoStream->time_base);
+    // Encoders with frame reordering (h264) need dts as well as pts.
+    if (packet.pts != (long long)AV_NOPTS_VALUE) {
+        packet.pts = av_rescale_q(packet.pts, pCodecContext->time_base,
+                m_pVideoStream->time_base);
+    }
+    if (packet.dts != (long long)AV_NOPTS_VALUE) {
+        packet.dts = av_rescale_q(packet.dts, pCodecContext->time_base,
+                m_pVideoStream->time_base);
     }
+    packet.stream_index = m_pVideoStream->index;
     bGotOutput = (got_output != 0);
 #else
     int out_size = avcodec_encode_video(pCodecContext, m_pVideoBuffer,
@@ -328,7 +422,31 @@ void VideoWriterThread::writeFrame(AVFrame* pFrame)
         }
         AVG_ASSERT(ret == 0);
     }
+    return bGotOutput;
+}
 
+void VideoWriterThread::flushEncoder()
+{
+#if LIBAVCODEC_VERSION_INT > AV_VERSION_INT(54, 0, 0)
+    if (m_pVideoStream->codec->codec->capabilities & CODEC_CAP_DELAY) {
+        while (writeFrame(0)) {}
+    }
+#endif
+}
+
+void VideoWriterThread::updateStats(long long submitTime, long long encodeStartTime)
+{
+    // Only this thread writes the statistics, so there are no lost updates. The 
+    // maximum is updated first, so a reader that reads the last lag before the 
+    // maximum never sees a maximum that is smaller than the last lag.
+    long long now = TimeSource::get()->getCurrentMicrosecs();
+    long long lag = now - submitTime;
+    if (lag > m_Stats.m_MaxLag) {
+        m_Stats.m_MaxLag = lag;
+    }
+    m_Stats.m_LastLag = lag;
+    m_Stats.m_TotalEncodeTime += now - encodeStartTime;
+    m_Stats.m_NumFramesEncoded++;
 }
 
 }
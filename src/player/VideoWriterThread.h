@@ -31,19 +31,49 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
 
-
+#include <atomic>
 #include <string>
 
 namespace avg {
 
+struct AVG_API VideoWriterConfig {
+    VideoWriterConfig();
+
+    // "mjpeg", "h264" (libx264) or "ffv1" (lossless).
+    std::string m_sCodec;
+    // Quantizer range, only used by mjpeg.
+    int m_QMin;
+    int m_QMax;
+    // Number of encoder threads, 0 lets the codec decide.
+    int m_NumThreads;
+    // Target bitrate in bits per second, 0 for the codec default.
+    int m_BitRate;
+    // Constant rate factor for h264, -1 to use the bitrate instead.
+    int m_CRF;
+};
+
+// Written by the VideoWriterThread, read by the VideoWriter. Times are in microseconds.
+struct AVG_API VideoWriterStats {
+    VideoWriterStats();
+
+    std::atomic<int> m_NumFramesEncoded;
+    std::atomic<long long> m_LastLag;
+    std::atomic<long long> m_MaxLag;
+    std::atomic<long long> m_TotalEncodeTime;
+};
+
 class AVG_API VideoWriterThread : public WorkerThread<VideoWriterThread>  {
     public:
         VideoWriterThread(CQueue& cmdQueue, const std::string& sFilename, IntPoint size,
-                int frameRate, int qMin, int qMax);
+                int frameRate, const VideoWriterConfig& config, VideoWriterStats& stats);
         virtual ~VideoWriterThread();
 
-        void encodeYUVFrame(BitmapPtr pBmp);
-        void encodeFrame(BitmapPtr pBmp);
+        // Throws if sCodec isn't a known codec name or not available in this build.
+        static void checkCodec(const std::string& sCodec);
+        static AVPixelFormat getStreamPixelFormat(const std::string& sCodec);
+
+        void encodeYUVFrame(BitmapPtr pBmp, long long submitTime);
+        void encodeFrame(BitmapPtr pBmp, long long submitTime);
         void close();
 
     private:
@@ -56,18 +86,22 @@ class AVG_API VideoWriterThread : public WorkerThread<VideoWriterThread>  {
 
         void setupVideoStream();
         void openVideoCodec();
+        static AVCodec* findEncoder(const std::string& sCodec);
 
         AVFrame* createFrame(AVPixelFormat pixelFormat, IntPoint size);
 
         void convertRGBImage(BitmapPtr pSrcBmp);
         void convertYUVImage(BitmapPtr pSrcBmp);
-        void writeFrame(AVFrame* pFrame);
+        bool writeFrame(AVFrame* pFrame);
+        void flushEncoder();
+        void updateStats(long long submitTime, long long encodeStartTime);
 
         std::string m_sFilename;
         IntPoint m_Size;
         int m_FrameRate;
-        int m_QMin;
-        int m_QMax;
+        VideoWriterConfig m_Config;
+        VideoWriterStats& m_Stats;
+        AVPixelFormat m_StreamPixelFormat;
         
         AVOutputFormat* m_pOutputFormat;
         AVFormatContext* m_pOutputFormatContext;
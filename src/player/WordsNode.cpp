@@ -115,6 +115,7 @@ void WordsNode::registerType()
 WordsNode::WordsNode(const ArgList& args, const string& sPublisherName)
     : RasterNode(sPublisherName),
       m_LogicalSize(0,0),
+      m_AlignOffset(0),
       m_pFontDescription(0),
       m_pLayout(0),
       m_bRenderNeeded(true)
@@ -654,24 +655,35 @@ void WordsNode::renderText()
             PangoRectangle ink_rect;
             pango_layout_get_pixel_extents(m_pLayout, &ink_rect, &logical_rect);
             pango_ft2_render_layout(&bitmap, m_pLayout, -ink_rect.x, -ink_rect.y);
+            int alignOffset = 0;
             switch (m_FontStyle.getAlignmentVal()) {
                 case PANGO_ALIGN_LEFT:
-                    m_AlignOffset = 0;
+                    alignOffset = 0;
                     break;
                 case PANGO_ALIGN_CENTER:
-                    m_AlignOffset = -logical_rect.width/2;
+                    alignOffset = -logical_rect.width/2;
                     break;
                 case PANGO_ALIGN_RIGHT:
-                    m_AlignOffset = -logical_rect.width;
+                    alignOffset = -logical_rect.width;
                     break;
                 default:
                     AVG_ASSERT(false);
             }
+            if (alignOffset != m_AlignOffset) {
+                // The offset moves the node in its parent's coordinates.
+                m_AlignOffset = alignOffset;
+                invalidateHitBounds();
+            }
             setRenderColor(m_FontStyle.getColor());
 
             GLContextManager* pCM = GLContextManager::get();
-            MCTexturePtr pTex = pCM->createTextureFromBmp(pBmp);
-            getSurface()->create(A8, pTex);
+            TextureAtlasEntryPtr pAtlasEntry = pCM->createAtlasEntryFromBmp(pBmp);
+            if (pAtlasEntry) {
+                getSurface()->create(A8, pAtlasEntry);
+            } else {
+                MCTexturePtr pTex = pCM->createTextureFromBmp(pBmp);
+                getSurface()->create(A8, pTex);
+            }
             newSurface();
         }
         m_bRenderNeeded = false;
@@ -0,0 +1,211 @@
+//
+//  libavg - Media Playback Engine.
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "TUIOParser.h"
+
+#include "../base/TimeSource.h"
+#include "../base/ThreadHelper.h"
+#include "../base/StringHelper.h"
+
+#include "../oscpack/UdpSocket.h"
+#include "../oscpack/PacketListener.h"
+#include "../oscpack/OscOutboundPacketStream.h"
+
+#include <boost/thread/thread.hpp>
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace avg;
+using namespace std;
+
+// Replays synthetic TUIO streams from several trackers over a local UDP socket and
+// measures how long the simulated render thread waits when it fetches the parsed
+// touches. The 'locked' receiver parses each packet while holding the lock the render
+// thread needs, as TUIOInputDevice used to do.
+
+static const int PORT = 43333;
+static const int NUM_TOUCHES = 20;
+static const int TEST_DURATION = 2000;
+static const int FRAME_DURATION = 16;
+
+class ReplayReceiver: public PacketListener
+{
+public:
+    ReplayReceiver(bool bLocked)
+        : m_bLocked(bLocked),
+          m_NumPackets(0)
+    {
+    }
+
+    virtual void ProcessPacket(const char* pData, int size,
+            const IpEndpointName& remoteEndpoint)
+    {
+        m_NumPackets++;
+        if (m_bLocked) {
+            avg::lock_guard lock(m_Mutex);
+            m_Parser.parsePacket(pData, size);
+            m_Parser.publish();
+        } else {
+            m_Parser.parsePacket(pData, size);
+        }
+    }
+
+    virtual void PacketBatchComplete()
+    {
+        if (!m_bLocked) {
+            m_Parser.publish();
+        }
+    }
+
+    void fetch(TUIOBatch& batch)
+    {
+        if (m_bLocked) {
+            avg::lock_guard lock(m_Mutex);
+            m_Parser.fetch(batch);
+        } else {
+            m_Parser.fetch(batch);
+        }
+    }
+
+    int getNumPackets() const
+    {
+        return m_NumPackets;
+    }
+
+private:
+    bool m_bLocked;
+    boost::mutex m_Mutex;
+    TUIOParser m_Parser;
+    std::atomic<int> m_NumPackets;
+};
+
+// Sends one bundle with NUM_TOUCHES moving touches per frame. frameRate == 0 sends as
+// fast as possible.
+static void sendTrackerStream(int trackerID, int frameRate, int* pNumSent)
+{
+    UdpTransmitSocket socket(IpEndpointName("127.0.0.1", PORT));
+    char buffer[4096];
+    long long startTime = TimeSource::get()->getCurrentMicrosecs();
+    long long endTime = startTime + TEST_DURATION*1000;
+    int frame = 0;
+    long long now = startTime;
+    while (now < endTime) {
+        osc::OutboundPacketStream packet(buffer, sizeof(buffer));
+        packet << osc::BeginBundleImmediate << osc::BeginMessage("/tuio/2Dcur")
+                << "alive";
+        for (int i = 0; i < NUM_TOUCHES; ++i) {
+            packet << trackerID*NUM_TOUCHES+i;
+        }
+        packet << osc::EndMessage;
+        for (int i = 0; i < NUM_TOUCHES; ++i) {
+            float pos = float((frame+i) % 1000)/1000;
+            packet << osc::BeginMessage("/tuio/2Dcur") << "set"
+                    << trackerID*NUM_TOUCHES+i << pos << 1-pos << 0.1f << -0.1f << 0.f
+                    << osc::EndMessage;
+        }
+        packet << osc::BeginMessage("/tuio/2Dcur") << "fseq" << frame << osc::EndMessage
+                << osc::EndBundle;
+        socket.Send(packet.Data(), packet.Size());
+        frame++;
+        if (frameRate > 0) {
+            long long nextFrameTime = startTime + frame*1000000LL/frameRate;
+            now = TimeSource::get()->getCurrentMicrosecs();
+            if (nextFrameTime > now) {
+                msleep(int((nextFrameTime-now)/1000));
+            }
+        }
+        now = TimeSource::get()->getCurrentMicrosecs();
+    }
+    *pNumSent = frame;
+}
+
+static void runReceiver(UdpListeningReceiveSocket* pSocket)
+{
+    pSocket->Run();
+}
+
+void runReplay(bool bLocked, int numTrackers, int frameRate)
+{
+    ReplayReceiver receiver(bLocked);
+    UdpListeningReceiveSocket socket(IpEndpointName(IpEndpointName::ANY_ADDRESS, PORT),
+            &receiver);
+    boost::thread receiverThread(runReceiver, &socket);
+
+    vector<int> numSent(numTrackers, 0);
+    vector<boost::thread*> pSenderThreads;
+    for (int i = 0; i < numTrackers; ++i) {
+        pSenderThreads.push_back(new boost::thread(sendTrackerStream, i, frameRate,
+                &numSent[i]));
+    }
+
+    // Render loop.
+    TUIOBatch batch;
+    long long startTime = TimeSource::get()->getCurrentMicrosecs();
+    long long maxFetchTime = 0;
+    long long totalFetchTime = 0;
+    int numFrames = 0;
+    int numCmds = 0;
+    while (TimeSource::get()->getCurrentMicrosecs() < startTime + TEST_DURATION*1000) {
+        long long fetchStartTime = TimeSource::get()->getCurrentMicrosecs();
+        receiver.fetch(batch);
+        long long fetchTime = TimeSource::get()->getCurrentMicrosecs() - fetchStartTime;
+        maxFetchTime = max(maxFetchTime, fetchTime);
+        totalFetchTime += fetchTime;
+        numCmds += batch.m_Cmds.size();
+        numFrames++;
+        msleep(FRAME_DURATION);
+    }
+
+    int totalSent = 0;
+    for (int i = 0; i < numTrackers; ++i) {
+        pSenderThreads[i]->join();
+        delete pSenderThreads[i];
+        totalSent += numSent[i];
+    }
+    msleep(100);
+    socket.AsynchronousBreak();
+    receiverThread.join();
+
+    string sRate = frameRate > 0 ? toString(frameRate)+" Hz" : "flood";
+    cerr << (bLocked ? "Locked" : "Staged") << " receiver, " << numTrackers
+            << " trackers at " << sRate << ": " << receiver.getNumPackets() << "/"
+            << totalSent << " packets, " << numCmds/numFrames << " commands/frame, "
+            << "fetch avg " << float(totalFetchTime)/numFrames << " us, max "
+            << maxFetchTime << " us" << endl;
+}
+
+int main(int nargs, char** args)
+{
+    try {
+        for (int i = 0; i < 2; ++i) {
+            bool bLocked = (i == 0);
+            runReplay(bLocked, 4, 200);
+            runReplay(bLocked, 8, 200);
+            runReplay(bLocked, 4, 0);
+        }
+    } catch (std::exception& e) {
+        cerr << "UDP replay failed: " << e.what() << endl;
+        return 1;
+    }
+}
@@ -20,19 +20,32 @@
 //
 
 #include "Player.h"
+#include "AVGNode.h"
+#include "FrameTimeStats.h"
+#include "Timeout.h"
+#include "TimeoutQueue.h"
+#include "TransformTracker.h"
+#include "TUIOParser.h"
 
 #include "../base/TestSuite.h"
 #include "../base/Exception.h"
 #include "../base/Logger.h"
+#include "../base/TimeSource.h"
+#include "../base/MathHelper.h"
 
 #include "../graphics/GLConfig.h"
 #include "../graphics/GLContext.h"
 #include "../graphics/ShaderRegistry.h"
 
+#include "../imaging/FakeCamera.h"
+
+#include "../oscpack/OscOutboundPacketStream.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <string>
+#include <sstream>
 
 #ifdef WIN32
 #include <direct.h>
@@ -75,12 +88,421 @@ public:
             player.doFrame(false);
             player.cleanup(false);
         }
+        runHitTestBenchmark(player, "div", 100);
+        runHitTestBenchmark(player, "div", 1000);
+        runHitTestBenchmark(player, "div", 10000);
+        runHitTestBenchmark(player, "circle", 100);
+        runHitTestBenchmark(player, "circle", 1000);
+        runHitTestBenchmark(player, "circle", 10000);
         try {
             throw bad_cast();
         } catch (bad_cast&) {
 
         }
     }
+
+private:
+    // Rows of 100 nodes each, grouped in divs without explicit size. Every node
+    // covers a 16x16 area at the left of its grid cell.
+    void runHitTestBenchmark(Player& player, const string& sNodeType, int numNodes)
+    {
+        const int numCols = 100;
+        int numRows = (numNodes+numCols-1)/numCols;
+        stringstream ss;
+        ss << "<avg width=\"1920\" height=\"1080\">";
+        for (int row = 0; row < numRows; ++row) {
+            ss << "<div y=\"" << row*1080.f/numRows << "\">";
+            for (int col = 0; col < numCols && row*numCols+col < numNodes; ++col) {
+                ss << "<" << sNodeType << " id=\"r" << row*numCols+col << "\" ";
+                if (sNodeType == "circle") {
+                    ss << "pos=\"(" << col*19.2f+8 << ",8)\" r=\"8\"/>";
+                } else {
+                    ss << "x=\"" << col*19.2f << "\" width=\"16\" height=\"16\"/>";
+                }
+            }
+            ss << "</div>";
+        }
+        ss << "</avg>";
+        player.loadString(ss.str());
+        NodePtr pRootNode = player.getRootNode();
+
+        NodePtr pNode = pRootNode->getElementByPos(glm::vec2(8, 4));
+        TEST(pNode == player.getElementByID("r0"));
+        pNode = pRootNode->getElementByPos(glm::vec2(18, 4));
+        TEST(pNode == pRootNode);
+
+        const int numQueries = 10000;
+        unsigned seed = 1;
+        long long startTime = TimeSource::get()->getCurrentMicrosecs();
+        for (int i = 0; i < numQueries; ++i) {
+            seed = seed*1103515245+12345;
+            glm::vec2 pos(float(seed%1920), float((seed/1920)%1080));
+            pRootNode->getElementByPos(pos);
+        }
+        float queryTime = float(TimeSource::get()->getCurrentMicrosecs()-startTime)/
+                numQueries;
+        cerr << "    Hit test, " << numNodes << " " << sNodeType << " nodes: " << queryTime
+                << " us/query" << endl;
+    }
+};
+
+class FrameTimeStatsTest: public Test {
+public:
+    FrameTimeStatsTest()
+        : Test("FrameTimeStatsTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        FrameTimeStats stats(100);
+        TEST(stats.getNumFrames() == 0);
+        TEST(stats.getPercentile(50) == 0);
+
+        // 100 frames of 10 ms, 20 ms, ..., 1000 ms. The last ones overflow the
+        // histogram.
+        long long time = 0;
+        stats.reset(time);
+        for (int i = 1; i <= 100; ++i) {
+            stats.startPhase(FrameTimeStats::RENDER, time);
+            time += i*10000;
+            stats.endFrame(time, false);
+        }
+        TEST(stats.getNumFrames() == 100);
+        TEST(almostEqual(stats.getPercentile(50), 500.f));
+        TEST(almostEqual(stats.getPercentile(95), 950.f));
+        TEST(almostEqual(stats.getMaxFrameTime(), 1000.f));
+        TEST(almostEqual(stats.getLastFrameTime(), 1000.f));
+        TEST(stats.getNumJankFrames() == 0);
+
+        // Overwrite the window with 16.6 ms frames.
+        for (int i = 0; i < 100; ++i) {
+            time += 16600;
+            stats.endFrame(time, false);
+        }
+        TEST(stats.getNumFrames() == 100);
+        TEST(almostEqual(stats.getPercentile(99), 16.6f));
+        TEST(almostEqual(stats.getMaxFrameTime(), 16.6f));
+
+        // Late frame, mostly spent in timers.
+        stats.startPhase(FrameTimeStats::TIMERS, time);
+        time += 30000;
+        stats.startPhase(FrameTimeStats::RENDER, time);
+        time += 5000;
+        stats.startPhase(FrameTimeStats::SWAP, time);
+        time += 1000;
+        stats.endFrame(time, true);
+        TEST(stats.getNumJankFrames() == 1);
+        TEST(stats.getNumJankFrames(FrameTimeStats::TIMERS) == 1);
+        TEST(stats.getLastJankPhase() == FrameTimeStats::TIMERS);
+        TEST(almostEqual(stats.getMaxFrameTime(), 36.f));
+        TEST(FrameTimeStats::getPhaseFromName("preRender") == FrameTimeStats::PRERENDER);
+        TEST(FrameTimeStats::getPhaseName(FrameTimeStats::SWAP) == "swap");
+    }
+};
+
+class TransformTrackerTest: public Test {
+public:
+    TransformTrackerTest()
+        : Test("TransformTrackerTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        vector<glm::vec2> pts;
+        pts.push_back(glm::vec2(0,0));
+        pts.push_back(glm::vec2(0,1));
+        vector<int> cluster1;
+        vector<int> cluster2;
+        TransformTracker::calcKMeans(pts, cluster1, cluster2);
+        TEST(cluster1.size() == 1 && cluster1[0] == 0);
+        TEST(cluster2.size() == 1 && cluster2[0] == 1);
+
+        pts.push_back(glm::vec2(0,4));
+        TransformTracker::calcKMeans(pts, cluster1, cluster2);
+        TEST(cluster1.size() == 2 && cluster1[0] == 0 && cluster1[1] == 1);
+        TEST(cluster2.size() == 1 && cluster2[0] == 2);
+
+        // Coincident points still result in two clusters.
+        pts.clear();
+        for (int i = 0; i < 3; ++i) {
+            pts.push_back(glm::vec2(5,5));
+        }
+        TransformTracker::calcKMeans(pts, cluster1, cluster2);
+        TEST(cluster1.size() == 1 && cluster2.size() == 2);
+
+        TransformTracker tracker;
+        TEST(tracker.getNumContacts() == 0);
+        GestureTransform transform = tracker.update(NodePtr(), 0);
+        TEST(transform.getTrans() == glm::vec2(0,0));
+        TEST(transform.getRot() == 0);
+        TEST(transform.getScale() == 1);
+    }
+};
+
+class CameraCaptureTest: public Test {
+public:
+    CameraCaptureTest()
+        : Test("CameraCaptureTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        const int numFrames = 5;
+        vector<BitmapPtr> frames;
+        for (int i = 0; i < numFrames; ++i) {
+            BitmapPtr pBmp(new Bitmap(IntPoint(4,4), I8));
+            pBmp->getPixels()[0] = i;
+            frames.push_back(pBmp);
+        }
+        FakeCamera camera(frames, 100);
+        camera.open();
+        long long startTime = TimeSource::get()->getCurrentMicrosecs();
+        camera.startCaptureThread();
+        TEST(camera.isCaptureThreadRunning());
+
+        // Poll like the render loop does. Frames may be dropped, but the ones that
+        // arrive are in order and carry their capture time.
+        int numReceived = 0;
+        int lastFrame = -1;
+        long long lastCaptureTime = startTime;
+        bool bOk = true;
+        while (lastFrame != numFrames-1 && 
+                TimeSource::get()->getCurrentMicrosecs() < startTime+5000000)
+        {
+            CameraFrame frame;
+            if (camera.getLatestFrame(frame)) {
+                int frameNum = frame.m_pBmp->getPixels()[0];
+                if (frameNum <= lastFrame || frame.m_CaptureTime < lastCaptureTime ||
+                        frame.m_CaptureTime > TimeSource::get()->getCurrentMicrosecs())
+                {
+                    bOk = false;
+                }
+                lastFrame = frameNum;
+                lastCaptureTime = frame.m_CaptureTime;
+                numReceived++;
+            } else {
+                msleep(1);
+            }
+        }
+        camera.stopCaptureThread();
+        TEST(!camera.isCaptureThreadRunning());
+        TEST(bOk);
+        TEST(lastFrame == numFrames-1);
+        TEST(numReceived+camera.getNumDroppedFrames() == numFrames);
+        CameraFrame frame;
+        TEST(!camera.getLatestFrame(frame));
+    }
+};
+
+class TUIOParserTest: public Test {
+public:
+    TUIOParserTest()
+        : Test("TUIOParserTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        TUIOParser parser;
+        TUIOBatch batch;
+        parser.fetch(batch);
+        TEST(batch.empty());
+
+        char buffer[1024];
+        osc::OutboundPacketStream packet(buffer, 1024);
+        packet << osc::BeginBundleImmediate
+                << osc::BeginMessage("/tuio/2Dcur") << "alive" << 1 << 2
+                << osc::EndMessage
+                << osc::BeginMessage("/tuio/2Dcur") << "set" << 2 << 0.5f << 0.25f
+                << 0.f << 0.f << 0.f << osc::EndMessage
+                << osc::BeginMessage("/tuio/2Dcur") << "fseq" << 1 << osc::EndMessage
+                << osc::EndBundle;
+        parser.parsePacket(packet.Data(), packet.Size());
+        // Nothing is handed over before publish().
+        parser.fetch(batch);
+        TEST(batch.empty());
+        parser.publish();
+        parser.fetch(batch);
+        TEST(batch.m_Cmds.size() == 2);
+        TEST(batch.m_Cmds[0].m_Type == TUIOCmd::ALIVE);
+        TEST(batch.m_Cmds[0].m_Source == Event::TOUCH);
+        TEST(batch.m_Cmds[0].m_NumLiveIDs == 2);
+        TEST(batch.m_LiveIDs[batch.m_Cmds[0].m_FirstLiveID+1] == 2);
+        TEST(batch.m_Cmds[1].m_Type == TUIOCmd::TOUCH_SET);
+        TEST(batch.m_Cmds[1].m_TUIOID == 2);
+        TEST(batch.m_Cmds[1].m_Pos == glm::vec2(0.5f, 0.25f));
+        parser.fetch(batch);
+        TEST(batch.empty());
+
+        // Batches published before the next fetch() are joined.
+        for (int i = 0; i < 2; ++i) {
+            packet.Clear();
+            packet << osc::BeginMessage("/tuio/2Dobj") << "alive" << 10+i
+                    << osc::EndMessage;
+            parser.parsePacket(packet.Data(), packet.Size());
+            parser.publish();
+        }
+        parser.fetch(batch);
+        TEST(batch.m_Cmds.size() == 2);
+        TEST(batch.m_Cmds[1].m_Source == Event::TANGIBLE);
+        TEST(batch.m_Cmds[1].m_NumLiveIDs == 1);
+        TEST(batch.m_LiveIDs[batch.m_Cmds[1].m_FirstLiveID] == 11);
+    }
+};
+
+class TimeoutQueueTest: public Test {
+public:
+    TimeoutQueueTest()
+        : Test("TimeoutQueueTest", 2)
+    {
+    }
+
+    void runTests()
+    {
+        if (!Py_IsInitialized()) {
+            Py_Initialize();
+        }
+        m_pGlobals = PyDict_New();
+        PyRun_String("calls = []", Py_single_input, m_pGlobals, m_pGlobals);
+
+        TimeoutQueue queue;
+        // Equal due times fire in the order the timeouts were added.
+        queue.add(createTimeout(10, 0, false));
+        int id1 = queue.add(createTimeout(10, 1, false));
+        queue.add(createTimeout(10, 2, true));
+        queue.add(createTimeout(5, 3, false));
+        TEST(queue.size() == 4);
+        TEST(queue.remove(id1));
+        TEST(!queue.remove(id1));
+        // Removing a timeout releases its callable even though the heap entry stays.
+        PyObject* pFunc = PyRun_String("lambda: None", Py_eval_input, m_pGlobals,
+                m_pGlobals);
+        Py_ssize_t refCount = Py_REFCNT(pFunc);
+        int id2 = queue.add(TimeoutPtr(new Timeout(10, pFunc, false, 0)));
+        TEST(Py_REFCNT(pFunc) == refCount+1);
+        TEST(queue.remove(id2));
+        TEST(Py_REFCNT(pFunc) == refCount);
+        Py_DECREF(pFunc);
+        fireBatch(queue, 5);
+        TEST(callsEqual(1, 3));
+        fireBatch(queue, 10);
+        TEST(callsEqual(2, 0, 2));
+        // The interval is due again at 20.
+        TEST(queue.size() == 1);
+        fireBatch(queue, 19);
+        TEST(callsEqual(0));
+        fireBatch(queue, 20);
+        TEST(callsEqual(1, 2));
+        queue.clear();
+        TEST(queue.size() == 0);
+
+        runBenchmark();
+        Py_DECREF(m_pGlobals);
+    }
+
+private:
+    TimeoutPtr createTimeout(int time, int i, bool bIsInterval)
+    {
+        stringstream ss;
+        ss << "lambda: calls.append(" << i << ")";
+        PyObject* pFunc = PyRun_String(ss.str().c_str(), Py_eval_input, m_pGlobals,
+                m_pGlobals);
+        TimeoutPtr pTimeout(new Timeout(time, pFunc, bIsInterval, 0));
+        Py_DECREF(pFunc);
+        return pTimeout;
+    }
+
+    int fireBatch(TimeoutQueue& queue, long long time)
+    {
+        int numFired = 0;
+        queue.startBatch(time);
+        while (queue.fireNext(time)) {
+            numFired++;
+        }
+        return numFired;
+    }
+
+    vector<int> getCalls()
+    {
+        PyObject* pCalls = PyDict_GetItemString(m_pGlobals, "calls");
+        vector<int> calls;
+        for (Py_ssize_t i = 0; i < PyList_Size(pCalls); ++i) {
+            calls.push_back(int(PyLong_AsLong(PyList_GetItem(pCalls, i))));
+        }
+        PyList_SetSlice(pCalls, 0, PyList_Size(pCalls), 0);
+        return calls;
+    }
+
+    bool callsEqual(int numCalls, int call0=-1, int call1=-1)
+    {
+        vector<int> calls = getCalls();
+        int expected[] = {call0, call1};
+        if (int(calls.size()) != numCalls) {
+            return false;
+        }
+        for (int i = 0; i < numCalls; ++i) {
+            if (calls[i] != expected[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 10000 timers: Half of them are intervals, the other half are one-shot timeouts
+    // that are replaced as soon as they have fired.
+    void runBenchmark()
+    {
+        const int numTimeouts = 10000;
+        const int numFrames = 1000;
+        PyObject* pFunc = PyRun_String("lambda: None", Py_eval_input, m_pGlobals,
+                m_pGlobals);
+        TimeoutQueue queue;
+        vector<int> ids;
+        long long startTime = TimeSource::get()->getCurrentMicrosecs();
+        for (int i = 0; i < numTimeouts; ++i) {
+            bool bIsInterval = (i%2 == 0);
+            TimeoutPtr pTimeout(new Timeout((i*7919)%1000+1, pFunc, bIsInterval, 0));
+            ids.push_back(queue.add(pTimeout));
+        }
+        float addTime = float(TimeSource::get()->getCurrentMicrosecs()-startTime)/
+                numTimeouts;
+
+        long long fireTime = 0;
+        int numFired = 0;
+        for (int frame = 1; frame <= numFrames; ++frame) {
+            long long frameTime = frame*16;
+            startTime = TimeSource::get()->getCurrentMicrosecs();
+            numFired += fireBatch(queue, frameTime);
+            for (int i = queue.size(); i < numTimeouts; ++i) {
+                queue.add(TimeoutPtr(new Timeout((i*7919)%1000+1, pFunc, false,
+                        frameTime)));
+            }
+            fireTime += TimeSource::get()->getCurrentMicrosecs()-startTime;
+        }
+        TEST(queue.size() == numTimeouts);
+        TEST(numFired > numFrames);
+
+        startTime = TimeSource::get()->getCurrentMicrosecs();
+        bool bAllRemoved = true;
+        for (int i = 0; i < numTimeouts; i += 2) {
+            bAllRemoved &= queue.remove(ids[(i*7919)%numTimeouts]);
+        }
+        float removeTime = float(TimeSource::get()->getCurrentMicrosecs()-startTime)/
+                (numTimeouts/2);
+        TEST(bAllRemoved);
+
+        cerr << "    Timeouts, " << numTimeouts << " pending: add " << addTime 
+                << " us, remove " << removeTime << " us, handle timers "
+                << float(fireTime)/numFrames << " us/frame (" << numFired/numFrames
+                << " fired/frame)" << endl;
+        queue.clear();
+        Py_DECREF(pFunc);
+    }
+
+    PyObject* m_pGlobals;
 };
 
 class PlayerTestSuite: public TestSuite {
@@ -89,6 +511,11 @@ public:
         : TestSuite("PlayerTestSuite")
     {
         Test::setRelSrcDir(".");
+        addTest(TestPtr(new FrameTimeStatsTest));
+        addTest(TestPtr(new TimeoutQueueTest));
+        addTest(TestPtr(new TransformTrackerTest));
+        addTest(TestPtr(new TUIOParserTest));
+        addTest(TestPtr(new CameraCaptureTest));
         addTest(TestPtr(new PlayerTest));
     }
 };
@@ -307,6 +307,58 @@ class AVTestCase(AVGTestCase):
                      lambda: self.compareImage("testVideoSeek3")
                     ))
 
+    def testVideoZeroCopy(self):
+        # Decoded frames are queued and ffmpeg keeps a few reference frames, so a 
+        # bounded number of pooled buffers (three planes per frame) is in use while 
+        # the video plays.
+        MAX_POOLED_BUFFERS = 3*(8+8)
+
+        def recordFrame():
+            if not(node.isSeeking()):
+                frames[node.getCurFrame()] = player.screenshot()
+
+        def checkNumBuffers():
+            numBuffers = helper.getNumPooledVideoBuffers()
+            if zeroCopy:
+                self.assert_(numBuffers <= MAX_POOLED_BUFFERS)
+            else:
+                self.assertEqual(numBuffers, 0)
+
+        def unload():
+            node.unlink(True)
+
+        def checkReleased():
+            self.assertEqual(helper.getNumPooledVideoBuffers(), 0)
+
+        helper = player.getTestHelper()
+        player.setFakeFPS(25)
+        recordedFrames = []
+        for zeroCopy in (False, True):
+            player.setVideoZeroCopy(zeroCopy)
+            self.assertEqual(player.isVideoZeroCopy(), zeroCopy)
+            frames = {}
+            root = self.loadEmptyScene()
+            node = avg.VideoNode(href="mpeg1-48x48.mov", threaded=True, parent=root)
+            node.play()
+            actions = [None, recordFrame, recordFrame, checkNumBuffers]
+            for frame in (30, 5, 20, 10):
+                actions.extend((lambda frame=frame: node.seekToFrame(frame),
+                        None,
+                        recordFrame,
+                        checkNumBuffers))
+            actions.extend((unload, None, checkReleased))
+            self.start(False, actions)
+            recordedFrames.append(frames)
+        player.setVideoZeroCopy(True)
+
+        # Frames that were displayed in both runs must look the same.
+        copiedFrames, zeroCopyFrames = recordedFrames
+        commonFrames = set(copiedFrames.keys()) & set(zeroCopyFrames.keys())
+        self.assert_(len(commonFrames) > 0)
+        for frame in commonFrames:
+            self.assert_(self.areSimilarBmps(copiedFrames[frame], zeroCopyFrames[frame],
+                    0.01, 0.01))
+
     def testVideoFPS(self):
         player.setFakeFPS(25)
         root = self.loadEmptyScene()
@@ -638,6 +690,63 @@ class AVTestCase(AVGTestCase):
                 ))
             os.remove("test.mov")    
 
+    def testVideoWriterCodecs(self):
+
+        def startWriter(codec, filename):
+            self.videoWriter = avg.VideoWriter(player.getMainCanvas(), filename, 30,
+                    codec=codec, numthreads=2, maxqueuesize=8, dropframes=True)
+            self.assertEqual(self.videoWriter.codec, codec)
+            self.assertEqual(self.videoWriter.numthreads, 2)
+            self.assertEqual(self.videoWriter.maxqueuesize, 8)
+
+        def stopWriter():
+            self.assertEqual(self.videoWriter.numdroppedframes, 0)
+            self.assert_(self.videoWriter.numqueuedframes <= 8)
+            self.videoWriter.stop()
+            # The encoder thread may still be running, so the last lag needs to be read
+            # before the maximum.
+            encoderLag = self.videoWriter.encoderlag
+            self.assert_(self.videoWriter.maxencoderlag >= encoderLag >= 0)
+            self.videoWriter = None
+
+        def checkVideo(codec, filename):
+            savedVideoNode = avg.VideoNode(href="../"+filename, threaded=False,
+                    parent=root)
+            savedVideoNode.pause()
+            self.assertEqual(savedVideoNode.getVideoCodec(), codec)
+            self.assertEqual(savedVideoNode.getNumFrames(), 4)
+            savedVideoNode.unlink(True)
+
+        def testParamExceptions():
+            canvas = player.getMainCanvas()
+            self.assertRaises(avg.Exception,
+                    lambda: avg.VideoWriter(canvas, "test.mov", codec="foo"))
+            self.assertRaises(avg.Exception,
+                    lambda: avg.VideoWriter(canvas, "test.mov", dropframes=True))
+            self.assertRaises(avg.Exception,
+                    lambda: avg.VideoWriter(canvas, "test.mov", numthreads=-1))
+
+        if not(self._isCurrentDirWriteable()):
+            self.skip("Current dir not writeable.")
+            return
+        if player.isUsingGLES():
+            self.skip("VideoWriter not supported under GLES.")
+            return
+
+        # h264 isn't tested since libx264 is an optional part of ffmpeg.
+        for codec, filename in (("mjpeg", "test.mov"), ("ffv1", "test.avi")):
+            player.setFakeFPS(30)
+            root = self.loadEmptyScene()
+            avg.VideoNode(href="mpeg1-48x48.mov", threaded=False, parent=root).play()
+            self.start(False,
+                (testParamExceptions,
+                 lambda: startWriter(codec, filename),
+                 lambda: self.delay(100),
+                 stopWriter,
+                 lambda: checkVideo(codec, filename),
+                ))
+            os.remove(filename)
+
     def test2VideosAtOnce(self):
         player.setFakeFPS(25)
         self.loadEmptyScene()
@@ -649,6 +758,37 @@ class AVTestCase(AVGTestCase):
         self.start(False,
                 [lambda: self.compareImage("test2VideosAtOnce1"),])
 
+    def testVideoDecoderThreads(self):
+        def checkDefaults():
+            node = avg.VideoNode(href="mpeg1-48x48.mov", parent=root)
+            self.assertEqual(node.decoderthreads, player.getVideoDecoderThreads())
+            self.assertEqual(node.decoderthreadtype, 
+                    player.getVideoDecoderThreadType())
+
+        def checkDecodeTime():
+            self.assert_(node.getAvgDecodeTime() >= 0)
+
+        player.setFakeFPS(25)
+        root = self.loadEmptyScene()
+        checkDefaults()
+        self.assertRaises(avg.Exception, 
+                lambda: avg.VideoNode(href="mpeg1-48x48.mov", decoderthreadtype="foo"))
+        self.assertRaises(avg.Exception,
+                lambda: player.setVideoDecoderThreads(-1, "auto"))
+        for threadType in ("auto", "frame", "slice"):
+            for isThreaded in (False, True):
+                root = self.loadEmptyScene()
+                node = avg.VideoNode(href="mpeg1-48x48.mov", threaded=isThreaded,
+                        decoderthreads=2, decoderthreadtype=threadType, parent=root)
+                self.assertEqual(node.decoderthreads, 2)
+                self.assertEqual(node.decoderthreadtype, threadType)
+                node.play()
+                self.start(False,
+                        (None,
+                         None,
+                         checkDecodeTime,
+                        ))
+
 
 def AVTestSuite(tests):
     availableTests = [
@@ -665,6 +805,7 @@ def AVTestSuite(tests):
             "testVideoHRef",
             "testVideoOpacity",
             "testVideoSeek",
+            "testVideoZeroCopy",
             "testVideoFPS",
             "testLoop",
             "testVideoMask",
@@ -672,7 +813,9 @@ def AVTestSuite(tests):
             "testVideoSeekAfterEOF",
             "testException",
             "testVideoWriter",
+            "testVideoWriterCodecs",
             "test2VideosAtOnce",
+            "testVideoDecoderThreads",
             ]
     return createAVGTestSuite(availableTests, AVTestCase, tests)
 
@@ -1094,6 +1094,30 @@ class GestureTestCase(AVGTestCase):
         self.assertAlmostEqual(image.size, (30,40))
         self.assertAlmostEqual(image.angle, 1.57)
 
+    def testTransformMoveNode(self):
+        def moveWithMat3x3(transform, node):
+            startTransform = gesture.Mat3x3.fromNode(node)
+            pivotMat = gesture.Mat3x3.translate(transform.pivot)
+            newTransform = pivotMat.applyMat(
+                    gesture.Mat3x3.rotate(transform.rot).applyMat(
+                    gesture.Mat3x3.scale((transform.scale, transform.scale)).applyMat(
+                    pivotMat.inverse().applyMat(
+                    gesture.Mat3x3.translate(transform.trans).applyMat(
+                    startTransform)))))
+            newTransform.setNodeTransform(node)
+
+        transform = gesture.Transform((5,-3), 0.5, 1.5, (20,30))
+        image = avg.ImageNode(pos=(10,20), size=(30,40), angle=0.3, 
+                href="rgb24alpha-64x64.png")
+        refImage = avg.ImageNode(pos=(10,20), size=(30,40), angle=0.3, 
+                href="rgb24alpha-64x64.png")
+        transform.moveNode(image)
+        moveWithMat3x3(transform, refImage)
+        self.assertAlmostEqual(image.pos, refImage.pos, 0.001)
+        self.assertAlmostEqual(image.size, refImage.size, 0.001)
+        self.assertAlmostEqual(image.angle, refImage.angle, 0.0001)
+        self.assertAlmostEqual(image.pivot, refImage.pivot, 0.001)
+
     def testTwoRecognizers(self):
         self.__initImageScene()
         self.__tapRecognizer = gesture.TapRecognizer(self.image)
@@ -1117,6 +1141,132 @@ class GestureTestCase(AVGTestCase):
                  self._genMouseEventFrames(avg.Event.CURSOR_UP, 30, 30, []),
                 ))
 
+    def testTapTracker(self):
+
+        def onDown(event):
+            self.__tracker.start(event.contact)
+            event.contact.subscribe(avg.Contact.CURSOR_UP, onUp)
+
+        def onUp(event):
+            # Same as the recognizers: Check the motion up to the up event.
+            self.__tracker.update()
+            self.__tracker.stop()
+
+        def assertState(expectedMessages, isRunning):
+            self.messageTester.assertState(expectedMessages)
+            self.assertEqual(self.__tracker.running, isRunning)
+
+        self.__initImageScene()
+        self.image.subscribe(avg.Node.CURSOR_DOWN, onDown)
+        self.__tracker = avg.TapTracker(5, 100)
+        self.messageTester = MessageTester(self.__tracker,
+                [avg.TapTracker.OUT_OF_RANGE, avg.TapTracker.TIMEOUT], self)
+        player.setFakeFPS(100)
+        self.start(False,
+                (# Motion inside maxDist, then outside.
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_DOWN, 30, 30)]),
+                 lambda: assertState([], True),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_MOTION, 33, 33)]),
+                 lambda: assertState([], True),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_MOTION, 40, 30)]),
+                 lambda: assertState([avg.TapTracker.OUT_OF_RANGE], False),
+                 # The tracker has stopped, so nothing is notified anymore.
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_MOTION, 50, 30)]),
+                 lambda: assertState([], False),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_UP, 50, 30)]),
+                 lambda: assertState([], False),
+
+                 # Timeout after 100 ms = 10 frames.
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_DOWN, 30, 30)]),
+                 None, None, None, None,
+                 lambda: assertState([], True),
+                 None, None, None, None, None, None, None,
+                 lambda: assertState([avg.TapTracker.TIMEOUT], False),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_UP, 30, 30)]),
+                 lambda: assertState([], False),
+
+                 # Down and up in the same frame.
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_DOWN, 30, 30),
+                        (avg.Event.CURSOR_UP, 32, 30)]),
+                 lambda: assertState([], False),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_DOWN, 30, 30),
+                        (avg.Event.CURSOR_MOTION, 50, 50),
+                        (avg.Event.CURSOR_UP, 50, 50)]),
+                 lambda: assertState([avg.TapTracker.OUT_OF_RANGE], False),
+                ))
+
+    def testDragTracker(self):
+
+        def onDown(event):
+            self.__tracker.start(event.contact, self.image)
+            event.contact.subscribe(avg.Contact.CURSOR_UP, onUp)
+
+        def onUp(event):
+            self.__tracker.update()
+            self.__tracker.stop()
+
+        def onMotion(offset):
+            self.__offsets.append(avg.Point2D(offset))
+
+        def assertState(expectedMessages, isRunning, expectedOffsets=[]):
+            self.messageTester.assertState(expectedMessages)
+            self.assertEqual(self.__tracker.running, isRunning)
+            self.assertEqual(self.__offsets, expectedOffsets)
+            self.__offsets = []
+
+        self.__initImageScene()
+        self.image.subscribe(avg.Node.CURSOR_DOWN, onDown)
+        self.__tracker = avg.DragTracker(avg.DragTracker.HORIZONTAL, math.pi/4, 5)
+        self.__tracker.subscribe(avg.DragTracker.MOTION, onMotion)
+        self.messageTester = MessageTester(self.__tracker,
+                [avg.DragTracker.DETECTED, avg.DragTracker.FAILED,
+                avg.DragTracker.MOTION], self)
+        self.__offsets = []
+        player.setFakeFPS(100)
+        self.start(False,
+                (# No motion is notified until minDragDist is exceeded.
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_DOWN, 30, 30)]),
+                 lambda: assertState([], True),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_MOTION, 33, 30)]),
+                 lambda: assertState([], True),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_MOTION, 40, 31)]),
+                 lambda: assertState([avg.DragTracker.DETECTED, 
+                        avg.DragTracker.MOTION], True, [(10,1)]),
+                 # Several motion events in one frame are notified once.
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_MOTION, 45, 30),
+                        (avg.Event.CURSOR_MOTION, 50, 35),
+                        (avg.Event.CURSOR_MOTION, 60, 40)]),
+                 lambda: assertState([avg.DragTracker.MOTION], True, [(30,10)]),
+                 # No motion, no notification. The up event itself isn't motion.
+                 None,
+                 lambda: assertState([], True),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_UP, 70, 40)]),
+                 lambda: assertState([], False),
+
+                 # Vertical motion fails.
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_DOWN, 30, 30)]),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_MOTION, 30, 45)]),
+                 lambda: assertState([avg.DragTracker.FAILED], False),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_MOTION, 60, 45)]),
+                 lambda: assertState([], False),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_UP, 60, 45)]),
+                 lambda: assertState([], False),
+
+                 # Down, motion and up in the same frame.
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_DOWN, 30, 30),
+                        (avg.Event.CURSOR_MOTION, 45, 32),
+                        (avg.Event.CURSOR_UP, 50, 32)]),
+                 lambda: assertState([avg.DragTracker.DETECTED, 
+                        avg.DragTracker.MOTION], False, [(15,2)]),
+                 lambda: self.__sendMouseEvents([(avg.Event.CURSOR_DOWN, 30, 30),
+                        (avg.Event.CURSOR_UP, 50, 30)]),
+                 lambda: assertState([], False),
+                ))
+
+    def __sendMouseEvents(self, events):
+        for (eventType, x, y) in events:
+            self._sendMouseEvent(eventType, x, y)
+
     def __initImageScene(self):
         self.root = self.loadEmptyScene()
         self.image = avg.ImageNode(parent=self.root, href="rgb24-64x64.png")
@@ -1141,8 +1291,11 @@ def gestureTestSuite(tests):
         "testDragRecognizerMinDist",
         "testTransformRecognizer",
         "testTwoRecognizers",
+        "testTapTracker",
+        "testDragTracker",
         "testKMeans",
         "testMat3x3",
+        "testTransformMoveNode",
         )
 
     return createAVGTestSuite(availableTests, GestureTestCase, tests)
@@ -22,6 +22,7 @@
 
 
 import shutil
+import tempfile
 
 from libavg import avg, player
 from libavg.testcase import *
@@ -165,6 +166,80 @@ class ImageTestCase(AVGTestCase):
         self.assert_(cache.getMemUsed() == (0,0))
         cache.capacity = oldCapacity
 
+    def testImageDiskCache(self):
+        def loadImage():
+            # The image is removed from the memory cache on unlink because its
+            # capacity is 0.
+            node = avg.ImageNode(href="rgb24-65x65.png", parent=root)
+            self.compareBitmapToFile(node.getBitmap(), "rgb24-65x65")
+            node.unlink(True)
+
+        def checkStored():
+            self.assert_(cache.getDiskCacheMemUsed() > 65*65*4)
+            self.assertEqual(cache.getNumDiskCacheHits(), 0)
+
+        def checkHit():
+            self.assertEqual(cache.getNumDiskCacheHits(), 1)
+
+        def disableCache():
+            cache.setDiskCache("", 0)
+            self.assertEqual(cache.getDiskCacheMemUsed(), 0)
+            cache.capacity = oldCapacity
+            shutil.rmtree(cacheDir)
+
+        cache = player.imageCache
+        oldCapacity = cache.capacity
+        cache.capacity = (0, 0)
+        cacheDir = tempfile.mkdtemp()
+        self.assertRaises(avg.Exception, lambda: cache.setDiskCache(cacheDir, -1))
+        cache.setDiskCache(cacheDir, 1024*1024)
+        root = self.loadEmptyScene()
+        self.start(False,
+                (loadImage,
+                 checkStored,
+                 loadImage,
+                 checkHit,
+                 disableCache,
+                ))
+
+    def testTexUploadBudget(self):
+        def addNode(parent, href, numBytes, numFrames):
+            avg.ImageNode(pos=(16,16), href=href, parent=parent)
+            self.assertEqual(player.getPendingTexUploadBytes(), numBytes)
+            self.assertEqual(player.getTexUploadFramesToDrain(), numFrames)
+
+        def checkPartialUpload(numBytes):
+            pendingBytes = player.getPendingTexUploadBytes()
+            self.assert_(pendingBytes > 0 and pendingBytes < numBytes)
+
+        def checkDone():
+            self.assertEqual(player.getPendingTexUploadBytes(), 0)
+            self.assertEqual(player.getTexUploadFramesToDrain(), 0)
+
+        def testUpload(href, numBytes, budget):
+            player.setTexUploadBudget(budget)
+            self.assertEqual(player.getTexUploadBudget(), budget)
+            numFrames = (numBytes+budget-1)/budget
+            root = self.loadEmptyScene()
+            self.start(False,
+                    (lambda: addNode(root, href, numBytes, numFrames),
+                     lambda: checkPartialUpload(numBytes),
+                     [None]*(numFrames-2),
+                     checkDone,
+                    ))
+
+        self.assertRaises(avg.Exception, lambda: player.setTexUploadBudget(-1))
+        # Make sure the images aren't in the texture cache.
+        oldCapacity = player.imageCache.capacity
+        player.imageCache.capacity = (0, 0)
+        # Small images go into the texture atlas and are uploaded with a one pixel 
+        # border.
+        testUpload("rgb24-64x64.png", 66*66*4, 64*64)
+        # Large images get a texture of their own.
+        testUpload("checker.png", 256*256*4, 256*64*4)
+        player.setTexUploadBudget(0)
+        player.imageCache.capacity = oldCapacity
+
     def testBitmap(self):
         def getBitmap(node):
             bmp = node.getBitmap()
@@ -348,6 +423,73 @@ class ImageTestCase(AVGTestCase):
             player.play()
         avg.BitmapManager.get().setNumThreads(1)
         
+    def testBitmapManagerRequests(self):
+        WAIT_TIMEOUT = 5000
+        def onLoaded(name, bitmap):
+            self.assert_(not isinstance(bitmap, Exception))
+            loadedBmps.append((name, bitmap))
+            if len(loadedBmps) == 2:
+                player.setTimeout(0, checkResults)
+
+        def load(name, fileName, priority):
+            return bitmapManager.loadBitmap(fileName, lambda bmp: onLoaded(name, bmp),
+                    avg.B8G8R8A8, priority)
+
+        def checkResults():
+            # Both requests were served by one load, the visible one first.
+            self.assertEqual([name for (name, bmp) in loadedBmps],
+                    ["visible", "duplicate"])
+            bmp0 = loadedBmps[0][1]
+            bmp1 = loadedBmps[1][1]
+            self.assert_(bmp0 is not bmp1)
+            self.assert_(self.areSimilarBmps(bmp0, bmp1, 0.01, 0.01))
+            self.assertEqual(bitmapManager.getNumPendingRequests(), 0)
+            self.assertEqual(bitmapManager.getQueueLength(), 0)
+            self.assert_(bitmapManager.getLatencyPercentile(99) >= 
+                    bitmapManager.getLatencyPercentile(50))
+            player.stop()
+
+        def reportStuck():
+            raise RuntimeError("BitmapManager didn't reply "
+                    "within %dms timeout" % WAIT_TIMEOUT)
+
+        loadedBmps = []
+        bitmapManager = avg.BitmapManager.get()
+        self.assertRaises(avg.Exception, lambda: bitmapManager.setMaxCallbacksPerFrame(-1))
+        bitmapManager.setMaxCallbacksPerFrame(1)
+        self.loadEmptyScene()
+        cancelledID = load("cancelled", "media/rgb24alpha-64x64.png",
+                avg.BitmapManager.BACKGROUND)
+        load("duplicate", "media/rgb24-64x64.png", avg.BitmapManager.PREFETCH)
+        load("visible", "media/rgb24-64x64.png", avg.BitmapManager.VISIBLE)
+        self.assert_(bitmapManager.cancel(cancelledID))
+        self.assert_(not bitmapManager.cancel(cancelledID))
+        self.assertEqual(bitmapManager.getNumPendingRequests(), 2)
+        player.setTimeout(WAIT_TIMEOUT, reportStuck)
+        player.play()
+        bitmapManager.setMaxCallbacksPerFrame(0)
+
+    def testBitmapTargetSize(self):
+        def checkSize(bmp):
+            # Decoders that can't downscale return the full image.
+            size = bmp.getSize()
+            self.assert_(40 <= size.x <= 160 and 30 <= size.y <= 120)
+
+        def onLoaded(bmp):
+            self.assert_(not isinstance(bmp, Exception))
+            checkSize(bmp)
+            player.stop()
+
+        def reportStuck():
+            raise RuntimeError("BitmapManager didn't reply within 5000ms timeout")
+
+        checkSize(avg.Bitmap("media/freidrehen.jpg", (40,30)))
+        self.loadEmptyScene()
+        avg.BitmapManager.get().loadBitmap("media/freidrehen.jpg", onLoaded,
+                avg.NO_PIXELFORMAT, avg.BitmapManager.VISIBLE, (40,30))
+        player.setTimeout(5000, reportStuck)
+        player.play()
+
     def testBitmapManagerException(self):
         def bitmapCb(bitmap):
             raise RuntimeError
@@ -556,6 +698,39 @@ class ImageTestCase(AVGTestCase):
                  checkAlpha,
                 ])
 
+    def testCompressedImage(self):
+        def isS3TCSupported():
+            def tryInsertNode():
+                try:
+                    avg.ImageNode(href="rgb24-64x64.dds", parent=root)
+                except avg.Exception:
+                    self.supported = False
+            root = self.loadEmptyScene()
+            self.supported = True
+            self.start(False,
+                    (tryInsertNode,
+                    ))
+            return self.supported
+
+        if not(isS3TCSupported()):
+            self.skip("S3TC texture compression not supported.")
+            return
+        bmp = avg.Bitmap("media/rgb24-64x64.dds")
+        self.assertEqual(bmp.getFormat(), avg.BC1)
+        self.assertEqual(bmp.getSize(), (64,64))
+        bmp = avg.Bitmap("media/rgb24alpha-64x64.ktx")
+        self.assertEqual(bmp.getFormat(), avg.BC3)
+        self.assertEqual(bmp.getSize(), (64,64))
+
+        # The cache accounts for the compressed size.
+        self.loadEmptyScene()
+        cache = player.imageCache
+        memUsed = cache.getMemUsed()[0]
+        node = avg.ImageNode(href="rgb24-64x64.dds")
+        self.assertEqual(cache.getMemUsed()[0], memUsed+64*64/2)
+        node.href = "rgb24alpha-64x64.ktx"
+        self.assertEqual(cache.getMemUsed()[0], memUsed+64*64/2+64*64)
+
     def testSpline(self):
         spline = avg.CubicSpline([(0,3),(1,2),(2,1),(3,0)])
         self.assertAlmostEqual(spline.interpolate(0), 3)
@@ -578,8 +753,12 @@ def imageTestSuite(tests):
             "testImagePos",
             "testImageSize",
             "testImageCache",
+            "testImageDiskCache",
+            "testTexUploadBudget",
             "testBitmap",
             "testBitmapManager",
+            "testBitmapManagerRequests",
+            "testBitmapTargetSize",
             "testBitmapManagerException",
             "testBlendMode",
             "testImageMask",
@@ -587,6 +766,7 @@ def imageTestSuite(tests):
             "testImageMaskPos",
             "testImageMipmap",
             "testImageCompression",
+            "testCompressedImage",
             "testSpline",
             )
     return createAVGTestSuite(availableTests, ImageTestCase, tests)
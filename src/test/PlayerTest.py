@@ -19,8 +19,12 @@
 # Current versions can be found at www.libavg.de
 #
 
+import json
 import math
+import os
 import threading
+import time
+import weakref
 
 from libavg import avg, player
 from libavg.testcase import *
@@ -438,6 +442,34 @@ class PlayerTestCase(AVGTestCase):
                 ))
 
 
+    def testClearedTimeoutRelease(self):
+        # Cleared timeouts don't keep their callables alive until they're due.
+        class Callback(object):
+            def __init__(self, clearSelf):
+                self.clearSelf = clearSelf
+                self.id = None
+
+            def __call__(self):
+                if self.clearSelf:
+                    player.clearInterval(self.id)
+
+        def setupTimeouts():
+            timeout = Callback(False)
+            timeout.id = player.setTimeout(100000, timeout)
+            self.timeoutRef = weakref.ref(timeout)
+            player.clearInterval(timeout.id)
+            interval = Callback(True)
+            interval.id = player.setInterval(0, interval)
+            self.intervalRef = weakref.ref(interval)
+
+        self.initDefaultImageScene()
+        self.start(False,
+                (setupTimeouts,
+                 lambda: self.assertEqual(self.timeoutRef(), None),
+                 None,
+                 lambda: self.assertEqual(self.intervalRef(), None),
+                ))
+
     def testCallFromThread(self):
 
         def onAsyncCall():
@@ -830,6 +862,61 @@ class PlayerTestCase(AVGTestCase):
         self.assertRaises(avg.Exception, lambda:
                 player.getConfigOption("illegalGroup", "illegalOption"))
 
+    def testTrace(self):
+        def checkTrace():
+            player.stopTrace()
+            self.assert_(not(player.isTracing()))
+            player.saveTrace("test.json")
+            trace = json.load(open("test.json"))
+            os.remove("test.json")
+            events = trace["traceEvents"]
+            threadNames = [event["args"]["name"] for event in events 
+                    if event["ph"] == "M"]
+            self.assert_("main" in threadNames)
+            frames = [event for event in events 
+                    if event["name"] == "Player - Total frame time"]
+            self.assert_(len(frames) >= 2)
+            self.assert_(frames[0]["dur"] > 0)
+
+        root = self.loadEmptyScene()
+        avg.ImageNode(href="rgb24-64x64.png", parent=root)
+        player.startTrace()
+        self.assert_(player.isTracing())
+        self.start(False,
+                (None,
+                 None,
+                 checkTrace,
+                ))
+
+    def testFrameTimeStats(self):
+        def onJank(frameTime, phase):
+            self.jankFrames.append((frameTime, phase))
+
+        def checkStats():
+            stats = player.getFrameTimeStats()
+            self.assert_(stats.numFrames >= 2)
+            self.assert_(0 < stats.p50 <= stats.p95 <= stats.p99 <= stats.max)
+            self.assertAlmostEqual(stats.p50, stats.getPercentile(50))
+
+        def checkJank():
+            stats = player.getFrameTimeStats()
+            self.assert_(stats.max >= 100)
+            self.assert_("timers" in [phase for frameTime, phase in self.jankFrames])
+            self.assert_(stats.getNumJankFramesInPhase("timers") >= 1)
+            self.assert_(stats.numJankFrames >= len(self.jankFrames))
+            self.assertRaises(RuntimeError,
+                    lambda: stats.getNumJankFramesInPhase("foo"))
+
+        self.jankFrames = []
+        self.loadEmptyScene()
+        player.subscribe(player.JANK, onJank)
+        self.start(False,
+                (None,
+                 checkStats,
+                 lambda: time.sleep(0.1),
+                 checkJank,
+                ))
+
     def testValidateXml(self):
         schema = """<?xml version="1.0" encoding="UTF-8"?>
         <xs:schema xmlns:xs="http://www.w3.org/2001/XMLSchema">
@@ -920,6 +1007,7 @@ def playerTestSuite(tests):
             "testInvalidVideoFilename",
             "testTimeouts",
             "testTimeoutOnFrameHandling",
+            "testClearedTimeoutRelease",
             "testCallFromThread",
             "testAVGFile",
             "testBroken",
@@ -933,6 +1021,8 @@ def playerTestSuite(tests):
             "testScreenDimensions",
             "testSVG",
             "testGetConfigOption",
+            "testTrace",
+            "testFrameTimeStats",
             "testValidateXml",
             "testSetWindowTitle",
             "testWindowFrame",
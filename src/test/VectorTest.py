@@ -810,6 +810,44 @@ class VectorTestCase(AVGTestCase):
                  lambda: self.fakeClick(20, 20),
                  lambda: self.assert_(self.onDownCalled)
                 ))
+
+    def testPreRenderThreads(self):
+        def createScene():
+            for i in xrange(4):
+                div = avg.DivNode(pos=(i*40, 0), parent=canvas)
+                for j in xrange(6):
+                    avg.RectNode(pos=(2, j*20+2), size=(16, 16), fillopacity=1,
+                            fillcolor="FF8000", parent=div)
+                    avg.CircleNode(pos=(28, j*20+10), r=8, parent=div)
+                    avg.PolyLineNode(pos=((2, j*20+18), (38, j*20+2)), parent=div)
+
+        def moveNodes(offset):
+            for div in (canvas.getChild(i) for i in xrange(canvas.getNumChildren())):
+                for node in (div.getChild(i) for i in xrange(div.getNumChildren())):
+                    if isinstance(node, avg.PolyLineNode):
+                        node.pos = [avg.Point2D(pt.x, pt.y+offset) for pt in node.pos]
+                    else:
+                        node.pos = avg.Point2D(node.pos.x, node.pos.y+offset)
+
+        def setBaseline():
+            self.baselineBmp = player.screenshot()
+            player.setPreRenderThreads(4)
+            self.assertEqual(player.getPreRenderThreads(), 4)
+
+        def checkSameImage():
+            bmp = player.screenshot()
+            self.assert_(self.areSimilarBmps(bmp, self.baselineBmp, 0, 0))
+
+        canvas = self.makeEmptyCanvas()
+        createScene()
+        self.start(False,
+                (setBaseline,
+                 lambda: moveNodes(3),
+                 lambda: moveNodes(-3),
+                 checkSameImage,
+                 lambda: player.setPreRenderThreads(0),
+                 checkSameImage
+                ))
         
         
 def vectorTestSuite(tests):
@@ -833,6 +871,7 @@ def vectorTestSuite(tests):
             "testPointInPolygon",
             "testCircle",
             "testMesh",
-            "testInactiveVector"
+            "testInactiveVector",
+            "testPreRenderThreads"
             )
     return createAVGTestSuite(availableTests, VectorTestCase, tests)
@@ -579,6 +579,32 @@ class WordsTestCase(AVGTestCase):
                  lambda: self.assert_(testInside(False)),
                 ))
 
+    def testAlignedHitBounds(self):
+        def changeText():
+            node.text = "Centered text"
+            # Updates the hit grid before the new text is rendered.
+            div.getElementByPos((0,0))
+
+        def checkHits():
+            width = node.getMediaSize()[0]
+            self.assertEqual(div.getElementByPos((81-width/2, 45)), node)
+            self.assertEqual(div.getElementByPos((79+width/2, 45)), node)
+            self.assertEqual(div.getElementByPos((78-width/2, 45)), None)
+
+        root = self.loadEmptyScene()
+        div = avg.DivNode(parent=root)
+        # Enough children that the div uses its hit grid.
+        for i in range(20):
+            avg.RectNode(pos=(i*8,140), size=(4,4), parent=div)
+        node = avg.WordsNode(pos=(80,40), fontsize=12, alignment="center",
+                font="Bitstream Vera Sans", variant="roman", text="Centered",
+                parent=div)
+        self.start(False,
+                (checkHits,
+                 changeText,
+                 checkHits,
+                ))
+
     def testFontDir(self):
         avg.WordsNode.addFontDir('extrafonts')
         root = self.loadEmptyScene()
@@ -688,6 +714,7 @@ def wordsTestSuite(tests):
             "testWordsBR",
             "testLetterSpacing",
             "testPositioning",
+            "testAlignedHitBounds",
             "testFontDir",
             "testGetNumLines",
             "testGetLineExtents",
@@ -37,7 +37,7 @@ using namespace std;
 using boost::dynamic_pointer_cast;
 
 #define AUDIO_MSG_QUEUE_LENGTH  50
-#define AUDIO_STATUS_QUEUE_LENGTH -1
+#define AUDIO_STATUS_QUEUE_LENGTH 256
 #define PACKET_QUEUE_LENGTH 50
 
 namespace avg {
@@ -107,7 +107,7 @@ void AsyncVideoDecoder::startDecoding(bool bDeliverYCbCr, const AudioParams* pAP
 
         m_pVDecoderThread = new boost::thread(VideoDecoderThread(
                 *m_pVCmdQ, *m_pVMsgQ, packetQ, getVideoStream(), 
-                getSize(), getPixelFormat()));
+                getSize(), getPixelFormat(), usesBufferPool()));
     }
     
     if (getVideoInfo().m_bHasAudio) {
@@ -361,6 +361,7 @@ VideoMsgPtr AsyncVideoDecoder::getNextBmps(bool bWait)
     if (pMsg) {
         switch (pMsg->getType()) {
             case VideoMsg::FRAME:
+                addFrameDecodeTime(pMsg->getDecodeTime());
                 return pMsg;
             case VideoMsg::END_OF_FILE:
                 m_NumVSeeksDone = m_NumSeeksSent;
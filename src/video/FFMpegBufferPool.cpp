@@ -0,0 +1,186 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#include "FFMpegBufferPool.h"
+
+#include "../base/Exception.h"
+#include "../base/ThreadHelper.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace avg {
+
+// Stride alignment. Large enough for the SIMD code in all ffmpeg versions.
+static const int STRIDE_ALIGN = 64;
+
+std::atomic<int> FFMpegBufferPool::s_NumAllocatedBuffers(0);
+
+FFMpegBufferPool::FFMpegBufferPool()
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+    : m_Width(0),
+      m_Height(0),
+      m_Format(AV_PIX_FMT_NONE),
+      m_NumPlanes(0)
+#endif
+{
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+    for (int i = 0; i < 4; ++i) {
+        m_Linesizes[i] = 0;
+        m_pPools[i] = 0;
+    }
+#endif
+}
+
+FFMpegBufferPool::~FFMpegBufferPool()
+{
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+    // Buffers still in use are freed by ffmpeg when they are released.
+    deletePools();
+#endif
+}
+
+void FFMpegBufferPool::attach(AVCodecContext* pContext)
+{
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+    pContext->opaque = this;
+    pContext->get_buffer2 = &FFMpegBufferPool::getBuffer2;
+    pContext->thread_safe_callbacks = 1;
+    // Decoded frames stay valid after the next call to avcodec_decode_video2().
+    pContext->refcounted_frames = 1;
+#endif
+}
+
+int FFMpegBufferPool::getNumAllocatedBuffers()
+{
+    return s_NumAllocatedBuffers;
+}
+
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+int FFMpegBufferPool::getBuffer2(AVCodecContext* pContext, AVFrame* pFrame, int flags)
+{
+    FFMpegBufferPool* pThis = (FFMpegBufferPool*)(pContext->opaque);
+    AVG_ASSERT(pThis);
+    bool bPlanar = (pFrame->format == AV_PIX_FMT_YUV420P || 
+            pFrame->format == AV_PIX_FMT_YUVJ420P || 
+            pFrame->format == AV_PIX_FMT_YUVA420P);
+    if (bPlanar && (pContext->codec->capabilities & AV_CODEC_CAP_DR1)) {
+        if (pThis->allocFrameBuffers(pContext, pFrame)) {
+            return 0;
+        }
+    }
+    return avcodec_default_get_buffer2(pContext, pFrame, flags);
+}
+
+bool FFMpegBufferPool::allocFrameBuffers(AVCodecContext* pContext, AVFrame* pFrame)
+{
+    lock_guard lock(m_Mutex);
+    if (pFrame->width != m_Width || pFrame->height != m_Height || 
+            pFrame->format != m_Format)
+    {
+        initPools(pContext, pFrame);
+    }
+    for (int i = 0; i < m_NumPlanes; ++i) {
+        pFrame->buf[i] = av_buffer_pool_get(m_pPools[i]);
+        if (!pFrame->buf[i]) {
+            for (int j = 0; j < i; ++j) {
+                av_buffer_unref(&pFrame->buf[j]);
+            }
+            return false;
+        }
+        pFrame->data[i] = pFrame->buf[i]->data;
+        pFrame->linesize[i] = m_Linesizes[i];
+    }
+    for (int i = m_NumPlanes; i < AV_NUM_DATA_POINTERS; ++i) {
+        pFrame->data[i] = 0;
+        pFrame->linesize[i] = 0;
+    }
+    pFrame->extended_data = pFrame->data;
+    return true;
+}
+
+void FFMpegBufferPool::initPools(AVCodecContext* pContext, AVFrame* pFrame)
+{
+    deletePools();
+    m_Width = pFrame->width;
+    m_Height = pFrame->height;
+    m_Format = pFrame->format;
+
+    // The codec may write beyond the visible frame, so the buffers are allocated for 
+    // the aligned dimensions.
+    int width = m_Width;
+    int height = m_Height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(pContext, &width, &height, linesizeAlign);
+    
+    const AVPixFmtDescriptor* pDesc = av_pix_fmt_desc_get(AVPixelFormat(m_Format));
+    m_NumPlanes = (m_Format == AV_PIX_FMT_YUVA420P) ? 4 : 3;
+    for (int i = 0; i < m_NumPlanes; ++i) {
+        bool bChroma = (i == 1 || i == 2);
+        int planeWidth = width;
+        int planeHeight = height;
+        if (bChroma) {
+            planeWidth = -((-width) >> pDesc->log2_chroma_w);
+            planeHeight = -((-height) >> pDesc->log2_chroma_h);
+        }
+        int align = max(STRIDE_ALIGN, linesizeAlign[i]);
+        m_Linesizes[i] = FFALIGN(planeWidth, align);
+        // Some codecs read and write slightly beyond the end of the plane.
+        int size = m_Linesizes[i]*planeHeight + 16 + STRIDE_ALIGN - 1;
+        m_pPools[i] = av_buffer_pool_init(size, &FFMpegBufferPool::allocBuffer);
+    }
+}
+
+AVBufferRef* FFMpegBufferPool::allocBuffer(int size)
+{
+    uint8_t* pData = (uint8_t*)av_malloc(size);
+    if (!pData) {
+        return 0;
+    }
+    AVBufferRef* pBuffer = av_buffer_create(pData, size, &FFMpegBufferPool::freeBuffer,
+            0, 0);
+    if (!pBuffer) {
+        av_free(pData);
+        return 0;
+    }
+    s_NumAllocatedBuffers++;
+    return pBuffer;
+}
+
+void FFMpegBufferPool::freeBuffer(void* pOpaque, uint8_t* pData)
+{
+    av_free(pData);
+    s_NumAllocatedBuffers--;
+}
+
+void FFMpegBufferPool::deletePools()
+{
+    for (int i = 0; i < 4; ++i) {
+        if (m_pPools[i]) {
+            av_buffer_pool_uninit(&m_pPools[i]);
+        }
+    }
+    m_NumPlanes = 0;
+}
+#endif
+
+}
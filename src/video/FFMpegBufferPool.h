@@ -0,0 +1,78 @@
+//
+//  libavg - Media Playback Engine. 
+//  Copyright (C) 2003-2014 Ulrich von Zadow
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//  Current versions can be found at www.libavg.de
+//
+
+#ifndef _FFMpegBufferPool_H_
+#define _FFMpegBufferPool_H_
+
+#include "../api.h"
+
+#include "WrapFFMpeg.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <atomic>
+
+namespace avg {
+
+// Frame buffer allocator for ffmpeg video codecs. Planar frames are decoded into
+// pooled, aligned memory blocks, so decoded frames can be passed on to the texture
+// upload without copying them. A block is reused when ffmpeg and all bitmaps that 
+// reference it have released it.
+class AVG_API FFMpegBufferPool
+{
+    public:
+        FFMpegBufferPool();
+        virtual ~FFMpegBufferPool();
+
+        // Must be called before avcodec_open2().
+        void attach(AVCodecContext* pContext);
+
+        // Number of buffers allocated by all pools that haven't been freed yet. 
+        // Buffers are freed when their pool has been deleted and ffmpeg and all 
+        // bitmaps have released them.
+        static int getNumAllocatedBuffers();
+
+    private:
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+        static int getBuffer2(AVCodecContext* pContext, AVFrame* pFrame, int flags);
+        static AVBufferRef* allocBuffer(int size);
+        static void freeBuffer(void* pOpaque, uint8_t* pData);
+        bool allocFrameBuffers(AVCodecContext* pContext, AVFrame* pFrame);
+        void initPools(AVCodecContext* pContext, AVFrame* pFrame);
+        void deletePools();
+
+        boost::mutex m_Mutex;
+        int m_Width;
+        int m_Height;
+        int m_Format;
+        int m_NumPlanes;
+        int m_Linesizes[4];
+        AVBufferPool* m_pPools[4];
+#endif
+        static std::atomic<int> s_NumAllocatedBuffers;
+};
+
+typedef boost::shared_ptr<FFMpegBufferPool> FFMpegBufferPoolPtr;
+
+}
+
+#endif
@@ -29,7 +29,9 @@
 #include "../base/ObjectCounter.h"
 #include "../base/ProfilingZoneID.h"
 #include "../base/StringHelper.h"
+#include "../base/TimeSource.h"
 #include "../graphics/Bitmap.h"
+#include "../graphics/YUVConversion.h"
 
 #include <iostream>
 #include <sstream>
@@ -47,7 +49,9 @@ FFMpegFrameDecoder::FFMpegFrameDecoder(AVStream* pStream)
       m_bEOF(false),
       m_StartTimestamp(-1),
       m_LastFrameTime(-1),
-      m_bUseStreamFPS(true)
+      m_bUseStreamFPS(true),
+      m_DecodeTime(0),
+      m_LastFrameDecodeTime(0)
 {
     m_TimeUnitsPerSecond = float(1.0/av_q2d(pStream->time_base));
     m_FPS = getStreamFPS(pStream);
@@ -73,9 +77,20 @@ bool FFMpegFrameDecoder::decodePacket(AVPacket* pPacket, AVFrame* pFrame,
     int bGotPicture = 0;
     AVCodecContext* pContext = m_pStream->codec;
     AVG_ASSERT(pPacket);
+    long long startTime = TimeSource::get()->getCurrentMicrosecs();
     avcodec_decode_video2(pContext, pFrame, &bGotPicture, pPacket);
+    m_DecodeTime += TimeSource::get()->getCurrentMicrosecs()-startTime;
     if (bGotPicture) {
-        m_LastFrameTime = getFrameTime(pPacket->dts, bFrameAfterSeek);
+        long long dts = pPacket->dts;
+#if LIBAVCODEC_VERSION_INT > AV_VERSION_INT(54, 28, 0)
+        // With frame threading, the frame returned doesn't belong to pPacket.
+        if (pFrame->pkt_dts != (long long)AV_NOPTS_VALUE) {
+            dts = pFrame->pkt_dts;
+        }
+#endif
+        m_LastFrameTime = getFrameTime(dts, bFrameAfterSeek);
+        m_LastFrameDecodeTime = m_DecodeTime;
+        m_DecodeTime = 0;
     }
     av_free_packet(pPacket);
     delete pPacket;
@@ -91,7 +106,13 @@ bool FFMpegFrameDecoder::decodeLastFrame(AVFrame* pFrame)
     av_init_packet(&packet);
     packet.data = 0;
     packet.size = 0;
+    long long startTime = TimeSource::get()->getCurrentMicrosecs();
     avcodec_decode_video2(pContext, pFrame, &bGotPicture, &packet);
+    m_DecodeTime += TimeSource::get()->getCurrentMicrosecs()-startTime;
+    if (bGotPicture) {
+        m_LastFrameDecodeTime = m_DecodeTime;
+        m_DecodeTime = 0;
+    }
     m_bEOF = true;
 
     // We don't have a timestamp for the last frame, so we'll
@@ -138,18 +159,24 @@ void FFMpegFrameDecoder::convertFrameToBmp(AVFrame* pFrame, BitmapPtr pBmp)
             destFmt = AV_PIX_FMT_BGRA;
     }
     AVCodecContext const* pContext = m_pStream->codec;
-    if (destFmt == AV_PIX_FMT_BGRA && (pContext->pix_fmt == AV_PIX_FMT_YUV420P || 
-                pContext->pix_fmt == AV_PIX_FMT_YUVJ420P))
+    AVPixelFormat srcFmt = pContext->pix_fmt;
+    bool bSrcIs420 = (srcFmt == AV_PIX_FMT_YUV420P || srcFmt == AV_PIX_FMT_YUVJ420P);
+    bool bSrcIs422 = (srcFmt == AV_PIX_FMT_YUV422P || srcFmt == AV_PIX_FMT_YUVJ422P);
+    if ((destFmt == AV_PIX_FMT_BGRA || destFmt == AV_PIX_FMT_RGBA) && 
+            (bSrcIs420 || bSrcIs422))
     {
         ScopeTimer timer(ConvertImageLibavgProfilingZone);
-        BitmapPtr pBmpY(new Bitmap(pBmp->getSize(), I8, pFrame->data[0],
-                pFrame->linesize[0], false));
-        BitmapPtr pBmpU(new Bitmap(pBmp->getSize(), I8, pFrame->data[1],
-                pFrame->linesize[1], false));
-        BitmapPtr pBmpV(new Bitmap(pBmp->getSize(), I8, pFrame->data[2],
-                pFrame->linesize[2], false));
-        pBmp->copyYUVPixels(*pBmpY, *pBmpU, *pBmpV, 
-                pContext->pix_fmt == AV_PIX_FMT_YUVJ420P);
+        IntPoint size = pBmp->getSize();
+        IntPoint chromaSize((size.x+1)/2, size.y);
+        if (bSrcIs420) {
+            chromaSize.y = (size.y+1)/2;
+        }
+        Bitmap bmpY(size, I8, pFrame->data[0], pFrame->linesize[0], false);
+        Bitmap bmpU(chromaSize, I8, pFrame->data[1], pFrame->linesize[1], false);
+        Bitmap bmpV(chromaSize, I8, pFrame->data[2], pFrame->linesize[2], false);
+        bool bJPEG = (srcFmt == AV_PIX_FMT_YUVJ420P || srcFmt == AV_PIX_FMT_YUVJ422P);
+        // Also sets alpha to 255.
+        YUVtoRGB32(bmpY, bmpU, bmpV, bJPEG, *pBmp);
     } else {
         if (!m_pSwsContext) {
             m_pSwsContext = sws_getContext(pContext->width, pContext->height, 
@@ -194,11 +221,67 @@ void FFMpegFrameDecoder::copyPlaneToBmp(BitmapPtr pBmp, unsigned char * pData, i
     }
 }
 
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+static void freeFrame(AVFrame* pFrame)
+{
+    av_frame_free(&pFrame);
+}
+
+// Bitmap deleter that holds a frame reference until the bitmap is deleted.
+class FrameRefDeleter
+{
+public:
+    FrameRefDeleter(boost::shared_ptr<AVFrame> pFrame)
+        : m_pFrame(pFrame)
+    {
+    }
+
+    void operator()(Bitmap* pBmp)
+    {
+        delete pBmp;
+        m_pFrame = boost::shared_ptr<AVFrame>();
+    }
+
+private:
+    boost::shared_ptr<AVFrame> m_pFrame;
+};
+#endif
+
+void FFMpegFrameDecoder::refPlanesInBmps(AVFrame* pFrame, const IntPoint& size, 
+        int numPlanes, vector<BitmapPtr>& pBmps)
+{
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+    AVG_ASSERT(pFrame->buf[0]);
+    boost::shared_ptr<AVFrame> pFrameRef(av_frame_clone(pFrame), freeFrame);
+    AVG_ASSERT(pFrameRef);
+    IntPoint halfSize(size.x/2, size.y/2);
+    for (int i = 0; i < numPlanes; ++i) {
+        IntPoint planeSize = size;
+        if (i == 1 || i == 2) {
+            planeSize = halfSize;
+        }
+        Bitmap* pBmp = new Bitmap(planeSize, I8, pFrameRef->data[i], 
+                pFrameRef->linesize[i], false);
+        pBmps.push_back(BitmapPtr(pBmp, FrameRefDeleter(pFrameRef)));
+    }
+#else
+    AVG_ASSERT(false);
+#endif
+}
+
+void FFMpegFrameDecoder::unrefFrame(AVFrame* pFrame)
+{
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+    av_frame_unref(pFrame);
+#endif
+}
+
 void FFMpegFrameDecoder::handleSeek()
 {
     m_LastFrameTime = -1.0f;
     avcodec_flush_buffers(m_pStream->codec);
     m_bEOF = false;
+    m_DecodeTime = 0;
     if (m_StartTimestamp == -1) {
         m_StartTimestamp = 0;
     }
@@ -229,6 +312,11 @@ bool FFMpegFrameDecoder::isEOF() const
     return m_bEOF;
 }
 
+long long FFMpegFrameDecoder::getLastFrameDecodeTime() const
+{
+    return m_LastFrameDecodeTime;
+}
+
 float FFMpegFrameDecoder::getFrameTime(long long dts, bool bFrameAfterSeek)
 {
     bool bUseStreamFPS = m_bUseStreamFPS;
@@ -26,7 +26,10 @@
 
 #include "WrapFFMpeg.h"
 
+#include "../base/GLMHelper.h"
+
 #include <boost/shared_ptr.hpp>
+#include <vector>
 
 namespace avg {
 
@@ -43,6 +46,14 @@ class AVG_API FFMpegFrameDecoder
         bool decodeLastFrame(AVFrame* pFrame);
         void convertFrameToBmp(AVFrame* pFrame, BitmapPtr pBmp);
         void copyPlaneToBmp(BitmapPtr pBmp, unsigned char * pData, int stride);
+        // Creates bitmaps that point to the planes of a reference-counted frame. 
+        // The frame data stays valid as long as any of the bitmaps exists.
+        void refPlanesInBmps(AVFrame* pFrame, const IntPoint& size, int numPlanes,
+                std::vector<BitmapPtr>& pBmps);
+        // Releases the buffers of a decoded frame. Must be called once the frame has
+        // been passed on, since the codec hands out reference-counted frames when a
+        // buffer pool is attached.
+        void unrefFrame(AVFrame* pFrame);
 
         void handleSeek();
 
@@ -51,6 +62,8 @@ class AVG_API FFMpegFrameDecoder
         virtual void setFPS(float fps);
 
         virtual bool isEOF() const;
+        // Time in microseconds spent in ffmpeg to get the last frame.
+        long long getLastFrameDecodeTime() const;
         
     private:
         float getFrameTime(long long dts, bool bFrameAfterSeek);
@@ -66,6 +79,9 @@ class AVG_API FFMpegFrameDecoder
 
         bool m_bUseStreamFPS;
         float m_FPS;
+
+        long long m_DecodeTime;
+        long long m_LastFrameDecodeTime;
 };
 
 typedef boost::shared_ptr<FFMpegFrameDecoder> FFMpegFrameDecoderPtr;
@@ -235,7 +235,9 @@ void SyncVideoDecoder::readFrame(AVFrame* pFrame)
     if (m_bProcessingLastFrames) {
         // EOF received, but last frames still need to be decoded.
         bool bGotPicture = m_pFrameDecoder->decodeLastFrame(pFrame);
-        if (!bGotPicture) {
+        if (bGotPicture) {
+            addFrameDecodeTime(m_pFrameDecoder->getLastFrameDecodeTime());
+        } else {
             m_bProcessingLastFrames = false;
         }
     } else {        
@@ -250,6 +252,9 @@ void SyncVideoDecoder::readFrame(AVFrame* pFrame)
             } else {
                 bGotPicture = m_pFrameDecoder->decodeLastFrame(pFrame);
             }
+            if (bGotPicture) {
+                addFrameDecodeTime(m_pFrameDecoder->getLastFrameDecodeTime());
+            }
             if (bGotPicture && m_pFrameDecoder->isEOF()) {
                 m_bProcessingLastFrames = true;
             }
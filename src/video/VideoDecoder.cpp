@@ -51,6 +51,11 @@ VideoDecoder::VideoDecoder()
       m_pVStream(0),
       m_PF(NO_PIXELFORMAT),
       m_Size(0,0),
+      m_NumDecoderThreads(1),
+      m_DecoderThreadType(DTT_AUTO),
+      m_NumFramesDecoded(0),
+      m_TotalDecodeTime(0),
+      m_bUseBufferPool(false),
       m_AStreamIndex(-1),
       m_pAStream(0)
 {
@@ -71,6 +76,8 @@ void VideoDecoder::open(const string& sFilename, bool bEnableSound)
     lock_guard lock(s_OpenMutex);
     int err;
     m_sFilename = sFilename;
+    m_NumFramesDecoded = 0;
+    m_TotalDecodeTime = 0;
     
     AVG_TRACE(Logger::category::MEMORY, Logger::severity::INFO, "Opening " << sFilename);
     err = avformat_open_input(&m_pFormatContext, sFilename.c_str(), 0, 0);
@@ -193,12 +200,19 @@ void VideoDecoder::close()
     lock_guard lock(s_OpenMutex);
     AVG_TRACE(Logger::category::MEMORY, Logger::severity::INFO, "Closing " <<
             m_sFilename);
+    if (m_NumFramesDecoded > 0) {
+        AVG_TRACE(Logger::category::PROFILE_VIDEO, Logger::severity::INFO,
+                m_sFilename << ": " << m_NumFramesDecoded << 
+                " frames decoded, average decode time " << getAvgDecodeTime() <<
+                " ms, " << getNumDecoderThreads() << " decoder thread(s).");
+    }
 
     // Close audio and video codecs
     if (m_pVStream) {
         avcodec_close(m_pVStream->codec);
         m_pVStream = 0;
         m_VStreamIndex = -1;
+        m_pBufferPool = FFMpegBufferPoolPtr();
     }
 
     if (m_pAStream) {
@@ -218,6 +232,46 @@ VideoDecoder::DecoderState VideoDecoder::getState() const
     return m_State;
 }
 
+void VideoDecoder::setDecoderThreads(int numThreads, DecoderThreadType type)
+{
+    AVG_ASSERT(m_State == CLOSED);
+    if (numThreads < 0) {
+        throw Exception(AVG_ERR_OUT_OF_RANGE, 
+                "Number of decoder threads must be >= 0 (0 selects automatically).");
+    }
+    m_NumDecoderThreads = numThreads;
+    m_DecoderThreadType = type;
+}
+
+int VideoDecoder::getNumDecoderThreads() const
+{
+    if (m_pVStream) {
+        // Returns the number of threads ffmpeg actually uses.
+        return m_pVStream->codec->thread_count;
+    } else {
+        return m_NumDecoderThreads;
+    }
+}
+
+DecoderThreadType VideoDecoder::getDecoderThreadType() const
+{
+    return m_DecoderThreadType;
+}
+
+int VideoDecoder::getNumFramesDecoded() const
+{
+    return m_NumFramesDecoded;
+}
+
+float VideoDecoder::getAvgDecodeTime() const
+{
+    if (m_NumFramesDecoded == 0) {
+        return 0;
+    } else {
+        return float(m_TotalDecodeTime)/m_NumFramesDecoded/1000;
+    }
+}
+
 VideoInfo VideoDecoder::getVideoInfo() const
 {
     AVG_ASSERT(m_State != CLOSED);
@@ -292,6 +346,25 @@ AVCodecContext* VideoDecoder::getCodecContext()
     return m_pVStream->codec;
 }
 
+void VideoDecoder::addFrameDecodeTime(long long decodeTime)
+{
+    m_NumFramesDecoded++;
+    m_TotalDecodeTime += decodeTime;
+}
+
+void VideoDecoder::setUseBufferPool(bool bUseBufferPool)
+{
+    AVG_ASSERT(m_State == CLOSED);
+#ifdef HAVE_AVCODEC_GET_BUFFER2
+    m_bUseBufferPool = bUseBufferPool;
+#endif
+}
+
+bool VideoDecoder::usesBufferPool() const
+{
+    return m_bUseBufferPool;
+}
+
 void VideoDecoder::allocFrameBmps(vector<BitmapPtr>& pBmps)
 {
     if (pixelFormatIsPlanar(getPixelFormat())) {
@@ -350,10 +423,34 @@ int VideoDecoder::openCodec(int streamIndex)
     if (!pCodec) {
         return -1;
     }
+    if (streamIndex == m_VStreamIndex) {
+        pContext->thread_count = m_NumDecoderThreads;
+#ifdef FF_THREAD_FRAME
+        switch (m_DecoderThreadType) {
+            case DTT_FRAME:
+                pContext->thread_type = FF_THREAD_FRAME;
+                break;
+            case DTT_SLICE:
+                pContext->thread_type = FF_THREAD_SLICE;
+                break;
+            default:
+                pContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        }
+#endif
+        if (m_bUseBufferPool) {
+            m_pBufferPool = FFMpegBufferPoolPtr(new FFMpegBufferPool());
+            m_pBufferPool->attach(pContext);
+        }
+    }
     int rc = avcodec_open2(pContext, pCodec, 0);
     if (rc < 0) {
         return -1;
     }
+    if (streamIndex == m_VStreamIndex) {
+        AVG_TRACE(Logger::category::PROFILE_VIDEO, Logger::severity::INFO,
+                m_sFilename << ": Decoding with " << pContext->thread_count << 
+                " thread(s).");
+    }
     return 0;
 }
 
@@ -415,6 +512,35 @@ string VideoDecoder::getStreamPF() const
     return s;
 }
 
+DecoderThreadType stringToDecoderThreadType(const string& s)
+{
+    if (s == "auto") {
+        return DTT_AUTO;
+    } else if (s == "frame") {
+        return DTT_FRAME;
+    } else if (s == "slice") {
+        return DTT_SLICE;
+    } else {
+        throw Exception(AVG_ERR_INVALID_ARGS, 
+                "Decoder thread type must be auto, frame or slice; '"+s+"' given.");
+    }
+}
+
+string decoderThreadTypeToString(DecoderThreadType type)
+{
+    switch (type) {
+        case DTT_AUTO:
+            return "auto";
+        case DTT_FRAME:
+            return "frame";
+        case DTT_SLICE:
+            return "slice";
+        default:
+            AVG_ASSERT(false);
+            return "";
+    }
+}
+
 void avcodecError(const string& sFilename, int err)
 {
     char buf[256];
@@ -26,6 +26,7 @@
 #include "../avgconfigwrapper.h"
 
 #include "VideoInfo.h"
+#include "FFMpegBufferPool.h"
 
 #include "../graphics/PixelFormat.h"
 
@@ -50,6 +51,14 @@ enum StreamSelect {
     SS_AUDIO, SS_VIDEO, SS_DEFAULT
 };
 
+// How ffmpeg distributes the work of decoding a video stream among threads.
+enum DecoderThreadType {
+    DTT_AUTO, DTT_FRAME, DTT_SLICE
+};
+
+AVG_API DecoderThreadType stringToDecoderThreadType(const std::string& s);
+AVG_API std::string decoderThreadTypeToString(DecoderThreadType type);
+
 class AVG_API VideoDecoder
 {
     public:
@@ -60,6 +69,12 @@ class AVG_API VideoDecoder
         virtual void startDecoding(bool bDeliverYCbCr, const AudioParams* pAP);
         virtual void close();
         virtual DecoderState getState() const;
+        // Must be called before open(). numThreads == 0 lets ffmpeg decide.
+        void setDecoderThreads(int numThreads, DecoderThreadType type);
+        int getNumDecoderThreads() const;
+        DecoderThreadType getDecoderThreadType() const;
+        int getNumFramesDecoded() const;
+        float getAvgDecodeTime() const;
         VideoInfo getVideoInfo() const;
         PixelFormat getPixelFormat() const;
         IntPoint getSize() const;
@@ -88,6 +103,11 @@ class AVG_API VideoDecoder
         AVCodecContext const * getCodecContext() const;
         AVCodecContext * getCodecContext();
         void allocFrameBmps(std::vector<BitmapPtr>& pBmps);
+        void addFrameDecodeTime(long long decodeTime);
+        // Must be called before open(). If enabled, planar video frames are decoded
+        // into pooled buffers that can be passed on without copying.
+        void setUseBufferPool(bool bUseBufferPool);
+        bool usesBufferPool() const;
 
         int getVStreamIndex() const;
         AVStream* getVideoStream() const;
@@ -110,6 +130,12 @@ class AVG_API VideoDecoder
         AVStream * m_pVStream;
         PixelFormat m_PF;
         IntPoint m_Size;
+        int m_NumDecoderThreads;
+        DecoderThreadType m_DecoderThreadType;
+        int m_NumFramesDecoded;
+        long long m_TotalDecodeTime;
+        bool m_bUseBufferPool;
+        FFMpegBufferPoolPtr m_pBufferPool;
         
         // Audio
         int m_AStreamIndex;
@@ -36,7 +36,8 @@ using namespace std;
 namespace avg {
 
 VideoDecoderThread::VideoDecoderThread(CQueue& cmdQ, VideoMsgQueue& msgQ, 
-        VideoMsgQueue& packetQ, AVStream* pStream, const IntPoint& size, PixelFormat pf)
+        VideoMsgQueue& packetQ, AVStream* pStream, const IntPoint& size, PixelFormat pf,
+        bool bZeroCopy)
     : WorkerThread<VideoDecoderThread>(string("Video Decoder"), cmdQ, 
             Logger::category::PROFILE_VIDEO),
       m_MsgQ(msgQ),
@@ -45,6 +46,7 @@ VideoDecoderThread::VideoDecoderThread(CQueue& cmdQ, VideoMsgQueue& msgQ,
       m_pHalfBmpQ(new BitmapQueue()),
       m_Size(size),
       m_PF(pf),
+      m_bZeroCopy(bZeroCopy),
       m_bSeekDone(false),
       m_bProcessingLastFrames(false)
 {
@@ -122,6 +124,10 @@ void VideoDecoderThread::setFPS(float fps)
 
 void VideoDecoderThread::returnFrame(VideoMsgPtr pMsg)
 {
+    if (!pMsg->getFrameBitmap(0)->ownsBits()) {
+        // Frame buffer belongs to ffmpeg and is released with the bitmaps.
+        return;
+    }
     m_pBmpQ->push(pMsg->getFrameBitmap(0));
     if (pixelFormatIsPlanar(m_PF)) {
         m_pHalfBmpQ->push(pMsg->getFrameBitmap(1));
@@ -138,6 +144,7 @@ void VideoDecoderThread::decodePacket(AVPacket* pPacket)
     if (bGotPicture) {
         m_bSeekDone = false;
         sendFrame(m_pFrame);
+        m_pFrameDecoder->unrefFrame(m_pFrame);
     }
 }
 
@@ -146,6 +153,7 @@ void VideoDecoderThread::handleEOF()
     bool bGotPicture = m_pFrameDecoder->decodeLastFrame(m_pFrame);
     if (bGotPicture) {
         sendFrame(m_pFrame);
+        m_pFrameDecoder->unrefFrame(m_pFrame);
     } else {
         m_bProcessingLastFrames = false;
         VideoMsgPtr pMsg(new VideoMsg());
@@ -168,7 +176,10 @@ void VideoDecoderThread::sendFrame(AVFrame* pFrame)
 {
     VideoMsgPtr pMsg(new VideoMsg());
     vector<BitmapPtr> pBmps;
-    if (pixelFormatIsPlanar(m_PF)) {
+    if (pixelFormatIsPlanar(m_PF) && m_bZeroCopy) {
+        int numPlanes = (m_PF == YCbCrA420p) ? 4 : 3;
+        m_pFrameDecoder->refPlanesInBmps(pFrame, m_Size, numPlanes, pBmps);
+    } else if (pixelFormatIsPlanar(m_PF)) {
         ScopeTimer timer(CopyImageProfilingZone);
         IntPoint halfSize(m_Size.x/2, m_Size.y/2);
         pBmps.push_back(getBmp(m_pBmpQ, m_Size, I8));
@@ -185,7 +196,8 @@ void VideoDecoderThread::sendFrame(AVFrame* pFrame)
         pBmps.push_back(getBmp(m_pBmpQ, m_Size, m_PF));
         m_pFrameDecoder->convertFrameToBmp(pFrame, pBmps[0]);
     }
-    pMsg->setFrame(pBmps, m_pFrameDecoder->getCurTime());
+    pMsg->setFrame(pBmps, m_pFrameDecoder->getCurTime(), 
+            m_pFrameDecoder->getLastFrameDecodeTime());
     pushMsg(pMsg);
 }
 
@@ -47,7 +47,8 @@ typedef boost::shared_ptr<FFMpegFrameDecoder> FFMpegFrameDecoderPtr;
 class AVG_API VideoDecoderThread: public WorkerThread<VideoDecoderThread> {
     public:
         VideoDecoderThread(CQueue& cmdQ, VideoMsgQueue& msgQ, VideoMsgQueue& packetQ, 
-                AVStream* pStream, const IntPoint& size, PixelFormat pf);
+                AVStream* pStream, const IntPoint& size, PixelFormat pf, 
+                bool bZeroCopy);
         virtual ~VideoDecoderThread();
         virtual bool init();
         virtual void deinit();
@@ -74,6 +75,8 @@ class AVG_API VideoDecoderThread: public WorkerThread<VideoDecoderThread> {
         
         IntPoint m_Size;
         PixelFormat m_PF;
+        // Pass planar frames on without copying them.
+        bool m_bZeroCopy;
 
         bool m_bSeekDone;
         bool m_bProcessingLastFrames;
@@ -23,7 +23,7 @@
 #define _VideoMsg_H_
 
 #include "../api.h"
-#include "../base/Queue.h"
+#include "../base/LockFreeQueue.h"
 
 #include "../audio/AudioMsg.h"
 
@@ -40,13 +40,15 @@ typedef boost::shared_ptr<Bitmap> BitmapPtr;
 class AVG_API VideoMsg: public AudioMsg {
 public:
     VideoMsg();
-    void setFrame(const std::vector<BitmapPtr>& pBmps, float frameTime);
+    void setFrame(const std::vector<BitmapPtr>& pBmps, float frameTime, 
+            long long decodeTime=0);
     void setPacket(AVPacket* pPacket);
 
     virtual ~VideoMsg();
 
     BitmapPtr getFrameBitmap(int i);
     float getFrameTime();
+    long long getDecodeTime();
     AVPacket* getPacket();
     void freePacket();
 
@@ -54,13 +56,14 @@ private:
     // FRAME
     std::vector<BitmapPtr> m_pBmps;
     float m_FrameTime;
+    long long m_DecodeTime;
 
     // PACKET
     AVPacket * m_pPacket;
 };
 
 typedef boost::shared_ptr<VideoMsg> VideoMsgPtr;
-typedef Queue<VideoMsg> VideoMsgQueue;
+typedef LockFreeQueue<VideoMsg> VideoMsgQueue;
 typedef boost::shared_ptr<VideoMsgQueue> VideoMsgQueuePtr;
 
 }
@@ -73,6 +73,13 @@ extern "C" {
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(55,28,1)
 #define av_frame_alloc  avcodec_alloc_frame
 #endif
+#if LIBAVCODEC_VERSION_INT > AV_VERSION_INT(55, 45, 101)
+  // Reference-counted frames and custom frame buffers.
+  #define HAVE_AVCODEC_GET_BUFFER2
+  #ifndef AV_CODEC_CAP_DR1
+    #define AV_CODEC_CAP_DR1 CODEC_CAP_DR1
+  #endif
+#endif
 }
 
 // Old ffmpeg has PixelFormat, new ffmpeg uses AVPixelFormat.
@@ -95,6 +102,8 @@ extern "C" {
     #define AV_PIX_FMT_BGRA PIX_FMT_BGRA
     #define AV_PIX_FMT_YUV420P PIX_FMT_YUV420P
     #define AV_PIX_FMT_YUVJ420P PIX_FMT_YUVJ420P
+    #define AV_PIX_FMT_YUV422P PIX_FMT_YUV422P
+    #define AV_PIX_FMT_YUVJ422P PIX_FMT_YUVJ422P
     #define AV_PIX_FMT_YUVA420P PIX_FMT_YUVA420P
     #define AV_PIX_FMT_YUYV422 PIX_FMT_YUYV422
 #endif
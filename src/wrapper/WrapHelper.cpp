@@ -512,7 +512,8 @@ void addPythonLogger(PyObject * self, PyObject * pyLogger)
 {
     Logger * logger = Logger::get();
     LogSinkPtr logSink(new PythonLogSink(pyLogger));
-    logger->addLogSink(logSink);
+    // Python sinks need the GIL, so they are called in the logging thread.
+    logger->addLogSink(logSink, true);
     m_pyObjectMap[pyLogger] = logSink;
 }
 
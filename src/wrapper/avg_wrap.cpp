@@ -40,6 +40,7 @@ void export_anim();
 #include "../player/Contact.h"
 #include "../player/OffscreenCanvas.h"
 #include "../player/VersionInfo.h"
+#include "../player/FrameTimeStats.h"
 #include "../player/ExportedObject.h"
 #include "../player/TestHelper.h"
 #include "../anim/Anim.h"
@@ -71,6 +72,32 @@ CanvasPtr createMainCanvas(const boost::python::tuple &args,
     return extract<Player&>(args[0])().createMainCanvas(params);
 }
 
+float FrameTimeStats_getP50(const FrameTimeStats& stats)
+{
+    return stats.getPercentile(50);
+}
+
+float FrameTimeStats_getP95(const FrameTimeStats& stats)
+{
+    return stats.getPercentile(95);
+}
+
+float FrameTimeStats_getP99(const FrameTimeStats& stats)
+{
+    return stats.getPercentile(99);
+}
+
+string FrameTimeStats_getLastJankPhase(const FrameTimeStats& stats)
+{
+    return FrameTimeStats::getPhaseName(stats.getLastJankPhase());
+}
+
+int FrameTimeStats_getNumJankFramesInPhase(const FrameTimeStats& stats,
+        const string& sPhase)
+{
+    return stats.getNumJankFrames(FrameTimeStats::getPhaseFromName(sPhase));
+}
+
 boost::function<size_t (const bp::tuple& args, const bp::dict& kwargs )>
         playerGetMemoryUsage = boost::bind(getMemoryUsage);
 
@@ -144,6 +171,22 @@ BOOST_PYTHON_MODULE(avg)
             .def("useGLES", &Player::useGLES)
             .def("setOGLOptions", &Player::setOGLOptions)
             .def("setMultiSampleSamples", &Player::setMultiSampleSamples)
+            .def("setPreRenderThreads", &Player::setPreRenderThreads)
+            .def("getPreRenderThreads", &Player::getPreRenderThreads)
+            .def("setVideoDecoderThreads", &Player::setVideoDecoderThreads)
+            .def("getVideoDecoderThreads", &Player::getVideoDecoderThreads)
+            .def("getVideoDecoderThreadType", &Player::getVideoDecoderThreadType,
+                    return_value_policy<copy_const_reference>())
+            .def("setVideoZeroCopy", &Player::setVideoZeroCopy)
+            .def("isVideoZeroCopy", &Player::isVideoZeroCopy)
+            .def("setTexUploadBudget", &Player::setTexUploadBudget)
+            .def("getTexUploadBudget", &Player::getTexUploadBudget)
+            .def("getPendingTexUploadBytes", &Player::getPendingTexUploadBytes)
+            .def("getTexUploadFramesToDrain", &Player::getTexUploadFramesToDrain)
+            .def("startTrace", &Player::startTrace)
+            .def("stopTrace", &Player::stopTrace)
+            .def("isTracing", &Player::isTracing)
+            .def("saveTrace", &Player::saveTrace)
             .def("enableGLErrorChecks", &Player::enableGLErrorChecks)
             .def("getScreenResolution", &Player::getScreenResolution)
             .def("getPixelsPerMM", &Player::getPixelsPerMM)
@@ -164,6 +207,8 @@ BOOST_PYTHON_MODULE(avg)
             .def("setFramerate", &Player::setFramerate)
             .def("setVBlankFramerate", &Player::setVBlankFramerate)
             .def("getEffectiveFramerate", &Player::getEffectiveFramerate)
+            .def("getFrameTimeStats", &Player::getFrameTimeStats,
+                    return_value_policy<copy_const_reference>())
             .def("getMemoryUsage", raw_function(playerGetMemoryUsage))
             .def("getTestHelper", &Player::getTestHelper,
                     return_value_policy<reference_existing_object>())
@@ -243,6 +288,21 @@ BOOST_PYTHON_MODULE(avg)
             .add_property("builder", &VersionInfo::getBuilder)
             .add_property("buildtime", &VersionInfo::getBuildTime)
             ;
+
+        class_<FrameTimeStats>("FrameTimeStats", no_init)
+            .def("getPercentile", &FrameTimeStats::getPercentile)
+            .def("getNumJankFramesInPhase", &FrameTimeStats_getNumJankFramesInPhase)
+            .add_property("windowSize", &FrameTimeStats::getWindowSize)
+            .add_property("numFrames", &FrameTimeStats::getNumFrames)
+            .add_property("p50", &FrameTimeStats_getP50)
+            .add_property("p95", &FrameTimeStats_getP95)
+            .add_property("p99", &FrameTimeStats_getP99)
+            .add_property("max", &FrameTimeStats::getMaxFrameTime)
+            .add_property("lastFrameTime", &FrameTimeStats::getLastFrameTime)
+            .add_property("numJankFrames", 
+                    (int (FrameTimeStats::*)() const)&FrameTimeStats::getNumJankFrames)
+            .add_property("lastJankPhase", &FrameTimeStats_getLastJankPhase)
+            ;
     } catch (const exception& e) {
         PyErr_SetString(PyExc_RuntimeError, e.what());
         throw error_already_set();
@@ -166,6 +166,12 @@ BitmapPtr createBitmapFromFile(const UTF8String& sFName)
     return loadBitmap(sFName);
 }
 
+BitmapPtr createBitmapFromFileWithSize(const UTF8String& sFName,
+        const glm::vec2& targetSize)
+{
+    return loadBitmap(sFName, NO_PIXELFORMAT, IntPoint(targetSize));
+}
+
 BitmapPtr createBitmapWithRect(BitmapPtr pBmp,
         const glm::vec2& tlPos, const glm::vec2& brPos)
 {
@@ -183,7 +189,7 @@ BitmapPtr createBitmapWithRect(BitmapPtr pBmp,
 }
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(loadBitmap_overloads, BitmapManager::loadBitmapPy, 
-        2, 3);
+        2, 5);
 
 static bp::object ImageCache_GetCapacity(ImageCache* pCache)
 {
@@ -209,6 +215,26 @@ static bp::object ImageCache_GetMemUsed(ImageCache* pCache)
             pCache->getMemUsed(CachedImage::STORAGE_GPU));
 }
 
+static long long ImageCache_GetDiskCacheMemUsed(ImageCache* pCache)
+{
+    DiskImageCache* pDiskCache = pCache->getDiskCache();
+    if (pDiskCache) {
+        return pDiskCache->getMemUsed();
+    } else {
+        return 0;
+    }
+}
+
+static int ImageCache_GetNumDiskCacheHits(ImageCache* pCache)
+{
+    DiskImageCache* pDiskCache = pCache->getDiskCache();
+    if (pDiskCache) {
+        return pDiskCache->getNumHits();
+    } else {
+        return 0;
+    }
+}
+
 vector<string> getSupportedPixelFormatsDeprecated()
 {
     avgDeprecationWarning("1.9.0", "avg.getSupportedPixelFormats",
@@ -284,6 +310,12 @@ void export_bitmap()
         .value("R32G32B32A32F", R32G32B32A32F)
         .value("I32F", I32F)
         .value("JPEG", JPEG)
+        .value("BC1", BC1)
+        .value("BC3", BC3)
+        .value("ETC2_RGB8", ETC2_RGB8)
+        .value("ETC2_RGBA8", ETC2_RGBA8)
+        .value("ASTC_4x4", ASTC_4x4)
+        .value("NO_PIXELFORMAT", NO_PIXELFORMAT)
         .export_values();
 
     def("getSupportedPixelFormats", &getSupportedPixelFormatsDeprecated);
@@ -295,6 +327,7 @@ void export_bitmap()
         .def(init<Bitmap>())
         .def("__init__", make_constructor(createBitmapWithRect))
         .def("__init__", make_constructor(createBitmapFromFile))
+        .def("__init__", make_constructor(createBitmapFromFileWithSize))
         .def("blt", &Bitmap::blt)
         .def("getResized", &Bitmap_getResized)
         .def("save", &Bitmap::save)
@@ -317,15 +350,34 @@ void export_bitmap()
         .add_property("capacity", ImageCache_GetCapacity, ImageCache_SetCapacity)
         .def("getNumImages", ImageCache_GetNumImages)
         .def("getMemUsed", ImageCache_GetMemUsed)
+        .def("setDiskCache", &ImageCache::setDiskCache)
+        .def("getDiskCacheMemUsed", ImageCache_GetDiskCacheMemUsed)
+        .def("getNumDiskCacheHits", ImageCache_GetNumDiskCacheHits)
     ;
 
-    class_<BitmapManager>("BitmapManager", no_init)
-        .def("get", &BitmapManager::get,
-                return_value_policy<reference_existing_object>())
-        .staticmethod("get")
-        .def("loadBitmap", &BitmapManager::loadBitmapPy, loadBitmap_overloads())
-        .def("setNumThreads", &BitmapManager::setNumThreads)
-    ;
+    {
+        scope bitmapManagerScope =
+                class_<BitmapManager, boost::noncopyable>("BitmapManager", no_init)
+            .def("get", &BitmapManager::get,
+                    return_value_policy<reference_existing_object>())
+            .staticmethod("get")
+            .def("loadBitmap", &BitmapManager::loadBitmapPy, loadBitmap_overloads())
+            .def("cancel", &BitmapManager::cancel)
+            .def("setNumThreads", &BitmapManager::setNumThreads)
+            .def("setMaxCallbacksPerFrame", &BitmapManager::setMaxCallbacksPerFrame)
+            .def("getMaxCallbacksPerFrame", &BitmapManager::getMaxCallbacksPerFrame)
+            .def("getNumPendingRequests", &BitmapManager::getNumPendingRequests)
+            .def("getQueueLength", &BitmapManager::getQueueLength)
+            .def("getLatencyPercentile", &BitmapManager::getLatencyPercentile)
+        ;
+
+        enum_<BitmapManagerMsg::Priority>("Priority")
+            .value("VISIBLE", BitmapManagerMsg::VISIBLE)
+            .value("PREFETCH", BitmapManagerMsg::PREFETCH)
+            .value("BACKGROUND", BitmapManagerMsg::BACKGROUND)
+            .export_values()
+        ;
+    }
 
     class_<CubicSpline, boost::noncopyable>("CubicSpline", no_init)
         .def(init<const vector<glm::vec2>&>())
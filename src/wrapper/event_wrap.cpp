@@ -29,6 +29,9 @@
 #include "../player/Contact.h"
 #include "../player/Publisher.h"
 #include "../player/InputDevice.h"
+#include "../player/TransformTracker.h"
+#include "../player/GestureTracker.h"
+#include "../player/AreaNode.h"
 
 #include <SDL2/SDL_events.h>
 #include <boost/shared_ptr.hpp>
@@ -177,4 +180,47 @@ void export_event()
         .def("isNodeInTargets", &Contact::isNodeInTargets)
         ;
     exportMessages(contactClass, "Contact");
+
+    class_<GestureTransform>("GestureTransform", init<const glm::vec2&,
+            optional<float, float, const glm::vec2&> >())
+        .add_property("trans", make_function(&GestureTransform::getTrans,
+                return_value_policy<copy_const_reference>()))
+        .add_property("rot", &GestureTransform::getRot)
+        .add_property("scale", &GestureTransform::getScale)
+        .add_property("pivot", make_function(&GestureTransform::getPivot,
+                return_value_policy<copy_const_reference>()))
+        .def("moveNode", &GestureTransform::moveNode)
+        ;
+
+    class_<TransformTracker, boost::noncopyable>("TransformTracker", 
+            init<optional<float, float> >())
+        .add_property("numcontacts", &TransformTracker::getNumContacts)
+        .def("addContact", &TransformTracker::addContact)
+        .def("removeContact", &TransformTracker::removeContact)
+        .def("update", &TransformTracker::update)
+        .def("clear", &TransformTracker::clear)
+        ;
+
+    class_<GestureTracker, bases<Publisher>, boost::noncopyable>("GestureTracker",
+            no_init)
+        .add_property("running", &GestureTracker::isRunning)
+        .def("update", &GestureTracker::update)
+        .def("stop", &GestureTracker::stop)
+        ;
+
+    object tapTrackerClass = class_<TapTracker, bases<GestureTracker>,
+            boost::noncopyable>("TapTracker", init<float, optional<float> >())
+        .def("start", &TapTracker::start)
+        .def("setContact", &TapTracker::setContact)
+        .def("restartTimer", &TapTracker::restartTimer)
+        ;
+    exportMessages(tapTrackerClass, "TapTracker");
+
+    object dragTrackerClass = class_<DragTracker, bases<GestureTracker>,
+            boost::noncopyable>("DragTracker", init<int, float, float>())
+        .add_property("startpos", make_function(&DragTracker::getStartPos,
+                return_value_policy<copy_const_reference>()))
+        .def("start", &DragTracker::start)
+        ;
+    exportMessages(dragTrackerClass, "DragTracker");
 }
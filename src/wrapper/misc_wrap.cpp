@@ -74,6 +74,7 @@ void export_misc()
             .def("addSink", addPythonLogger)
             .def("removeSink", removePythonLogger)
             .def("removeStdLogSink", &Logger::removeStdLogSink)
+            .def("flush", &Logger::flush)
             .def("configureCategory", &Logger::configureCategory,
                     (bp::arg("severity")=Logger::severity::NONE))
             .def("getCategories", &Logger::getCategories)
@@ -129,13 +130,19 @@ void export_misc()
         .def("fakeKeyEvent", &TestHelper::fakeKeyEvent)
         .def("dumpObjects", &TestHelper::dumpObjects)
         .def("getObjectCount", &TestHelper::getObjectCount)
+        .def("getNumPooledVideoBuffers", &TestHelper::getNumPooledVideoBuffers)
     ;
 
     class_<VideoWriter, boost::shared_ptr<VideoWriter>, boost::noncopyable>
             ("VideoWriter", no_init)
-        .def(init<CanvasPtr, const std::string&, int, int, int, bool>())
-        .def(init<CanvasPtr, const std::string&, int, int, int>())
-        .def(init<CanvasPtr, const std::string&, int>())
+        .def(init<CanvasPtr, const std::string&,
+                optional<int, int, int, bool, const std::string&, int, int, int, int,
+                bool> >
+                ((bp::arg("canvas"), bp::arg("filename"), bp::arg("framerate")=30,
+                 bp::arg("qmin")=3, bp::arg("qmax")=5, bp::arg("synctoplayback")=true,
+                 bp::arg("codec")="mjpeg", bp::arg("numthreads")=1,
+                 bp::arg("bitrate")=0, bp::arg("crf")=-1, bp::arg("maxqueuesize")=0,
+                 bp::arg("dropframes")=false)))
         .def("stop", &VideoWriter::stop)
         .def("pause", &VideoWriter::pause)
         .def("play", &VideoWriter::play)
@@ -143,6 +150,18 @@ void export_misc()
         .add_property("framerate", &VideoWriter::getFramerate)
         .add_property("qmin", &VideoWriter::getQMin)
         .add_property("qmax", &VideoWriter::getQMax)
+        .add_property("codec", &VideoWriter::getCodec)
+        .add_property("numthreads", &VideoWriter::getNumThreads)
+        .add_property("bitrate", &VideoWriter::getBitRate)
+        .add_property("crf", &VideoWriter::getCRF)
+        .add_property("maxqueuesize", &VideoWriter::getMaxQueueSize)
+        .add_property("dropframes", &VideoWriter::getDropFrames)
+        .add_property("numqueuedframes", &VideoWriter::getNumQueuedFrames)
+        .add_property("numdroppedframes", &VideoWriter::getNumDroppedFrames)
+        .add_property("numencodedframes", &VideoWriter::getNumEncodedFrames)
+        .add_property("encoderlag", &VideoWriter::getEncoderLag)
+        .add_property("maxencoderlag", &VideoWriter::getMaxEncoderLag)
+        .add_property("avgencodetime", &VideoWriter::getAvgEncodeTime)
     ;
 
     BitmapPtr (SVG::*renderElement1)(const UTF8String&) = &SVG::renderElement;
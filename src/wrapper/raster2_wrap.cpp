@@ -48,6 +48,8 @@ void export_raster2()
                 return_value_policy<copy_const_reference>()))
         .add_property("framerate", &CameraNode::getFrameRate)
         .add_property("framenum", &CameraNode::getFrameNum)
+        .add_property("framelatency", &CameraNode::getFrameLatency)
+        .add_property("numdroppedframes", &CameraNode::getNumDroppedFrames)
         .add_property("brightness", &CameraNode::getBrightness, 
                 &CameraNode::setBrightness)
         .add_property("sharpness", &CameraNode::getSharpness, &CameraNode::setSharpness)
@@ -128,6 +130,7 @@ void export_raster2()
         .def("isSeeking", &VideoNode::isSeeking)
         .def("hasAudio", &VideoNode::hasAudio)
         .def("hasAlpha", &VideoNode::hasAlpha)
+        .def("getAvgDecodeTime", &VideoNode::getAvgDecodeTime)
         .def("setEOFCallback", &VideoNode::setEOFCallback)
         .add_property("fps", &VideoNode::getFPS)
         .add_property("queuelength", &VideoNode::getQueueLength)
@@ -138,6 +141,10 @@ void export_raster2()
         .add_property("loop", &VideoNode::getLoop)
         .add_property("volume", &VideoNode::getVolume, &VideoNode::setVolume)
         .add_property("threaded", &VideoNode::isThreaded)
+        .add_property("decoderthreads", &VideoNode::getDecoderThreads)
+        .add_property("decoderthreadtype", 
+                make_function(&VideoNode::getDecoderThreadType,
+                        return_value_policy<copy_const_reference>()))
         .add_property("duration", &VideoNode::getDuration)
     ;
 }